@@ -65,20 +65,36 @@ namespace Halley {
 		int version = 0;
 	};
 
+	// Scratch buffer borrowed from a thread-local pool, and returned to it on destruction
+	class SerializerBuffer {
+	public:
+		SerializerBuffer();
+		~SerializerBuffer();
+
+		SerializerBuffer(const SerializerBuffer& other) = delete;
+		SerializerBuffer(SerializerBuffer&& other) = delete;
+		SerializerBuffer& operator=(const SerializerBuffer& other) = delete;
+		SerializerBuffer& operator=(SerializerBuffer&& other) = delete;
+
+		Bytes& getBytes() { return bytes; }
+
+	private:
+		Bytes bytes;
+	};
+
 	class Serializer : public ByteSerializationBase {
 	public:
 		Serializer(SerializerOptions options);
 		explicit Serializer(gsl::span<gsl::byte> dst, SerializerOptions options);
+		explicit Serializer(Bytes& dst, SerializerOptions options); // Appends to dst, growing it as needed
 
 		template <typename T, typename std::enable_if<std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
 		static Bytes toBytes(const T& f, SerializerOptions options = {})
 		{
-			auto dry = Serializer(options);
-			f(dry);
-			Bytes result(dry.getSize());
-			auto s = Serializer(gsl::as_writable_bytes(gsl::span<Halley::Byte>(result)), options);
-			f(s);
-			return result;
+			SerializerBuffer buffer;
+			toBytes(f, buffer.getBytes(), std::move(options));
+			const auto& bytes = buffer.getBytes();
+			return Bytes(bytes.begin(), bytes.end());
 		}
 
 		template <typename T, typename std::enable_if<!std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
@@ -86,6 +102,36 @@ namespace Halley {
 		{
 			return toBytes([&value](Serializer& s) { s << value; }, options);
 		}
+
+		// Serializes into dst in a single pass, replacing its contents but reusing its capacity
+		template <typename T, typename std::enable_if<std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
+		static void toBytes(const T& f, Bytes& dst, SerializerOptions options = {})
+		{
+			dst.clear();
+			auto s = Serializer(dst, std::move(options));
+			f(s);
+		}
+
+		template <typename T, typename std::enable_if<!std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
+		static void toBytes(const T& value, Bytes& dst, SerializerOptions options = {})
+		{
+			toBytes([&value](Serializer& s) { s << value; }, dst, std::move(options));
+		}
+
+		// Serializes into a caller-provided span, returning the number of bytes written. Throws if it doesn't fit.
+		template <typename T, typename std::enable_if<std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
+		static size_t toSpan(const T& f, gsl::span<gsl::byte> dst, SerializerOptions options = {})
+		{
+			auto s = Serializer(dst, std::move(options));
+			f(s);
+			return s.getSize();
+		}
+
+		template <typename T, typename std::enable_if<!std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
+		static size_t toSpan(const T& value, gsl::span<gsl::byte> dst, SerializerOptions options = {})
+		{
+			return toSpan([&value](Serializer& s) { s << value; }, dst, std::move(options));
+		}
 		
 		template <typename T, typename std::enable_if<std::is_convertible<T, std::function<void(Serializer&)>>::value, int>::type = 0>
 		static size_t getSize(const T& f, SerializerOptions options = {})
@@ -280,9 +326,16 @@ namespace Halley {
 		}
 
 	private:
+		enum class Mode : uint8_t {
+			DryRun,
+			Span,
+			Growable
+		};
+
 		size_t size = 0;
 		gsl::span<gsl::byte> dst;
-		bool dryRun;
+		Bytes* growableDst = nullptr;
+		Mode mode;
 
 		template <typename T>
 		Serializer& serializePod(T val)
@@ -368,6 +421,9 @@ namespace Halley {
 		Deserializer& operator>>(gsl::span<gsl::byte> span);
 		Deserializer& operator>>(Bytes& bytes);
 
+		// Reads a string without copying it. The view points into the source data or the dictionary, so it's only valid while those are.
+		std::string_view readStringView();
+
 		template <typename T>
 		Deserializer& operator>>(Vector<T>& val)
 		{
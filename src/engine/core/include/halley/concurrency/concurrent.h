@@ -1,6 +1,13 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <halley/text/halleystring.h>
 #include "executor.h"
 #include "future.h"
@@ -43,28 +50,133 @@ namespace Halley
 			return future.getFuture();
 		}
 
-		template <typename T, typename F>
-		void foreach(ExecutionQueue& e, T begin, T end, F f)
+		// Calls f(i) for every i in [begin, end), split into chunks of grainSize indices.
+		// Chunks are claimed from a shared counter by the calling thread and up to one helper task per worker thread,
+		// so the caller never blocks while there's work left and nested calls from inside f are safe.
+		// Once every chunk is claimed, the caller sleeps until the ones running on other threads are done.
+		template <typename F>
+		void parallel_for(ExecutionQueue& e, size_t begin, size_t end, size_t grainSize, F f)
+		{
+			if (end <= begin) {
+				return;
+			}
+
+			const size_t grain = std::max(grainSize, size_t(1));
+			const size_t nChunks = (end - begin + grain - 1) / grain;
+			const size_t nHelpers = std::min(e.threadCount(), nChunks - 1);
+			if (nHelpers == 0) {
+				for (size_t i = begin; i < end; ++i) {
+					f(i);
+				}
+				return;
+			}
+
+			struct State {
+				std::atomic<size_t> nextChunk { 0 };
+				std::atomic<size_t> chunksDone { 0 };
+				std::atomic<bool> failed { false };
+				std::exception_ptr error;
+				std::mutex mutex;
+				std::condition_variable done;
+			};
+			auto state = std::make_shared<State>();
+
+			// Helpers that only get to run after every chunk has been claimed return without touching f
+			auto runChunks = [state, begin, end, grain, nChunks, f = &f] ()
+			{
+				for (size_t chunk = state->nextChunk++; chunk < nChunks; chunk = state->nextChunk++) {
+					const size_t chunkStart = begin + chunk * grain;
+					const size_t chunkEnd = std::min(chunkStart + grain, end);
+					try {
+						for (size_t i = chunkStart; i < chunkEnd; ++i) {
+							(*f)(i);
+						}
+					} catch (...) {
+						if (!state->failed.exchange(true)) {
+							state->error = std::current_exception();
+						}
+					}
+					if (++state->chunksDone == nChunks) {
+						std::unique_lock<std::mutex> lock(state->mutex);
+						state->done.notify_all();
+					}
+				}
+			};
+
+			for (size_t i = 0; i < nHelpers; ++i) {
+				e.addToQueue(runChunks);
+			}
+			runChunks();
+
+			// The remaining chunks are all running on other threads, so they're guaranteed to finish
+			{
+				std::unique_lock<std::mutex> lock(state->mutex);
+				state->done.wait(lock, [&] { return state->chunksDone.load() == nChunks; });
+			}
+
+			if (state->error) {
+				std::rethrow_exception(state->error);
+			}
+		}
+
+		template <typename F>
+		void parallel_for(size_t begin, size_t end, size_t grainSize, F f)
+		{
+			parallel_for(ExecutionQueue::getDefault(), begin, end, grainSize, std::move(f));
+		}
+
+		// Sorts [begin, end) by sorting up to one chunk per thread in parallel, then merging neighbouring chunks pairwise.
+		// If no two elements compare equal, the result is exactly the same as std::sort's.
+		template <typename Iter>
+		void parallel_sort(ExecutionQueue& e, Iter begin, Iter end, size_t minElementsPerChunk)
 		{
 			const size_t n = end - begin;
-			constexpr size_t maxThreads = 8;
-			size_t nThreads = std::max(size_t(1), std::min(maxThreads, e.threadCount()));
-			std::array<Future<void>, maxThreads> futures;
-
-			size_t prevEnd = 0;
-			for (size_t j = 0; j < nThreads; ++j) {
-				size_t curStart = prevEnd;
-				size_t curEnd = n * (j + 1) / nThreads;
-				prevEnd = curEnd;
-
-				futures[j] = execute([begin, f, curStart, curEnd]() {
-					for (auto i = begin + curStart; i < begin + curEnd; ++i) {
-						f(*i);
+			const size_t nChunks = std::min(e.threadCount() + 1, n / std::max(minElementsPerChunk, size_t(1)));
+			if (nChunks < 2) {
+				std::sort(begin, end);
+				return;
+			}
+
+			Vector<size_t> bounds(nChunks + 1);
+			for (size_t i = 0; i <= nChunks; ++i) {
+				bounds[i] = i * n / nChunks;
+			}
+
+			parallel_for(e, 0, nChunks, 1, [&] (size_t i)
+			{
+				std::sort(begin + bounds[i], begin + bounds[i + 1]);
+			});
+
+			for (size_t width = 1; width < nChunks; width *= 2) {
+				const size_t nMerges = (nChunks + 2 * width - 1) / (2 * width);
+				parallel_for(e, 0, nMerges, 1, [&] (size_t i)
+				{
+					const size_t lo = i * 2 * width;
+					const size_t mid = std::min(lo + width, nChunks);
+					const size_t hi = std::min(lo + 2 * width, nChunks);
+					if (mid < hi) {
+						std::inplace_merge(begin + bounds[lo], begin + bounds[mid], begin + bounds[hi]);
 					}
 				});
 			}
+		}
+
+		template <typename Iter>
+		void parallel_sort(Iter begin, Iter end, size_t minElementsPerChunk)
+		{
+			parallel_sort(ExecutionQueue::getDefault(), begin, end, minElementsPerChunk);
+		}
 
-			whenAll(futures.data(), futures.data() + nThreads).wait();
+		template <typename T, typename F>
+		void foreach(ExecutionQueue& e, T begin, T end, F f)
+		{
+			// A few chunks per thread, so threads that finish early pick up the slack
+			const size_t n = end - begin;
+			const size_t grain = std::max(size_t(1), n / (std::max(e.threadCount(), size_t(1)) * 4));
+			parallel_for(e, 0, n, grain, [&] (size_t i)
+			{
+				f(*(begin + i));
+			});
 		}
 
 		template <typename T, typename F>
@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <deque>
 #include <thread>
 #include <mutex>
@@ -12,6 +13,48 @@ namespace Halley
 {
 	using TaskBase = std::function<void()>;
 
+	// Chase-Lev work-stealing deque, with the memory orderings from Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+	// Only the owning thread may push and pop (at the bottom), any thread may steal (from the top). Neither side takes a lock.
+	// Buffers replaced when growing are kept until the deque is destroyed, as thieves might still be reading from them.
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque(size_t initialCapacity = 64);
+		~WorkStealingDeque();
+
+		WorkStealingDeque(const WorkStealingDeque& other) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+		void push(TaskBase task);
+		TaskBase pop();
+
+		// Might return an empty task while there's still work left, if another thread took the same task first
+		TaskBase steal();
+
+		size_t size() const;
+
+	private:
+		struct Buffer {
+			size_t mask;
+			std::unique_ptr<std::atomic<TaskBase*>[]> items;
+
+			explicit Buffer(size_t capacity);
+			size_t capacity() const { return mask + 1; }
+			TaskBase* get(int64_t idx) const { return items[static_cast<size_t>(idx) & mask].load(std::memory_order_relaxed); }
+			void put(int64_t idx, TaskBase* task) { items[static_cast<size_t>(idx) & mask].store(task, std::memory_order_relaxed); }
+		};
+
+		std::atomic<int64_t> top;
+		std::atomic<int64_t> bottom;
+		std::atomic<Buffer*> buffer;
+		Vector<std::unique_ptr<Buffer>> buffers;
+
+		Buffer* grow(Buffer* old, int64_t top, int64_t bottom);
+	};
+
+	// Tasks queued from outside go into a shared queue. Threads running the queue (see Executor::runForever) also get
+	// a lock-free deque of their own: tasks they queue go there, they pop from the back (LIFO, cache friendly for fork/join),
+	// and idle threads steal from the front of other threads' deques before going to sleep.
 	class ExecutionQueue
 	{
 	public:
@@ -25,6 +68,7 @@ namespace Halley
 		size_t threadCount() const;
 		void onAttached();
 		void onDetached();
+		void attachWorkerThread();
 		void abort();
 
 		void setImmediate(bool immediate);
@@ -32,15 +76,26 @@ namespace Halley
 		static ExecutionQueue& getDefault();
 
 	private:
+		constexpr static size_t maxWorkers = 64;
+
 		std::deque<TaskBase> queue;
 		std::mutex mutex;
 		std::condition_variable condition;
 
+		std::array<std::unique_ptr<WorkStealingDeque>, maxWorkers> workers;
+		std::atomic<size_t> workerCount;
+		std::atomic<size_t> pendingTasks;
+		std::atomic<int> sleepingCount;
+
 		std::atomic<int> attachedCount;
 		std::atomic<bool> hasTasks;
 		std::atomic<bool> aborted;
 
 		bool immediate = false;
+
+		WorkStealingDeque* getCurrentWorker() const;
+		TaskBase tryGetNext();
+		void notifyTaskAdded();
 	};
 
 	class Executors
@@ -50,6 +105,7 @@ namespace Halley
 
 		static Executors& get();
 		static void setInstance(Executors& e);
+		static bool hasInstance() { return instance != nullptr; }
 
 		static ExecutionQueue& getCPU() { return instance->cpu; }
 		static ExecutionQueue& getCPUAux() { return instance->cpuAux; }
@@ -55,7 +55,18 @@ namespace Halley
 	class BinPack
 	{
 	public:
+		// MaxRects packing, trying several heuristics and entry orders in parallel and keeping the tightest result
 		static std::optional<Vector<BinPackResult>> pack(const Vector<BinPackEntry>& entries, Vector2i binSize);
+
+		// Single MaxRects pass with one heuristic that doesn't look at the placed rects. Much cheaper than pack() on
+		// large inputs, and usually tighter than fastPack()
+		static std::optional<Vector<BinPackResult>> quickPack(const Vector<BinPackEntry>& entries, Vector2i binSize);
+
+		// Single pass skyline packing, much cheaper than pack() but not as tight
 		static std::optional<Vector<BinPackResult>> fastPack(const Vector<BinPackEntry>& entries, Vector2i binSize);
+
+		// Keeps entries that are still present in previous (matched by data, with the same size) where they were,
+		// and packs the rest around them. Falls back to a full pack() if they don't fit.
+		static std::optional<Vector<BinPackResult>> repack(const Vector<BinPackEntry>& entries, const Vector<BinPackResult>& previous, Vector2i binSize);
 	};
 }
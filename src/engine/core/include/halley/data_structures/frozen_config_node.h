@@ -0,0 +1,219 @@
+#pragma once
+
+#include "config_node.h"
+
+namespace Halley {
+	class FrozenConfigNode;
+
+	// Read-only handle to a node stored in a FrozenConfigNode.
+	// Cheap to copy, and valid for as long as the FrozenConfigNode that owns it.
+	class ConfigNodeView {
+		friend class FrozenConfigNode;
+
+	public:
+		class SequenceIterator {
+		public:
+			SequenceIterator(const FrozenConfigNode* owner, uint32_t idx) : owner(owner), idx(idx) {}
+
+			ConfigNodeView operator*() const { return ConfigNodeView(owner, idx); }
+			SequenceIterator& operator++() { ++idx; return *this; }
+			bool operator==(const SequenceIterator& other) const { return idx == other.idx; }
+			bool operator!=(const SequenceIterator& other) const { return idx != other.idx; }
+
+		private:
+			const FrozenConfigNode* owner;
+			uint32_t idx;
+		};
+
+		class MapIterator {
+		public:
+			MapIterator(const FrozenConfigNode* owner, uint32_t idx) : owner(owner), idx(idx) {}
+
+			std::pair<std::string_view, ConfigNodeView> operator*() const;
+			MapIterator& operator++() { ++idx; return *this; }
+			bool operator==(const MapIterator& other) const { return idx == other.idx; }
+			bool operator!=(const MapIterator& other) const { return idx != other.idx; }
+
+		private:
+			const FrozenConfigNode* owner;
+			uint32_t idx;
+		};
+
+		template <typename Iter>
+		class NodeRange {
+		public:
+			NodeRange(Iter b, Iter e, size_t size) : b(b), e(e), sz(size) {}
+
+			Iter begin() const { return b; }
+			Iter end() const { return e; }
+			size_t size() const { return sz; }
+			bool empty() const { return sz == 0; }
+
+		private:
+			Iter b;
+			Iter e;
+			size_t sz;
+		};
+
+		ConfigNodeView() = default;
+
+		ConfigNodeType getType() const;
+
+		int asInt() const;
+		int64_t asInt64() const;
+		EntityId asEntityId() const;
+		float asFloat() const;
+		bool asBool() const;
+		Vector2i asVector2i() const;
+		Vector2f asVector2f() const;
+		Vector3i asVector3i() const;
+		Vector3f asVector3f() const;
+		Vector4i asVector4i() const;
+		Vector4f asVector4f() const;
+		Rect4i asRect4i() const;
+		Rect4f asRect4f() const;
+		Range<int> asIntRange() const;
+		Range<float> asFloatRange() const;
+		String asString() const;
+		std::string_view asStringView() const;
+		gsl::span<const gsl::byte> asBytes() const;
+
+		int asInt(int defaultValue) const;
+		int64_t asInt64(int64_t defaultValue) const;
+		float asFloat(float defaultValue) const;
+		bool asBool(bool defaultValue) const;
+		String asString(const std::string_view& defaultValue) const;
+		std::string_view asStringView(const std::string_view& defaultValue) const;
+		Vector2i asVector2i(Vector2i defaultValue) const;
+		Vector2f asVector2f(Vector2f defaultValue) const;
+
+		template <typename T>
+		T asType() const
+		{
+			if constexpr (std::is_same_v<T, int>) {
+				return asInt();
+			} else if constexpr (std::is_same_v<T, float>) {
+				return asFloat();
+			} else if constexpr (std::is_same_v<T, bool>) {
+				return asBool();
+			} else if constexpr (std::is_same_v<T, String>) {
+				return asString();
+			} else {
+				return toConfigNode().asType<T>();
+			}
+		}
+
+		template <typename T>
+		T asType(T defaultValue) const
+		{
+			if (getType() == ConfigNodeType::Undefined) {
+				return defaultValue;
+			}
+			return asType<T>();
+		}
+
+		template <typename T>
+		Vector<T> asVector() const
+		{
+			if (getType() == ConfigNodeType::Sequence) {
+				Vector<T> result;
+				result.reserve(getSequenceSize());
+				for (const auto& e: asSequence()) {
+					result.push_back(e.asType<T>());
+				}
+				return result;
+			}
+			return toConfigNode().asVector<T>();
+		}
+
+		NodeRange<SequenceIterator> asSequence() const;
+		NodeRange<MapIterator> asMap() const;
+		size_t getSequenceSize(size_t defaultValue = 0) const;
+
+		bool hasKey(std::string_view key) const;
+
+		// Returns an undefined node if the key isn't present
+		ConfigNodeView operator[](std::string_view key) const;
+		ConfigNodeView operator[](size_t idx) const;
+
+		SequenceIterator begin() const;
+		SequenceIterator end() const;
+
+		ConfigNode toConfigNode() const;
+
+	private:
+		const FrozenConfigNode* owner = nullptr;
+		uint32_t idx = 0;
+
+		ConfigNodeView(const FrozenConfigNode* owner, uint32_t idx) : owner(owner), idx(idx) {}
+
+		String getNodeDebugId() const;
+	};
+
+	// Immutable ConfigNode tree stored in a few flat arrays: one for nodes (children of each container are contiguous),
+	// one for string and byte data, and an interned key table. Map children are sorted by key, for binary search.
+	// Meant for data that is only read at runtime, as deserializing it takes a handful of allocations rather than one per node.
+	class FrozenConfigNode {
+		friend class ConfigNodeView;
+
+	public:
+		FrozenConfigNode();
+		explicit FrozenConfigNode(const ConfigNode& node);
+
+		FrozenConfigNode(const FrozenConfigNode& other) = delete;
+		FrozenConfigNode(FrozenConfigNode&& other) noexcept = default;
+		FrozenConfigNode& operator=(const FrozenConfigNode& other) = delete;
+		FrozenConfigNode& operator=(FrozenConfigNode&& other) noexcept = default;
+
+		ConfigNodeView getRoot() const;
+
+		// Reads the same format as ConfigNode::deserialize
+		void deserialize(Deserializer& s);
+
+		size_t getSizeBytes() const;
+		size_t getNodeCount() const;
+
+	private:
+		constexpr static uint32_t noKey = std::numeric_limits<uint32_t>::max();
+
+		struct Node {
+			union {
+				int intData;
+				float floatData;
+				int64_t int64Data;
+				Vector2i vec2iData;
+				Vector2f vec2fData;
+				struct {
+					uint32_t start; // First child, or offset into data
+					uint32_t count; // Number of children, or number of bytes
+				} range;
+			};
+			ConfigNodeType type = ConfigNodeType::Undefined;
+
+			Node() : int64Data(0) {}
+		};
+
+		Vector<Node> nodes;
+		Vector<uint32_t> keys; // Interned key id of each node, for map children
+		Vector<char> data;
+		Vector<std::pair<uint32_t, uint32_t>> keyTable; // Offset and length into data of each interned key
+		Vector<std::pair<int, int>> positions; // Line and column of each node in its source file, if the data had them
+		HashMap<String, uint32_t> keyIds; // Only used while building
+
+		const Node& getNode(uint32_t idx) const { return nodes[idx]; }
+		std::string_view getKey(uint32_t nodeIdx) const;
+		std::string_view getData(const Node& node) const;
+		std::optional<uint32_t> findKey(const Node& map, std::string_view key) const;
+
+		uint32_t allocateNodes(size_t count);
+		uint32_t internKey(std::string_view key);
+		Node makeDataNode(ConfigNodeType type, gsl::span<const gsl::byte> bytes);
+		void sortMapChildren(const Node& map);
+		void finishBuilding();
+
+		void deserializeNode(Deserializer& s, uint32_t idx, bool storeFilePosition);
+		void freezeNode(const ConfigNode& src, uint32_t idx);
+		ConfigNode thawNode(uint32_t idx) const;
+		ConfigNode thawNodeData(uint32_t idx) const;
+	};
+}
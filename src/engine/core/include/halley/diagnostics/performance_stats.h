@@ -77,6 +77,7 @@ namespace Halley
 		TextRenderer fpsLabel;
 		TextRenderer graphLabel;
 		TextRenderer connLabel;
+		TextRenderer resourceLabel;
 		Vector<TextRenderer> systemLabels;
 
 		AveragingLatched<int64_t> totalFrameTime;
@@ -114,6 +115,7 @@ namespace Halley
 		void drawTimeGraphThreads(Painter& painter, Rect4f rect, Range<ProfilerData::TimePoint> timeRange);
 		void drawTimeGraphThread(Painter& painter, Rect4f rect, const ProfilerData::ThreadInfo& threadInfo, Range<ProfilerData::TimePoint> timeRange);
 		void drawTopEvents(Painter& painter, Rect4f rect, Time t, const HashMap<String, EventHistoryData>& eventHistory);
+		void drawResourceStats(Painter& painter, Rect4f rect);
 		void drawNetworkStats(Painter& painter, Rect4f rect);
 		
 		Colour4f getEventColour(ProfilerEventType event) const;
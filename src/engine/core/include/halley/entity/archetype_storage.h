@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <gsl/span>
+#include "halley/data_structures/vector.h"
+#include "halley/data_structures/hash_map.h"
+
+namespace Halley {
+	class Entity;
+	class TypeDeleterBase;
+	class ComponentDeleterTable;
+
+	// Opt-in storage that keeps the components of all entities with the same set of components (an "archetype")
+	// contiguously in fixed-size chunks, one array per component type (SoA), instead of one allocation per component.
+	// Entities keep pointing at their components through Entity::components, so EntityRef stays valid across moves;
+	// families must be refreshed whenever an entity is relocated. Relocation bumps the entity's component revision, so
+	// raw component pointers must not be kept across updates unless they're re-fetched when that revision changes.
+	// Entities that are already stored are not moved as soon as their components change, but only once their set of
+	// components has been stable for a whole update, so components that are toggled often don't drag the rest along.
+	class ArchetypeStorage {
+	public:
+		constexpr static size_t chunkSize = 16 * 1024;
+
+		explicit ArchetypeStorage(ComponentDeleterTable& table);
+		~ArchetypeStorage();
+
+		ArchetypeStorage(const ArchetypeStorage& other) = delete;
+		ArchetypeStorage& operator=(const ArchetypeStorage& other) = delete;
+
+		// Moves all live components of a new entity into a row of the archetype matching its components.
+		// Entities that already have a row are queued for flushPending() instead. Returns true if any component moved,
+		// or if the entity's row started or stopped being visited by forEachChunk(); either way, families must be refreshed.
+		bool relocate(Entity& entity);
+
+		// Relocates every entity queued before the last call, and returns them
+		Vector<Entity*> flushPending();
+		bool hasPending() const;
+
+		// Moves all components of the entity back into individual allocations, e.g. before it leaves the world
+		void evict(Entity& entity);
+
+		// Frees the row of an entity whose components have already been destroyed
+		void release(Entity& entity);
+
+		bool owns(const void* ptr) const;
+
+		// Whether forEachChunk() visits this entity: it has a row, all its components are in it, and it's enabled
+		bool isChunked(const Entity& entity) const;
+
+		// Calls f(Entity* const* entities, size_t count, void* const* columns) for every chunk of every archetype that
+		// has all the non-optional components listed. columns[i] points at the first componentIds[i] in the chunk, or is
+		// null if that optional component isn't part of the archetype. Rows with a null entity must be skipped.
+		template <typename F>
+		void forEachChunk(gsl::span<const int> componentIds, gsl::span<const bool> optional, F&& f) const
+		{
+			Vector<const Column*> columns(componentIds.size());
+			Vector<void*> bases(componentIds.size());
+
+			for (const auto& [ids, archetype]: archetypes) {
+				if (!archetype || archetype->nextRow == 0) {
+					continue;
+				}
+
+				bool matches = true;
+				for (size_t i = 0; i < componentIds.size() && matches; ++i) {
+					size_t idx = 0;
+					columns[i] = archetype->tryGetColumn(componentIds[i], idx);
+					matches = columns[i] || optional[i];
+				}
+				if (!matches) {
+					continue;
+				}
+
+				for (size_t chunk = 0; chunk * archetype->rowsPerChunk < archetype->nextRow; ++chunk) {
+					const size_t firstRow = chunk * archetype->rowsPerChunk;
+					for (size_t i = 0; i < columns.size(); ++i) {
+						bases[i] = columns[i] ? archetype->chunks[chunk] + columns[i]->offset : nullptr;
+					}
+					f(archetype->rows.data() + firstRow, std::min(archetype->rowsPerChunk, archetype->nextRow - firstRow), bases.data());
+				}
+			}
+		}
+
+		size_t getNumArchetypes() const;
+		size_t getNumChunks() const;
+		size_t getNumEntities() const;
+
+	private:
+		struct Column {
+			int componentId;
+			size_t offset;
+			size_t size;
+			TypeDeleterBase* type;
+		};
+
+		class Archetype {
+		public:
+			Vector<Column> columns;
+			size_t rowsPerChunk = 0;
+			Vector<std::byte*> chunks;
+			Vector<uint32_t> freeRows;
+			Vector<Entity*> rows; // Null if free, or if the entity's components aren't all in place
+			uint32_t nextRow = 0;
+
+			void* getAddress(uint32_t row, size_t column) const;
+			const Column* tryGetColumn(int componentId, size_t& idx) const;
+		};
+
+		struct Location {
+			Archetype* archetype = nullptr;
+			uint32_t row = 0;
+		};
+
+		ComponentDeleterTable& table;
+		std::map<Vector<int>, std::unique_ptr<Archetype>> archetypes;
+		HashMap<const Entity*, Location> locations;
+		HashSet<const std::byte*> chunkSet;
+		HashMap<Entity*, uint32_t> pending;
+		uint32_t generation = 0;
+
+		bool doRelocate(Entity& entity);
+		bool isInPlace(const Entity& entity, const Location& location) const;
+		bool setRowEntity(const Location& location, Entity* entity);
+		Archetype* getArchetype(const Vector<int>& componentIds);
+		uint32_t allocRow(Archetype& archetype);
+		void freeRow(Archetype& archetype, uint32_t row);
+	};
+}
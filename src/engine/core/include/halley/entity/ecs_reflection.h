@@ -1,4 +1,5 @@
 #pragma once
+#include <gsl/span>
 #include "halley/data_structures/config_node.h"
 
 namespace Halley {
@@ -27,6 +28,10 @@ namespace Halley {
 		virtual ConfigNode serialize(const EntitySerializationContext& context, const Component& component) const = 0;
 		virtual CreateComponentFunctionResult createComponent(const EntityFactoryContext& context, EntityRef& e, const ConfigNode& node) const = 0;
 
+		// Deserializes a component that addComponentCopy() can then add to any number of entities. Null if it can't be copied.
+		virtual std::shared_ptr<const Component> createPrototype(const EntitySerializationContext& context, const ConfigNode& node) const = 0;
+		virtual void addComponentCopy(EntityRef& e, const Component& prototype) const = 0;
+
 		virtual ConfigNode serializeField(const EntitySerializationContext& context, const Component& component, std::string_view fieldName) const = 0;
 		virtual ConfigNode serializeField(const EntitySerializationContext& context, EntityRef entity, std::string_view fieldName) const = 0;
 		virtual ConfigNode serializeField(const EntitySerializationContext& context, ConstEntityRef entity, std::string_view fieldName) const = 0;
@@ -37,6 +42,9 @@ namespace Halley {
 		virtual const Component* tryGetComponent(ConstEntityRef entity) const = 0;
 
 		virtual void rebindComponent(Component& component, EntityRef entity) const = 0;
+
+		// Fields sent over the network, in codegen order. Empty for components generated before this was added.
+		virtual gsl::span<const char* const> getNetworkFieldNames() const = 0;
     };
 
 	class MessageReflector {
@@ -4,6 +4,9 @@
 #include "halley/entity/entity_factory.h"
 
 namespace Halley {
+	template <class, class = std::void_t<>> struct HasNetworkFieldNames : std::false_type {};
+	template <class T> struct HasNetworkFieldNames<T, std::void_t<decltype(T::networkFieldNames)>> : std::true_type { };
+
 	template <typename T>
 	class ComponentReflectorImpl final : public ComponentReflector {
 	public:
@@ -29,6 +32,24 @@ namespace Halley {
 			return context.createComponent<T>(e, node);
 		}
 
+		std::shared_ptr<const Component> createPrototype(const EntitySerializationContext& context, const ConfigNode& node) const override
+		{
+			if constexpr (std::is_copy_constructible_v<T>) {
+				auto result = std::make_shared<T>();
+				result->deserialize(context, node);
+				return result;
+			} else {
+				return {};
+			}
+		}
+
+		void addComponentCopy(EntityRef& e, const Component& prototype) const override
+		{
+			if constexpr (std::is_copy_constructible_v<T>) {
+				e.addComponent<T>(T(static_cast<const T&>(prototype)));
+			}
+		}
+
 		ConfigNode serializeField(const EntitySerializationContext& context, const Component& component, std::string_view fieldName) const override
 		{
 			return static_cast<const T&>(component).serializeField(context, fieldName);
@@ -84,6 +105,15 @@ namespace Halley {
 				static_cast<T&>(component).onAddedToEntity(entity);
 			}
 		}
+
+		gsl::span<const char* const> getNetworkFieldNames() const override
+		{
+			if constexpr (HasNetworkFieldNames<T>::value) {
+				return T::networkFieldNames;
+			} else {
+				return {};
+			}
+		}
 	};
 
 	template <typename T>
@@ -45,6 +45,7 @@ namespace Halley {
 	{
 		friend class World;
 		friend class System;
+		friend class ArchetypeStorage;
 		friend class EntityRef;
 		friend class ConstEntityRef;
 
@@ -139,7 +140,7 @@ namespace Halley {
 			return enabled;
 		}
 
-		void setEnabled(bool enabled);
+		void setEnabled(World& world, bool enabled);
 		
 		const UUID& getPrefabUUID() const
 		{
@@ -200,6 +201,7 @@ namespace Halley {
 		WorldPartitionId worldPartition = 0;
 		uint8_t hierarchyRevision = 0;
 		uint8_t componentRevision = 0;
+		uint32_t worldIndex = 0;
 
 		Entity();
 		void destroyComponents(ComponentDeleterTable& storage);
@@ -231,17 +233,19 @@ namespace Halley {
 		void onReady();
 
 		void markDirty(World& world);
+		void setDirty(World& world);
 		ComponentDeleterTable& getComponentDeleterTable(World& world);
 
 		Entity* getParent() const { return parent; }
-		void setParent(Entity* parent, bool propagate = true, size_t childIdx = -1);
+		void setParent(World& world, Entity* parent, bool propagate = true, size_t childIdx = -1);
 		const Vector<Entity*>& getChildren() const { return children; }
-		void addChild(Entity& child);
-		void detachChildren();
+		void addChild(World& world, Entity& child);
+		void detachChildren(World& world);
 		void markHierarchyDirty();
 		void propagateChildrenChange();
+		void onComponentsRelocated();
 		void propagateChildWorldPartition(WorldPartitionId newWorldPartition);
-		void propagateEnabled(bool enabled, bool parentEnabled);
+		void propagateEnabled(World& world, bool enabled, bool parentEnabled);
 
 		DataInterpolatorSet& setupNetwork(EntityRef& ref, uint8_t peerId);
 		std::optional<uint8_t> getOwnerPeerId() const;
@@ -639,13 +643,13 @@ namespace Halley {
 		void setParent(const EntityRef& parent, size_t childIdx = -1)
 		{
 			validate();
-			entity->setParent(parent.entity, true, childIdx);
+			entity->setParent(*world, parent.entity, true, childIdx);
 		}
 
 		void setParent()
 		{
 			validate();
-			entity->setParent(nullptr);
+			entity->setParent(*world, nullptr);
 		}
 
 		const Vector<Entity*>& getRawChildren() const
@@ -682,13 +686,13 @@ namespace Halley {
 		void addChild(EntityRef& child)
 		{
 			validate();
-			entity->addChild(*child.entity);
+			entity->addChild(*world, *child.entity);
 		}
 
 		void detachChildren()
 		{
 			validate();
-			entity->detachChildren();
+			entity->detachChildren(*world);
 		}
 
 		uint8_t getHierarchyRevision() const
@@ -747,7 +751,7 @@ namespace Halley {
 		void setEnabled(bool enabled)
 		{
 			validate();
-			entity->setEnabled(enabled);
+			entity->setEnabled(*world, enabled);
 		}
 
 		bool operator==(const EntityRef& other) const
@@ -10,6 +10,7 @@ namespace Halley {
 
 	class EntityDataDelta final : public IEntityData {
 		friend class EntityData;
+		friend class EntityNetworkDeltaCodec;
 		
 	public:
         class Options {
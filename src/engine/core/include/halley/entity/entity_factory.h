@@ -40,6 +40,9 @@ namespace Halley {
 		
 		EntityRef createEntity(const String& prefabName, EntityRef parent = EntityRef(), EntityScene* scene = nullptr);
 		EntityRef createEntity(const EntityData& data, int mask, EntityRef parent = EntityRef(), EntityScene* scene = nullptr, EntityFactoryContext* parentContext = nullptr);
+		// Instantiates count copies of prefab from its compiled template, calling initializer on each root as it's created.
+		// Like a scene load, roots spawned without a parent are added to the scene.
+		Vector<EntityRef> spawnBatch(const std::shared_ptr<const Prefab>& prefab, size_t count, const std::function<void(EntityRef, size_t)>& initializer = {}, EntityRef parent = EntityRef(), EntityScene* scene = nullptr);
 		EntityScene createScene(const std::shared_ptr<const Prefab>& scene, bool allowReload, WorldPartitionId worldPartition = 0, String variant = "");
 
 		void updateEntity(EntityRef& entity, const IEntityData& data, int serializationMask, EntityScene* scene = nullptr, IDataInterpolatorSetRetriever* interpolators = nullptr);
@@ -129,6 +132,7 @@ namespace Halley {
 
 		void addEntity(EntityRef entity);
 		void setEntities(Vector<EntityRef> entities);
+		void clearEntities();
 		void notifyEntity(const EntityRef& entity) const;
 		EntityRef getEntity(const UUID& uuid, bool allowPrefabUUID, bool allowWorldLookup) const;
 
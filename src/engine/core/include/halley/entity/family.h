@@ -1,11 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <gsl/assert>
+#include "archetype_storage.h"
 #include "family_type.h"
 #include "family_mask.h"
 #include "entity_id.h"
 #include "halley/data_structures/nullable_reference.h"
+#include "halley/data_structures/hash_map.h"
 #include "halley/support/exception.h"
 #include "halley/support/debug.h"
 #include "halley/utils/utils.h"
@@ -53,6 +56,7 @@ namespace Halley {
 		void* elems = nullptr;
 		size_t elemCount = 0;
 		size_t elemSize = 0;
+		const ArchetypeStorage* archetypeStorage = nullptr;
 		Vector<EntityId> toRemove;
 		Vector<EntityId> toReload;
 
@@ -87,6 +91,33 @@ namespace Halley {
 		}
 	};
 	
+	// A run of family members, with each component laid out as an array (see FamilyImpl::forEachChunk)
+	template <typename Type>
+	struct FamilyChunk {
+		size_t count = 0;
+		Entity* const* entities = nullptr; // Rows with a null entity must be skipped; null for a single heap-stored member
+		std::array<void*, Type::getNumComponents()> columns = {};
+
+		bool has(size_t row) const
+		{
+			return !entities || entities[row];
+		}
+
+		// Null if the component is optional and missing
+		template <size_t I>
+		typename Type::template ComponentType<I>* tryGet(size_t row) const
+		{
+			auto* column = static_cast<typename Type::template ComponentType<I>*>(columns[I]);
+			return column ? column + row : nullptr;
+		}
+
+		template <size_t I>
+		typename Type::template ComponentType<I>& get(size_t row) const
+		{
+			return *tryGet<I>(row);
+		}
+	};
+
 	// Apple's Clang 3.5 does not seem to have constexpr std::max...
 	constexpr size_t maxSize(size_t a, size_t b)
 	{
@@ -108,28 +139,59 @@ namespace Halley {
 		};
 
 	public:
+		using Chunk = FamilyChunk<typename T::Type>;
+
 		explicit FamilyImpl(MaskStorage& storage)
 			: Family(T::Type::inclusionMask(storage), T::Type::optionalMask(storage))
 		{
 		}
+
+		// Visits members chunk by chunk when the world stores them in an ArchetypeStorage, so each component is walked
+		// as a contiguous array. Members that aren't in chunks (yet) are visited afterwards as chunks of one.
+		template <typename F>
+		void forEachChunk(F&& f) const
+		{
+			if (archetypeStorage) {
+				constexpr auto componentIds = T::Type::getComponentIds();
+				constexpr auto optional = T::Type::getOptionalComponents();
+				archetypeStorage->forEachChunk(componentIds, optional, [&] (Entity* const* rows, size_t count, void* const* columns)
+				{
+					Chunk chunk;
+					chunk.count = count;
+					chunk.entities = rows;
+					std::copy_n(columns, chunk.columns.size(), chunk.columns.begin());
+					f(chunk);
+				});
+			}
+
+			for (size_t i = 0; i < entities.size(); ++i) {
+				if (!chunked[i]) {
+					Chunk chunk;
+					chunk.count = 1;
+					std::copy_n(reinterpret_cast<void* const*>(entities[i].data.data()), chunk.columns.size(), chunk.columns.begin());
+					f(chunk);
+				}
+			}
+		}
 				
 	protected:
 		void addEntity(Entity& entity) override
 		{
+			indices[entity.getEntityId()] = entities.size();
 			auto& e = entities.emplace_back();
 			e.entityId = entity.getEntityId();
 			T::Type::loadComponents(entity, &e.data[0]);
+			chunked.push_back(archetypeStorage && archetypeStorage->isChunked(entity));
 
 			dirty = true;
 		}
 		
 		void refreshEntity(Entity& entity) override
 		{
-			for (auto& e: entities) {
-				if (e.entityId == entity.getEntityId()) {
-					T::Type::loadComponents(entity, &e.data[0]);
-					break;
-				}
+			const auto iter = indices.find(entity.getEntityId());
+			if (iter != indices.end()) {
+				T::Type::loadComponents(entity, &entities[iter->second].data[0]);
+				chunked[iter->second] = archetypeStorage && archetypeStorage->isChunked(entity);
 			}
 		}
 
@@ -153,9 +215,11 @@ namespace Halley {
 				// Notify reloads
 				HALLEY_DEBUG_TRACE();
 				Vector<StorageType*> reloadedEntities;
-				for (auto& entity : entities) {
-					if (std::find(toReload.begin(), toReload.end(), entity.entityId) != toReload.end()) {
-						reloadedEntities.push_back(&entity);
+				reloadedEntities.reserve(toReload.size());
+				for (const auto& id: toReload) {
+					const auto iter = indices.find(id);
+					if (iter != indices.end()) {
+						reloadedEntities.push_back(&entities[iter->second]);
 					}
 				}
 				notifyReload(reloadedEntities.data(), reloadedEntities.size());
@@ -170,11 +234,15 @@ namespace Halley {
 		{
 			notifyRemove(entities.data(), entities.size());
 			entities.clear();
+			indices.clear();
+			chunked.clear();
 			updateElems();
 		}
 
 	private:
 		Vector<StorageType> entities;
+		HashMap<EntityId, size_t> indices;
+		Vector<uint8_t> chunked; // Whether each member is visited through the archetype chunks by forEachChunk()
 		bool dirty = false;
 
 		void updateElems()
@@ -187,42 +255,32 @@ namespace Halley {
 		void removeDeadEntities()
 		{
 			// Performance-critical code
-			// Benchmarks suggest that using a Vector is faster than std::set and std::unordered_set
+			// Each entity knows its slot through the index map, so removal is O(1) per entity instead of a scan of the family
 			if (!toRemove.empty()) {
 				HALLEY_DEBUG_TRACE();
 				size_t removeCount = toRemove.size();
 				Expects(removeCount > 0);
 				Expects(removeCount <= entities.size());
-				std::sort(toRemove.begin(), toRemove.end());
-
-				for (size_t i = 1; i < toRemove.size(); ++i) {
-					Expects(toRemove[i - 1] != toRemove[i]);
-				}
 
 				// Move all entities to be removed to the back of the vector
 				{
-					int n = int(entities.size());
-					// Note: it's important to scan it forward. Scanning backwards would improve performance for short-lived entities,
-					// but it causes an issue where an entity is removed and added to the same family in one frame.
-					for (int i = 0; i < n; i++) {
-						EntityId id = entities[i].entityId;
-						auto iter = std::lower_bound(toRemove.begin(), toRemove.end(), id);
-						if (iter != toRemove.end() && id == *iter) {
-							toRemove.erase(iter);
-							if (i != n - 1) {
-								std::swap(entities[i], entities[n - 1]);
-								i--;
-							}
-							n--;
-							if (toRemove.empty()) {
-								break;
-							}
+					size_t n = entities.size();
+					for (const auto& id: toRemove) {
+						const auto iter = indices.find(id);
+						Expects(iter != indices.end());
+						const size_t idx = iter->second;
+						indices.erase(iter);
+
+						--n;
+						if (idx != n) {
+							std::swap(entities[idx], entities[n]);
+							std::swap(chunked[idx], chunked[n]);
+							indices[entities[idx].entityId] = idx;
 						}
 					}
-					Ensures(size_t(n) + removeCount == entities.size());
+					Ensures(n + removeCount == entities.size());
 				}
-
-				Expects(toRemove.empty());
+				toRemove.clear();
 
 				// Notify removal
 				size_t newSize = entities.size() - removeCount;
@@ -231,6 +289,7 @@ namespace Halley {
 
 				// Remove them
 				entities.resize(newSize);
+				chunked.resize(newSize);
 				updateElems();
 			}
 			Ensures(toRemove.empty());
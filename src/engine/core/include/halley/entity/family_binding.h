@@ -22,6 +22,7 @@ namespace Halley {
 		void doInit(FamilyMaskType readMask, FamilyMaskType writeMask) noexcept;
 		
 		void* getElement(size_t index) const noexcept { return family->getElement(index); }
+		const Family& getFamily() const noexcept { return *family; }
 		void setFamily(Family* family) noexcept;
 
 		void setOnEntitiesAdded(std::function<void(void*, size_t)> callback);
@@ -107,6 +108,13 @@ namespace Halley {
 			return getSingleton();
 		}
 
+		// Walks members as arrays of components, see FamilyImpl::forEachChunk
+		template <typename F>
+		void forEachChunk(F&& f) const
+		{
+			static_cast<const FamilyImpl<T>&>(getFamily()).forEachChunk(std::forward<F>(f));
+		}
+
 		template <typename F>
 		T* tryMatch(F f)
 		{
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <tuple>
 #include "family_extractor.h"
 
 namespace Halley {
@@ -34,5 +36,18 @@ namespace Halley {
 		{
 			return sizeof...(Ts);
 		}
+
+		template <size_t I>
+		using ComponentType = typename FamilyExtractor::StripMaybeRef<std::tuple_element_t<I, std::tuple<Ts...>>>::type;
+
+		constexpr static std::array<int, sizeof...(Ts)> getComponentIds()
+		{
+			return { FamilyMask::RetrieveComponentIndex<Ts>::componentIndex... };
+		}
+
+		constexpr static std::array<bool, sizeof...(Ts)> getOptionalComponents()
+		{
+			return { FamilyMask::IsMaybeRef<Ts>::value... };
+		}
 	};
 }
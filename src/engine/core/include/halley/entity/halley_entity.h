@@ -2,17 +2,20 @@
 
 namespace Halley {} // Get GitHub to realise this is C++ :3
 
+#include "halley/entity/archetype_storage.h"
 #include "halley/entity/component.h"
 #include "halley/entity/data_interpolator.h"
 #include "halley/entity/ecs_reflection.h"
 #include "halley/entity/message.h"
 #include "halley/entity/prefab.h"
+#include "halley/entity/prefab_template.h"
 #include "halley/entity/prefab_scene_data.h"
 #include "halley/entity/registry.h"
 #include "halley/entity/service.h"
 #include "halley/entity/system.h"
 #include "halley/entity/system_interface.h"
 #include "halley/entity/system_message.h"
+#include "halley/entity/system_scheduler.h"
 #include "halley/entity/world.h"
 #include "halley/entity/world_scene_data.h"
 #include "halley/entity/family_binding.h"
@@ -6,6 +6,8 @@
 
 namespace Halley {
 	class SceneVariant;
+	class PrefabTemplate;
+	class WorldReflection;
 
 	class Prefab : public AsyncResource {
 	public:		
@@ -56,6 +58,9 @@ namespace Halley {
 
 		void generateUUIDs();
 
+		// Compiled lazily on first use and kept until the entity data is modified or reloaded. Null if the prefab can't be compiled.
+		std::shared_ptr<const PrefabTemplate> getTemplate(const WorldReflection& reflection, Resources& resources) const;
+
 	protected:
 		struct Deltas {
 			std::map<UUID, EntityDataDelta> entitiesModified;
@@ -72,7 +77,10 @@ namespace Halley {
 
 		Deltas deltas;
 
+		mutable std::shared_ptr<const PrefabTemplate> compiledTemplate;
+
 		void doPreloadDependencies(const EntityData& entityData, Resources& resources) const;
+		void invalidateTemplate();
 	};
 
 	class Scene final : public Prefab {
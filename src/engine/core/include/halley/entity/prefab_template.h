@@ -0,0 +1,57 @@
+#pragma once
+
+#include "halley/data_structures/config_node.h"
+#include "halley/maths/uuid.h"
+
+namespace Halley {
+	class EntityData;
+	class Prefab;
+	class ComponentReflector;
+	class WorldReflection;
+	class Resources;
+	class Component;
+
+	// Prefab hierarchy flattened into a pre-order node list, with component types already resolved against a WorldReflection.
+	// Used by EntityFactory::spawnBatch to instantiate many copies of a prefab without going through EntityData for each one.
+	// Components are deserialized once into a prototype that every instance copies. Components that look up other entities
+	// while deserializing (or can't be copied) have no prototype, and are deserialized from data for each instance instead.
+	class PrefabTemplate {
+	public:
+		struct Component {
+			const ComponentReflector* reflector = nullptr;
+			ConfigNode data;
+			std::shared_ptr<const Halley::Component> prototype;
+		};
+
+		struct Node {
+			int parent = -1;
+			String name;
+			String variant;
+			UUID prefabUUID;
+			bool selectable = true;
+			bool serializable = true;
+			bool disabled = false;
+			uint32_t firstComponent = 0;
+			uint32_t numComponents = 0;
+		};
+
+		// Returns null if the prefab can't be compiled (scenes and prefabs containing other prefab instances)
+		static std::shared_ptr<PrefabTemplate> compile(const Prefab& prefab, const WorldReflection& reflection, Resources& resources);
+
+		PrefabTemplate(const WorldReflection& reflection, Resources& resources);
+
+		const WorldReflection& getReflection() const { return *reflection; }
+		Resources& getResources() const { return *resources; }
+		gsl::span<const Node> getNodes() const { return nodes; }
+		gsl::span<const Component> getComponents(const Node& node) const;
+
+	private:
+		const WorldReflection* reflection = nullptr;
+		Resources* resources = nullptr;
+		Vector<Node> nodes;
+		Vector<Component> components;
+
+		bool addNode(const EntityData& data, int parent, const String& prefabName);
+		std::shared_ptr<const Halley::Component> makePrototype(const ComponentReflector& reflector, const ConfigNode& data) const;
+	};
+}
@@ -8,10 +8,21 @@ namespace Halley {
 
 	class ScriptingService : public Service, public ILuaInterface {
 	public:
+		using EnvironmentFactory = std::function<std::unique_ptr<ScriptEnvironment>()>;
+
 		ScriptingService(std::unique_ptr<ScriptEnvironment> environment, Resources& resources, const String& initialLuaModule = "");
 
 		ScriptEnvironment& getEnvironment() const;
 
+		// Lets ScriptSystem update scripts that can run in parallel on worker threads, each using its own environment made by this factory
+		void setWorkerEnvironmentFactory(EnvironmentFactory factory);
+		bool hasWorkerEnvironments() const;
+		ScriptEnvironment& getWorkerEnvironment(size_t idx);
+
+		// Calls prepare on each of the n entries in order, on this thread. Entries it accepts are then updated on worker environments through the queue, the rest on the main environment.
+		// Everything is committed to the main environment in index order, calling finish after each entry, so the order of side effects doesn't depend on the number of threads.
+		void updateInParallel(ExecutionQueue& queue, size_t n, const std::function<bool(size_t)>& prepare, const std::function<void(ScriptEnvironment&, size_t)>& update, const std::function<void(size_t)>& finish);
+
 		ConfigNode evaluateExpression(const String& expression) const;
 		ConfigNode evaluateExpression(const LuaExpression& expression) const;
 
@@ -28,6 +39,9 @@ namespace Halley {
 	private:
 		std::unique_ptr<ScriptEnvironment> scriptEnvironment;
 		std::unique_ptr<LuaState> luaState;
+
+		EnvironmentFactory workerEnvironmentFactory;
+		Vector<std::unique_ptr<ScriptEnvironment>> workerEnvironments;
 	};
 }
 
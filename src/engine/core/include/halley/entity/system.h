@@ -10,6 +10,7 @@
 #include "entity.h"
 #include "halley/utils/type_traits.h"
 #include "system_message.h"
+#include "system_scheduler.h"
 #include "halley/bytes/byte_serializer.h"
 
 namespace Halley {
@@ -53,6 +54,8 @@ namespace Halley {
 		size_t getEntityCount() const;
 		bool tryInit();
 
+		const SystemAccessInfo& getAccessInfo() const { return accessInfo; }
+
 		virtual bool canHandleSystemMessage(int messageId, const String& targetSystem) const { return false; }
 		void receiveSystemMessage(const SystemMessageContext& context);
 		void prepareSystemMessages();
@@ -69,6 +72,7 @@ namespace Halley {
 		World& doGetWorld() const { return *world; }
 		Resources& doGetResources() const { return *resources; }
 		SystemMessageBridge doGetMessageBridge() { return SystemMessageBridge(*this); }
+		void setAccessInfo(SystemAccessInfo info) { accessInfo = std::move(info); }
 
 		virtual void initBase() {}
 		virtual void deInit() {}
@@ -187,6 +191,7 @@ namespace Halley {
 
 	private:
 		friend class World;
+		friend class SystemScheduler;
 
 		Vector<FamilyBindingBase*> families;
 		Vector<int> messageTypesReceived;
@@ -194,6 +199,7 @@ namespace Halley {
 		Vector<std::pair<EntityId, MessageEntry>> outbox;
 		Vector<const SystemMessageContext*> systemMessageInbox;
 		Vector<const SystemMessageContext*> systemMessages;
+		SystemAccessInfo accessInfo;
 
 		World* world = nullptr;
 		const HalleyAPI* api = nullptr;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <gsl/span>
+#include "halley/data_structures/vector.h"
+#include "halley/text/halleystring.h"
+#include "halley/time/halleytime.h"
+
+namespace Halley {
+	class System;
+	class World;
+	class ExecutionQueue;
+
+	enum class SystemAccessFlags : int {
+		None = 0,
+		Exclusive = 1,					// Must run on its own (e.g. has World access, or spawns parallel work itself)
+		API = 2,						// Touches the HalleyAPI
+		SendEntityMessages = 4,
+		ReceiveEntityMessages = 8,
+		SendSystemMessages = 16
+	};
+
+	// Declared by codegen for each system, describes which resources it reads and writes during update
+	// Systems that never declare their access are treated as exclusive
+	class SystemAccessInfo {
+	public:
+		SystemAccessInfo() = default;
+		SystemAccessInfo(Vector<int> componentsRead, Vector<int> componentsWritten, Vector<String> servicesRead, Vector<String> servicesWritten, int flags);
+
+		bool isExclusive() const;
+		bool hasFlag(SystemAccessFlags flag) const;
+		bool conflictsWith(const SystemAccessInfo& other) const;
+
+	private:
+		Vector<int> componentsRead;
+		Vector<int> componentsWritten;
+		Vector<String> servicesRead;
+		Vector<String> servicesWritten;
+		int flags = int(SystemAccessFlags::Exclusive);
+	};
+
+	// Groups the systems of a timeline into stages of non-conflicting systems.
+	// Systems in the same stage run concurrently; each stage boundary is a sync point where pending entities are spawned.
+	class SystemScheduler {
+	public:
+		void build(gsl::span<const std::unique_ptr<System>> systems);
+		void run(World& world, Time time, ExecutionQueue& queue) const;
+
+		size_t getNumStages() const;
+		gsl::span<System* const> getStage(size_t idx) const;
+
+	private:
+		Vector<Vector<System*>> stages;
+	};
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <new>
+#include <type_traits>
 #include <halley/data_structures/vector.h>
 
 namespace Halley {
@@ -8,10 +10,17 @@ namespace Halley {
 	public:
 		virtual ~TypeDeleterBase() {}
 		virtual size_t getSize() = 0;
+		virtual size_t getAlignment() = 0;
 		virtual void callDestructor(void* ptr) = 0;
 		virtual void destroy(void* ptr) = 0;
+
+		virtual bool isRelocatable() = 0;
+		virtual void moveConstruct(void* dst, void* src) = 0;
+		virtual void* moveToHeap(void* src) = 0;
 	};
 
+	class ArchetypeStorage;
+
 	class ComponentDeleterTable
 	{
 	public:
@@ -43,8 +52,19 @@ namespace Halley {
 			return map[uid] != nullptr;
 		}
 
+		void setArchetypeStorage(const ArchetypeStorage* storage)
+		{
+			archetypeStorage = storage;
+		}
+
+		const ArchetypeStorage* getArchetypeStorage() const
+		{
+			return archetypeStorage;
+		}
+
 	private:
 		Vector<TypeDeleterBase*> map;
+		const ArchetypeStorage* archetypeStorage = nullptr;
 	};
 
 	template <typename T>
@@ -63,6 +83,11 @@ namespace Halley {
 			return sizeof(T);
 		}
 
+		size_t getAlignment() override
+		{
+			return alignof(T);
+		}
+
 		void callDestructor(void* ptr) override
 		{
 #ifdef _MSC_VER
@@ -75,5 +100,26 @@ namespace Halley {
 		{
 			delete static_cast<T*>(ptr);
 		}
+
+		bool isRelocatable() override
+		{
+			return std::is_move_constructible_v<T>;
+		}
+
+		void moveConstruct(void* dst, void* src) override
+		{
+			if constexpr (std::is_move_constructible_v<T>) {
+				::new (dst) T(std::move(*static_cast<T*>(src)));
+			}
+		}
+
+		void* moveToHeap(void* src) override
+		{
+			if constexpr (std::is_move_constructible_v<T>) {
+				return new T(std::move(*static_cast<T*>(src)));
+			} else {
+				return nullptr;
+			}
+		}
 	};
 }
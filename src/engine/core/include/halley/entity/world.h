@@ -20,6 +20,8 @@
 #include "system_message.h"
 #include "world_reflection.h"
 #include "system_interface.h"
+#include "system_scheduler.h"
+#include "archetype_storage.h"
 
 namespace Halley {
 	class SystemMessage;
@@ -121,9 +123,9 @@ namespace Halley {
 
 		void spawnPending(); // Warning: use with care, will invalidate entities
 
-		void onEntityDirty();
+		void onEntityDirty(Entity& entity);
 
-		void setEntityReloaded();
+		void setEntityReloaded(Entity& entity);
 
 		template <typename T>
 		Family& getFamily() noexcept
@@ -214,21 +216,29 @@ namespace Halley {
 		bool isHeadless() const;
 		void setHeadless(bool headless);
 
+		bool isParallelUpdate() const;
+		void setParallelUpdate(bool parallel);
+
+		bool hasArchetypeStorage() const;
+		void setArchetypeStorage(bool enabled);
+		const ArchetypeStorage* getArchetypeStorage() const;
+
 	private:
 		const HalleyAPI& api;
 		Resources& resources;
 		std::array<Vector<std::unique_ptr<System>>, static_cast<int>(TimeLine::NUMBER_OF_TIMELINES)> systems;
 		std::shared_ptr<WorldReflection> reflection;
-		bool entityDirty = false;
-		bool entityReloaded = false;
 		bool editor = false;
 		bool devMode = false;
 		bool terminating = false;
 		bool headless = false;
 		bool canDeleteEntities = true;
+		bool parallelUpdate = false;
 		
 		Vector<Entity*> entities;
 		Vector<Entity*> entitiesPendingCreation;
+		Vector<Entity*> dirtyEntities;
+		Vector<EntityId> reloadedEntities;
 		std::shared_ptr<MappedPool<Entity*>> entityMap;
 		HashMap<UUID, Entity*> uuidMap;
 
@@ -241,8 +251,10 @@ namespace Halley {
 		std::shared_ptr<MaskStorage> maskStorage;
 		std::shared_ptr<ComponentDeleterTable> componentDeleterTable;
 		std::shared_ptr<TypedPool<Entity>> entityPool;
+		std::unique_ptr<ArchetypeStorage> archetypeStorage;
 
 		std::array<std::list<SystemMessageContext>, static_cast<int>(TimeLine::NUMBER_OF_TIMELINES)> pendingSystemMessages;
+		std::array<std::optional<SystemScheduler>, static_cast<int>(TimeLine::NUMBER_OF_TIMELINES)> schedulers;
 		
 		IWorldNetworkInterface* networkInterface = nullptr;
 		float transform2DAnisotropy = 1.0f;
@@ -254,6 +266,7 @@ namespace Halley {
 
 		void allocateEntity(Entity* entity);
 		void updateEntities();
+		void updateEntityFamilies(Entity& entity, const FamilyMaskType& oldMask, const FamilyMaskType& newMask, bool relocated);
 		void initSystems(gsl::span<const TimeLine> timelines);
 
 		void doDestroyEntity(EntityId id);
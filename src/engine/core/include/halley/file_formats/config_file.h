@@ -1,7 +1,10 @@
 #pragma once
 
 #include "halley/data_structures/config_node.h"
+#include "halley/data_structures/frozen_config_node.h"
 #include "halley/resources/resource.h"
+#include <atomic>
+#include <mutex>
 
 namespace Halley
 {
@@ -11,16 +14,21 @@ namespace Halley
 	class ConfigFile : public Resource
 	{
 	public:
-		ConfigFile() = default;
+		ConfigFile();
 		explicit ConfigFile(const ConfigFile& other);
 		explicit ConfigFile(ConfigNode root);
 		ConfigFile(ConfigFile&& other) noexcept;
 
 		ConfigFile& operator=(ConfigFile&& other) noexcept;
 
+		// Deserialized files are kept frozen, and the ConfigNode tree is only built the first time the root is requested.
+		// The non-const version also drops the frozen data, as the tree can be modified through it.
 		ConfigNode& getRoot();
 		const ConfigNode& getRoot() const;
 
+		// Reads the file without building a ConfigNode tree. Valid until the file is reloaded or the non-const getRoot() is called.
+		ConfigNodeView getView() const;
+
 		void serialize(Serializer& s) const;
 		void deserialize(Deserializer& s);
 
@@ -33,10 +41,14 @@ namespace Halley
 		void reload(Resource&& resource) override;
 
 	protected:
-		ConfigNode root;
+		mutable ConfigNode root;
+		mutable std::unique_ptr<FrozenConfigNode> frozen;
+		mutable std::atomic<bool> thawed;
+		mutable std::mutex mutex;
 		bool storeFilePosition = true;
 
 		void updateRoot();
+		void thaw() const;
 	};
 
 	class ConfigObserver
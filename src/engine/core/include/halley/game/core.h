@@ -101,6 +101,7 @@ namespace Halley
 		void pumpAudio();
 		void updateSystem(Time time);
 		void updatePlatform();
+		void updateResources();
 
 		void onProfileData(std::shared_ptr<ProfilerData> data);
 		Time getProfileCaptureThreshold() const;
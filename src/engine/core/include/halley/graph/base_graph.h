@@ -143,6 +143,9 @@ namespace Halley {
 			return false;
 		}
 
+		// Called by assignTypes() after it (re)assigns the node types
+		virtual void onTypesAssigned() const {}
+
 		uint64_t hash = 0;
 		uint64_t assetHash = 0;
 		mutable uint64_t lastAssignTypeHash = 1;
@@ -86,6 +86,9 @@ namespace Halley
 		// vertPosOffset is the offset, in bytes, from the start of each vertex's data, to a Vector2f which will be filled with the vertex's position in 0-1 space.
 		void drawSprites(const std::shared_ptr<const Material>& material, size_t numSprites, const void* vertexData);
 
+		// Does the vertex expansion of drawSprites into dst (4 vertices of vertexStride bytes per sprite), so it can be done ahead of time and submitted with drawQuads
+		static void expandSpriteVertices(const void* vertexData, size_t numSprites, size_t vertexSize, size_t vertexStride, size_t vertPosOffset, void* dst);
+
 		// Draw one sliced sprite. Slices -> x = left, y = top, z = right, w = bottom, in [0..1] space relative to the texture
 		void drawSlicedSprite(const std::shared_ptr<const Material>& material, Vector2f scale, Vector4f slices, const void* vertexData);
 
@@ -36,14 +36,25 @@ namespace Halley {
 	};
 	
 	class Particles {
-		struct Particle {
-			Vector3f pos;
-			Vector3f vel;
-			float scale = 1;
-			float time = 0;
-			float ttl = 1;
-			bool alive = true;
-			bool firstFrame = true;
+		// Particle state stored as a structure of arrays, so updates can run on four particles at a time.
+		// Arrays are always sized to a multiple of four, so SIMD kernels don't need a scalar tail.
+		struct ParticleArrays {
+			Vector<float> posX, posY, posZ;
+			Vector<float> velX, velY, velZ;
+			Vector<float> scale;
+			Vector<float> time;
+			Vector<float> ttl;
+			Vector<float> moving; // 0 on the first frame, when the particle is not integrated yet
+			Vector<uint8_t> alive;
+
+			size_t size() const;
+			void resize(size_t size);
+			void move(size_t from, size_t to);
+
+			Vector3f getPos(size_t idx) const;
+			void setPos(size_t idx, Vector3f pos);
+			Vector3f getVel(size_t idx) const;
+			void setVel(size_t idx, Vector3f vel);
 		};
 		
 	public:
@@ -107,6 +118,7 @@ namespace Halley {
 		[[nodiscard]] gsl::span<const Sprite> getSprites() const;
 
 		void setSecondarySpawner(IParticleSpawner* spawner);
+		void setRNG(Random& rng);
 		void spawnAt(Vector3f pos);
 
 		std::optional<Rect4f> getAABB() const;
@@ -124,7 +136,8 @@ namespace Halley {
 		float speedMultiplier = 1.0f;
 
 		Vector<Sprite> sprites;
-		Vector<Particle> particles;
+		ParticleArrays particles;
+		Vector<float> normalisedTimes;
 		Vector<AnimationPlayerLite> animationPlayers;
 		
 		size_t nParticlesAlive = 0;
@@ -171,12 +184,13 @@ namespace Halley {
 		void start();
 		void initializeParticle(size_t index, float time, float totalTime);
 		void updateParticles(float t);
+		void integrateParticles(float t);
 		void removeDeadParticles();
 		void spawn(size_t n, float time);
 
 		Vector3f getSpawnPosition() const;
 
-		void onSecondarySpawn(const Particle& particle, EntityId target);
+		void onSecondarySpawn(size_t idx, EntityId target);
 
 		float getSpriteBorder(const Sprite& sprite) const;
 		void computeMaxBorder() const;
@@ -63,6 +63,12 @@ namespace Halley
 		static void draw(gsl::span<const Sprite> sprites, Painter& painter);
 		static void drawMixedMaterials(const Sprite* sprites, size_t n, Painter& painter);
 
+		// Writes the 4 vertices of this sprite's quad, ready for Painter::drawQuads, for building vertex buffers ahead of time.
+		// Requires a material.
+		constexpr static size_t vertexDataSize = sizeof(SpriteVertexAttrib) + 16;
+		constexpr static size_t quadVertexDataSize = vertexDataSize * 4;
+		void copyQuadVertexData(char* dst) const;
+
 		Sprite& setMaterial(Resources& resources, String materialName = "");
 		Sprite& setMaterial(std::shared_ptr<const Material> m);
 		MaterialUpdater getMutableMaterial();
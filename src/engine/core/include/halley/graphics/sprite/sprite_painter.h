@@ -104,7 +104,23 @@ namespace Halley
 
 		void setWaitForSpriteLoad(bool wait);
 
+		// When enabled, sorting, culling and vertex generation for plain sprites run in parallel chunks on the CPU executor,
+		// and the render thread only submits the pre-built vertex data. Worth it with tens of thousands of sprites.
+		void setParallelRecording(bool enabled);
+
 	private:
+		struct RecordedBatch {
+			const Sprite* first = nullptr;
+			size_t vertexOffset = 0;
+			size_t count = 0;
+			bool direct = false; // Drawn with Sprite::draw on the render thread (sliced, clipped, needs material pre-processing)
+		};
+
+		struct RecordedChunk {
+			Vector<char> vertices;
+			Vector<RecordedBatch> batches;
+		};
+
 		Vector<SpritePainterEntry> sprites;
 		Vector<Sprite> cachedSprites;
 		Vector<TextRenderer> cachedText;
@@ -113,9 +129,19 @@ namespace Halley
 		bool dirty = false;
 		bool forceCopy = false;
 		bool waitForSpriteLoad = true;
+		bool parallelRecording = false;
 		SpritePainterMaterialParamUpdater paramUpdater;
 
+		Vector<const Sprite*> recordSprites;
+		Vector<RecordedChunk> recordChunks;
+
+		void sortEntries();
+		void drawRecorded(gsl::span<const SpritePainterEntry> entries, int mask, Painter& painter, Rect4f view);
+		void recordChunk(RecordedChunk& chunk, gsl::span<const Sprite* const> sprites, Rect4f view) const;
+
+		void draw(const SpritePainterEntry& entry, int mask, Painter& painter, Rect4f view) const;
 		void draw(gsl::span<const Sprite> sprite, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const;
+		void draw(const Sprite& sprite, Painter& painter, const std::optional<Rect4f>& clip) const;
 		void draw(gsl::span<const TextRenderer> text, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const;
 		void draw(const SpritePainterEntry::Callback& callback, Painter& painter, const std::optional<Rect4f>& clip) const;
 	};
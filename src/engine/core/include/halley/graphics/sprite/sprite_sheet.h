@@ -218,7 +218,7 @@ namespace Halley
 		ResourceMemoryUsage getMemoryUsage() const override;
 
 	private:
-		std::weak_ptr<const SpriteSheet> spriteSheet;
+		std::shared_ptr<const SpriteSheet> spriteSheet; // Strong, so the sheet isn't evicted while its sprites are still loaded
 		uint64_t idx = -1;
 		Resources* resources = nullptr;
 	};
@@ -40,9 +40,14 @@ namespace Halley
 		};
 
 		Font() = default;
+		Font(const Font& other) = delete;
+		Font(Font&& other) noexcept;
 		Font(String name, String imageName, float ascender, float height, float sizePt, float replacementScale, Vector2i imageSize);
 		Font(String name, String imageName, float ascender, float height, float sizePt, float replacementScale, Vector2i imageSize, float distanceFieldSmoothRadius, Vector<String> fallback, bool floorGlyphPosition);
 
+		Font& operator=(const Font& other) = delete;
+		Font& operator=(Font&& other) noexcept;
+
 		static std::unique_ptr<Font> loadResource(ResourceLoader& loader);
 		constexpr static AssetType getAssetType() { return AssetType::Font; }
 		void reload(Resource&& resource) override;
@@ -51,6 +56,7 @@ namespace Halley
 		std::pair<const Glyph&, const Font&> getGlyph(int code) const;
 		const Glyph& getGlyphHere(int code) const;
 		const Font& getFontForGlyph(int code) const;
+		Vector2f getKerning(int32_t from, int32_t to) const;
 		float getLineHeightAtSize(float size) const;
 		float getAscenderDistance() const;
 		float getHeight() const;
@@ -87,6 +93,23 @@ namespace Halley
 
 		std::shared_ptr<Material> material;
 		HashMap<int, Glyph> glyphs;
+
+		// Direct lookup for low codepoints (Latin, Greek, Cyrillic...), everything else goes through glyphs.
+		// Built on load; addGlyph drops them, and lookups go through glyphs until the font is loaded again.
+		constexpr static int denseGlyphRange = 0x3000;
+		Vector<const Glyph*> denseGlyphs;
+
+		struct KerningPair {
+			uint64_t key;
+			Vector2f kerning;
+
+			bool operator<(const KerningPair& other) const { return key < other.key; }
+		};
+		Vector<KerningPair> kerningTable;
+		bool lookupTablesBuilt = false;
+
+		const Glyph* findGlyph(int code) const;
+		void buildLookupTables();
 	};
 	
 }
@@ -112,11 +112,40 @@ namespace Halley
 
 		Vector<ColourOverride> colourOverrides;
 
+		// Glyph layout relative to the pen start, only recomputed when glyphsDirty is set.
+		// Moving the text just offsets it again; draw() writes quads straight from it unless there's a sprite filter.
+		struct GlyphLayout {
+			Vector2f offset;
+			Vector2f size;
+			Vector2f pivot;
+			Rect4f texRect;
+			float scale;
+			Colour4f colour;
+		};
+
+		struct GlyphQuad {
+			Vector4f vertPos;
+			SpriteVertexAttrib attrib;
+		};
+
+		mutable Vector<GlyphLayout> layout;
+		mutable Vector<std::pair<std::shared_ptr<Material>, size_t>> layoutMaterials;
+		mutable Vector2f layoutAnchor;
+		mutable Vector2f penStart;
+		mutable uint32_t layoutVersion = 0;
+		mutable uint32_t quadsVersion = std::numeric_limits<uint32_t>::max();
+		mutable Vector<GlyphQuad> quadsCache;
+
 		mutable Vector<Sprite> spritesCache;
 		mutable bool materialDirty = true;
 		mutable bool glyphsDirty = true;
 		mutable bool positionDirty = true;
 
+		void updateLayout() const;
+		void generateLayout() const;
+		void generateQuads() const;
+		Vector2f getGlyphRenderPosition(const GlyphLayout& glyph) const;
+
 		std::shared_ptr<Material> getMaterial(const Font& font) const;
 		void updateMaterial(Material& material, const Font& font) const;
 		void updateMaterialForFont(const Font& font) const;
@@ -18,6 +18,7 @@ namespace Halley {} // Get GitHub to realise this is C++ :3
 #include "data_structures/bin_pack.h"
 #include "data_structures/config_database.h"
 #include "data_structures/config_node.h"
+#include "data_structures/frozen_config_node.h"
 #include "data_structures/dynamic_grid.h"
 #include "data_structures/hash_map.h"
 #include "data_structures/mapped_pool.h"
@@ -80,6 +81,7 @@ namespace Halley {} // Get GitHub to realise this is C++ :3
 #include "navigation/navmesh.h"
 #include "navigation/navmesh_generator.h"
 #include "navigation/navmesh_set.h"
+#include "navigation/navmesh_query_service.h"
 #include "navigation/navigation_query.h"
 #include "navigation/navigation_path.h"
 #include "navigation/navigation_path_follower.h"
@@ -174,6 +174,45 @@ namespace Halley {
 #endif
         }
 
+		// Comparisons return a per-lane mask, only meant to be used with select() and moveMask()
+		inline SIMDVec4 lessThan(const SIMDVec4& other) const
+        {
+#if defined(HAS_SSE)
+			return SIMDVec4(_mm_cmplt_ps(x, other.x));
+#else
+			return SIMDVec4(x[0] < other.x[0] ? 1.0f : 0.0f, x[1] < other.x[1] ? 1.0f : 0.0f, x[2] < other.x[2] ? 1.0f : 0.0f, x[3] < other.x[3] ? 1.0f : 0.0f);
+#endif
+        }
+
+		inline SIMDVec4 greaterOrEqual(const SIMDVec4& other) const
+        {
+#if defined(HAS_SSE)
+			return SIMDVec4(_mm_cmpge_ps(x, other.x));
+#else
+			return SIMDVec4(x[0] >= other.x[0] ? 1.0f : 0.0f, x[1] >= other.x[1] ? 1.0f : 0.0f, x[2] >= other.x[2] ? 1.0f : 0.0f, x[3] >= other.x[3] ? 1.0f : 0.0f);
+#endif
+        }
+
+		// Returns one bit per lane, set where the mask is set
+		inline int moveMask() const
+        {
+#if defined(HAS_SSE)
+			return _mm_movemask_ps(x);
+#else
+			return (x[0] != 0 ? 1 : 0) | (x[1] != 0 ? 2 : 0) | (x[2] != 0 ? 4 : 0) | (x[3] != 0 ? 8 : 0);
+#endif
+        }
+
+		// Picks a where mask is set, b elsewhere
+		static inline SIMDVec4 select(const SIMDVec4& mask, const SIMDVec4& a, const SIMDVec4& b)
+		{
+#if defined(HAS_SSE)
+			return SIMDVec4(_mm_or_ps(_mm_and_ps(mask.x, a.x), _mm_andnot_ps(mask.x, b.x)));
+#else
+			return SIMDVec4(mask.x[0] != 0 ? a.x[0] : b.x[0], mask.x[1] != 0 ? a.x[1] : b.x[1], mask.x[2] != 0 ? a.x[2] : b.x[2], mask.x[3] != 0 ? a.x[3] : b.x[3]);
+#endif
+		}
+
 		// Returns a[0] + a[1], a[2] + a[3], b[0] + b[1], b[2] + b[3]
 		static inline SIMDVec4 horizontalAdd(SIMDVec4 a, SIMDVec4 b)
 		{
@@ -4,6 +4,7 @@
 #include "navigation_query.h"
 #include "halley/maths/polygon.h"
 #include "halley/maths/base_transform.h"
+#include "halley/data_structures/priority_queue.h"
 
 namespace Halley {
 	class Random;
@@ -149,21 +150,28 @@ namespace Halley {
 			float gScore = std::numeric_limits<float>::infinity();
 			float fScore = std::numeric_limits<float>::infinity();
 			NodeAndConn cameFrom;
-			bool inOpenSet = false;
 			bool inClosedSet = false;
+			uint32_t generation = 0;
 		};
 
-		class NodeComparator {
+		struct OpenNode {
+			float fScore;
+			NodeId id;
+
+			bool operator<(const OpenNode& other) const { return fScore > other.fScore; } // Lowest score on top
+		};
+
+		// Per-thread buffers reused by every query, so pathfinding doesn't allocate.
+		// State entries from a previous query are detected by their generation and reset on first access.
+		class Scratch {
 		public:
-			NodeComparator(const Vector<State>& state) : state(state) {}
-			
-			bool operator()(Navmesh::NodeId a, Navmesh::NodeId b) const
-			{
-				return state[a].fScore > state[b].fScore;
-			}
+			Vector<State> state;
+			PriorityQueue<OpenNode, std::less<>> openSet;
+			uint32_t generation = 0;
 
-		private:
-			const Vector<State>& state;
+			Scratch() : openSet(std::less<>()) {}
+			void begin(size_t nNodes);
+			State& get(size_t id);
 		};
 
 		Vector<Node> nodes;
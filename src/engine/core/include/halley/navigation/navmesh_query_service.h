@@ -0,0 +1,34 @@
+#pragma once
+
+#include "navmesh_set.h"
+#include "halley/concurrency/future.h"
+
+namespace Halley {
+	class ExecutionQueue;
+
+	// Collects pathfinding requests (e.g. from every agent that wants to repath this frame) and runs them as one batch on worker threads.
+	// The navmesh set must not be modified while a batch is running.
+	class NavmeshQueryService {
+	public:
+		NavmeshQueryService(std::shared_ptr<const NavmeshSet> navmeshSet);
+		NavmeshQueryService(std::shared_ptr<const NavmeshSet> navmeshSet, ExecutionQueue& queue);
+
+		void setNavmeshSet(std::shared_ptr<const NavmeshSet> navmeshSet);
+
+		Future<std::optional<NavigationPath>> request(NavigationQuery query, float anisotropy = 1.0f, float nudge = 0.1f);
+		Future<void> dispatch(); // Starts every request made since the last dispatch
+		size_t getNumPending() const;
+
+	private:
+		struct Request {
+			NavigationQuery query;
+			float anisotropy;
+			float nudge;
+			Promise<std::optional<NavigationPath>> promise;
+		};
+
+		std::shared_ptr<const NavmeshSet> navmeshSet;
+		ExecutionQueue& queue;
+		Vector<Request> pending;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include "navmesh.h"
 #include "navigation_query.h"
 #include "navigation_path.h"
@@ -40,6 +41,7 @@ namespace Halley {
 		std::optional<WorldPosition> getClosestPointTo(WorldPosition pos, float anisotropy = 1.0f, float nudge = 0.1f) const;
 
 		std::pair<uint16_t, uint16_t> getPortalDestination(uint16_t region, uint16_t edge) const;
+		size_t getNumCachedPortalTrees() const;
 
 	private:
 		struct PortalConnection {
@@ -76,33 +78,48 @@ namespace Halley {
 		using NodeId = uint16_t;
 		using NodeAndConn = NavigationPath::RegionNode;
 
-		struct State {
-			float gScore = std::numeric_limits<float>::infinity();
-			float fScore = std::numeric_limits<float>::infinity();
-			NodeId cameFrom;
-			bool inOpenSet = false;
-			bool inClosedSet = false;
+		struct OpenNode {
+			float cost;
+			NodeId id;
+
+			bool operator<(const OpenNode& other) const { return cost > other.cost; } // Lowest cost on top
+		};
+
+		// Cheapest path from one portal to every other portal
+		struct PortalTree {
+			Vector<float> costs;
+			Vector<NodeId> cameFrom;
 		};
 
-		class NodeComparator {
+		// Portal trees are built on demand and shared by every query (on any thread) until the portal graph changes.
+		// Copies start empty, as they might be linked differently.
+		class PortalPathCache {
 		public:
-			NodeComparator(const Vector<State>& state) : state(state) {}
-			
-			bool operator()(NodeId a, NodeId b) const
-			{
-				return state[a].fScore > state[b].fScore;
-			}
+			PortalPathCache() = default;
+			PortalPathCache(const PortalPathCache&) {}
+			PortalPathCache& operator=(const PortalPathCache&);
+
+			std::shared_ptr<const PortalTree> get(NodeId portalId) const;
+			void put(NodeId portalId, std::shared_ptr<const PortalTree> tree);
+			void clear();
+			size_t size() const;
 
 		private:
-			const Vector<State>& state;
+			constexpr static size_t maxTrees = 256;
+
+			mutable std::mutex mutex;
+			HashMap<NodeId, std::shared_ptr<const PortalTree>> trees;
+			Vector<NodeId> insertionOrder;
 		};
 
 		Vector<Navmesh> navmeshes;
 		Vector<PortalNode> portalNodes;
 		Vector<RegionNode> regionNodes;
+		mutable PortalPathCache portalPathCache;
 
 		void tryLinkNavMeshes(uint16_t idxA, uint16_t idxB);
 
 		Vector<NavigationPath::RegionNode> findRegionPath(Vector2f startPos, Vector2f endPos, uint16_t fromRegionId, uint16_t toRegionId) const;
+		std::shared_ptr<const PortalTree> getPortalTree(NodeId startId) const;
 	};
 }
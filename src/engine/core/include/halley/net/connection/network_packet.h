@@ -2,6 +2,7 @@
 #include "halley/data_structures/vector.h"
 #include <gsl/gsl>
 #include "halley/utils/utils.h"
+#include "halley/bytes/byte_serializer.h"
 
 namespace Halley
 {
@@ -20,7 +21,7 @@ namespace Halley
 		NetworkPacketBase(gsl::span<const gsl::byte> data, size_t prePadding);
 
 		size_t dataStart;
-		Vector<gsl::byte> data;
+		Bytes data;
 	};
 
 	class OutboundNetworkPacket : public NetworkPacketBase
@@ -30,6 +31,18 @@ namespace Halley
 		OutboundNetworkPacket(OutboundNetworkPacket&& other) noexcept;
 		explicit OutboundNetworkPacket(gsl::span<const gsl::byte> data);
 		explicit OutboundNetworkPacket(const Bytes& data);
+
+		// Serializes straight into the packet buffer, leaving room for headers in front
+		template <typename T>
+		static OutboundNetworkPacket fromValue(const T& value, SerializerOptions options = {})
+		{
+			OutboundNetworkPacket result;
+			result.data.resize(headerSpace);
+			result.dataStart = headerSpace;
+			auto s = Serializer(result.data, std::move(options));
+			s << value;
+			return result;
+		}
 		
 		void addHeader(gsl::span<const gsl::byte> src);
 
@@ -40,6 +53,11 @@ namespace Halley
 		}
 
 		OutboundNetworkPacket& operator=(OutboundNetworkPacket&& other) noexcept;
+
+	private:
+		constexpr static size_t headerSpace = 128;
+
+		OutboundNetworkPacket() = default;
 	};
 
 	class InboundNetworkPacket : public NetworkPacketBase
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <gsl/span>
+#include "halley/bytes/byte_serializer.h"
+#include "halley/data_structures/vector.h"
+#include "halley/text/halleystring.h"
+
+namespace Halley {
+	class ConfigNode;
+	class EntityData;
+	class EntityDataDelta;
+	class WorldReflection;
+
+	// Encodes entity deltas for the network.
+	// ConfigNode mode sends EntityDataDelta as-is. Binary mode uses the component field lists generated by codegen:
+	// components are sent by index, changed fields as a bitmask instead of names, ints as varint differences and
+	// floats XORed against the baseline the receiver already has, with trailing zero bits stripped.
+	// Binary mode requires both ends to run the same codegen and to keep identical baselines.
+	class EntityNetworkDeltaCodec {
+	public:
+		enum class Mode : uint8_t {
+			ConfigNode,
+			Binary
+		};
+
+		EntityNetworkDeltaCodec() = default;
+		EntityNetworkDeltaCodec(Mode mode, const WorldReflection& reflection, SerializerOptions options);
+
+		Mode getMode() const;
+
+		Bytes encode(const EntityDataDelta& delta, const EntityData& baseline) const;
+		EntityDataDelta decode(gsl::span<const gsl::byte> bytes, const EntityData& baseline) const;
+
+	private:
+		Mode mode = Mode::ConfigNode;
+		SerializerOptions options;
+		Vector<String> componentNames;
+		Vector<Vector<String>> componentFields;
+		HashMap<String, int> componentIds;
+
+		void encodeDelta(Serializer& s, const EntityDataDelta& delta, const EntityData& baseline) const;
+		void decodeDelta(Deserializer& s, EntityDataDelta& delta, const EntityData& baseline) const;
+
+		void encodeComponent(Serializer& s, const String& name, const ConfigNode& data, const ConfigNode* baseline) const;
+		std::pair<String, ConfigNode> decodeComponent(Deserializer& s, const EntityData& baseline) const;
+
+		void encodeValue(Serializer& s, const ConfigNode& value, const ConfigNode* baseline) const;
+		ConfigNode decodeValue(Deserializer& s, const ConfigNode* baseline) const;
+	};
+}
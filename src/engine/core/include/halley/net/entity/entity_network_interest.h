@@ -0,0 +1,76 @@
+#pragma once
+
+#include <gsl/span>
+#include "entity_network_remote_peer.h"
+#include "halley/data_structures/hash_map.h"
+#include "halley/data_structures/vector.h"
+#include "halley/maths/rect.h"
+#include "halley/maths/vector2.h"
+#include "halley/time/halleytime.h"
+
+namespace Halley {
+	class World;
+	class EntityClientSharedData;
+
+	// Decides which networked entities are relevant to each peer, and in which order their updates are sent.
+	// Entities are bucketed in a spatial grid once per tick. An entity becomes relevant to a peer once it's within
+	// enterMargin of its view, and stays relevant until it's beyond leaveMargin, so entities on the edge don't keep
+	// getting created and destroyed. Relevant entities accumulate priority every tick (faster if they're close to the
+	// view or moving fast), and updates are sent in priority order until the peer's bandwidth budget runs out.
+	class EntityNetworkInterestManager {
+	public:
+		struct Config {
+			int cellSize = 256;
+			int enterMargin = 256;
+			int leaveMargin = 512;
+			float bytesPerSecond = 0; // Per peer, 0 means unlimited
+			float speedPriority = 0.01f; // Extra priority for each unit/second of speed
+		};
+
+		EntityNetworkInterestManager();
+		explicit EntityNetworkInterestManager(Config config);
+		virtual ~EntityNetworkInterestManager() = default;
+
+		const Config& getConfig() const;
+
+		void update(Time t, World& world, gsl::span<const EntityNetworkUpdateInfo> entities);
+
+		void updatePeer(Time t, NetworkSession::PeerId peerId, const EntityClientSharedData& clientData);
+		void removePeer(NetworkSession::PeerId peerId);
+
+		bool isRelevant(NetworkSession::PeerId peerId, EntityId entityId) const;
+		float getPriority(NetworkSession::PeerId peerId, EntityId entityId) const;
+		bool hasBudget(NetworkSession::PeerId peerId) const;
+		void markUpToDate(NetworkSession::PeerId peerId, EntityId entityId, size_t bytesSent);
+
+	protected:
+		virtual std::optional<Vector2f> getEntityPosition(EntityRef entity) const;
+		virtual float getEntityPriority(EntityRef entity, float distanceToView, float speed) const;
+
+	private:
+		constexpr static Time maxBudgetTime = 0.25;
+
+		struct EntityInfo {
+			std::optional<Vector2f> position;
+			float speed = 0;
+			uint64_t tick = 0;
+		};
+
+		struct PeerState {
+			HashMap<EntityId, float> relevant; // Accumulated priority of each relevant entity
+			float budget = 0;
+		};
+
+		Config config;
+		World* world = nullptr;
+		uint64_t tick = 0;
+
+		HashMap<EntityId, EntityInfo> entities;
+		HashMap<Vector2i, Vector<EntityId>> grid;
+		Vector<EntityId> unpositioned;
+		HashMap<NetworkSession::PeerId, PeerState> peers;
+
+		Vector2i getCell(Vector2f pos) const;
+		static float getDistance(Rect4i rect, Vector2f pos);
+	};
+}
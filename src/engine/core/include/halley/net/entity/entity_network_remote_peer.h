@@ -45,7 +45,8 @@ namespace Halley {
             bool alive = true;
             Time timeSinceSend = 0;
             EntityNetworkId networkId = 0;
-            EntityData data;
+            uint32_t version = 0;
+            std::shared_ptr<const EntityData> data;
         };
 
         class InboundEntity {
@@ -5,6 +5,8 @@
 
 #include "halley/time/halleytime.h"
 #include "../session/network_session.h"
+#include "entity_network_delta_codec.h"
+#include "entity_network_interest.h"
 #include "entity_network_remote_peer.h"
 #include "halley/bytes/serialization_dictionary.h"
 #include "halley/entity/system.h"
@@ -34,6 +36,33 @@ namespace Halley {
 
 	class EntityNetworkSession : NetworkSession::IListener, NetworkSession::ISharedDataHandler, public IWorldNetworkInterface {
     public:
+		// Entity state as the receiving peer will see it once it decodes bytes.
+		// This is the baseline for the next update sent to that peer.
+		class EncodedEntityState {
+		public:
+			std::optional<Bytes> bytes; // Empty if there was no relevant change
+			std::shared_ptr<const EntityData> data;
+			uint32_t version = 0;
+		};
+
+		// Serialized state of an outbound entity, shared by every peer.
+		// A new version is only made when the serialized data actually changes.
+		class EntitySnapshot {
+		public:
+			std::shared_ptr<const EntityData> data;
+			uint32_t version = 0;
+
+		private:
+			friend class EntityNetworkSession;
+
+			uint64_t tick = 0;
+			uint64_t lastSeenTick = 0;
+			uint64_t revisions = 0;
+			Time serializedTime = 0;
+			std::optional<EncodedEntityState> create;
+			HashMap<uint32_t, EncodedEntityState> updates; // Encoded delta from each baseline version
+		};
+
 		class IEntityNetworkSessionListener {
 		public:
 			virtual ~IEntityNetworkSessionListener() = default;
@@ -51,6 +80,18 @@ namespace Halley {
 		~EntityNetworkSession() override;
 
 		void setWorld(World& world, SystemMessageBridge bridge);
+		void setDeltaCodecMode(EntityNetworkDeltaCodec::Mode mode); // Must match on every peer
+
+		EntityDataDelta decodeEntityDelta(const Bytes& bytes, const EntityData& baseline) const;
+
+		void setInterestManager(std::unique_ptr<EntityNetworkInterestManager> interestManager); // If not set, relevance is decided by the listener and every update is sent
+		EntityNetworkInterestManager* getInterestManager() const;
+
+		// With dirty tracking, outbound entities are only re-serialized if they were marked dirty, if components or children were
+		// added/removed, if a transform in their tree changed, or at least once every maxSnapshotAge seconds.
+		// Only enable it if the game calls markEntityDirty whenever it changes other networked component fields.
+		void setDirtyTracking(bool enabled, Time maxSnapshotAge = 1.0);
+		void markEntityDirty(EntityId entityId);
 
 		void update(Time t);
 		void sendUpdates();
@@ -69,6 +110,10 @@ namespace Halley {
 
 		Time getMinSendInterval() const;
 
+		const EntitySnapshot& getEntitySnapshot(EntityRef entity);
+		const EncodedEntityState& getEntityCreateState(EntityRef entity);
+		const EncodedEntityState& getEntityUpdateState(EntityRef entity, const EntityData& baseline, uint32_t baselineVersion);
+
 		void onRemoteEntityCreated(EntityRef entity, NetworkSession::PeerId peerId);
 		void requestSetupInterpolators(DataInterpolatorSet& interpolatorSet, EntityRef entity, bool remote);
 		void setupOutboundInterpolators(EntityRef entity);
@@ -121,6 +166,9 @@ namespace Halley {
 		EntityDataDelta::Options deltaOptions;
 		SerializerOptions byteSerializationOptions;
 		SerializationDictionary serializationDictionary;
+		EntityNetworkDeltaCodec::Mode codecMode = EntityNetworkDeltaCodec::Mode::ConfigNode;
+		EntityNetworkDeltaCodec codec;
+		std::unique_ptr<EntityNetworkInterestManager> interestManager;
 
 		std::shared_ptr<NetworkSession> session;
 		Vector<EntityNetworkRemotePeer> peers;
@@ -129,6 +177,14 @@ namespace Halley {
 
 		HashMap<int, Vector<EntityNetworkMessage>> outbox;
 
+		HashMap<EntityId, EntitySnapshot> snapshots;
+		HashSet<EntityId> dirtyEntities;
+		bool dirtyTracking = false;
+		Time maxSnapshotAge = 1.0;
+		Time snapshotTime = 0;
+		uint64_t snapshotTick = 0;
+		uint32_t nextSnapshotVersion = 1;
+
 		bool readyToStartGame = false;
 		bool gameStarted = false;
 		bool lobbyReady = false;
@@ -146,6 +202,8 @@ namespace Halley {
 		void onReceiveSetLobbyInfo(NetworkSession::PeerId fromPeerId, const EntityNetworkMessageSetLobbyInfo& msg);
 
 		void sendMessages();
+		void setWireState(EncodedEntityState& state, const EntitySnapshot& snapshot, EntityData wireData);
+		bool needsSnapshot(EntitySnapshot& snapshot, EntityRef entity) const;
 		
 		void setupDictionary();
 
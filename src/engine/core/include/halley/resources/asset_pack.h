@@ -13,6 +13,8 @@ namespace Halley {
 	class ResourceData;
 	class ResourceDataReader;
 
+	// Version 1 ("HALLEYPK") has a zlib-compressed asset database and every asset stored raw.
+	// Version 2 ("HALLEYP2") has an LZ4 asset database, and assets may be stored as independent LZ4 blocks (see AssetPack::appendAsset).
 	struct AssetPackHeader {
 		std::array<char, 8> identifier;
 		std::array<char, 16> iv;
@@ -20,6 +22,7 @@ namespace Halley {
 		uint64_t dataStartPos;
 
 		void init(size_t assetDbSize);
+		int getVersion() const;
 	};
 
     class AssetPack {
@@ -40,6 +43,10 @@ namespace Halley {
 
 		Bytes writeOut() const;
 
+		// Appends an asset to the pack data, returning the location to store in its asset database entry.
+		// If compress is set, the asset is split into LZ4 blocks, as long as that saves enough space to be worth it.
+		String appendAsset(gsl::span<const gsl::byte> asset, bool compress);
+
 		std::unique_ptr<ResourceData> getData(const String& asset, AssetType type, bool stream);
 
 		void readToMemory();
@@ -47,6 +54,11 @@ namespace Halley {
 		void decrypt(const String& key);
 	    
     	void readData(size_t pos, gsl::span<gsl::byte> dst);
+		gsl::span<const gsl::byte> tryGetDataSpan(size_t pos, size_t size) const;
+
+		constexpr static size_t assetBlockSize = 64 * 1024;
+		static size_t getBlockCount(size_t uncompressedSize);
+		void decompressAsset(size_t pos, size_t storedSize, gsl::span<gsl::byte> dst);
 
 		std::unique_ptr<ResourceDataReader> extractReader();
 
@@ -61,6 +73,8 @@ namespace Halley {
 		std::mutex readerMutex;
 		size_t dataOffset = 0;
 		Bytes data;
+		std::shared_ptr<ResourceDataReader> mapping; // Shared with the resource data pointing into it
+		gsl::span<const gsl::byte> mappedData; // Owned by mapping; reads from it don't need readerMutex
 		std::array<char, 16> iv;
 		mutable std::shared_ptr<bool> aliveToken;
     };
@@ -69,6 +83,7 @@ namespace Halley {
 	class PackDataReader final : public ResourceDataReader {
 	public:
 		PackDataReader(AssetPack& pack, size_t startPos, size_t fileSize);
+		PackDataReader(AssetPack& pack, size_t startPos, size_t storedSize, size_t uncompressedSize);
 
 		size_t size() const override;
 		int read(gsl::span<gsl::byte> dst) override;
@@ -84,5 +99,14 @@ namespace Halley {
 		size_t curPos = 0;
 		mutable std::mutex mutex;
 		std::shared_ptr<bool> aliveToken;
+
+		// LZ4 block streaming, for compressed assets
+		bool compressed = false;
+		Vector<size_t> blockOffsets;
+		Bytes blockData;
+		Bytes compressedBlock;
+		size_t loadedBlock = std::numeric_limits<size_t>::max();
+
+		void loadBlock(size_t block);
 	};
 }
@@ -7,6 +7,7 @@
 #include "metadata.h"
 #include "halley/concurrency/future.h"
 #include "halley/text/enum_names.h"
+#include "halley/time/halleytime.h"
 
 #if defined(DEV_BUILD) && !defined(__NX_TOOLCHAIN_MAJOR__)
 #define ENABLE_HOT_RELOAD
@@ -170,6 +171,23 @@ namespace Halley
 		}
 	};
 
+	struct ResourceCollectionStats {
+		AssetType type;
+		ResourceMemoryUsage memoryUsage;
+		size_t memoryBudget = 0;
+		size_t numResident = 0;
+		size_t numPinned = 0;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+
+		float getHitRate() const
+		{
+			const auto total = hits + misses;
+			return total > 0 ? float(double(hits) / double(total)) : 1.0f;
+		}
+	};
+
 	class Resource
 	{
 	public:
@@ -260,6 +278,7 @@ namespace Halley
 	struct ResourceOptions {
 		bool retainPixelData = false;
 		bool retainShaderData = false;
+		Time streamingBudget = 0.002; // Main thread time spent each frame finishing streamed resources
 		
 		ResourceOptions(bool retainPixelData = false, bool retainShaderData = false)
 			: retainPixelData(retainPixelData)
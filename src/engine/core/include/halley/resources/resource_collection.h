@@ -3,6 +3,7 @@
 #include <utility>
 #include <memory>
 #include <functional>
+#include <atomic>
 #include <shared_mutex>
 #include <halley/concurrency/shared_recursive_mutex.h>
 #include <halley/text/halleystring.h>
@@ -15,26 +16,39 @@ namespace Halley
 	class Resource;
 	class Resources;
 	class ResourceLoader;
+	class ResourceStreamer;
 	struct ResourceMemoryUsage;
+	struct ResourceCollectionStats;
 
 	class ResourceCollectionBase
 	{
+		friend class ResourceStreamer;
+
 		class Wrapper
 		{
 		public:
-			Wrapper(std::shared_ptr<Resource> resource, int loadDepth)
-				: res(std::move(resource))
-				, depth(loadDepth)
-			{}
+			Wrapper(std::shared_ptr<Resource> resource, int loadDepth);
+			Wrapper(Wrapper&& other) noexcept;
+			Wrapper& operator=(Wrapper&& other) noexcept;
+
+			void touch() const;
 
 			std::shared_ptr<Resource> res;
 			int depth;
+			mutable std::atomic<uint64_t> lastUsed;
 		};
 
 	public:
 		using ResourceLoaderFunc = std::function<std::shared_ptr<Resource>(std::string_view, ResourceLoadPriority)>;
 		using ResourceEnumeratorFunc = std::function<Vector<String>()>;
 
+		struct EvictionCandidate {
+			ResourceCollectionBase* collection;
+			String assetId;
+			uint64_t age; // In accesses to any resource since it was last used
+			size_t size;
+		};
+
 		explicit ResourceCollectionBase(Resources& parent, AssetType type);
 		virtual ~ResourceCollectionBase() {}
 
@@ -52,6 +66,7 @@ namespace Halley
 		void purge(std::string_view assetId);
 
 		std::shared_ptr<Resource> getUntyped(std::string_view name, ResourceLoadPriority priority = ResourceLoadPriority::Normal);
+		std::shared_ptr<Resource> getIfLoaded(std::string_view name) const;
 
 		Vector<String> enumerate() const;
 
@@ -65,11 +80,30 @@ namespace Halley
 		ResourceMemoryUsage clearOldResources(float maxAge);
 		void notifyResourcesUnloaded();
 
+		// 0 means no budget. Enforced by Resources::enforceMemoryBudgets().
+		void setMemoryBudget(size_t bytes);
+		size_t getMemoryBudget() const;
+
+		// Pinned resources are never evicted to meet a budget
+		void pin(std::string_view assetId);
+		void unpin(std::string_view assetId);
+		bool isPinned(std::string_view assetId) const;
+
+		ResourceCollectionStats getStats() const;
+
+		// Resources that are resident, not pinned and not referenced from anywhere else
+		void getEvictionCandidates(Vector<EvictionCandidate>& dst) const;
+		/// <returns>How much memory was freed</returns>
+		ResourceMemoryUsage evict(std::string_view assetId);
+
 	protected:
 		virtual std::shared_ptr<Resource> loadResource(ResourceLoader& loader) = 0;
 
 		std::shared_ptr<Resource> doGet(std::string_view name, ResourceLoadPriority priority, bool allowFallback);
-		std::pair<std::shared_ptr<Resource>, bool> loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback);
+		std::pair<std::shared_ptr<Resource>, bool> loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback, std::unique_ptr<ResourceDataStatic> prefetched = {});
+
+		std::unique_ptr<ResourceDataStatic> prefetch(std::string_view assetId, ResourceLoadPriority priority);
+		std::shared_ptr<Resource> storeStreamed(std::string_view assetId, std::shared_ptr<Resource> resource);
 
 	private:
 		Resources& parent;
@@ -82,6 +116,12 @@ namespace Halley
 		mutable SharedRecursiveMutex mutex;
 		mutable std::condition_variable_any resourceLoaded;
 		HashSet<String> resourcesLoading;
+		HashSet<String> pinned;
+
+		size_t memoryBudget = 0;
+		std::atomic<uint64_t> hits = 0;
+		std::atomic<uint64_t> misses = 0;
+		std::atomic<uint64_t> evictions = 0;
 	};
 
 	template <typename T>
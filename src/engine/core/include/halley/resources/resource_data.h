@@ -42,6 +42,10 @@ namespace Halley {
 		virtual void close() = 0;
 		virtual bool isAvailable() const { return true; }
 
+		// Readers backed by memory (e.g. a memory-mapped file) expose their whole contents here, which stays valid for
+		// the lifetime of the reader. Empty if not supported.
+		virtual gsl::span<const gsl::byte> getMappedData() const { return {}; }
+
 		Bytes readAll();
 	};
 
@@ -60,6 +64,29 @@ namespace Halley {
 		size_t fileSize = 0;
 	};
 
+	class ResourceDataReaderMemoryMapped final : public ResourceDataReader {
+	public:
+		// Returns null if the file can't be opened or memory mapping isn't supported on this platform
+		static std::unique_ptr<ResourceDataReaderMemoryMapped> tryOpen(const Path& path);
+		~ResourceDataReaderMemoryMapped() override;
+
+		size_t size() const override;
+		int read(gsl::span<gsl::byte> dst) override;
+		void seek(int64_t pos, int whence) override;
+		size_t tell() const override;
+		void close() override;
+		gsl::span<const gsl::byte> getMappedData() const override;
+
+	private:
+		ResourceDataReaderMemoryMapped(const gsl::byte* data, size_t size, void* fileHandle, void* mappingHandle);
+
+		const gsl::byte* data = nullptr;
+		size_t fileSize = 0;
+		size_t pos = 0;
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+	};
+
 	class ResourceData {
 	public:
 		ResourceData(String path);
@@ -75,6 +102,7 @@ namespace Halley {
 	public:
 		ResourceDataStatic(String path);
 		ResourceDataStatic(const void* data, size_t size, String path, bool owning = true);
+		ResourceDataStatic(std::shared_ptr<const char> data, size_t size, String path);
 
 		void set(const void* data, size_t size, bool owning = true);
 		bool isLoaded() const;
@@ -153,6 +181,9 @@ namespace Halley {
 		const HalleyAPI* api;
 		const Metadata* metadata;
 		bool loaded = false;
+
+		// Data already read (and decompressed) ahead of time by the resource streamer, handed out by getStatic()/getAsync()
+		mutable std::unique_ptr<ResourceDataStatic> prefetched;
 	};
 
 }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "halley/concurrency/future.h"
+#include "halley/data_structures/hash_map.h"
+#include "halley/resources/resource_data.h"
+#include "halley/text/halleystring.h"
+#include "halley/time/halleytime.h"
+
+namespace Halley
+{
+	class ExecutionQueue;
+	class Resource;
+	class ResourceCollectionBase;
+
+	// Loads resources in the background, in three stages:
+	// 1. Data is read and decompressed on the disk IO queue, highest priority requests first
+	// 2. The resource is constructed from that data on the CPU queue
+	// 3. It's added to its collection on the main thread, in update(), which only spends up to the given time per frame
+	// Requests for an asset that's already in flight share the same future (and can bump its priority).
+	class ResourceStreamer : public std::enable_shared_from_this<ResourceStreamer>
+	{
+	public:
+		ResourceStreamer() = default;
+		~ResourceStreamer();
+
+		Future<std::shared_ptr<Resource>> request(ResourceCollectionBase& collection, std::string_view assetId, ResourceLoadPriority priority);
+
+		// Main thread only
+		void update(Time maxTime);
+
+		// Stops any pending work from running and waits for work in progress to finish. Pending futures are never fulfilled.
+		void abort();
+
+		size_t getNumPending() const;
+
+	private:
+		struct Request {
+			ResourceCollectionBase& collection;
+			String assetId;
+			String key;
+			ResourceLoadPriority priority;
+			bool queued = true;
+
+			std::unique_ptr<ResourceDataStatic> data;
+			std::shared_ptr<Resource> result;
+			bool loaded = false;
+
+			Promise<std::shared_ptr<Resource>> promise;
+
+			Request(ResourceCollectionBase& collection, std::string_view assetId, String key, ResourceLoadPriority priority);
+		};
+
+		mutable std::mutex mutex;
+		std::array<std::deque<std::shared_ptr<Request>>, 3> pending;
+		HashMap<String, std::shared_ptr<Request>> inFlight;
+		std::deque<std::shared_ptr<Request>> toFinalize;
+
+		std::atomic<bool> aborted = false;
+		std::atomic<int> running = 0;
+
+		template <typename F>
+		void enqueue(ExecutionQueue& queue, F f);
+
+		std::shared_ptr<Request> popNext();
+		void read();
+		void decode(const std::shared_ptr<Request>& request);
+	};
+}
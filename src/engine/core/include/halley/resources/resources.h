@@ -26,11 +26,13 @@
 #include <halley/support/exception.h>
 #include "halley/resources/resource.h"
 #include "resource_collection.h"
+#include "halley/concurrency/executor.h"
 #include "halley/text/enum_names.h"
 
 namespace Halley {
 	
 	class ResourceLocator;
+	class ResourceStreamer;
 	class HalleyAPI;
 	
 	class Resources {
@@ -66,6 +68,26 @@ namespace Halley {
 			return of<T>().get(name, priority);
 		}
 
+		// Loads the resource in the background, see ResourceStreamer. The future is fulfilled on the main thread, during update().
+		template <typename T>
+		Future<std::shared_ptr<const T>> requestAsync(std::string_view name, ResourceLoadPriority priority = ResourceLoadPriority::Normal) const
+		{
+			if (!Executors::hasInstance()) {
+				// Nowhere to stream from (or to chain the cast on), just load it
+				return Future<std::shared_ptr<const T>>::makeImmediate(get<T>(name, priority));
+			}
+			return requestAsync(T::getAssetType(), name, priority).then(Executors::getImmediate(), [] (std::shared_ptr<Resource> res) -> std::shared_ptr<const T>
+			{
+				return std::static_pointer_cast<const T>(std::move(res));
+			});
+		}
+
+		Future<std::shared_ptr<Resource>> requestAsync(AssetType type, std::string_view name, ResourceLoadPriority priority = ResourceLoadPriority::Normal) const;
+
+		// Finishes loading streamed resources, spending up to maxTime on it
+		void update(Time maxTime);
+		size_t getNumStreamingRequests() const;
+
 		template <typename T>
 		void preload(std::string_view name) const
 		{
@@ -92,6 +114,18 @@ namespace Halley {
 			of<T>().unload(res->getAssetId());
 		}
 
+		template <typename T>
+		void pin(std::string_view name) const
+		{
+			of<T>().pin(name);
+		}
+
+		template <typename T>
+		void unpin(std::string_view name) const
+		{
+			of<T>().unpin(name);
+		}
+
 		template <typename T>
 		void setFallback(std::string_view name)
 		{
@@ -120,6 +154,16 @@ namespace Halley {
 
 		const ResourceOptions& getOptions() const { return options; }
 
+		// Budgets in bytes (RAM + VRAM), 0 means no budget. Resources over budget are evicted in update(), as long as
+		// nothing else holds them and they're not pinned.
+		void setMemoryBudget(size_t bytes);
+		void setMemoryBudget(AssetType type, size_t bytes);
+		size_t getMemoryBudget() const;
+
+		/// <returns>How much memory was freed</returns>
+		ResourceMemoryUsage enforceMemoryBudgets();
+
+		Vector<ResourceCollectionStats> getStats() const;
 		void generateMemoryReport();
 
 	private:
@@ -127,5 +171,10 @@ namespace Halley {
 		Vector<std::unique_ptr<ResourceCollectionBase>> resources;
 		const HalleyAPI* const api;
 		ResourceOptions options;
+		std::shared_ptr<ResourceStreamer> streamer;
+		size_t memoryBudget = 0;
+		bool hasMemoryBudgets = false;
+
+		void updateHasMemoryBudgets();
 	};
 }
@@ -14,23 +14,6 @@ namespace Halley {
 	class InputDevice;
 	class ScriptState;
 
-    enum class ScriptVariableScope {
-        Local,
-        Shared,
-        Entity
-    };
-
-	template <>
-	struct EnumNames<ScriptVariableScope> {
-		constexpr std::array<const char*, 3> operator()() const {
-			return{{
-				"local",
-                "shared",
-				"entity"
-			}};
-		}
-	};
-
     class ScriptEnvironment: public IEntityFactoryContext {
     public:
         struct EntityMessageData {
@@ -61,6 +44,21 @@ namespace Halley {
             bool allThreads = false;
         };
 
+        struct AudioCommand {
+	        EntityId entityId;
+            String id;
+            std::optional<float> variableValue; // If set, id is the name of a variable to set, otherwise it's an event to post
+        };
+
+        // Everything a script update wants done outside of its own entity, see setDeferSideEffects
+        struct Outbox {
+	        Vector<std::pair<EntityId, ScriptMessage>> scriptMessages;
+            Vector<EntityMessageData> entityMessages;
+            Vector<ScriptExecutionRequest> executionRequests;
+            Vector<SystemMessageData> systemMessages;
+            Vector<AudioCommand> audioCommands;
+        };
+
         enum class NetworkControlMsgType {
 	        StartHostThread,
             ReturnToOwner
@@ -91,12 +89,14 @@ namespace Halley {
         EntityId readOutputEntityId(const ScriptGraphNode& node, GraphPinId pinN);
 
     	void postAudioEvent(const String& id, EntityId entityId);
+        void setAudioVariable(EntityId entityId, const String& variable, float value);
 
         ScriptVariables& getVariables(ScriptVariableScope scope);
         const ScriptVariables& getVariables(ScriptVariableScope scope) const;
         const ScriptVariables& getEntityVariables(EntityId entityId) const;
 
         void setEntityVariable(EntityId entityId, const String& name, ConfigNode data) const;
+        void setEntityVariable(EntityId entityId, const ScriptVariableId& id, ConfigNode data) const;
         void setVariableTable(const VariableTable& variableTable);
         const VariableTable* getVariableTable() const;
 
@@ -141,6 +141,15 @@ namespace Halley {
         Vector<EntityMessageData> getOutboundEntityMessages();
         Vector<ScriptExecutionRequest> getScriptExecutionRequests();
 
+        // When set, system messages and audio are queued in the outbox instead of being sent straight away.
+        // Used by environments running scripts on worker threads, whose outboxes are then merged on the main thread, in order.
+        void setDeferSideEffects(bool defer);
+        Outbox takeOutbox();
+        void mergeOutbox(Outbox outbox);
+
+        // Copies the settings games apply to the main environment (targets, variable table, authority, input enabled) to a worker environment
+        void copySettingsFrom(const ScriptEnvironment& other);
+
         void startHostThread(int node, ConfigNode params);
         void cancelHostThread(int node);
         void returnHostThread(ConfigNode params);
@@ -185,6 +194,9 @@ namespace Halley {
         Vector<std::pair<EntityId, ScriptMessage>> scriptOutbox;
         Vector<EntityMessageData> entityOutbox;
         Vector<ScriptExecutionRequest> scriptExecutionRequestOutbox;
+        Vector<SystemMessageData> systemMessageOutbox;
+        Vector<AudioCommand> audioOutbox;
+        bool deferSideEffects = false;
 
         ScriptTargetRetriever scriptTargetRetriever;
 
@@ -215,6 +227,9 @@ namespace Halley {
         void processMessages(Time time, Vector<ScriptStateThread>& pending);
         void processControlEvents(Time time, Vector<ScriptStateThread>& pending);
 
+        void doSendSystemMessage(SystemMessageData message);
+        void doAudioCommand(const AudioCommand& command);
+
     	EntityId getEntityIdFromUUID(const UUID& uuid) const override;
         UUID getUUIDFromEntityId(EntityId id) const override;
     };
@@ -9,6 +9,7 @@ namespace Halley {
 	class IScriptNodeType;
 	class ScriptNodeTypeCollection;
 	class ScriptGraph;
+	class ScriptGraphProgram;
 	class World;
 
 	class ScriptGraphNode final : public BaseGraphNode {
@@ -132,6 +133,9 @@ namespace Halley {
 
 		const ScriptGraph* getPreviousVersion(uint64_t hash) const;
 
+		// Built by assignTypes(), so that's required after any change to the graph
+		const ScriptGraphProgram& getProgram() const;
+
 	private:
 		Vector<std::pair<GraphNodeId, GraphNodeId>> callerToCallee;
 		Vector<std::pair<GraphNodeId, GraphNodeId>> returnToCaller;
@@ -142,6 +146,9 @@ namespace Halley {
 		ConfigNode properties;
 
 		std::shared_ptr<ScriptGraph> previousVersion;
+		mutable std::shared_ptr<const ScriptGraphProgram> program;
+
+		void onTypesAssigned() const override;
 
 		GraphNodeId findNodeRoot(GraphNodeId nodeId) const;
 		void generateRoots();
@@ -0,0 +1,62 @@
+#pragma once
+#include "script_node_type.h"
+#include "script_variables.h"
+
+namespace Halley {
+	class ScriptGraph;
+
+	// Flattened form of a ScriptGraph, used by ScriptEnvironment to run it.
+	// Connections, flow outputs, literal values and variable names are resolved once into tables indexed by node id, instead of being looked up on the graph's pins and settings at every step.
+	// Built by ScriptGraph::assignTypes() whenever it assigns types for a new version of the graph, and only read after that, so it can be shared by threads running the graph.
+	// This only caches lookups, it's not a linear instruction stream and there are no typed registers: nodes still run through IScriptNodeType, and data pins are still pulled through getData as ConfigNode.
+	class ScriptGraphProgram {
+	public:
+		using OutputNode = IScriptNodeType::OutputNode;
+
+		struct PinLink {
+			OptionalLite<GraphNodeId> node;
+			GraphPinId pin = 0;
+		};
+
+		explicit ScriptGraphProgram(const ScriptGraph& graph);
+
+		uint64_t getGraphHash() const { return graphHash; }
+		bool canRunInParallel() const { return parallel; }
+
+		// First connection of the given pin, used for data and target pins, which only have one
+		const PinLink& getLink(GraphNodeId node, GraphPinId pin) const;
+
+		std::array<OutputNode, 8> getOutputNodes(GraphNodeId node, uint8_t outputActiveMask) const;
+		GraphPinId getNthOutputPinIdx(GraphNodeId node, size_t n) const;
+
+		const ConfigNode* tryGetConstant(GraphNodeId node) const;
+		const ScriptVariableRef* tryGetVariable(GraphNodeId node) const;
+
+	private:
+		struct NodeEntry {
+			uint32_t firstLink = 0;
+			uint32_t firstFlowOutput = 0;
+			int constantIdx = -1;
+			int variableIdx = -1;
+			GraphPinId numLinks = 0;
+			uint8_t numFlowOutputs = 0;
+		};
+
+		struct FlowOutput {
+			uint32_t firstTarget = 0;
+			uint32_t numTargets = 0;
+			GraphPinId pin = 0;
+		};
+
+		uint64_t graphHash = 0;
+		bool parallel = true;
+		Vector<NodeEntry> nodes;
+		Vector<PinLink> links;
+		Vector<FlowOutput> flowOutputs;
+		Vector<OutputNode> targets;
+		Vector<ConfigNode> constants;
+		Vector<ScriptVariableRef> variables;
+
+		PinLink emptyLink;
+	};
+}
@@ -3,6 +3,7 @@
 #include "script_graph.h"
 #include "script_state.h"
 #include "script_node_enums.h"
+#include "script_variables.h"
 #include "halley/graph/base_graph_type.h"
 #include "halley/graphics/text/text_renderer.h"
 #include "halley/time/halleytime.h"
@@ -42,6 +43,10 @@ namespace Halley {
 		virtual bool hasDestructor(const ScriptGraphNode& node) const { return false; }
 		virtual bool showDestructor() const { return true; }
 
+		// True if this node only touches its own entity's script state and goes through ScriptEnvironment for anything else (messages, audio, starting scripts),
+		// so scripts made entirely of such nodes can be updated on worker threads alongside other entities. See ScriptSystem.
+		virtual bool canRunInParallel() const { return false; }
+
 		virtual std::unique_ptr<IScriptStateData> makeData() const { return {}; }
         virtual void initData(IScriptStateData& data, const ScriptGraphNode& node, const EntitySerializationContext& context, const ConfigNode& nodeData) const {}
 
@@ -54,6 +59,11 @@ namespace Halley {
         virtual EntityId getEntityId(ScriptEnvironment& environment, const ScriptGraphNode& node, GraphPinId pinN, IScriptStateData* curData) const = 0;
 		virtual ConfigNode getDevConData(ScriptEnvironment& environment, const ScriptGraphNode& node, IScriptStateData* curData) const = 0;
 
+		// Resolved once when the graph is compiled into a ScriptGraphProgram
+		// getConstantValue is the value of all output data pins, for nodes whose data only depends on their settings
+		virtual std::optional<ConfigNode> getConstantValue(const ScriptGraphNode& node) const { return std::nullopt; }
+		virtual std::optional<ScriptVariableRef> getVariableRef(const ScriptGraphNode& node) const { return std::nullopt; }
+
 		ConfigNode readDataPin(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN) const;
 		void writeDataPin(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN, ConfigNode data) const;
 		EntityId readEntityId(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t idx) const;
@@ -67,8 +77,6 @@ namespace Halley {
 			GraphPinId outputPin;
 			GraphPinId inputPin;
 		};
-		std::array<OutputNode, 8> getOutputNodes(const ScriptGraphNode& node, uint8_t outputActiveMask) const;
-		GraphPinId getNthOutputPinIdx(const ScriptGraphNode& node, size_t n) const;
 
         static String addParentheses(String str);
 
@@ -1,10 +1,55 @@
 #pragma once
 #include "halley/data_structures/config_node.h"
 #include "halley/bytes/config_node_serializer_base.h"
+#include "halley/text/enum_names.h"
 
 namespace Halley {
 	class EntitySerializationContext;
 
+    enum class ScriptVariableScope {
+        Local,
+        Shared,
+        Entity
+    };
+
+	template <>
+	struct EnumNames<ScriptVariableScope> {
+		constexpr std::array<const char*, 3> operator()() const {
+			return{{
+				"local",
+                "shared",
+				"entity"
+			}};
+		}
+	};
+
+	// Variable name with its hash computed up front, so scripts can look it up repeatedly without hashing the string every time
+	class ScriptVariableId {
+	public:
+		ScriptVariableId() = default;
+		explicit ScriptVariableId(String name);
+
+		const String& getName() const { return name; }
+		uint64_t getHash() const { return hash; }
+
+		bool operator==(const ScriptVariableId& other) const { return hash == other.hash && name == other.name; }
+		bool operator!=(const ScriptVariableId& other) const { return !(*this == other); }
+
+		// Uses the precomputed hash; names are still compared on lookup, so colliding names are kept apart
+		struct Hasher {
+			size_t operator()(const ScriptVariableId& id) const { return static_cast<size_t>(id.hash); }
+		};
+
+	private:
+		String name;
+		uint64_t hash = 0;
+	};
+
+	struct ScriptVariableRef {
+		ScriptVariableId id;
+		ScriptVariableScope scope = ScriptVariableScope::Local;
+	};
+
 	class ScriptVariables {
 	public:
 		ScriptVariables() = default;
@@ -14,7 +59,9 @@ namespace Halley {
 		ConfigNode toConfigNode(const EntitySerializationContext& context) const;
 
 		const ConfigNode& getVariable(const String& name) const;
+		const ConfigNode& getVariable(const ScriptVariableId& id) const;
     	void setVariable(const String& name, ConfigNode value);
+    	void setVariable(const ScriptVariableId& id, ConfigNode value);
 		bool hasVariable(const String& name) const;
 
 		bool empty() const;
@@ -22,7 +69,10 @@ namespace Halley {
 
 	private:
 		ConfigNode dummy;
-		HashMap<String, ConfigNode> variables;
+		HashMap<ScriptVariableId, ConfigNode, ScriptVariableId::Hasher> variables;
+
+		ConfigNode& getOrCreate(const ScriptVariableId& id);
+		void erase(const ScriptVariableId& id);
 	};
 
 	template <>
@@ -4,8 +4,13 @@
 #include <thread>
 #include <gsl/span>
 #include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
 
 #include "halley/data_structures/hash_map.h"
+#include "halley/file/path.h"
+#include "halley/text/enum_names.h"
 #include "halley/time/halleytime.h"
 
 namespace Halley {
@@ -17,6 +22,7 @@ namespace Halley {
 		CoreVariableUpdate,
 		CoreUpdateSystem,
 		CoreUpdatePlatform,
+		CoreResourceStreaming,
 		CoreUpdate,
 		CoreStartRender,
 		CoreRender,
@@ -47,7 +53,44 @@ namespace Halley {
 
         ExternalCode,
         UserDefined
-    };	
+    };
+
+	template <>
+	struct EnumNames<ProfilerEventType> {
+		constexpr std::array<const char*, 29> operator()() const {
+			return{{
+				"corePumpEvents",
+				"coreDevConClient",
+				"corePumpAudio",
+				"coreFixedUpdate",
+				"coreVariableUpdate",
+				"coreUpdateSystem",
+				"coreUpdatePlatform",
+				"coreResourceStreaming",
+				"coreUpdate",
+				"coreStartRender",
+				"coreRender",
+				"coreVSync",
+				"painterDrawCall",
+				"painterEndRender",
+				"painterUpdateProjection",
+				"worldVariableUpdate",
+				"worldFixedUpdate",
+				"worldRender",
+				"worldSystemUpdate",
+				"worldSystemRender",
+				"worldSystemMessages",
+				"scriptUpdate",
+				"audioGenerateBuffer",
+				"gpu",
+				"diskIO",
+				"statsView",
+				"game",
+				"externalCode",
+				"userDefined"
+			}};
+		}
+	};
 
     class ProfilerData {
     public:
@@ -109,11 +152,16 @@ namespace Halley {
     	void processEvents();
     };
 	
+	// Each thread records into its own ring buffer, so recording an event never takes a lock. Event names are interned
+	// into ids, and the name strings are only looked up when a capture is read.
+	// Frame captures (getCapture()) cover the events recorded between startFrame() and endFrame(). Streaming writes every
+	// event to a trace file from a background thread instead, across any number of frames (see ProfilerTrace).
     class ProfilerCapture {
     public:
         using EventId = uint64_t;
     	
-        ProfilerCapture(size_t maxEvents = 16384);
+        ProfilerCapture(size_t maxEventsPerThread = 16384);
+    	~ProfilerCapture();
     	
     	[[nodiscard]] static ProfilerCapture& get();
 
@@ -130,6 +178,10 @@ namespace Halley {
 
     	Time getFrameTime() const;
 
+		bool startStreaming(const Path& path);
+		void stopStreaming();
+		[[nodiscard]] bool isStreaming() const;
+
     private:
     	enum class State {
     		Idle,
@@ -137,18 +189,135 @@ namespace Halley {
     		FrameEnded
     	};
 
+		struct Slot {
+			std::atomic<uint64_t> seq;
+			std::atomic<int64_t> startTime;
+			std::atomic<int64_t> endTime;
+			std::atomic<uint32_t> nameId;
+			std::atomic<ProfilerEventType> type;
+		};
+
+		struct ReadEvent {
+			uint64_t seq;
+			int64_t startTime;
+			int64_t endTime;
+			uint32_t nameId;
+			ProfilerEventType type;
+		};
+
+		class ThreadBuffer {
+		public:
+			ThreadBuffer(size_t capacity, uint32_t index);
+
+			uint64_t getWritePos() const;
+			bool read(uint64_t seq, ReadEvent& dst) const;
+
+			// Set by the owner thread when it exits, then made free by startFrame() once its events can't be captured any more
+			enum class OwnerState : int {
+				Alive,
+				Exited,
+				Free
+			};
+
+			const uint32_t index;
+			std::atomic<std::thread::id> threadId;
+			const std::shared_ptr<std::atomic<OwnerState>> ownerState;
+			const size_t capacity;
+			std::unique_ptr<Slot[]> slots;
+			std::atomic<uint64_t> writePos;
+
+			// Owner thread only
+			HashMap<String, uint32_t> nameCache;
+
+			// Main thread only
+			uint64_t frameStart = 0;
+			uint64_t frameEnd = 0;
+
+			// Streaming thread only
+			uint64_t streamed = 0;
+		};
+
+		struct ThreadBufferCache;
+		static thread_local ThreadBufferCache threadBufferCache;
+
+		constexpr static size_t maxThreads = 256;
+		constexpr static int seqBits = 48;
+
+		const uint64_t instanceId;
+		const size_t maxEventsPerThread;
     	std::atomic<bool> recording;
-    	std::atomic<uint64_t> curId;
-    	uint64_t startId;
-    	std::atomic<uint64_t> endId;
         State state = State::Idle;
     	
     	std::chrono::steady_clock::time_point frameStartTime;
     	std::chrono::steady_clock::time_point frameEndTime;
 
-    	Vector<ProfilerData::Event> events;
+		std::array<std::atomic<ThreadBuffer*>, maxThreads> threadBuffers;
+		std::atomic<uint32_t> numThreadBuffers;
+		Vector<std::unique_ptr<ThreadBuffer>> ownedThreadBuffers;
+		std::mutex threadBuffersMutex;
+		std::atomic<bool> warnedMaxThreads;
+
+		mutable std::mutex namesMutex;
+		HashMap<String, uint32_t> nameIds;
+		Vector<String> names;
+
+		std::atomic<bool> streaming;
+		std::thread streamThread;
+		std::mutex streamMutex;
+		std::condition_variable streamCondition;
+
+		ThreadBuffer* getThreadBuffer();
+		uint32_t getNameId(ThreadBuffer& buffer, std::string_view name);
+
+		void runStreaming(std::ostream& out);
+		void writeStreamed(std::ostream& out, uint32_t& threadsWritten, uint32_t& namesWritten, bool final);
     };
 
+	// Reads the trace files written by ProfilerCapture::startStreaming()
+	class ProfilerTrace {
+	public:
+		struct Thread {
+			uint32_t index;
+			uint64_t threadId;
+		};
+
+		struct Event {
+			uint32_t threadIndex;
+			ProfilerEventType type;
+			uint32_t nameId;
+			int64_t startTime; // Nanoseconds
+			int64_t endTime; // 0 if the event never ended
+		};
+
+		constexpr static std::array<char, 8> magic = { 'H', 'L', 'Y', 'T', 'R', 'A', 'C', 'E' };
+		constexpr static uint32_t version = 1;
+		constexpr static uint32_t gpuThreadIndex = 1000;
+
+		enum class RecordType : uint8_t {
+			Thread,
+			Name,
+			Event,
+			Dropped
+		};
+
+		ProfilerTrace() = default;
+		explicit ProfilerTrace(gsl::span<const gsl::byte> data);
+
+		const Vector<Thread>& getThreads() const;
+		const Vector<Event>& getEvents() const;
+		const String& getName(uint32_t nameId) const;
+		uint64_t getDroppedEvents() const;
+
+		// Chrome's trace event format, which can be opened in chrome://tracing or Perfetto
+		String toChromeJSON() const;
+
+	private:
+		Vector<Thread> threads;
+		Vector<Event> events;
+		Vector<String> names;
+		uint64_t droppedEvents = 0;
+	};
+
 	class ProfilerEvent {
 	public:
 		ProfilerEvent(ProfilerEventType type, std::string_view name = "");
@@ -10,6 +10,7 @@
 
 namespace Halley {
 	class ConfigNode;
+	class ConfigNodeView;
 	class ConfigFile;
 	class ConfigObserver;
 	class I18N;
@@ -147,6 +148,7 @@ namespace Halley {
 		int version = 0;
 
 		void loadLocalisation(const ConfigNode& node);
+		void loadLocalisation(ConfigNodeView node);
 	};
 }
 
@@ -36,6 +36,7 @@ namespace Halley {
 		bool isWaitingToSpawnChildren() const;
 
 		virtual void markAsNeedingLayout();
+		virtual void markAsNeedingRelayout();
 		virtual void onChildrenAdded() {}
 		virtual void onChildrenRemoved() {}
 		virtual void onChildAdded(UIWidget& child) {}
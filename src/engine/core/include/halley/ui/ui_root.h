@@ -43,6 +43,10 @@ namespace Halley {
 
 		void mouseOverNext(bool forward = true);
 		void runLayout();
+
+		// When enabled (default), layout only visits subtrees that were marked as needing layout, or that moved
+		void setIncrementalLayout(bool enabled);
+		bool isIncrementalLayout() const;
 		
 		std::optional<std::shared_ptr<IAudioHandle>> playSound(const String& eventName);
 		void sendEvent(UIEvent event, bool includeSelf) const override;
@@ -87,6 +91,9 @@ namespace Halley {
 		InputAPI* inputAPI = nullptr;
 		AudioAPI* audioAPI = nullptr;
 		Rect4f uiRect;
+		std::optional<Rect4f> lastLayoutRect;
+		bool incrementalLayout = true;
+		Vector<std::shared_ptr<UIWidget>> laidOutChildren;
 
 		std::weak_ptr<UIWidget> currentMouseOver;
 		std::weak_ptr<UIWidget> mouseExclusive; // A widget that's taking exclusive control of mouse
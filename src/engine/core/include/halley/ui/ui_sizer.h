@@ -180,5 +180,6 @@ namespace Halley {
 		float getRowProportion(int row) const;
 
 		void sortChildrenBySizerOrder();
+		void markParentAsNeedingLayout();
 	};
 }
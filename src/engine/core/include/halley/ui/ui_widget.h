@@ -156,6 +156,7 @@ namespace Halley {
 
 		bool isDescendentOf(const UIWidget& ancestor) const final override;
 		void setMouseClip(std::optional<Rect4f> mouseClip, bool force);
+		const std::optional<Rect4f>& getMouseClip() const;
 
 		virtual void onManualControlCycleValue(int delta);
 		virtual void onManualControlAnalogueAdjustValue(float delta, Time t);
@@ -180,6 +181,8 @@ namespace Halley {
 
 		bool needsLayout() const;
 		void markAsNeedingLayout() final override;
+		// Places this subtree again on the next layout without recomputing minimum sizes, for when only positions changed (e.g. scrolling)
+		void markAsNeedingRelayout() final override;
 
 		virtual bool canReceiveFocus() const;
 		std::shared_ptr<UIWidget> getFocusableOrAncestor();
@@ -202,8 +205,13 @@ namespace Halley {
 		void fitToRoot();
 
 		virtual std::optional<Vector2f> transformToChildSpace(Vector2f pos) const;
+		virtual Rect4f transformFromChildSpace(Rect4f rect) const;
 		virtual std::optional<MouseCursorMode> getMouseCursorMode() const;
 
+		// Union of the mouse rects of this widget and all its active descendants, cached until something in the subtree moves
+		// Empty if the subtree can't be bounded, in which case it must always be visited when looking for the widget under the mouse
+		std::optional<Rect4f> getMouseBounds() const;
+
 	protected:
 		virtual void draw(UIPainter& painter) const;
 		virtual void drawAfterChildren(UIPainter& painter) const;
@@ -244,6 +252,8 @@ namespace Halley {
 
 		void playStyleSound(const String& keyId);
 
+		void markMouseBoundsDirty();
+
 		Vector<UIStyle> styles = {};
 
 	private:
@@ -252,6 +262,8 @@ namespace Halley {
 		void notifyTreeRemovedFromRoot(UIRoot& root);
 
 		void setWidgetRect(Rect4f rect);
+		bool canSkipLayout(Rect4f rect, IUIElementListener* listener) const;
+		std::optional<Rect4f> computeMouseBounds() const;
 		void resetInputResults();
 		void updateActive(bool wasActiveBefore);
 		void notifyActivationChange(bool active);
@@ -270,11 +282,14 @@ namespace Halley {
 		UIInputType lastInputType = UIInputType::Undefined;
 	private:
 		mutable int layoutNeeded = 1;
+		bool layoutDirty = true;
 		
 		Vector2f position;
 		Vector2f size;
 		Vector2f minSize;
 		std::optional<Rect4f> mouseClip;
+		mutable std::optional<Rect4f> mouseBounds;
+		mutable bool mouseBoundsDirty = true;
 
 		Vector4f innerBorder;
 		std::optional<UISizer> sizer;
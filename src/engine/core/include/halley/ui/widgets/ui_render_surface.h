@@ -23,6 +23,7 @@ namespace Halley {
         void onPreNotifySetRect(IUIElementListener& listener) override;
 
         std::optional<Vector2f> transformToChildSpace(Vector2f pos) const override;
+        Rect4f transformFromChildSpace(Rect4f rect) const override;
 
         void setBypass(bool bypass);
         void setAutoBypass(bool autoBypass);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "ui_clickable.h"
+#include "../ui_style.h"
+#include "halley/graphics/sprite/sprite.h"
+
+namespace Halley {
+	// Vertical list for very large numbers of items (asset browsers, logs, etc).
+	// Items aren't widgets: only the rows currently on screen get one, which is created by makeRow and reused as the list scrolls, with bindRow filling it in for a given index.
+	// All rows have the same height. Put it inside a UIScrollPane, which is used to work out which rows are visible.
+	class UIVirtualList : public UIClickable {
+	public:
+		using MakeRowCallback = std::function<std::shared_ptr<UIWidget>()>;
+		using BindRowCallback = std::function<void(UIWidget& row, int index)>;
+		using GetItemIdCallback = std::function<String(int index)>;
+
+		UIVirtualList(String id, UIStyle style, float rowHeight, MakeRowCallback makeRow, BindRowCallback bindRow);
+
+		void setCount(int count);
+		int getCount() const;
+		void setRowHeight(float height);
+		float getRowHeight() const;
+
+		// Used for the ids sent on list events, defaults to the index
+		void setItemIdCallback(GetItemIdCallback callback);
+		String getItemId(int index) const;
+
+		// Binds all visible rows again, call when the underlying data changes
+		void refresh();
+
+		bool setSelectedOption(int option);
+		int getSelectedOption() const;
+		String getSelectedOptionId() const;
+		std::optional<int> getHoveredOption() const;
+		void showCurSelection(bool centre);
+
+		Rect4f getOptionRect(int option) const;
+		std::optional<int> getOptionAt(Vector2f pos) const;
+
+		bool canReceiveFocus() const override;
+
+		Vector2f getMinimumSize() const override;
+
+		void onClicked(Vector2f mousePos, KeyMods keyMods) override;
+		void onDoubleClicked(Vector2f mousePos, KeyMods keyMods) override;
+		void onMouseOver(Vector2f mousePos) override;
+		void onMouseLeft(Vector2f mousePos) override;
+
+	protected:
+		void draw(UIPainter& painter) const override;
+		void update(Time t, bool moved) override;
+		void doSetState(State state) override;
+		bool onKeyPress(KeyboardKeyPress key) override;
+
+	private:
+		struct Row {
+			std::shared_ptr<UIWidget> widget;
+			int index = -1;
+		};
+
+		MakeRowCallback makeRow;
+		BindRowCallback bindRow;
+		GetItemIdCallback getItemIdCallback;
+
+		Sprite sprite;
+		Sprite itemSprite;
+		Sprite hoverSprite;
+		Sprite selectedSprite;
+
+		Vector<Row> rows;
+		Range<int> visibleRange;
+		Rect4f lastRect;
+		float rowHeight = 0;
+		float gap = 0;
+		int count = 0;
+		int curOption = -1;
+		int curHover = -1;
+		bool rowsDirty = true;
+
+		float getRowStride() const;
+		Range<int> getVisibleRange() const;
+		void updateRows();
+		void placeRow(Row& row);
+		void setHover(int option);
+		void moveSelection(int delta);
+	};
+}
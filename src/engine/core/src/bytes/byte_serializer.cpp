@@ -13,15 +13,51 @@ SerializerState* ByteSerializationBase::setState(SerializerState* s)
 	return oldState;
 }
 
+namespace {
+	// Buffers that grew past this are freed instead of pooled, so one huge save doesn't pin memory forever
+	constexpr size_t maxPooledBufferCapacity = 4 * 1024 * 1024;
+	constexpr size_t maxPooledBuffers = 8;
+
+	Vector<Bytes>& getBufferPool()
+	{
+		thread_local Vector<Bytes> pool;
+		return pool;
+	}
+}
+
+SerializerBuffer::SerializerBuffer()
+{
+	auto& pool = getBufferPool();
+	if (!pool.empty()) {
+		bytes = std::move(pool.back());
+		pool.pop_back();
+	}
+}
+
+SerializerBuffer::~SerializerBuffer()
+{
+	auto& pool = getBufferPool();
+	if (bytes.capacity() <= maxPooledBufferCapacity && pool.size() < maxPooledBuffers) {
+		bytes.clear();
+		pool.push_back(std::move(bytes));
+	}
+}
+
 Serializer::Serializer(SerializerOptions options)
 	: ByteSerializationBase(std::move(options))
-	, dryRun(true)
+	, mode(Mode::DryRun)
 {}
 
 Serializer::Serializer(gsl::span<gsl::byte> dst, SerializerOptions options)
 	: ByteSerializationBase(std::move(options))
 	, dst(dst)
-	, dryRun(false)
+	, mode(Mode::Span)
+{}
+
+Serializer::Serializer(Bytes& dst, SerializerOptions options)
+	: ByteSerializationBase(std::move(options))
+	, growableDst(&dst)
+	, mode(Mode::Growable)
 {}
 
 Serializer& Serializer::operator<<(const std::string& str)
@@ -145,11 +181,16 @@ void Serializer::serializeVariableInteger(uint64_t val, std::optional<bool> sign
 
 void Serializer::copyBytes(const void* src, size_t srcSize)
 {
-	if (!dryRun) {
+	if (mode == Mode::Span) {
 		if (dst.size() - size < srcSize) {
 			throw Exception("Insufficient bytes to serialize data.", HalleyExceptions::Utils);
 		}
 		memcpy(dst.data() + size, src, srcSize);
+	} else if (mode == Mode::Growable) {
+		const size_t pos = growableDst->size();
+		growableDst->reserve(pos + srcSize);
+		growableDst->resize_no_init(pos + srcSize);
+		memcpy(growableDst->data() + pos, src, srcSize);
 	}
 	size += srcSize;
 }
@@ -175,18 +216,26 @@ Deserializer& Deserializer::operator>>(std::string& str)
 }
 
 Deserializer& Deserializer::operator>>(String& str)
+{
+	const auto view = readStringView();
+	str = String(view.data(), view.size());
+	return *this;
+}
+
+std::string_view Deserializer::readStringView()
 {
 	auto readRawString = [&] (size_t size)
 	{
 		ensureSufficientBytesRemaining(size);
-		str = String(reinterpret_cast<const char*>(src.data() + pos), size);
+		const auto result = std::string_view(reinterpret_cast<const char*>(src.data() + pos), size);
 		pos += size;
+		return result;
 	};
 	
 	if (options.version == 0) {
 		uint32_t size;
 		*this >> size;
-		readRawString(size);
+		return readRawString(size);
 	} else {
 		uint64_t value;
 		*this >> value;
@@ -195,18 +244,16 @@ Deserializer& Deserializer::operator>>(String& str)
 			if (options.exhaustiveDictionary || (value & 0x1) != 0) {
 				// Indexed string
 				int shift = options.exhaustiveDictionary ? 0 : 1;
-				str = options.dictionary->indexToString(value >> shift);
+				return options.dictionary->indexToString(value >> shift);
 			} else {
 				// Not indexed
-				readRawString(value >> 1);
+				return readRawString(value >> 1);
 			}
 		} else {
 			// No dictionary
-			readRawString(value);
+			return readRawString(value);
 		}
 	}
-
-	return *this;
 }
 
 Deserializer& Deserializer::operator>>(StringUTF32& str)
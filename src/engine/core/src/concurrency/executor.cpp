@@ -5,72 +5,279 @@
 #include "halley/game/game_platform.h"
 #include "halley/text/string_converter.h"
 #include "halley/support/logger.h"
+#include "halley/utils/utils.h"
 
 using namespace Halley;
 
 Executors* Executors::instance = nullptr;
 
+namespace {
+	// Which queue (if any) the current thread is a worker of, and its slot in that queue
+	thread_local const ExecutionQueue* currentWorkerQueue = nullptr;
+	thread_local size_t currentWorkerIdx = 0;
+
+	TaskBase takeTask(TaskBase* task)
+	{
+		std::unique_ptr<TaskBase> owned(task);
+		return std::move(*owned);
+	}
+}
+
+WorkStealingDeque::Buffer::Buffer(size_t capacity)
+	: mask(capacity - 1)
+	, items(std::make_unique<std::atomic<TaskBase*>[]>(capacity))
+{
+	Expects((capacity & mask) == 0);
+}
+
+WorkStealingDeque::WorkStealingDeque(size_t initialCapacity)
+	: top(0)
+	, bottom(0)
+{
+	buffers.push_back(std::make_unique<Buffer>(nextPowerOf2(std::max(initialCapacity, size_t(2)))));
+	buffer.store(buffers.back().get());
+}
+
+WorkStealingDeque::~WorkStealingDeque()
+{
+	while (size() > 0) {
+		pop();
+	}
+}
+
+void WorkStealingDeque::push(TaskBase task)
+{
+	const auto b = bottom.load(std::memory_order_relaxed);
+	const auto t = top.load(std::memory_order_acquire);
+	auto* buf = buffer.load(std::memory_order_relaxed);
+	if (b - t > static_cast<int64_t>(buf->capacity()) - 1) {
+		buf = grow(buf, t, b);
+	}
+	buf->put(b, new TaskBase(std::move(task)));
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+TaskBase WorkStealingDeque::pop()
+{
+	const auto b = bottom.load(std::memory_order_relaxed) - 1;
+	auto* buf = buffer.load(std::memory_order_relaxed);
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto t = top.load(std::memory_order_relaxed);
+
+	if (t > b) {
+		// Empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return {};
+	}
+
+	auto* task = buf->get(b);
+	if (t == b) {
+		// Last one, race thieves for it
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			task = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return task ? takeTask(task) : TaskBase();
+}
+
+TaskBase WorkStealingDeque::steal()
+{
+	auto t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const auto b = bottom.load(std::memory_order_acquire);
+	if (t >= b) {
+		return {};
+	}
+
+	auto* task = buffer.load(std::memory_order_acquire)->get(t);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		// Lost the race to another thief or the owner
+		return {};
+	}
+	return takeTask(task);
+}
+
+size_t WorkStealingDeque::size() const
+{
+	const auto b = bottom.load(std::memory_order_relaxed);
+	const auto t = top.load(std::memory_order_relaxed);
+	return static_cast<size_t>(std::max(b - t, int64_t(0)));
+}
+
+WorkStealingDeque::Buffer* WorkStealingDeque::grow(Buffer* old, int64_t t, int64_t b)
+{
+	auto next = std::make_unique<Buffer>(old->capacity() * 2);
+	for (auto i = t; i < b; ++i) {
+		next->put(i, old->get(i));
+	}
+	auto* result = next.get();
+	buffers.push_back(std::move(next));
+	buffer.store(result, std::memory_order_release);
+	return result;
+}
+
 ExecutionQueue::ExecutionQueue()
-	: aborted(false)
+	: workerCount(0)
+	, pendingTasks(0)
+	, sleepingCount(0)
+	, aborted(false)
 {
 	hasTasks.store(false);
 }
 
 TaskBase ExecutionQueue::getNext()
 {
-	std::unique_lock<std::mutex> lock(mutex);
-	while (queue.empty()) {
-		if (!aborted) {
-			condition.wait(lock);
+	while (true) {
+		if (auto task = tryGetNext()) {
+			return task;
 		}
+
+		std::unique_lock<std::mutex> lock(mutex);
 		if (aborted) {
-			queue.clear();
 			return TaskBase([] () {});
 		}
-	}
 
-	TaskBase value = queue.front();
-	queue.pop_front();
-	return value;
+		// sleepingCount is raised before pendingTasks is checked, and producers do the opposite, so a wake-up can't be missed
+		++sleepingCount;
+		condition.wait(lock, [&] () { return pendingTasks.load() > 0 || aborted; });
+		--sleepingCount;
+	}
 }
 
 Vector<TaskBase> ExecutionQueue::getUpTo(size_t n)
 {
-	std::unique_lock<std::mutex> lock(mutex);
-	if (queue.size() <= n) {
-		hasTasks.store(false);
-		Vector<TaskBase> tasks(queue.begin(), queue.end());
-		queue.clear();
-		return tasks;
-	} else {
-		Vector<TaskBase> tasks(queue.begin(), queue.begin() + n);
-		queue.erase(queue.begin(), queue.begin() + n);
-		return tasks;
+	Vector<TaskBase> tasks;
+	while (tasks.size() < n) {
+		auto task = tryGetNext();
+		if (!task) {
+			break;
+		}
+		tasks.push_back(std::move(task));
 	}
+	return tasks;
 }
 
 Vector<TaskBase> ExecutionQueue::getAll()
 {
-	std::unique_lock<std::mutex> lock(mutex);
-	hasTasks.store(false);
-	Vector<TaskBase> tasks(queue.begin(), queue.end());
-	queue.clear();
+	Vector<TaskBase> tasks;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		hasTasks.store(false);
+		tasks.assign(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.end()));
+		queue.clear();
+	}
+
+	const size_t nWorkers = workerCount.load(std::memory_order_acquire);
+	for (size_t i = 0; i < nWorkers; ++i) {
+		auto& worker = *workers[i];
+		while (worker.size() > 0) {
+			if (auto task = worker.steal()) {
+				tasks.push_back(std::move(task));
+			}
+		}
+	}
+
+	pendingTasks -= tasks.size();
 	return tasks;
 }
 
+TaskBase ExecutionQueue::tryGetNext()
+{
+	if (pendingTasks.load() == 0) {
+		return {};
+	}
+
+	// Own deque first, newest task
+	auto* self = getCurrentWorker();
+	if (self) {
+		if (auto task = self->pop()) {
+			--pendingTasks;
+			return task;
+		}
+	}
+
+	// Then the shared queue
+	if (hasTasks.load()) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!queue.empty()) {
+			auto task = std::move(queue.front());
+			queue.pop_front();
+			--pendingTasks;
+			if (queue.empty()) {
+				hasTasks.store(false);
+			}
+			return task;
+		}
+		hasTasks.store(false);
+	}
+
+	// Then steal the oldest task of another worker, starting from our neighbour so thieves spread out
+	const size_t nWorkers = workerCount.load(std::memory_order_acquire);
+	const size_t start = self ? currentWorkerIdx + 1 : 0;
+	for (size_t i = 0; i < nWorkers; ++i) {
+		auto& victim = *workers[(start + i) % nWorkers];
+		if (&victim == self) {
+			continue;
+		}
+		if (auto task = victim.steal()) {
+			--pendingTasks;
+			return task;
+		}
+	}
+
+	return {};
+}
+
 void ExecutionQueue::addToQueue(TaskBase task)
 {
 	if (immediate) {
 		task();
+	} else if (auto* self = getCurrentWorker()) {
+		// Counted before it's visible, so thieves can never take pendingTasks below zero
+		++pendingTasks;
+		self->push(std::move(task));
+		notifyTaskAdded();
 	} else {
 		std::unique_lock<std::mutex> lock(mutex);
-		queue.emplace_back(task);
+		queue.emplace_back(std::move(task));
 		hasTasks.store(true);
+		++pendingTasks;
 
 		condition.notify_one();
 	}
 }
 
+void ExecutionQueue::notifyTaskAdded()
+{
+	if (sleepingCount.load() > 0) {
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.notify_one();
+	}
+}
+
+WorkStealingDeque* ExecutionQueue::getCurrentWorker() const
+{
+	return currentWorkerQueue == this ? workers[currentWorkerIdx].get() : nullptr;
+}
+
+void ExecutionQueue::attachWorkerThread()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	const size_t idx = workerCount.load();
+	if (idx >= maxWorkers) {
+		// Past the limit, this thread just uses the shared queue
+		return;
+	}
+
+	workers[idx] = std::make_unique<WorkStealingDeque>();
+	workerCount.store(idx + 1, std::memory_order_release);
+	currentWorkerQueue = this;
+	currentWorkerIdx = idx;
+}
+
 Executors::Executors()
 {
 	immediate.setImmediate(true);
@@ -164,6 +371,10 @@ void Executor::runPending()
 
 void Executor::runForever()
 {
+#if HAS_THREADS
+	queue.attachWorkerThread();
+#endif
+
 	while (running)	{
 		auto next = queue.getNext();
 		try {
@@ -1,87 +1,441 @@
 #include "halley/data_structures/bin_pack.h"
-
-#ifdef _MSC_VER
-#pragma warning(disable: 4456 4458)
-#endif
-#include "binpack2d.hpp"
-#include <queue>
-#include "halley/support/logger.h"
+#include "halley/concurrency/concurrent.h"
+#include "halley/data_structures/hash_map.h"
+#include <limits>
 
 using namespace Halley;
 
+namespace {
+	enum class MaxRectsHeuristic {
+		BestShortSideFit,
+		BestLongSideFit,
+		BestAreaFit,
+		BottomLeft,
+		ContactPoint
+	};
+
+	enum class EntryOrder {
+		Area,
+		LongSide,
+		Height,
+		Perimeter
+	};
+
+	constexpr std::array<MaxRectsHeuristic, 5> allHeuristics = {{ MaxRectsHeuristic::BestShortSideFit, MaxRectsHeuristic::BestLongSideFit, MaxRectsHeuristic::BestAreaFit, MaxRectsHeuristic::BottomLeft, MaxRectsHeuristic::ContactPoint }};
+	constexpr std::array<EntryOrder, 4> allOrders = {{ EntryOrder::Area, EntryOrder::LongSide, EntryOrder::Height, EntryOrder::Perimeter }};
+
+	struct Placement {
+		Rect4i rect;
+		bool rotated = false;
+		int64_t score1 = std::numeric_limits<int64_t>::max();
+		int64_t score2 = std::numeric_limits<int64_t>::max();
+
+		bool isBetterThan(const Placement& other) const
+		{
+			return score1 < other.score1 || (score1 == other.score1 && score2 < other.score2);
+		}
+	};
+
+	bool containsRect(const Rect4i& outer, const Rect4i& inner)
+	{
+		return inner.getLeft() >= outer.getLeft() && inner.getTop() >= outer.getTop() && inner.getRight() <= outer.getRight() && inner.getBottom() <= outer.getBottom();
+	}
+
+	int overlapLength(int a0, int a1, int b0, int b1)
+	{
+		return std::max(0, std::min(a1, b1) - std::max(a0, b0));
+	}
+
+	// MaxRects bin (Jylänki, "A Thousand Ways to Pack the Bin"): tracks the maximal free rectangles left in the bin
+	class MaxRectsBin {
+	public:
+		explicit MaxRectsBin(Vector2i size)
+			: size(size)
+		{
+			freeRects.push_back(Rect4i(0, 0, size.x, size.y));
+		}
+
+		std::optional<Placement> findPosition(Vector2i entrySize, bool canRotate, MaxRectsHeuristic heuristic) const
+		{
+			Placement best;
+			bool found = false;
+
+			auto tryRect = [&] (const Rect4i& freeRect, Vector2i sz, bool rotated)
+			{
+				if (sz.x > freeRect.getWidth() || sz.y > freeRect.getHeight()) {
+					return;
+				}
+
+				Placement p;
+				p.rect = Rect4i(freeRect.getLeft(), freeRect.getTop(), sz.x, sz.y);
+				p.rotated = rotated;
+				const int leftoverX = freeRect.getWidth() - sz.x;
+				const int leftoverY = freeRect.getHeight() - sz.y;
+
+				switch (heuristic) {
+				case MaxRectsHeuristic::BestShortSideFit:
+					p.score1 = std::min(leftoverX, leftoverY);
+					p.score2 = std::max(leftoverX, leftoverY);
+					break;
+				case MaxRectsHeuristic::BestLongSideFit:
+					p.score1 = std::max(leftoverX, leftoverY);
+					p.score2 = std::min(leftoverX, leftoverY);
+					break;
+				case MaxRectsHeuristic::BestAreaFit:
+					p.score1 = int64_t(freeRect.getWidth()) * freeRect.getHeight() - int64_t(sz.x) * sz.y;
+					p.score2 = std::min(leftoverX, leftoverY);
+					break;
+				case MaxRectsHeuristic::BottomLeft:
+					p.score1 = freeRect.getTop() + sz.y;
+					p.score2 = freeRect.getLeft();
+					break;
+				case MaxRectsHeuristic::ContactPoint:
+					p.score1 = -getContactScore(p.rect);
+					p.score2 = 0;
+					break;
+				}
+
+				if (!found || p.isBetterThan(best)) {
+					best = p;
+					found = true;
+				}
+			};
+
+			for (const auto& freeRect: freeRects) {
+				tryRect(freeRect, entrySize, false);
+				if (canRotate && entrySize.x != entrySize.y) {
+					tryRect(freeRect, Vector2i(entrySize.y, entrySize.x), true);
+				}
+			}
+
+			if (found) {
+				return best;
+			}
+			return {};
+		}
+
+		bool canPlace(const Rect4i& rect) const
+		{
+			if (rect.getLeft() < 0 || rect.getTop() < 0 || rect.getRight() > size.x || rect.getBottom() > size.y) {
+				return false;
+			}
+			return std::none_of(usedRects.begin(), usedRects.end(), [&] (const Rect4i& r) { return r.overlaps(rect); });
+		}
+
+		void place(const Rect4i& rect)
+		{
+			// Split every free rect that overlaps the new one into up to four maximal rects around it
+			newFreeRects.clear();
+			for (size_t i = 0; i < freeRects.size(); ) {
+				if (freeRects[i].overlaps(rect)) {
+					splitFreeRect(freeRects[i], rect);
+					freeRects[i] = freeRects.back();
+					freeRects.pop_back();
+				} else {
+					++i;
+				}
+			}
+
+			// Untouched free rects were already maximal, so only the new ones can be redundant
+			for (size_t i = 0; i < newFreeRects.size(); ++i) {
+				const auto& r = newFreeRects[i];
+				bool redundant = std::any_of(freeRects.begin(), freeRects.end(), [&] (const Rect4i& other) { return containsRect(other, r); });
+				for (size_t j = 0; j < newFreeRects.size() && !redundant; ++j) {
+					if (i != j && containsRect(newFreeRects[j], r) && (newFreeRects[j] != r || j < i)) {
+						redundant = true;
+					}
+				}
+				if (!redundant) {
+					freeRects.push_back(r);
+				}
+			}
+
+			usedRects.push_back(rect);
+		}
+
+	private:
+		Vector2i size;
+		Vector<Rect4i> freeRects;
+		Vector<Rect4i> usedRects;
+		Vector<Rect4i> newFreeRects;
+
+		void splitFreeRect(const Rect4i& freeRect, const Rect4i& used)
+		{
+			if (used.getLeft() > freeRect.getLeft()) {
+				newFreeRects.push_back(Rect4i(freeRect.getLeft(), freeRect.getTop(), used.getLeft() - freeRect.getLeft(), freeRect.getHeight()));
+			}
+			if (used.getRight() < freeRect.getRight()) {
+				newFreeRects.push_back(Rect4i(used.getRight(), freeRect.getTop(), freeRect.getRight() - used.getRight(), freeRect.getHeight()));
+			}
+			if (used.getTop() > freeRect.getTop()) {
+				newFreeRects.push_back(Rect4i(freeRect.getLeft(), freeRect.getTop(), freeRect.getWidth(), used.getTop() - freeRect.getTop()));
+			}
+			if (used.getBottom() < freeRect.getBottom()) {
+				newFreeRects.push_back(Rect4i(freeRect.getLeft(), used.getBottom(), freeRect.getWidth(), freeRect.getBottom() - used.getBottom()));
+			}
+		}
+
+		int64_t getContactScore(const Rect4i& rect) const
+		{
+			int64_t score = 0;
+			if (rect.getLeft() == 0 || rect.getRight() == size.x) {
+				score += rect.getHeight();
+			}
+			if (rect.getTop() == 0 || rect.getBottom() == size.y) {
+				score += rect.getWidth();
+			}
+			for (const auto& used: usedRects) {
+				if (used.getLeft() == rect.getRight() || used.getRight() == rect.getLeft()) {
+					score += overlapLength(used.getTop(), used.getBottom(), rect.getTop(), rect.getBottom());
+				}
+				if (used.getTop() == rect.getBottom() || used.getBottom() == rect.getTop()) {
+					score += overlapLength(used.getLeft(), used.getRight(), rect.getLeft(), rect.getRight());
+				}
+			}
+			return score;
+		}
+	};
+
+	Vector<const BinPackEntry*> sortEntries(gsl::span<const BinPackEntry* const> entries, EntryOrder order)
+	{
+		auto key = [order] (const BinPackEntry& e) -> std::pair<int64_t, int64_t>
+		{
+			const int64_t longSide = std::max(e.size.x, e.size.y);
+			const int64_t shortSide = std::min(e.size.x, e.size.y);
+			switch (order) {
+			case EntryOrder::Area:
+				return { int64_t(e.size.x) * e.size.y, longSide };
+			case EntryOrder::LongSide:
+				return { longSide, shortSide };
+			case EntryOrder::Height:
+				return { e.size.y, e.size.x };
+			case EntryOrder::Perimeter:
+				return { longSide + shortSide, longSide };
+			}
+			return {};
+		};
+
+		Vector<const BinPackEntry*> result(entries.begin(), entries.end());
+		std::stable_sort(result.begin(), result.end(), [&] (const BinPackEntry* a, const BinPackEntry* b)
+		{
+			return key(*a) > key(*b);
+		});
+		return result;
+	}
+
+	std::optional<Vector<BinPackResult>> packMaxRects(const MaxRectsBin& initialBin, const Vector<BinPackResult>& fixed, gsl::span<const BinPackEntry* const> entries, MaxRectsHeuristic heuristic, EntryOrder order)
+	{
+		MaxRectsBin bin = initialBin;
+		Vector<BinPackResult> results = fixed;
+		results.reserve(fixed.size() + entries.size());
+
+		for (const auto* entry: sortEntries(entries, order)) {
+			const auto placement = bin.findPosition(entry->size, entry->canRotate, heuristic);
+			if (!placement) {
+				return {};
+			}
+			bin.place(placement->rect);
+			results.push_back(BinPackResult(placement->rect, placement->rotated, entry->data));
+		}
+
+		return results;
+	}
+
+	int64_t getBoundingArea(const Vector<BinPackResult>& results)
+	{
+		int w = 0;
+		int h = 0;
+		for (const auto& r: results) {
+			w = std::max(w, r.rect.getRight());
+			h = std::max(h, r.rect.getBottom());
+		}
+		return int64_t(w) * int64_t(h);
+	}
+
+	std::optional<Vector<BinPackResult>> packBest(const MaxRectsBin& initialBin, const Vector<BinPackResult>& fixed, gsl::span<const BinPackEntry* const> entries)
+	{
+		// Try every heuristic and entry order in parallel, and keep the one with the smallest bounding box.
+		// Ties go to the lowest index, so the result is deterministic.
+		constexpr size_t nAttempts = allHeuristics.size() * allOrders.size();
+		std::array<std::optional<Vector<BinPackResult>>, nAttempts> attempts;
+		auto attempt = [&] (size_t i)
+		{
+			attempts[i] = packMaxRects(initialBin, fixed, entries, allHeuristics[i % allHeuristics.size()], allOrders[i / allHeuristics.size()]);
+		};
+
+		if (Executors::hasInstance()) {
+			Concurrent::parallel_for(0, nAttempts, 1, attempt);
+		} else {
+			for (size_t i = 0; i < nAttempts; ++i) {
+				attempt(i);
+			}
+		}
+
+		std::optional<Vector<BinPackResult>> best;
+		int64_t bestArea = std::numeric_limits<int64_t>::max();
+		for (auto& result: attempts) {
+			if (result) {
+				const auto area = getBoundingArea(*result);
+				if (area < bestArea) {
+					bestArea = area;
+					best = std::move(result);
+				}
+			}
+		}
+		return best;
+	}
+
+	Vector<const BinPackEntry*> toPointers(const Vector<BinPackEntry>& entries)
+	{
+		Vector<const BinPackEntry*> result;
+		result.reserve(entries.size());
+		for (const auto& e: entries) {
+			result.push_back(&e);
+		}
+		return result;
+	}
+}
+
 std::optional<Vector<BinPackResult>> BinPack::pack(const Vector<BinPackEntry>& entries, Vector2i binSize)
 {
-	using T = void*;
+	return packBest(MaxRectsBin(binSize), {}, toPointers(entries));
+}
 
-	BinPack2D::ContentAccumulator<T> inputContent;
-	for (auto& e: entries) {
-		inputContent += BinPack2D::Content<T>(e.data, BinPack2D::Coord(), BinPack2D::Size(e.size.x, e.size.y), false);
+std::optional<Vector<BinPackResult>> BinPack::quickPack(const Vector<BinPackEntry>& entries, Vector2i binSize)
+{
+	return packMaxRects(MaxRectsBin(binSize), {}, toPointers(entries), MaxRectsHeuristic::BottomLeft, EntryOrder::Height);
+}
+
+std::optional<Vector<BinPackResult>> BinPack::repack(const Vector<BinPackEntry>& entries, const Vector<BinPackResult>& previous, Vector2i binSize)
+{
+	HashMap<void*, const BinPackResult*> previousByData;
+	for (const auto& p: previous) {
+		previousByData[p.data] = &p;
+	}
+
+	// Keep every entry that still has the same size where it was
+	MaxRectsBin bin(binSize);
+	Vector<BinPackResult> kept;
+	Vector<const BinPackEntry*> remaining;
+	for (const auto& e: entries) {
+		const auto iter = previousByData.find(e.data);
+		if (iter != previousByData.end()) {
+			const auto& p = *iter->second;
+			const auto size = p.rotated ? Vector2i(e.size.y, e.size.x) : e.size;
+			if (p.rect.getSize() == size && (!p.rotated || e.canRotate) && bin.canPlace(p.rect)) {
+				bin.place(p.rect);
+				kept.push_back(p);
+				continue;
+			}
+		}
+		remaining.push_back(&e);
 	}
-	inputContent.Sort();
-	BinPack2D::CanvasArray<T> canvasArray = BinPack2D::UniformCanvasArrayBuilder<T>(binSize.x, binSize.y, 1).Build();
-	BinPack2D::ContentAccumulator<T> remainder;
-	bool success = canvasArray.Place(inputContent, remainder);
-	BinPack2D::ContentAccumulator<T> outputContent;
-	canvasArray.CollectContent(outputContent);
-
-	if (success) {
-		Vector<BinPackResult> results;
-		for (auto& content: outputContent.Get()) {
-			results.push_back(BinPackResult(Rect4i(content.coord.x, content.coord.y, content.size.w, content.size.h), content.rotated, content.content));
-		}
-		return std::optional<Vector<BinPackResult>>(std::move(results));
-	} else {
-		return std::optional<Vector<BinPackResult>>();
+
+	if (remaining.empty()) {
+		return kept;
+	}
+	if (auto result = packBest(bin, kept, remaining)) {
+		return result;
 	}
+	return pack(entries, binSize);
 }
 
 std::optional<Vector<BinPackResult>> BinPack::fastPack(const Vector<BinPackEntry>& entries, Vector2i binSize)
 {
+	// Skyline bottom-left: the top edge of everything placed so far is kept as a list of horizontal segments,
+	// and each entry goes wherever it ends up lowest
+	struct Segment {
+		int x;
+		int y;
+		int width;
+	};
+	Vector<Segment> skyline;
+	skyline.push_back(Segment{ 0, 0, binSize.x });
+
+	// Returns the y at which a rect of the given width would sit if placed starting at segment idx
+	auto fitAt = [&] (size_t idx, Vector2i size) -> std::optional<int>
+	{
+		if (skyline[idx].x + size.x > binSize.x) {
+			return {};
+		}
+		int y = 0;
+		int widthLeft = size.x;
+		for (size_t i = idx; widthLeft > 0; ++i) {
+			y = std::max(y, skyline[i].y);
+			if (y + size.y > binSize.y) {
+				return {};
+			}
+			widthLeft -= skyline[i].width;
+		}
+		return y;
+	};
+
+	Vector<const BinPackEntry*> sorted = sortEntries(toPointers(entries), EntryOrder::Height);
 	Vector<BinPackResult> result;
-	std::priority_queue<BinPackEntry> queue;
-	for (auto& e: entries) {
-		queue.push(e);
-	}
+	result.reserve(entries.size());
 
-	Vector2i cursorPos;
-	int lineHeight = 0;
-	int binsInLine = 0;
+	for (const auto* entry: sorted) {
+		int bestY = 0;
+		int bestTop = std::numeric_limits<int>::max();
+		int bestWidth = std::numeric_limits<int>::max();
+		size_t bestIdx = 0;
+		Vector2i bestSize;
+		bool found = false;
 
-	while (!queue.empty()) {
-		auto& next = queue.top();
-		auto nextSize = next.size;
-		bool rotated = false;
-		if (next.canRotate && nextSize.x > nextSize.y) {
-			rotated = true;
-			std::swap(nextSize.x, nextSize.y);
-		}
-
-		const int xFree = binSize.x - cursorPos.x;
-		if (nextSize.x > xFree) {
-			// Can't fit this line anymore
-			if (binsInLine > 0) {
-				cursorPos.x = 0;
-				cursorPos.y += lineHeight;
-				const int yFree = binSize.y - cursorPos.y;
-				if (nextSize.y > yFree) {
-					// Can't fit, give up
-					return {};
+		auto tryFit = [&] (Vector2i size)
+		{
+			for (size_t i = 0; i < skyline.size(); ++i) {
+				if (const auto y = fitAt(i, size)) {
+					const int top = *y + size.y;
+					if (top < bestTop || (top == bestTop && skyline[i].width < bestWidth)) {
+						bestY = *y;
+						bestTop = top;
+						bestWidth = skyline[i].width;
+						bestIdx = i;
+						bestSize = size;
+						found = true;
+					}
 				}
+			}
+		};
+
+		tryFit(entry->size);
+		if (entry->canRotate && entry->size.x != entry->size.y) {
+			tryFit(Vector2i(entry->size.y, entry->size.x));
+		}
+		if (!found) {
+			return {};
+		}
 
-				// New line started
-				lineHeight = 0;
-				binsInLine = 0;
+		const Rect4i rect(skyline[bestIdx].x, bestY, bestSize.x, bestSize.y);
+		result.push_back(BinPackResult(rect, bestSize != entry->size, entry->data));
+
+		// Raise the skyline under the new rect, trimming or removing the segments it covers
+		skyline.insert(skyline.begin() + bestIdx, Segment{ rect.getLeft(), rect.getBottom(), rect.getWidth() });
+		for (size_t i = bestIdx + 1; i < skyline.size(); ) {
+			const int prevRight = skyline[i - 1].x + skyline[i - 1].width;
+			if (skyline[i].x >= prevRight) {
+				break;
+			}
+			const int shrink = prevRight - skyline[i].x;
+			skyline[i].x += shrink;
+			skyline[i].width -= shrink;
+			if (skyline[i].width <= 0) {
+				skyline.erase(skyline.begin() + i);
 			} else {
-				// Ops, can't fit at all, give up
-				return {};
+				break;
 			}
 		}
 
-		result.push_back(BinPackResult(Rect4i(cursorPos.x, cursorPos.y, nextSize.x, nextSize.y), rotated, next.data));
-		cursorPos.x += nextSize.x;
-		lineHeight = std::max(lineHeight, nextSize.y);
-		++binsInLine;
-		queue.pop();
+		// Merge neighbours at the same height
+		for (size_t i = 0; i + 1 < skyline.size(); ) {
+			if (skyline[i].y == skyline[i + 1].y) {
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			} else {
+				++i;
+			}
+		}
 	}
 
 	return result;
@@ -0,0 +1,690 @@
+#include "halley/data_structures/frozen_config_node.h"
+#include "halley/bytes/byte_serializer.h"
+#include "halley/support/exception.h"
+#include "../file_formats/config_file_serialization_state.h"
+#include "halley/entity/world.h"
+#include <numeric>
+using namespace Halley;
+
+std::pair<std::string_view, ConfigNodeView> ConfigNodeView::MapIterator::operator*() const
+{
+	return { owner->getKey(idx), ConfigNodeView(owner, idx) };
+}
+
+ConfigNodeType ConfigNodeView::getType() const
+{
+	return owner ? owner->getNode(idx).type : ConfigNodeType::Undefined;
+}
+
+// The common cases are read straight from the frozen node, anything else goes through ConfigNode so conversions behave identically
+
+int ConfigNodeView::asInt() const
+{
+	if (getType() == ConfigNodeType::Int) {
+		return owner->getNode(idx).intData;
+	}
+	return toConfigNode().asInt();
+}
+
+int64_t ConfigNodeView::asInt64() const
+{
+	const auto type = getType();
+	if (type == ConfigNodeType::Int64 || type == ConfigNodeType::EntityId) {
+		return owner->getNode(idx).int64Data;
+	} else if (type == ConfigNodeType::Int) {
+		return owner->getNode(idx).intData;
+	}
+	return toConfigNode().asInt64();
+}
+
+EntityId ConfigNodeView::asEntityId() const
+{
+	const auto type = getType();
+	if (type == ConfigNodeType::EntityId || type == ConfigNodeType::Int64) {
+		return EntityId{ owner->getNode(idx).int64Data };
+	}
+	return toConfigNode().asEntityId();
+}
+
+float ConfigNodeView::asFloat() const
+{
+	const auto type = getType();
+	if (type == ConfigNodeType::Float) {
+		return owner->getNode(idx).floatData;
+	} else if (type == ConfigNodeType::Int) {
+		return float(owner->getNode(idx).intData);
+	}
+	return toConfigNode().asFloat();
+}
+
+bool ConfigNodeView::asBool() const
+{
+	const auto type = getType();
+	if (type == ConfigNodeType::Bool || type == ConfigNodeType::Int) {
+		return owner->getNode(idx).intData != 0;
+	}
+	return toConfigNode().asBool();
+}
+
+Vector2i ConfigNodeView::asVector2i() const
+{
+	const auto type = getType();
+	if (type == ConfigNodeType::Int2 || type == ConfigNodeType::Idx) {
+		return owner->getNode(idx).vec2iData;
+	}
+	return toConfigNode().asVector2i();
+}
+
+Vector2f ConfigNodeView::asVector2f() const
+{
+	const auto type = getType();
+	if (type == ConfigNodeType::Float2) {
+		return owner->getNode(idx).vec2fData;
+	} else if (type == ConfigNodeType::Int2) {
+		return Vector2f(owner->getNode(idx).vec2iData);
+	}
+	return toConfigNode().asVector2f();
+}
+
+Vector3i ConfigNodeView::asVector3i() const
+{
+	return toConfigNode().asVector3i();
+}
+
+Vector3f ConfigNodeView::asVector3f() const
+{
+	return toConfigNode().asVector3f();
+}
+
+Vector4i ConfigNodeView::asVector4i() const
+{
+	return toConfigNode().asVector4i();
+}
+
+Vector4f ConfigNodeView::asVector4f() const
+{
+	return toConfigNode().asVector4f();
+}
+
+Rect4i ConfigNodeView::asRect4i() const
+{
+	return toConfigNode().asRect4i();
+}
+
+Rect4f ConfigNodeView::asRect4f() const
+{
+	return toConfigNode().asRect4f();
+}
+
+Range<int> ConfigNodeView::asIntRange() const
+{
+	return toConfigNode().asIntRange();
+}
+
+Range<float> ConfigNodeView::asFloatRange() const
+{
+	return toConfigNode().asFloatRange();
+}
+
+String ConfigNodeView::asString() const
+{
+	if (getType() == ConfigNodeType::String) {
+		return String(asStringView());
+	}
+	return toConfigNode().asString();
+}
+
+std::string_view ConfigNodeView::asStringView() const
+{
+	if (getType() == ConfigNodeType::String) {
+		return owner->getData(owner->getNode(idx));
+	} else {
+		throw Exception("Can't convert " + getNodeDebugId() + " from " + toString(getType()) + " to StringView.", HalleyExceptions::Resources);
+	}
+}
+
+gsl::span<const gsl::byte> ConfigNodeView::asBytes() const
+{
+	if (getType() == ConfigNodeType::Bytes) {
+		const auto str = owner->getData(owner->getNode(idx));
+		return gsl::as_bytes(gsl::span<const char>(str.data(), str.size()));
+	} else {
+		throw Exception(getNodeDebugId() + " is not a byte sequence type", HalleyExceptions::Resources);
+	}
+}
+
+int ConfigNodeView::asInt(int defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asInt();
+}
+
+int64_t ConfigNodeView::asInt64(int64_t defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asInt64();
+}
+
+float ConfigNodeView::asFloat(float defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asFloat();
+}
+
+bool ConfigNodeView::asBool(bool defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asBool();
+}
+
+String ConfigNodeView::asString(const std::string_view& defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? String(defaultValue) : asString();
+}
+
+std::string_view ConfigNodeView::asStringView(const std::string_view& defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asStringView();
+}
+
+Vector2i ConfigNodeView::asVector2i(Vector2i defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asVector2i();
+}
+
+Vector2f ConfigNodeView::asVector2f(Vector2f defaultValue) const
+{
+	return getType() == ConfigNodeType::Undefined ? defaultValue : asVector2f();
+}
+
+ConfigNodeView::NodeRange<ConfigNodeView::SequenceIterator> ConfigNodeView::asSequence() const
+{
+	if (getType() == ConfigNodeType::Sequence) {
+		const auto& node = owner->getNode(idx);
+		return NodeRange<SequenceIterator>(SequenceIterator(owner, node.range.start), SequenceIterator(owner, node.range.start + node.range.count), node.range.count);
+	} else {
+		throw Exception(getNodeDebugId() + " is not a sequence type", HalleyExceptions::Resources);
+	}
+}
+
+ConfigNodeView::NodeRange<ConfigNodeView::MapIterator> ConfigNodeView::asMap() const
+{
+	if (getType() == ConfigNodeType::Map) {
+		const auto& node = owner->getNode(idx);
+		return NodeRange<MapIterator>(MapIterator(owner, node.range.start), MapIterator(owner, node.range.start + node.range.count), node.range.count);
+	} else {
+		throw Exception(getNodeDebugId() + " is not a map type", HalleyExceptions::Resources);
+	}
+}
+
+size_t ConfigNodeView::getSequenceSize(size_t defaultValue) const
+{
+	if (getType() == ConfigNodeType::Sequence) {
+		return owner->getNode(idx).range.count;
+	} else {
+		return defaultValue;
+	}
+}
+
+bool ConfigNodeView::hasKey(std::string_view key) const
+{
+	if (getType() == ConfigNodeType::Map) {
+		const auto child = owner->findKey(owner->getNode(idx), key);
+		return child && owner->getNode(*child).type != ConfigNodeType::Undefined;
+	} else {
+		return false;
+	}
+}
+
+ConfigNodeView ConfigNodeView::operator[](std::string_view key) const
+{
+	if (getType() != ConfigNodeType::Map) {
+		throw Exception(getNodeDebugId() + " is not a map type", HalleyExceptions::Resources);
+	}
+
+	if (const auto child = owner->findKey(owner->getNode(idx), key)) {
+		return ConfigNodeView(owner, *child);
+	} else {
+		return ConfigNodeView();
+	}
+}
+
+ConfigNodeView ConfigNodeView::operator[](size_t i) const
+{
+	if (getType() != ConfigNodeType::Sequence) {
+		throw Exception(getNodeDebugId() + " is not a sequence type", HalleyExceptions::Resources);
+	}
+
+	const auto& node = owner->getNode(idx);
+	if (i >= node.range.count) {
+		throw Exception("Index " + toString(i) + " is out of range of " + getNodeDebugId(), HalleyExceptions::Resources);
+	}
+	return ConfigNodeView(owner, node.range.start + static_cast<uint32_t>(i));
+}
+
+ConfigNodeView::SequenceIterator ConfigNodeView::begin() const
+{
+	return asSequence().begin();
+}
+
+ConfigNodeView::SequenceIterator ConfigNodeView::end() const
+{
+	return asSequence().end();
+}
+
+ConfigNode ConfigNodeView::toConfigNode() const
+{
+	return owner ? owner->thawNode(idx) : ConfigNode();
+}
+
+String ConfigNodeView::getNodeDebugId() const
+{
+	switch (getType()) {
+	case ConfigNodeType::Sequence:
+		return "Sequence[" + toString(getSequenceSize()) + "]";
+	case ConfigNodeType::Map:
+		return "Map";
+	case ConfigNodeType::String:
+		return "\"" + String(asStringView()) + "\"";
+	default:
+		return toString(getType());
+	}
+}
+
+
+FrozenConfigNode::FrozenConfigNode()
+{
+	allocateNodes(1);
+}
+
+FrozenConfigNode::FrozenConfigNode(const ConfigNode& node)
+{
+	allocateNodes(1);
+	freezeNode(node, 0);
+	finishBuilding();
+}
+
+ConfigNodeView FrozenConfigNode::getRoot() const
+{
+	return ConfigNodeView(this, 0);
+}
+
+void FrozenConfigNode::deserialize(Deserializer& s)
+{
+	nodes.clear();
+	keys.clear();
+	data.clear();
+	keyTable.clear();
+	positions.clear();
+
+	const auto state = s.getState<ConfigFileSerializationState>();
+	const bool storeFilePosition = state && state->storeFilePosition;
+#if defined(STORE_CONFIG_NODE_PARENTING)
+	if (storeFilePosition) {
+		positions.resize(1);
+	}
+#endif
+	allocateNodes(1);
+	deserializeNode(s, 0, storeFilePosition);
+	finishBuilding();
+}
+
+size_t FrozenConfigNode::getSizeBytes() const
+{
+	return sizeof(*this) + nodes.capacity() * sizeof(Node) + keys.capacity() * sizeof(uint32_t) + data.capacity() + keyTable.capacity() * sizeof(std::pair<uint32_t, uint32_t>) + positions.capacity() * sizeof(std::pair<int, int>);
+}
+
+size_t FrozenConfigNode::getNodeCount() const
+{
+	return nodes.size();
+}
+
+std::string_view FrozenConfigNode::getKey(uint32_t nodeIdx) const
+{
+	const auto [offset, len] = keyTable[keys[nodeIdx]];
+	return std::string_view(data.data() + offset, len);
+}
+
+std::string_view FrozenConfigNode::getData(const Node& node) const
+{
+	return std::string_view(data.data() + node.range.start, node.range.count);
+}
+
+std::optional<uint32_t> FrozenConfigNode::findKey(const Node& map, std::string_view key) const
+{
+	// Children are sorted by key
+	uint32_t lo = map.range.start;
+	uint32_t hi = map.range.start + map.range.count;
+	while (lo < hi) {
+		const uint32_t mid = lo + (hi - lo) / 2;
+		const auto midKey = getKey(mid);
+		if (midKey < key) {
+			lo = mid + 1;
+		} else if (key < midKey) {
+			hi = mid;
+		} else {
+			return mid;
+		}
+	}
+	return std::nullopt;
+}
+
+uint32_t FrozenConfigNode::allocateNodes(size_t count)
+{
+	const auto start = nodes.size();
+	if (start + count >= noKey) {
+		throw Exception("Too many nodes in FrozenConfigNode.", HalleyExceptions::Resources);
+	}
+	nodes.resize(start + count);
+	keys.resize(start + count, noKey);
+	if (!positions.empty()) {
+		positions.resize(start + count);
+	}
+	return static_cast<uint32_t>(start);
+}
+
+uint32_t FrozenConfigNode::internKey(std::string_view key)
+{
+	// Most maps in a document share the same few keys, so each is only stored once
+	const auto iter = keyIds.find(key);
+	if (iter != keyIds.end()) {
+		return iter->second;
+	}
+
+	const auto id = static_cast<uint32_t>(keyTable.size());
+	const auto offset = static_cast<uint32_t>(data.size());
+	data.insert(data.end(), key.begin(), key.end());
+	keyTable.emplace_back(offset, static_cast<uint32_t>(key.size()));
+	keyIds[String(key)] = id;
+	return id;
+}
+
+FrozenConfigNode::Node FrozenConfigNode::makeDataNode(ConfigNodeType type, gsl::span<const gsl::byte> bytes)
+{
+	Node node;
+	node.type = type;
+	node.range.start = static_cast<uint32_t>(data.size());
+	node.range.count = static_cast<uint32_t>(bytes.size());
+
+	const auto* src = reinterpret_cast<const char*>(bytes.data());
+	data.insert(data.end(), src, src + bytes.size());
+	return node;
+}
+
+void FrozenConfigNode::sortMapChildren(const Node& map)
+{
+	const auto start = map.range.start;
+	const auto end = map.range.start + map.range.count;
+
+	bool sorted = true;
+	for (uint32_t i = start + 1; i < end && sorted; ++i) {
+		sorted = getKey(i - 1) < getKey(i);
+	}
+	if (sorted) {
+		return;
+	}
+
+	// Children own their own subtrees by index, so moving them around within the range is safe
+	Vector<uint32_t> order(map.range.count);
+	std::iota(order.begin(), order.end(), start);
+	std::sort(order.begin(), order.end(), [&] (uint32_t a, uint32_t b)
+	{
+		return getKey(a) < getKey(b);
+	});
+
+	auto permute = [&] (auto& values)
+	{
+		const auto old = Vector<std::decay_t<decltype(values[0])>>(values.begin() + start, values.begin() + end);
+		for (uint32_t i = start; i < end; ++i) {
+			values[i] = old[order[i - start] - start];
+		}
+	};
+	permute(nodes);
+	permute(keys);
+	if (!positions.empty()) {
+		permute(positions);
+	}
+}
+
+void FrozenConfigNode::finishBuilding()
+{
+	keyIds.clear();
+}
+
+void FrozenConfigNode::deserializeNode(Deserializer& s, uint32_t idx, bool storeFilePosition)
+{
+	ConfigNodeType type;
+	s >> type;
+
+	Node node;
+	node.type = type;
+
+	switch (type) {
+	case ConfigNodeType::String:
+		{
+			const auto str = s.readStringView();
+			node = makeDataNode(type, gsl::as_bytes(gsl::span<const char>(str.data(), str.size())));
+		}
+		break;
+	case ConfigNodeType::Bytes:
+		{
+			uint32_t size;
+			s >> size;
+			if (size > s.getBytesLeft()) {
+				throw Exception("Insufficient bytes remaining in stream to deserialize.", HalleyExceptions::Resources);
+			}
+			node.range.start = static_cast<uint32_t>(data.size());
+			node.range.count = size;
+			data.resize(data.size() + size);
+			s >> gsl::as_writable_bytes(gsl::span<char>(data.data() + node.range.start, size));
+		}
+		break;
+	case ConfigNodeType::Sequence:
+	case ConfigNodeType::Map:
+		{
+			uint32_t count;
+			s >> count;
+			if (count > s.getBytesLeft()) {
+				throw Exception("Insufficient bytes remaining in stream to deserialize.", HalleyExceptions::Resources);
+			}
+			node.range.start = allocateNodes(count);
+			node.range.count = count;
+			for (uint32_t i = 0; i < count; ++i) {
+				if (type == ConfigNodeType::Map) {
+					keys[node.range.start + i] = internKey(s.readStringView());
+				}
+				deserializeNode(s, node.range.start + i, storeFilePosition);
+			}
+			if (type == ConfigNodeType::Map) {
+				sortMapChildren(node);
+			}
+		}
+		break;
+	case ConfigNodeType::Bool:
+		{
+			bool value;
+			s >> value;
+			node.intData = value ? 1 : 0;
+		}
+		break;
+	case ConfigNodeType::Int:
+		s >> node.intData;
+		break;
+	case ConfigNodeType::Int64:
+		s >> node.int64Data;
+		break;
+	case ConfigNodeType::EntityId:
+		if (s.getOptions().world != nullptr) {
+			UUID uuid;
+			s >> uuid;
+			node.int64Data = s.getOptions().world->findEntity(uuid)->getEntityId().value;
+		} else {
+			s >> node.int64Data;
+		}
+		break;
+	case ConfigNodeType::Float:
+		s >> node.floatData;
+		break;
+	case ConfigNodeType::Int2:
+	case ConfigNodeType::Idx:
+		s >> node.vec2iData;
+		break;
+	case ConfigNodeType::Float2:
+		s >> node.vec2fData;
+		break;
+	case ConfigNodeType::Noop:
+	case ConfigNodeType::Del:
+	case ConfigNodeType::Undefined:
+		break;
+	case ConfigNodeType::DeltaMap:
+	case ConfigNodeType::DeltaSequence:
+		throw Exception("Delta configuration nodes can't be frozen.", HalleyExceptions::Resources);
+	default:
+		throw Exception("Unknown configuration node type: " + toString(int(type)), HalleyExceptions::Resources);
+	}
+
+	if (storeFilePosition) {
+		int line;
+		int column;
+		s >> line >> column;
+		if (!positions.empty()) {
+			positions[idx] = { line, column };
+		}
+	}
+
+	nodes[idx] = node;
+}
+
+void FrozenConfigNode::freezeNode(const ConfigNode& src, uint32_t idx)
+{
+	const auto type = src.getType();
+
+	Node node;
+	node.type = type;
+
+	switch (type) {
+	case ConfigNodeType::String:
+		{
+			const auto str = src.asStringView();
+			node = makeDataNode(type, gsl::as_bytes(gsl::span<const char>(str.data(), str.size())));
+		}
+		break;
+	case ConfigNodeType::Bytes:
+		node = makeDataNode(type, gsl::as_bytes(gsl::span<const Byte>(src.asBytes())));
+		break;
+	case ConfigNodeType::Sequence:
+		{
+			const auto& seq = src.asSequence();
+			node.range.start = allocateNodes(seq.size());
+			node.range.count = static_cast<uint32_t>(seq.size());
+			for (uint32_t i = 0; i < node.range.count; ++i) {
+				freezeNode(seq[i], node.range.start + i);
+			}
+		}
+		break;
+	case ConfigNodeType::Map:
+		{
+			const auto& map = src.asMap();
+			node.range.start = allocateNodes(map.size());
+			node.range.count = static_cast<uint32_t>(map.size());
+			uint32_t i = node.range.start;
+			for (const auto& [k, v]: map) {
+				keys[i] = internKey(k);
+				freezeNode(v, i);
+				++i;
+			}
+			sortMapChildren(node);
+		}
+		break;
+	case ConfigNodeType::Bool:
+		node.intData = src.asBool() ? 1 : 0;
+		break;
+	case ConfigNodeType::Int:
+		node.intData = src.asInt();
+		break;
+	case ConfigNodeType::Int64:
+		node.int64Data = src.asInt64();
+		break;
+	case ConfigNodeType::EntityId:
+		node.int64Data = src.asEntityId().value;
+		break;
+	case ConfigNodeType::Float:
+		node.floatData = src.asFloat();
+		break;
+	case ConfigNodeType::Int2:
+	case ConfigNodeType::Idx:
+		node.vec2iData = src.asVector2i();
+		break;
+	case ConfigNodeType::Float2:
+		node.vec2fData = src.asVector2f();
+		break;
+	case ConfigNodeType::Noop:
+	case ConfigNodeType::Del:
+	case ConfigNodeType::Undefined:
+		break;
+	default:
+		throw Exception("Delta configuration nodes can't be frozen.", HalleyExceptions::Resources);
+	}
+
+	nodes[idx] = node;
+}
+
+ConfigNode FrozenConfigNode::thawNode(uint32_t idx) const
+{
+	auto result = thawNodeData(idx);
+	if (!positions.empty()) {
+		result.setOriginalPosition(positions[idx].first, positions[idx].second);
+	}
+	return result;
+}
+
+ConfigNode FrozenConfigNode::thawNodeData(uint32_t idx) const
+{
+	const auto& node = nodes[idx];
+
+	switch (node.type) {
+	case ConfigNodeType::String:
+		return ConfigNode(getData(node));
+	case ConfigNodeType::Bytes:
+		{
+			const auto str = getData(node);
+			return ConfigNode(Bytes(str.begin(), str.end()));
+		}
+	case ConfigNodeType::Sequence:
+		{
+			ConfigNode::SequenceType seq;
+			seq.reserve(node.range.count);
+			for (uint32_t i = 0; i < node.range.count; ++i) {
+				seq.push_back(thawNode(node.range.start + i));
+			}
+			return ConfigNode(std::move(seq));
+		}
+	case ConfigNodeType::Map:
+		{
+			ConfigNode::MapType map;
+			map.reserve(node.range.count);
+			for (uint32_t i = 0; i < node.range.count; ++i) {
+				map[String(getKey(node.range.start + i))] = thawNode(node.range.start + i);
+			}
+			return ConfigNode(std::move(map));
+		}
+	case ConfigNodeType::Bool:
+		return ConfigNode(node.intData != 0);
+	case ConfigNodeType::Int:
+		return ConfigNode(node.intData);
+	case ConfigNodeType::Int64:
+		return ConfigNode(node.int64Data);
+	case ConfigNodeType::EntityId:
+		return ConfigNode(EntityId{ node.int64Data });
+	case ConfigNodeType::Float:
+		return ConfigNode(node.floatData);
+	case ConfigNodeType::Int2:
+		return ConfigNode(node.vec2iData);
+	case ConfigNodeType::Idx:
+		return ConfigNode(ConfigNode::IdxType(node.vec2iData.x, node.vec2iData.y));
+	case ConfigNodeType::Float2:
+		return ConfigNode(node.vec2fData);
+	case ConfigNodeType::Noop:
+		return ConfigNode(ConfigNode::NoopType());
+	case ConfigNodeType::Del:
+		return ConfigNode(ConfigNode::DelType());
+	default:
+		return ConfigNode();
+	}
+}
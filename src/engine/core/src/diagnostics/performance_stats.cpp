@@ -34,6 +34,7 @@ PerformanceStatsView::PerformanceStatsView(Resources& resources, const HalleyAPI
 	fpsLabel = TextRenderer(resources.get<Font>("Ubuntu Bold"), "", 15, Colour(1, 1, 1), 1.0f, Colour(0.1f, 0.1f, 0.1f)).setOffset(Vector2f(0.5f, 0.5f));
 	graphLabel = TextRenderer(resources.get<Font>("Ubuntu Bold"), "", 15, Colour(1, 1, 1), 1.0f, Colour(0.1f, 0.1f, 0.1f)).setAlignment(0.5f);
 	connLabel = TextRenderer(resources.get<Font>("Ubuntu Bold"), "", 15, Colour(1, 1, 1), 1.0f, Colour(0.1f, 0.1f, 0.1f));
+	resourceLabel = connLabel.clone();
 
 	for (size_t i = 0; i < 3; ++i) {
 		systemLabels.push_back(headerText.clone());
@@ -73,6 +74,8 @@ void PerformanceStatsView::paint(Painter& painter)
 		} else if (page == 2) {
 			drawTopEvents(painter, Rect4f(20, 200, rect.getWidth() - 40, rect.getHeight() - 220), t, scriptHistory);
 		} else if (page == 3) {
+			drawResourceStats(painter, Rect4f(20, 200, rect.getWidth() - 40, rect.getHeight() - 220));
+		} else if (page == 4) {
 			drawNetworkStats(painter, Rect4f(20, 200, rect.getWidth() - 40, rect.getHeight() - 220));
 		}
 	} else {
@@ -135,7 +138,7 @@ void PerformanceStatsView::setNetworkStats(NetworkSession& session)
 
 int PerformanceStatsView::getNumPages() const
 {
-	return networkStats ? 4 : 3;
+	return networkStats ? 5 : 4;
 }
 
 int PerformanceStatsView::getPage() const
@@ -737,6 +740,54 @@ void PerformanceStatsView::drawTopEvents(Painter& painter, Rect4f rect, Time t,
 	}
 }
 
+void PerformanceStatsView::drawResourceStats(Painter& painter, Rect4f rect)
+{
+	auto stats = resources.getStats();
+	std_ex::erase_if(stats, [] (const ResourceCollectionStats& s) { return s.numResident == 0 && s.hits + s.misses == 0; });
+	std::sort(stats.begin(), stats.end(), [] (const auto& a, const auto& b) { return a.memoryUsage.getTotal() > b.memoryUsage.getTotal(); });
+
+	const std::array<float, 6> xPos = { 0, 160, 380, 480, 580, 680 };
+	const float lineHeight = 20.0f;
+
+	const auto drawLine = [&] (float y, std::array<String, 6> columns)
+	{
+		for (size_t i = 0; i < columns.size(); ++i) {
+			resourceLabel
+				.setPosition(rect.getTopLeft() + Vector2f(xPos[i], y))
+				.setText(columns[i])
+				.draw(painter);
+		}
+	};
+
+	const auto formatMemory = [] (const ResourceMemoryUsage& usage, size_t budget)
+	{
+		return usage.toString() + (budget > 0 ? " / " + String::prettySize(budget) : "");
+	};
+
+	ResourceMemoryUsage total;
+	for (const auto& s: stats) {
+		total += s.memoryUsage;
+	}
+
+	drawLine(0, { "Total", formatMemory(total, resources.getMemoryBudget()), "Resident", "Hit rate", "Misses", "Evictions" });
+
+	float y = lineHeight * 1.5f;
+	for (const auto& s: stats) {
+		if (y + lineHeight > rect.getHeight()) {
+			break;
+		}
+		drawLine(y, {
+			toString(s.type),
+			formatMemory(s.memoryUsage, s.memoryBudget),
+			toString(s.numResident) + (s.numPinned > 0 ? " (" + toString(s.numPinned) + " pinned)" : ""),
+			toString(lroundl(s.getHitRate() * 100)) + "%",
+			toString(s.misses),
+			toString(s.evictions)
+		});
+		y += lineHeight;
+	}
+}
+
 void PerformanceStatsView::drawNetworkStats(Painter& painter, Rect4f rect)
 {
 	if (!networkSession) {
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include "halley/entity/archetype_storage.h"
+#include "halley/entity/entity.h"
+#include "halley/entity/type_deleter.h"
+#include "halley/utils/utils.h"
+
+using namespace Halley;
+
+void* ArchetypeStorage::Archetype::getAddress(uint32_t row, size_t column) const
+{
+	const auto& col = columns[column];
+	return chunks[row / rowsPerChunk] + col.offset + (row % rowsPerChunk) * col.size;
+}
+
+const ArchetypeStorage::Column* ArchetypeStorage::Archetype::tryGetColumn(int componentId, size_t& idx) const
+{
+	const auto iter = std::lower_bound(columns.begin(), columns.end(), componentId, [] (const Column& c, int id) { return c.componentId < id; });
+	if (iter != columns.end() && iter->componentId == componentId) {
+		idx = iter - columns.begin();
+		return &*iter;
+	}
+	return nullptr;
+}
+
+ArchetypeStorage::ArchetypeStorage(ComponentDeleterTable& table)
+	: table(table)
+{
+}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+	// All entities should have been released or evicted by now, so this only frees memory
+	for (auto& [ids, archetype]: archetypes) {
+		if (archetype) {
+			for (auto* chunk: archetype->chunks) {
+				::operator delete(chunk, std::align_val_t(chunkSize));
+			}
+		}
+	}
+}
+
+bool ArchetypeStorage::relocate(Entity& entity)
+{
+	const auto iter = locations.find(&entity);
+	if (iter == locations.end()) {
+		return doRelocate(entity);
+	}
+
+	// Moving means moving every component of the entity, so wait until its components have settled
+	const bool inPlace = isInPlace(entity, iter->second);
+	if (inPlace) {
+		pending.erase(&entity);
+	} else {
+		pending[&entity] = generation;
+	}
+
+	// Until then, its row no longer matches its components, so it's left out of chunk iteration
+	return setRowEntity(iter->second, inPlace && entity.enabled && entity.parentEnabled ? &entity : nullptr);
+}
+
+Vector<Entity*> ArchetypeStorage::flushPending()
+{
+	Vector<Entity*> result;
+	for (auto iter = pending.begin(); iter != pending.end(); ) {
+		if (iter->second != generation) {
+			auto* entity = iter->first;
+			iter = pending.erase(iter);
+			if (entity->isAlive() && doRelocate(*entity)) {
+				result.push_back(entity);
+			}
+		} else {
+			++iter;
+		}
+	}
+	++generation;
+	return result;
+}
+
+bool ArchetypeStorage::hasPending() const
+{
+	return !pending.empty();
+}
+
+bool ArchetypeStorage::doRelocate(Entity& entity)
+{
+	Vector<int> ids;
+	ids.reserve(entity.liveComponents);
+	for (uint8_t i = 0; i < entity.liveComponents; ++i) {
+		ids.push_back(entity.components[i].first);
+	}
+	std::sort(ids.begin(), ids.end());
+
+	auto* archetype = ids.empty() ? nullptr : getArchetype(ids);
+	if (!archetype) {
+		// Can't be stored in chunks (e.g. non-movable or huge components), keep it on the heap
+		if (locations.find(&entity) != locations.end()) {
+			evict(entity);
+			return true;
+		}
+		return false;
+	}
+
+	const auto oldIter = locations.find(&entity);
+	const auto oldLocation = oldIter != locations.end() ? oldIter->second : Location();
+
+	// Already in place?
+	if (oldLocation.archetype == archetype && isInPlace(entity, oldLocation)) {
+		return setRowEntity(oldLocation, entity.enabled && entity.parentEnabled ? &entity : nullptr);
+	}
+
+	const auto row = allocRow(*archetype);
+	for (uint8_t i = 0; i < entity.liveComponents; ++i) {
+		auto& [id, component] = entity.components[i];
+		size_t colIdx = 0;
+		const auto* column = archetype->tryGetColumn(id, colIdx);
+		void* dst = archetype->getAddress(row, colIdx);
+
+		column->type->moveConstruct(dst, component);
+		if (owns(component)) {
+			column->type->callDestructor(component);
+		} else {
+			column->type->destroy(component);
+		}
+		component = static_cast<Component*>(dst);
+	}
+
+	// Any columns of the old row not moved above were destroyed when the components were removed
+	if (oldLocation.archetype) {
+		freeRow(*oldLocation.archetype, oldLocation.row);
+	}
+	locations[&entity] = Location{ archetype, row };
+	setRowEntity(Location{ archetype, row }, entity.enabled && entity.parentEnabled ? &entity : nullptr);
+
+	return true;
+}
+
+bool ArchetypeStorage::isInPlace(const Entity& entity, const Location& location) const
+{
+	const auto& archetype = *location.archetype;
+	if (entity.liveComponents != archetype.columns.size()) {
+		return false;
+	}
+	for (uint8_t i = 0; i < entity.liveComponents; ++i) {
+		size_t colIdx = 0;
+		if (!archetype.tryGetColumn(entity.components[i].first, colIdx) || archetype.getAddress(location.row, colIdx) != entity.components[i].second) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ArchetypeStorage::setRowEntity(const Location& location, Entity* entity)
+{
+	auto& row = location.archetype->rows[location.row];
+	const bool changed = row != entity;
+	row = entity;
+	return changed;
+}
+
+void ArchetypeStorage::evict(Entity& entity)
+{
+	pending.erase(&entity);
+
+	const auto iter = locations.find(&entity);
+	if (iter == locations.end()) {
+		return;
+	}
+
+	for (auto& [id, component]: entity.components) {
+		if (owns(component)) {
+			auto* type = table.get(id);
+			void* heap = type->moveToHeap(component);
+			type->callDestructor(component);
+			component = static_cast<Component*>(heap);
+		}
+	}
+
+	freeRow(*iter->second.archetype, iter->second.row);
+	locations.erase(iter);
+}
+
+void ArchetypeStorage::release(Entity& entity)
+{
+	pending.erase(&entity);
+
+	const auto iter = locations.find(&entity);
+	if (iter != locations.end()) {
+		freeRow(*iter->second.archetype, iter->second.row);
+		locations.erase(iter);
+	}
+}
+
+bool ArchetypeStorage::owns(const void* ptr) const
+{
+	// Chunks are aligned to their size, so rounding down gives the chunk that contains the pointer
+	const auto chunk = reinterpret_cast<const std::byte*>(reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(chunkSize - 1));
+	return chunkSet.find(chunk) != chunkSet.end();
+}
+
+bool ArchetypeStorage::isChunked(const Entity& entity) const
+{
+	const auto iter = locations.find(&entity);
+	return iter != locations.end() && iter->second.archetype->rows[iter->second.row] == &entity;
+}
+
+size_t ArchetypeStorage::getNumArchetypes() const
+{
+	return std::count_if(archetypes.begin(), archetypes.end(), [] (const auto& a) { return a.second != nullptr; });
+}
+
+size_t ArchetypeStorage::getNumChunks() const
+{
+	return chunkSet.size();
+}
+
+size_t ArchetypeStorage::getNumEntities() const
+{
+	return locations.size();
+}
+
+ArchetypeStorage::Archetype* ArchetypeStorage::getArchetype(const Vector<int>& componentIds)
+{
+	const auto iter = archetypes.find(componentIds);
+	if (iter != archetypes.end()) {
+		return iter->second.get();
+	}
+
+	auto& result = archetypes[componentIds];
+
+	Vector<Column> columns;
+	size_t rowSize = 0;
+	for (const int id: componentIds) {
+		auto* type = table.hasComponent(id) ? table.get(id) : nullptr;
+		if (!type || !type->isRelocatable()) {
+			return nullptr;
+		}
+		columns.push_back(Column{ id, 0, type->getSize(), type });
+		rowSize += type->getSize();
+	}
+
+	// Find how many rows fit in a chunk once every column is aligned
+	const auto layout = [&] (size_t rows) -> size_t
+	{
+		size_t offset = 0;
+		for (auto& c: columns) {
+			offset = alignUp(offset, c.type->getAlignment());
+			c.offset = offset;
+			offset += c.size * rows;
+		}
+		return offset;
+	};
+	size_t rows = chunkSize / std::max(rowSize, size_t(1));
+	while (rows > 0 && layout(rows) > chunkSize) {
+		--rows;
+	}
+	if (rows == 0) {
+		return nullptr;
+	}
+	layout(rows);
+
+	result = std::make_unique<Archetype>();
+	result->columns = std::move(columns);
+	result->rowsPerChunk = rows;
+	return result.get();
+}
+
+uint32_t ArchetypeStorage::allocRow(Archetype& archetype)
+{
+	if (!archetype.freeRows.empty()) {
+		const auto row = archetype.freeRows.back();
+		archetype.freeRows.pop_back();
+		return row;
+	}
+
+	const auto row = archetype.nextRow++;
+	if (row >= archetype.rows.size()) {
+		archetype.rows.resize(row + 1, nullptr);
+	}
+	if (row / archetype.rowsPerChunk >= archetype.chunks.size()) {
+		auto* chunk = static_cast<std::byte*>(::operator new(chunkSize, std::align_val_t(chunkSize)));
+		archetype.chunks.push_back(chunk);
+		chunkSet.insert(chunk);
+	}
+	return row;
+}
+
+void ArchetypeStorage::freeRow(Archetype& archetype, uint32_t row)
+{
+	archetype.rows[row] = nullptr;
+	if (row + 1 == archetype.nextRow) {
+		--archetype.nextRow;
+	} else {
+		archetype.freeRows.push_back(row);
+	}
+}
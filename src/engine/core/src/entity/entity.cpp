@@ -1,5 +1,6 @@
 #include <halley/data_structures/memory_pool.h>
 #include "halley/entity/entity.h"
+#include "halley/entity/archetype_storage.h"
 #include "halley/entity/world.h"
 #include "halley/entity/data_interpolator.h"
 
@@ -93,7 +94,13 @@ void Entity::removeAllComponents(World& world)
 void Entity::deleteComponent(Component* component, int id, ComponentDeleterTable& table)
 {
 	TypeDeleterBase* deleter = table.get(id);
-	deleter->destroy(component);
+	const auto* archetypeStorage = table.getArchetypeStorage();
+	if (archetypeStorage && archetypeStorage->owns(component)) {
+		// Lives in a chunk, the storage owns the memory
+		deleter->callDestructor(component);
+	} else {
+		deleter->destroy(component);
+	}
 	//PoolPool::getPool(deleter->getSize())->free(component);
 }
 
@@ -115,12 +122,17 @@ void Entity::onReady()
 }
 
 void Entity::markDirty(World& world)
+{
+	setDirty(world);
+	++componentRevision;
+}
+
+void Entity::setDirty(World& world)
 {
 	if (!dirty) {
 		dirty = true;
-		world.onEntityDirty();
+		world.onEntityDirty(*this);
 	}
-	++componentRevision;
 }
 
 ComponentDeleterTable& Entity::getComponentDeleterTable(World& world)
@@ -128,7 +140,7 @@ ComponentDeleterTable& Entity::getComponentDeleterTable(World& world)
 	return world.getComponentDeleterTable();
 }
 
-void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
+void Entity::setParent(World& world, Entity* newParent, bool propagate, size_t childIdx)
 {
 	Expects(newParent != this);
 	if (newParent) {
@@ -153,7 +165,7 @@ void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
 			if (worldPartition != newParent->worldPartition) {
 				propagateChildWorldPartition(newParent->worldPartition);
 			}
-			propagateEnabled(enabled, newParent->enabled && newParent->parentEnabled);
+			propagateEnabled(world, enabled, newParent->enabled && newParent->parentEnabled);
 			if (childIdx >= parent->children.size()) {
 				parent->children.push_back(this);
 			} else {
@@ -161,7 +173,7 @@ void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
 			}
 			parent->propagateChildrenChange();
 		} else {
-			propagateEnabled(enabled, true);
+			propagateEnabled(world, enabled, true);
 		}
 
 		if (propagate) {
@@ -170,16 +182,16 @@ void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
 	}
 }
 
-void Entity::addChild(Entity& child)
+void Entity::addChild(World& world, Entity& child)
 {
-	child.setParent(this);
+	child.setParent(world, this);
 }
 
-void Entity::detachChildren()
+void Entity::detachChildren(World& world)
 {
 	auto childrenCopy = std::move(children);
 	for (auto& child : childrenCopy) {
-		child->setParent(nullptr);
+		child->setParent(world, nullptr);
 	}
 	children.clear();
 }
@@ -199,6 +211,20 @@ void Entity::markHierarchyDirty()
 	}
 }
 
+void Entity::onComponentsRelocated()
+{
+	// Anything holding raw pointers into our components has to re-fetch them once this changes
+	++componentRevision;
+
+	// Children cache a pointer to our transform, which has just moved
+	for (auto& child: children) {
+		auto transform = child->tryGetComponent<Transform2DComponent>();
+		if (transform) {
+			transform->onHierarchyChanged();
+		}
+	}
+}
+
 void Entity::propagateChildrenChange()
 {
 	// Could be recursive, but want to make sure I'm not paying for function calls here
@@ -215,7 +241,7 @@ void Entity::propagateChildWorldPartition(WorldPartitionId newWorldPartition)
 	}
 }
 
-void Entity::propagateEnabled(bool enabledStatus, bool parentStatus)
+void Entity::propagateEnabled(World& world, bool enabledStatus, bool parentStatus)
 {
 	const bool oldStatus = enabled && parentEnabled;
 	enabled = enabledStatus;
@@ -224,16 +250,16 @@ void Entity::propagateEnabled(bool enabledStatus, bool parentStatus)
 
 	if (oldStatus != newStatus) {
 		for (auto& child: children) {
-			child->propagateEnabled(child->enabled, newStatus);
+			child->propagateEnabled(world, child->enabled, newStatus);
 		}
-		dirty = true;
+		setDirty(world);
 		markHierarchyDirty();
 	}
 }
 
-void Entity::setEnabled(bool enabled)
+void Entity::setEnabled(World& world, bool enabled)
 {
-	propagateEnabled(enabled, parentEnabled);
+	propagateEnabled(world, enabled, parentEnabled);
 }
 
 FamilyMaskType Entity::getMask() const
@@ -383,7 +409,7 @@ void Entity::doDestroy(World& world, bool updateParenting)
 	}
 	
 	if (updateParenting) {
-		setParent(nullptr, false);
+		setParent(world, nullptr, false);
 	}
 
 	for (auto& c: children) {
@@ -394,7 +420,7 @@ void Entity::doDestroy(World& world, bool updateParenting)
 	world.onEntityDestroyed(getInstanceUUID());
 	
 	alive = false;
-	dirty = true;
+	setDirty(world);
 }
 
 bool Entity::hasBit(const World& world, int index) const
@@ -410,7 +436,8 @@ bool Entity::hasAnyBit(const World& world, gsl::span<const int> indices) const
 void EntityRef::setReloaded()
 {
 	Expects(entity);
-	entity->reloaded = true;
-
-	world->setEntityReloaded();
+	if (!entity->reloaded) {
+		entity->reloaded = true;
+		world->setEntityReloaded(*entity);
+	}
 }
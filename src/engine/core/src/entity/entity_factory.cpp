@@ -7,6 +7,7 @@
 #include "halley/entity/entity_scene.h"
 #include "halley/support/logger.h"
 #include "halley/entity/entity_data_instanced.h"
+#include "halley/entity/prefab_template.h"
 #include "halley/entity/world.h"
 #include "halley/entity/registry.h"
 #include "halley/bytes/byte_serializer.h"
@@ -208,6 +209,11 @@ void EntityFactoryContext::setEntities(Vector<EntityRef> entities)
 	this->entities = std::move(entities);
 }
 
+void EntityFactoryContext::clearEntities()
+{
+	entities.clear();
+}
+
 EntityRef EntityFactoryContext::getEntity(const UUID& uuid, bool allowPrefabUUID, bool allowWorldLookup) const
 {
 	if (!uuid.isValid()) {
@@ -356,6 +362,93 @@ EntityRef EntityFactory::createEntity(const EntityData& data, int mask, EntityRe
 	return entity;
 }
 
+Vector<EntityRef> EntityFactory::spawnBatch(const std::shared_ptr<const Prefab>& prefab, size_t count, const std::function<void(EntityRef, size_t)>& initializer, EntityRef parent, EntityScene* scene)
+{
+	Vector<EntityRef> result;
+	result.reserve(count);
+
+	auto onInstanceCreated = [&] (EntityRef entity, size_t i)
+	{
+		// createEntity has already told the scene about the prefab, for instances that went through it
+		if (scene && !parent.isValid()) {
+			scene->addRootEntity(entity);
+		}
+		if (initializer) {
+			initializer(entity, i);
+		}
+		result.push_back(entity);
+	};
+
+	const auto prefabTemplate = prefab->getTemplate(world.getReflection(), resources);
+	if (!prefabTemplate) {
+		for (size_t i = 0; i < count; ++i) {
+			EntityData data(UUID::generate());
+			data.setPrefab(prefab->getAssetId());
+			onInstanceCreated(createEntity(data, makeMask(EntitySerialization::Type::Prefab), parent, scene), i);
+		}
+		return result;
+	}
+
+	// A single context is reused by every instance, it only needs to know about the entities of the instance being created, for UUID lookups
+	const auto context = std::make_shared<EntityFactoryContext>(world, resources, makeMask(EntitySerialization::Type::Prefab), false, prefab, nullptr, scene);
+	const auto nodes = prefabTemplate->getNodes();
+	Vector<EntityRef> instance;
+	instance.reserve(nodes.size());
+
+	for (size_t i = 0; i < count; ++i) {
+		const auto rootUUID = UUID::generate();
+		instance.clear();
+		context->clearEntities();
+
+		for (size_t j = 0; j < nodes.size(); ++j) {
+			const auto& node = nodes[j];
+			const auto uuid = j == 0 ? rootUUID : UUID::generateFromUUIDs(node.prefabUUID, rootUUID);
+			auto entity = world.createEntity(uuid, node.name, std::optional<EntityRef>(), context->getWorldPartition());
+			if (networkFactory) {
+				entity.setFromNetwork(true);
+			}
+			if (node.prefabUUID.isValid()) {
+				entity.setPrefab(prefab, node.prefabUUID);
+			}
+			instance.push_back(entity);
+			context->addEntity(entity);
+		}
+		if (scene) {
+			scene->addPrefabReference(prefab, instance[0]);
+		}
+
+		for (size_t j = 0; j < nodes.size(); ++j) {
+			const auto& node = nodes[j];
+			auto& entity = instance[j];
+			if (node.parent >= 0) {
+				entity.setParent(instance[node.parent]);
+			} else if (parent.isValid()) {
+				entity.setParent(parent);
+			}
+
+			context->setCurrentEntity(entity.getEntityId());
+			entity.setSelectable(node.selectable);
+			entity.setSerializable(node.serializable);
+			entity.setEnabled(!node.disabled && context->canInstantiateVariant(node.variant));
+			for (const auto& component: prefabTemplate->getComponents(node)) {
+				if (component.prototype) {
+					component.reflector->addComponentCopy(entity, *component.prototype);
+				} else {
+					const auto created = component.reflector->createComponent(*context, entity, component.data);
+					if (!created.created) {
+						Logger::logError("Failed to create component \"" + String(component.reflector->getName()) + "\" on entity " + entity.getName());
+					}
+				}
+			}
+		}
+		context->setCurrentEntity(EntityId());
+
+		onInstanceCreated(instance[0], i);
+	}
+
+	return result;
+}
+
 void EntityFactory::updateEntity(EntityRef& entity, const IEntityData& data, int serializationMask, EntityScene* scene, IDataInterpolatorSetRetriever* interpolators)
 {
 	Expects(entity.isValid());
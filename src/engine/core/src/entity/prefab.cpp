@@ -1,6 +1,7 @@
 #include "halley/entity/prefab.h"
 
 #include "halley/entity/entity_data_delta.h"
+#include "halley/entity/prefab_template.h"
 #include "halley/bytes/byte_serializer.h"
 #include "halley/resources/resources.h"
 #include "halley/file_formats/yaml_convert.h"
@@ -67,6 +68,7 @@ void Prefab::serialize(Serializer& s) const
 
 void Prefab::deserialize(Deserializer& s)
 {
+	invalidateTemplate();
 	s >> entityData;
 	s >> gameData;
 	entityData.setSceneRoot(isScene());
@@ -89,6 +91,7 @@ String Prefab::toYAML() const
 
 void Prefab::parseConfigNode(const ConfigNode& node)
 {
+	invalidateTemplate();
 	if (node.getType() == ConfigNodeType::Map && node.hasKey("entity")) {
 		entityData = makeEntityData(node["entity"]);
 		gameData.getRoot() = std::move(node["game"]);
@@ -124,6 +127,7 @@ bool Prefab::isScene() const
 EntityData& Prefab::getEntityData()
 {
 	waitForLoad(true);
+	invalidateTemplate();
 	return entityData;
 }
 
@@ -142,6 +146,7 @@ gsl::span<const EntityData> Prefab::getEntityDatas() const
 gsl::span<EntityData> Prefab::getEntityDatas()
 {
 	waitForLoad(true);
+	invalidateTemplate();
 	return gsl::span<EntityData>(&entityData, 1);
 }
 
@@ -238,6 +243,7 @@ String Prefab::getPrefabIcon() const
 EntityData* Prefab::findEntityData(const UUID& uuid)
 {
 	waitForLoad(true);
+	invalidateTemplate();
 	if (!uuid.isValid()) {
 		if (isScene()) {
 			return &entityData;
@@ -270,11 +276,31 @@ ResourceMemoryUsage Prefab::getMemoryUsage() const
 
 void Prefab::generateUUIDs()
 {
+	invalidateTemplate();
 	HashMap<UUID, UUID> changes;
 	entityData.generateUUIDs(changes);
 	entityData.updateComponentUUIDs(changes);
 }
 
+std::shared_ptr<const PrefabTemplate> Prefab::getTemplate(const WorldReflection& reflection, Resources& resources) const
+{
+	waitForLoad(true);
+
+	auto result = std::atomic_load(&compiledTemplate);
+	if (!result || &result->getReflection() != &reflection || &result->getResources() != &resources) {
+		// Prefabs that can't be compiled are cached as an empty template, so they're not attempted again on every spawn
+		std::shared_ptr<const PrefabTemplate> compiled = PrefabTemplate::compile(*this, reflection, resources);
+		result = compiled ? compiled : std::make_shared<const PrefabTemplate>(reflection, resources);
+		std::atomic_store(&compiledTemplate, result);
+	}
+	return result->getNodes().empty() ? std::shared_ptr<const PrefabTemplate>() : result;
+}
+
+void Prefab::invalidateTemplate()
+{
+	std::atomic_store(&compiledTemplate, std::shared_ptr<const PrefabTemplate>());
+}
+
 void Prefab::doPreloadDependencies(const EntityData& data, Resources& resources) const
 {
 	if (!data.getPrefab().isEmpty()) {
@@ -382,10 +408,17 @@ ConfigNode Scene::entityToConfigNode() const
 
 Vector<SceneVariant> Scene::getVariants() const
 {
-	if (const auto* variantData = tryGetGameData("variants")) {
-		auto result = variantData->asVector<SceneVariant>({});
-		if (!result.empty()) {
-			return result;
+	waitForLoad(true);
+
+	// Read through the frozen game data, so only the variants are turned into ConfigNodes
+	const auto root = gameData.getView();
+	if (root.getType() == ConfigNodeType::Map) {
+		const auto variantData = root["variants"];
+		if (variantData.getType() == ConfigNodeType::Sequence) {
+			auto result = variantData.asVector<SceneVariant>();
+			if (!result.empty()) {
+				return result;
+			}
 		}
 	}
 
@@ -0,0 +1,116 @@
+#include "halley/entity/prefab_template.h"
+
+#include "halley/entity/entity_data.h"
+#include "halley/entity/entity_factory.h"
+#include "halley/entity/prefab.h"
+#include "halley/entity/world_reflection.h"
+#include "halley/support/logger.h"
+
+using namespace Halley;
+
+namespace {
+	// Deserializing through this flags any component whose value depends on the instance it's created for
+	class PrototypeContext final : public IEntityFactoryContext {
+	public:
+		mutable bool instanceDependent = false;
+
+		EntityId getEntityIdFromUUID(const UUID& uuid) const override
+		{
+			instanceDependent = true;
+			return {};
+		}
+
+		UUID getUUIDFromEntityId(EntityId id) const override
+		{
+			instanceDependent = true;
+			return {};
+		}
+
+		EntityId getCurrentEntityId() const override
+		{
+			instanceDependent = true;
+			return {};
+		}
+
+		bool isHeadless() const override
+		{
+			instanceDependent = true;
+			return false;
+		}
+	};
+}
+
+std::shared_ptr<PrefabTemplate> PrefabTemplate::compile(const Prefab& prefab, const WorldReflection& reflection, Resources& resources)
+{
+	if (prefab.isScene()) {
+		return {};
+	}
+
+	auto result = std::make_shared<PrefabTemplate>(reflection, resources);
+	if (!result->addNode(prefab.getEntityData(), -1, prefab.getAssetId())) {
+		return {};
+	}
+	return result;
+}
+
+PrefabTemplate::PrefabTemplate(const WorldReflection& reflection, Resources& resources)
+	: reflection(&reflection)
+	, resources(&resources)
+{
+}
+
+gsl::span<const PrefabTemplate::Component> PrefabTemplate::getComponents(const Node& node) const
+{
+	return gsl::span<const Component>(components).subspan(node.firstComponent, node.numComponents);
+}
+
+bool PrefabTemplate::addNode(const EntityData& data, int parent, const String& prefabName)
+{
+	if (parent != -1 && !data.getPrefab().isEmpty()) {
+		// Nested prefab instances need their own factory context, so they go through the regular path
+		return false;
+	}
+
+	const int idx = static_cast<int>(nodes.size());
+	auto& node = nodes.emplace_back();
+	node.parent = parent;
+	node.name = data.getName();
+	node.variant = data.getVariant();
+	node.prefabUUID = data.getPrefabUUID();
+	node.selectable = !data.getFlag(EntityData::Flag::NotSelectable);
+	node.serializable = !data.getFlag(EntityData::Flag::NotSerializable);
+	node.disabled = data.getFlag(EntityData::Flag::Disabled);
+	node.firstComponent = static_cast<uint32_t>(components.size());
+
+	for (const auto& [componentName, componentData]: data.getComponents()) {
+		if (const auto* reflector = reflection->tryGetComponentReflector(componentName)) {
+			components.push_back(Component{ reflector, ConfigNode(componentData), makePrototype(*reflector, componentData) });
+		} else {
+			Logger::logError("Unknown component \"" + componentName + "\" in prefab \"" + prefabName + "\"");
+		}
+	}
+	nodes[idx].numComponents = static_cast<uint32_t>(components.size()) - nodes[idx].firstComponent;
+
+	for (const auto& child: data.getChildren()) {
+		if (!addNode(child, idx, prefabName)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::shared_ptr<const Halley::Component> PrefabTemplate::makePrototype(const ComponentReflector& reflector, const ConfigNode& data) const
+{
+	if (data.getType() == ConfigNodeType::Del) {
+		return {};
+	}
+
+	PrototypeContext prototypeContext;
+	EntitySerializationContext context;
+	context.resources = resources;
+	context.entityContext = &prototypeContext;
+	context.entitySerializationTypeMask = EntitySerialization::makeMask(EntitySerialization::Type::Prefab);
+
+	auto prototype = reflector.createPrototype(context, data);
+	return prototypeContext.instanceDependent ? std::shared_ptr<const Halley::Component>() : prototype;
+}
@@ -1,4 +1,5 @@
 #include "halley/entity/services/scripting_service.h"
+#include "halley/concurrency/concurrent.h"
 
 using namespace Halley;
 
@@ -18,6 +19,89 @@ ScriptEnvironment& Halley::ScriptingService::getEnvironment() const
 	return *scriptEnvironment;
 }
 
+void Halley::ScriptingService::setWorkerEnvironmentFactory(EnvironmentFactory factory)
+{
+	workerEnvironmentFactory = std::move(factory);
+	workerEnvironments.clear();
+}
+
+bool Halley::ScriptingService::hasWorkerEnvironments() const
+{
+	return !!workerEnvironmentFactory;
+}
+
+ScriptEnvironment& Halley::ScriptingService::getWorkerEnvironment(size_t idx)
+{
+	Expects(workerEnvironmentFactory);
+
+	while (workerEnvironments.size() <= idx) {
+		auto env = workerEnvironmentFactory();
+		env->setDeferSideEffects(true);
+		workerEnvironments.push_back(std::move(env));
+	}
+	return *workerEnvironments[idx];
+}
+
+void Halley::ScriptingService::updateInParallel(ExecutionQueue& queue, size_t n, const std::function<bool(size_t)>& prepare, const std::function<void(ScriptEnvironment&, size_t)>& update, const std::function<void(size_t)>& finish)
+{
+	auto& env = *scriptEnvironment;
+
+	Vector<uint8_t> isParallel(n, 0);
+	Vector<size_t> parallelIdx;
+	for (size_t i = 0; i < n; ++i) {
+		if (prepare(i)) {
+			isParallel[i] = 1;
+			parallelIdx.push_back(i);
+		}
+	}
+
+	// Each chunk borrows a worker environment, and everything each entry sends out is kept aside
+	Vector<ScriptEnvironment::Outbox> outboxes(n);
+	if (!parallelIdx.empty()) {
+		constexpr size_t grainSize = 16;
+		const size_t nChunks = (parallelIdx.size() + grainSize - 1) / grainSize;
+		const size_t nEnvironments = std::min(nChunks, queue.threadCount() + 1);
+
+		std::mutex mutex;
+		Vector<ScriptEnvironment*> idleEnvironments;
+		for (size_t i = 0; i < nEnvironments; ++i) {
+			auto& workerEnv = getWorkerEnvironment(i);
+			workerEnv.copySettingsFrom(env);
+			idleEnvironments.push_back(&workerEnv);
+		}
+
+		Concurrent::parallel_for(queue, 0, nChunks, 1, [&] (size_t chunk)
+		{
+			ScriptEnvironment* workerEnv;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				Expects(!idleEnvironments.empty());
+				workerEnv = idleEnvironments.back();
+				idleEnvironments.pop_back();
+			}
+
+			const size_t end = std::min((chunk + 1) * grainSize, parallelIdx.size());
+			for (size_t j = chunk * grainSize; j < end; ++j) {
+				const auto i = parallelIdx[j];
+				update(*workerEnv, i);
+				outboxes[i] = workerEnv->takeOutbox();
+			}
+
+			std::unique_lock<std::mutex> lock(mutex);
+			idleEnvironments.push_back(workerEnv);
+		});
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		if (isParallel[i]) {
+			env.mergeOutbox(std::move(outboxes[i]));
+		} else {
+			update(env, i);
+		}
+		finish(i);
+	}
+}
+
 ConfigNode Halley::ScriptingService::evaluateExpression(const String& expression) const
 {
 	auto stack = LuaStackOps(*luaState);
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include "halley/entity/system_scheduler.h"
+#include "halley/entity/system.h"
+#include "halley/entity/world.h"
+#include "halley/concurrency/concurrent.h"
+#include "halley/utils/algorithm.h"
+
+using namespace Halley;
+
+SystemAccessInfo::SystemAccessInfo(Vector<int> componentsRead, Vector<int> componentsWritten, Vector<String> servicesRead, Vector<String> servicesWritten, int flags)
+	: componentsRead(std::move(componentsRead))
+	, componentsWritten(std::move(componentsWritten))
+	, servicesRead(std::move(servicesRead))
+	, servicesWritten(std::move(servicesWritten))
+	, flags(flags)
+{
+}
+
+bool SystemAccessInfo::isExclusive() const
+{
+	return hasFlag(SystemAccessFlags::Exclusive);
+}
+
+bool SystemAccessInfo::hasFlag(SystemAccessFlags flag) const
+{
+	return (flags & int(flag)) != 0;
+}
+
+bool SystemAccessInfo::conflictsWith(const SystemAccessInfo& other) const
+{
+	if (isExclusive() || other.isExclusive()) {
+		return true;
+	}
+
+	// Write/write and read/write on the same component or service
+	const auto overlaps = [] (const auto& a, const auto& b)
+	{
+		return std::any_of(a.begin(), a.end(), [&] (const auto& v) { return std_ex::contains(b, v); });
+	};
+	if (overlaps(componentsWritten, other.componentsWritten) || overlaps(componentsWritten, other.componentsRead) || overlaps(componentsRead, other.componentsWritten)) {
+		return true;
+	}
+	if (overlaps(servicesWritten, other.servicesWritten) || overlaps(servicesWritten, other.servicesRead) || overlaps(servicesRead, other.servicesWritten)) {
+		return true;
+	}
+
+	// Entity inboxes are shared by all message types, so senders conflict with anyone else touching them
+	const bool sends = hasFlag(SystemAccessFlags::SendEntityMessages);
+	const bool otherSends = other.hasFlag(SystemAccessFlags::SendEntityMessages);
+	const bool usesInbox = sends || hasFlag(SystemAccessFlags::ReceiveEntityMessages);
+	const bool otherUsesInbox = otherSends || other.hasFlag(SystemAccessFlags::ReceiveEntityMessages);
+	if ((sends && otherUsesInbox) || (otherSends && usesInbox)) {
+		return true;
+	}
+
+	if (hasFlag(SystemAccessFlags::SendSystemMessages) && other.hasFlag(SystemAccessFlags::SendSystemMessages)) {
+		return true;
+	}
+	if (hasFlag(SystemAccessFlags::API) && other.hasFlag(SystemAccessFlags::API)) {
+		return true;
+	}
+
+	return false;
+}
+
+void SystemScheduler::build(gsl::span<const std::unique_ptr<System>> systems)
+{
+	stages.clear();
+
+	// Each system goes on the stage after the last system it conflicts with, so relative order of conflicting systems is preserved
+	Vector<size_t> systemStage;
+	systemStage.reserve(systems.size());
+	for (size_t i = 0; i < systems.size(); ++i) {
+		const auto& access = systems[i]->getAccessInfo();
+
+		size_t stage = 0;
+		for (size_t j = 0; j < i; ++j) {
+			if (systemStage[j] + 1 > stage && access.conflictsWith(systems[j]->getAccessInfo())) {
+				stage = systemStage[j] + 1;
+			}
+		}
+		systemStage.push_back(stage);
+
+		if (stages.size() <= stage) {
+			stages.resize(stage + 1);
+		}
+		stages[stage].push_back(systems[i].get());
+	}
+}
+
+void SystemScheduler::run(World& world, Time time, ExecutionQueue& queue) const
+{
+	for (const auto& stage: stages) {
+		if (stage.size() == 1) {
+			stage[0]->doUpdate(time);
+		} else {
+			Vector<Future<void>> futures;
+			Vector<std::exception_ptr> errors(stage.size());
+			futures.reserve(stage.size() - 1);
+
+			for (size_t i = 1; i < stage.size(); ++i) {
+				futures.push_back(Concurrent::execute(queue, [system = stage[i], time, error = &errors[i]] ()
+				{
+					try {
+						system->doUpdate(time);
+					} catch (...) {
+						*error = std::current_exception();
+					}
+				}));
+			}
+
+			// Run the first one on this thread while the others are on the pool
+			try {
+				stage[0]->doUpdate(time);
+			} catch (...) {
+				errors[0] = std::current_exception();
+			}
+			Concurrent::whenAll(futures.begin(), futures.end()).wait();
+
+			for (auto& e: errors) {
+				if (e) {
+					std::rethrow_exception(e);
+				}
+			}
+		}
+
+		world.spawnPending();
+	}
+}
+
+size_t SystemScheduler::getNumStages() const
+{
+	return stages.size();
+}
+
+gsl::span<System* const> SystemScheduler::getStage(size_t idx) const
+{
+	return stages.at(idx);
+}
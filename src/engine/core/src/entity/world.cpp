@@ -19,6 +19,7 @@
 #include "halley/support/logger.h"
 #include "halley/support/profiler.h"
 #include "halley/utils/algorithm.h"
+#include "halley/concurrency/executor.h"
 
 using namespace Halley;
 
@@ -72,6 +73,11 @@ World::~World()
 	}
 	families.clear();
 	services.clear();
+
+	if (archetypeStorage) {
+		componentDeleterTable->setArchetypeStorage(nullptr);
+		archetypeStorage.reset();
+	}
 }
 
 std::unique_ptr<World> World::make(const HalleyAPI& api, Resources& resources, const String& sceneName, bool devMode)
@@ -89,6 +95,9 @@ std::unique_ptr<World> World::make(const HalleyAPI& api, Resources& resources, c
 
 void World::loadSystems(const ConfigNode& root, const std::optional<String>& systemTag)
 {
+	parallelUpdate = root["parallelUpdate"].asBool(parallelUpdate);
+	setArchetypeStorage(root["archetypeStorage"].asBool(hasArchetypeStorage()));
+
 	for (const auto& [timelineName, tlSystems]: root["timelines"].asMap()) {
 		const TimeLine timeline = fromString<TimeLine>(timelineName);
 
@@ -125,6 +134,7 @@ System& World::addSystem(std::unique_ptr<System> system, TimeLine timelineType)
 	auto& timeline = getSystems(timelineType);
 	timeline.emplace_back(std::move(system));
 	ref.onAddedToWorld(*this, int(timeline.size()));
+	schedulers[int(timelineType)].reset();
 	return ref;
 }
 
@@ -134,6 +144,7 @@ void World::removeSystem(System& system)
 		for (size_t i = 0; i < sys.size(); i++) {
 			if (sys[i].get() == &system) {
 				sys.erase(sys.begin() + i);
+				schedulers[&sys - systems.data()].reset();
 				return;
 			}
 		}
@@ -262,7 +273,7 @@ void World::moveEntitiesFrom(World& other, std::optional<WorldPartitionId> world
 		if (!worldPartition || e->worldPartition == worldPartition) {
 			entitiesToMove.push_back(e);
 			e->alive = false;
-			e->dirty = true;
+			e->setDirty(other);
 			other.uuidMap.erase(e->getInstanceUUID());
 		}
 	}
@@ -270,15 +281,23 @@ void World::moveEntitiesFrom(World& other, std::optional<WorldPartitionId> world
 	// Update other world
 	// We tell it not to delete entities - we want them to "leak" since we're stealing them
 	// It'll still remove it from families and whatnot
-	other.entityDirty = true;
 	other.canDeleteEntities = false;
 	other.spawnPending();
 	other.canDeleteEntities = true;
 
+	// Components living in the other world's chunks have to move out with the entities
+	if (other.archetypeStorage) {
+		for (auto* e: entitiesToMove) {
+			other.archetypeStorage->evict(*e);
+		}
+	}
+
 	// Add entities to my pending list
 	entitiesPendingCreation.reserve(entitiesPendingCreation.size() + entitiesToMove.size());
 	for (auto* e: entitiesToMove) {
+		// Still flagged dirty from the other world, which has already dropped it from its dirty list
 		e->dirty = true;
+		dirtyEntities.push_back(e);
 		e->alive = true;
 		e->mask = FamilyMask::Handle();
 
@@ -343,7 +362,6 @@ void World::doDestroyEntity(EntityId id)
 void World::doDestroyEntity(Entity* e)
 {
 	e->destroy(*this);
-	entityDirty = true;
 }
 
 EntityRef World::getEntity(EntityId id)
@@ -459,15 +477,14 @@ Vector<ConstEntityRef> World::getTopLevelEntities() const
 	return result;
 }
 
-void World::onEntityDirty()
+void World::onEntityDirty(Entity& entity)
 {
-	entityDirty = true;
+	dirtyEntities.push_back(&entity);
 }
 
-void World::setEntityReloaded()
+void World::setEntityReloaded(Entity& entity)
 {
-	entityReloaded = true;
-	entityDirty = true;
+	reloadedEntities.push_back(entity.getEntityId());
 }
 
 const WorldReflection& World::getReflection() const
@@ -598,10 +615,61 @@ void World::setHeadless(bool headless)
 	this->headless = headless;
 }
 
+bool World::isParallelUpdate() const
+{
+	return parallelUpdate;
+}
+
+void World::setParallelUpdate(bool parallel)
+{
+	parallelUpdate = parallel;
+}
+
+bool World::hasArchetypeStorage() const
+{
+	return !!archetypeStorage;
+}
+
+void World::setArchetypeStorage(bool enabled)
+{
+	if (enabled == hasArchetypeStorage()) {
+		return;
+	}
+
+	if (enabled) {
+		// Existing entities will move into chunks the next time their components change
+		archetypeStorage = std::make_unique<ArchetypeStorage>(*componentDeleterTable);
+		componentDeleterTable->setArchetypeStorage(archetypeStorage.get());
+		for (auto& family: families) {
+			family->archetypeStorage = archetypeStorage.get();
+		}
+	} else {
+		for (auto* e: entities) {
+			archetypeStorage->evict(*e);
+			for (auto* fam: getFamiliesFor(e->getMask())) {
+				fam->refreshEntity(*e);
+			}
+		}
+		for (auto& family: families) {
+			family->archetypeStorage = nullptr;
+		}
+		componentDeleterTable->setArchetypeStorage(nullptr);
+		archetypeStorage.reset();
+	}
+}
+
+const ArchetypeStorage* World::getArchetypeStorage() const
+{
+	return archetypeStorage.get();
+}
+
 void World::deleteEntity(Entity* entity)
 {
 	Expects (entity);
 	entity->destroyComponents(*componentDeleterTable);
+	if (archetypeStorage) {
+		archetypeStorage->release(*entity);
+	}
 	entity->~Entity();
 	entityPool->free(entity);
 }
@@ -641,12 +709,13 @@ void World::spawnPending()
 {
 	if (!entitiesPendingCreation.empty()) {
 		HALLEY_DEBUG_TRACE();
+		entities.reserve(entities.size() + entitiesPendingCreation.size());
 		for (auto& e : entitiesPendingCreation) {
 			e->onReady();
+			e->worldIndex = static_cast<uint32_t>(entities.size());
+			entities.push_back(e);
 		}
-		std::move(entitiesPendingCreation.begin(), entitiesPendingCreation.end(), std::insert_iterator<decltype(entities)>(entities, entities.end()));
 		entitiesPendingCreation.clear();
-		entityDirty = true;
 		HALLEY_DEBUG_TRACE();
 	}
 
@@ -655,96 +724,76 @@ void World::spawnPending()
 
 void World::updateEntities()
 {
-	if (!entityDirty) {
+	if (dirtyEntities.empty() && reloadedEntities.empty() && !(archetypeStorage && archetypeStorage->hasPending())) {
 		return;
 	}
 
-	entityDirty = false;
-
 	HALLEY_DEBUG_TRACE();
-	size_t nEntities = entities.size();
-
-	Vector<size_t> entitiesRemoved;
-
-	struct FamilyTodo {
-		Vector<std::pair<FamilyMaskType, Entity*>> toAdd;
-		Vector<std::pair<FamilyMaskType, Entity*>> toRemove;
-		Vector<std::pair<FamilyMaskType, Entity*>> toReload;
-	};
-	std::map<FamilyMaskType, FamilyTodo> pending;
-
-	// Update all entities
-	// This loop should be as fast as reasonably possible
-	for (size_t i = 0; i < nEntities; i++) {
-		auto& entity = *entities[i];
-		if (i + 20 < nEntities) { // Watch out for sign! Don't subtract!
-			prefetchL2(entities[i + 20]);
-		}
-
-		// Check if it needs any sort of updating
-		if (entity.needsRefresh()) {
-			// First of all, let's check if it's dead
-			if (!entity.isAlive()) {
-				// Remove from systems
-				pending[entity.getMask()].toRemove.emplace_back(FamilyMaskType(), &entity);
-				entitiesRemoved.push_back(i);
-			} else {
-				// It's alive, so check old and new system inclusions
-				FamilyMaskType oldMask = entity.getMask();
-				entity.refresh(maskStorage.get(), *componentDeleterTable);
-				FamilyMaskType newMask = entity.getMask();
-
-				// Did it change?
-				if (oldMask != newMask) {
-					pending[oldMask].toRemove.emplace_back(newMask, &entity);
-					pending[newMask].toAdd.emplace_back(oldMask, &entity);
+	// Only entities flagged since the last update are visited; anything flagged while families notify goes into the next batch
+	auto dirty = std::move(dirtyEntities);
+	dirtyEntities.clear();
+	auto reloaded = std::move(reloadedEntities);
+	reloadedEntities.clear();
+
+	Vector<Entity*> entitiesRemoved;
+
+	const size_t nDirty = dirty.size();
+	for (size_t i = 0; i < nDirty; i++) {
+		auto& entity = *dirty[i];
+		if (i + 20 < nDirty) { // Watch out for sign! Don't subtract!
+			prefetchL2(dirty[i + 20]);
+		}
+
+		if (!entity.needsRefresh()) {
+			continue;
+		}
+
+		// First of all, let's check if it's dead
+		if (!entity.isAlive()) {
+			// Remove from systems
+			if (maskStorage) {
+				for (auto* fam: getFamiliesFor(entity.getMask())) {
+					fam->removeEntity(entity);
 				}
 			}
+			entitiesRemoved.push_back(&entity);
+		} else {
+			// It's alive, so check old and new system inclusions
+			FamilyMaskType oldMask = entity.getMask();
+			entity.refresh(maskStorage.get(), *componentDeleterTable);
+			FamilyMaskType newMask = entity.getMask();
+
+			// Move components into the chunks of their new archetype
+			const bool relocated = archetypeStorage && archetypeStorage->relocate(entity);
+			if (relocated) {
+				entity.onComponentsRelocated();
+			}
+
+			if (maskStorage && (oldMask != newMask || relocated)) {
+				updateEntityFamilies(entity, oldMask, newMask, relocated);
+			}
 		}
 	}
 
-	if (entityReloaded) {
-		for (size_t i = 0; i < nEntities; i++) {
-			auto& entity = *entities[i];
-			if (entity.reloaded && entity.isAlive()) {
-				pending[entity.getMask()].toReload.emplace_back(entity.getMask(), &entity);
-				entity.reloaded = false;
+	if (archetypeStorage) {
+		// Entities whose components changed in an earlier update are only moved now
+		for (auto* entity: archetypeStorage->flushPending()) {
+			entity->onComponentsRelocated();
+			if (maskStorage) {
+				updateEntityFamilies(*entity, entity->getMask(), entity->getMask(), true);
 			}
 		}
 	}
 
-	entityReloaded = false;
-
 	HALLEY_DEBUG_TRACE();
-	// Go through every family adding/removing entities as needed
-	if (maskStorage) {
-		for (auto& todo: pending) {
-			for (auto* fam: getFamiliesFor(todo.first)) {
-				const auto& famMask = fam->inclusionMask;
-				const auto& optFamMask = fam->optionalMask;
-				auto& ms = *maskStorage;
-				
-				for (auto& e: todo.second.toRemove) {
-					// Only remove if the entity is not about to be re-added
-					const auto& newMask = e.first;
-					if (!newMask.contains(famMask, ms)) {
-						fam->removeEntity(*e.second);
-					}
-				}
-				for (auto& e: todo.second.toAdd) {
-					// Only add if the entity was not already in this
-					const auto& oldMask = e.first;
-					const auto& newMask = todo.first;
-					if (!oldMask.contains(famMask, ms)) {
-						fam->addEntity(*e.second);
-					} else if (optFamMask.unionChangedBetween(oldMask, newMask, ms)) {
-						// Needs refreshing of optional references
-						fam->refreshEntity(*e.second);
-					}
-				}
-
-				for (auto& e : todo.second.toReload) {
-					fam->reloadEntity(*e.second);
+	for (const auto id: reloaded) {
+		// Entities are re-resolved, as they might have been destroyed since they were flagged
+		auto* entity = tryGetRawEntity(id);
+		if (entity && entity->reloaded && entity->isAlive()) {
+			entity->reloaded = false;
+			if (maskStorage) {
+				for (auto* fam: getFamiliesFor(entity->getMask())) {
+					fam->reloadEntity(*entity);
 				}
 			}
 		}
@@ -758,27 +807,45 @@ void World::updateEntities()
 	
 	HALLEY_DEBUG_TRACE();
 	// Actually remove dead entities
-	if (!entitiesRemoved.empty()) {
-		size_t livingEntityCount = entities.size();
-		for (int i = int(entitiesRemoved.size()); --i >= 0; ) {
-			size_t idx = entitiesRemoved[i];
-			auto& entity = *entities[idx];
-
-			// Remove
-			if (canDeleteEntities) {
-				entityMap->freeId(entity.getEntityId().value);
-				deleteEntity(&entity);
-			}
-
-			// Put it at the back of the array, so it's removed when the array gets resized
-			std::swap(entities[idx], entities[--livingEntityCount]);
+	for (auto* entity: entitiesRemoved) {
+		// Swap with the last entity, so it's removed in O(1)
+		const auto idx = entity->worldIndex;
+		Expects(idx < entities.size() && entities[idx] == entity);
+		entities[idx] = entities.back();
+		entities[idx]->worldIndex = idx;
+		entities.pop_back();
+
+		if (canDeleteEntities) {
+			entityMap->freeId(entity->getEntityId().value);
+			deleteEntity(entity);
 		}
-		entities.resize(livingEntityCount);
 	}
 
 	HALLEY_DEBUG_TRACE();
 }
 
+void World::updateEntityFamilies(Entity& entity, const FamilyMaskType& oldMask, const FamilyMaskType& newMask, bool relocated)
+{
+	auto& ms = *maskStorage;
+
+	// Only remove if the entity is not about to be re-added
+	for (auto* fam: getFamiliesFor(oldMask)) {
+		if (!newMask.contains(fam->inclusionMask, ms)) {
+			fam->removeEntity(entity);
+		}
+	}
+
+	for (auto* fam: getFamiliesFor(newMask)) {
+		if (!oldMask.contains(fam->inclusionMask, ms)) {
+			// Only add if the entity was not already in this
+			fam->addEntity(entity);
+		} else if (relocated || fam->optionalMask.unionChangedBetween(oldMask, newMask, ms)) {
+			// Needs refreshing of optional references, or components moved to a different archetype
+			fam->refreshEntity(entity);
+		}
+	}
+}
+
 void World::initSystems(gsl::span<const TimeLine> timelines)
 {
 	for (auto& tl: timelines) {
@@ -793,6 +860,16 @@ void World::initSystems(gsl::span<const TimeLine> timelines)
 
 void World::updateSystems(TimeLine timeline, Time elapsed)
 {
+	if (parallelUpdate && Executors::getCPU().threadCount() > 0) {
+		auto& scheduler = schedulers[int(timeline)];
+		if (!scheduler) {
+			scheduler.emplace();
+			scheduler->build(getSystems(timeline));
+		}
+		scheduler->run(*this, elapsed, Executors::getCPU());
+		return;
+	}
+
 	for (auto& system : getSystems(timeline)) {
 		system->doUpdate(elapsed);
 		spawnPending();
@@ -814,6 +891,8 @@ Family& World::addFamily(std::unique_ptr<Family> family) noexcept
 
 void World::onAddFamily(Family& family) noexcept
 {
+	family.archetypeStorage = archetypeStorage.get();
+
 	// Add any existing entities to this new family
 	if (maskStorage) {
 		size_t nEntities = entities.size();
@@ -12,41 +12,74 @@ public:
 	bool storeFilePosition = false;
 };
 
+ConfigFile::ConfigFile()
+	: thawed(true)
+{
+}
+
 ConfigFile::ConfigFile(const ConfigFile& other)
+	: thawed(true)
 {
-	root = ConfigNode(other.root);
+	root = ConfigNode(other.getRoot());
 	updateRoot();
 }
 
 ConfigFile::ConfigFile(ConfigNode root)
+	: thawed(true)
 {
 	this->root = std::move(root);
 	updateRoot();
 }
 
 ConfigFile::ConfigFile(ConfigFile&& other) noexcept
+	: thawed(true)
 {
-	root = std::move(other.root);
-	updateRoot();
+	*this = std::move(other);
 }
 
 ConfigFile& ConfigFile::operator=(ConfigFile&& other) noexcept
 {
 	root = std::move(other.root);
+	frozen = std::move(other.frozen);
+	thawed = other.thawed.load();
 	updateRoot();
 	return *this;
 }
 
 ConfigNode& ConfigFile::getRoot()
 {
+	thaw();
+	frozen.reset();
 	return root;
 }
 
 const ConfigNode& ConfigFile::getRoot() const
 {
+	if (!thawed.load(std::memory_order_acquire)) {
+		thaw();
+	}
 	return root;
 }
 
+ConfigNodeView ConfigFile::getView() const
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!frozen) {
+		frozen = std::make_unique<FrozenConfigNode>(root);
+	}
+	return frozen->getRoot();
+}
+
+void ConfigFile::thaw() const
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!thawed.load(std::memory_order_relaxed)) {
+		root = frozen->getRoot().toConfigNode();
+		root.propagateParentingInformation(this);
+		thawed.store(true, std::memory_order_release);
+	}
+}
+
 constexpr int curVersion = 3;
 
 void ConfigFile::serialize(Serializer& s) const
@@ -59,7 +92,7 @@ void ConfigFile::serialize(Serializer& s) const
 	state.storeFilePosition = storeFilePosition;
 	const auto oldState = s.setState(&state);
 	
-	s << root;
+	s << getRoot();
 
 	s.setState(oldState);
 }
@@ -80,16 +113,22 @@ void ConfigFile::deserialize(Deserializer& s)
 	state.storeFilePosition = storeFilePosition;
 	const auto oldState = s.setState(&state);
 
-	s >> root;
+	// Read straight into the flat representation, the ConfigNode tree is built if anyone asks for it
+	auto newFrozen = std::make_unique<FrozenConfigNode>();
+	s >> *newFrozen;
 
 	s.setState(oldState);
 
-	updateRoot();
+	std::unique_lock<std::mutex> lock(mutex);
+	frozen = std::move(newFrozen);
+	root = ConfigNode();
+	thawed = false;
 }
 
 size_t ConfigFile::getSizeBytes() const
 {
-	return root.getSizeBytes();
+	std::unique_lock<std::mutex> lock(mutex);
+	return (thawed ? root.getSizeBytes() : 0) + (frozen ? frozen->getSizeBytes() : 0);
 }
 
 ResourceMemoryUsage ConfigFile::getMemoryUsage() const
@@ -375,6 +375,14 @@ void Core::updateSystem(Time time)
 	}
 }
 
+void Core::updateResources()
+{
+	if (resources) {
+		ProfilerEvent event(ProfilerEventType::CoreResourceStreaming);
+		resources->update(resources->getOptions().streamingBudget);
+	}
+}
+
 void Core::updatePlatform()
 {
 	if (api->platform) {
@@ -475,6 +483,8 @@ void Core::preUpdate(Time time)
 		ProfilerEvent event(ProfilerEventType::CoreDevConClient);
 		devConClient->update(time);
 	}
+
+	updateResources();
 }
 
 void Core::postUpdate(Time time)
@@ -193,18 +193,7 @@ void Painter::drawSprites(const std::shared_ptr<const Material>& material, size_
 		const auto result = addDrawData(material, numVertices, numSprites * 6, true);
 
 		const char* const src = static_cast<const char*>(vertexData) + offset;
-
-		for (size_t i = 0; i < numSprites; i++) {
-			for (size_t j = 0; j < verticesPerSprite; j++) {
-				const size_t srcOffset = i * result.vertexStride;
-				const size_t dstOffset = (i * verticesPerSprite + j) * result.vertexStride;
-				memcpy(result.dstVertex + dstOffset, src + srcOffset, result.vertexSize);
-
-				constexpr static Vector2f vertPosList[] = { Vector2f(0, 0), Vector2f(1, 0), Vector2f(1, 1), Vector2f(0, 1)};
-				const auto vertPos = Vector4f(vertPosList[j], vertPosList[j]);
-				memcpy(result.dstVertex + dstOffset + vertPosOffset, &vertPos, sizeof(vertPos));
-			}
-		}
+		expandSpriteVertices(src, numSprites, result.vertexSize, result.vertexStride, vertPosOffset, result.dstVertex);
 
 		generateQuadIndices(result.firstIndex, numSprites, result.dstIndex);
 
@@ -213,6 +202,25 @@ void Painter::drawSprites(const std::shared_ptr<const Material>& material, size_
 	}
 }
 
+void Painter::expandSpriteVertices(const void* vertexData, size_t numSprites, size_t vertexSize, size_t vertexStride, size_t vertPosOffset, void* dst)
+{
+	constexpr size_t verticesPerSprite = 4;
+	const char* const src = static_cast<const char*>(vertexData);
+	char* const dstVertex = static_cast<char*>(dst);
+
+	for (size_t i = 0; i < numSprites; i++) {
+		for (size_t j = 0; j < verticesPerSprite; j++) {
+			const size_t srcOffset = i * vertexStride;
+			const size_t dstOffset = (i * verticesPerSprite + j) * vertexStride;
+			memcpy(dstVertex + dstOffset, src + srcOffset, vertexSize);
+
+			constexpr static Vector2f vertPosList[] = { Vector2f(0, 0), Vector2f(1, 0), Vector2f(1, 1), Vector2f(0, 1)};
+			const auto vertPos = Vector4f(vertPosList[j], vertPosList[j]);
+			memcpy(dstVertex + dstOffset + vertPosOffset, &vertPos, sizeof(vertPos));
+		}
+	}
+}
+
 void Painter::drawSlicedSprite(const std::shared_ptr<const Material>& material, Vector2f scale, Vector4f slices, const void* vertexData)
 {
 	Expects(vertexData != nullptr);
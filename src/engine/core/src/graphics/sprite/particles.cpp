@@ -2,6 +2,7 @@
 
 #include "halley/maths/polygon.h"
 #include "halley/maths/random.h"
+#include "halley/maths/simd.h"
 #include "halley/support/logger.h"
 
 using namespace Halley;
@@ -179,8 +180,8 @@ void Particles::setPosition(Vector3f pos)
 		const auto delta = pos - position;
 		if (delta.squaredLength() > 0.000001f) {
 			if (relativePosition) {
-				for (auto& particle: particles) {
-					particle.pos += delta;
+				for (size_t i = 0; i < particles.size(); ++i) {
+					particles.setPos(i, particles.getPos(i) + delta);
 				}
 			}
 
@@ -371,18 +372,22 @@ void Particles::setSecondarySpawner(IParticleSpawner* spawner)
 	secondarySpawner = spawner;
 }
 
+void Particles::setRNG(Random& rng)
+{
+	this->rng = &rng;
+}
+
 void Particles::spawnAt(Vector3f pos)
 {
 	spawn(1, 0.0f);
-	particles[nParticlesAlive - 1].pos = pos;
+	particles.setPos(nParticlesAlive - 1, pos);
 }
 
 void Particles::destroyOverlapping(const Polygon& polygon)
 {
 	for (size_t i = 0; i < nParticlesAlive; ++i) {
-		auto& particle = particles[i];
-		if (polygon.isPointInside(particle.pos.xy())) {
-			particle.alive = false;
+		if (polygon.isPointInside(Vector2f(particles.posX[i], particles.posY[i]))) {
+			particles.alive[i] = 0;
 		}
 	}
 }
@@ -390,9 +395,8 @@ void Particles::destroyOverlapping(const Polygon& polygon)
 void Particles::destroyOverlapping(const Ellipse& ellipse)
 {
 	for (size_t i = 0; i < nParticlesAlive; ++i) {
-		auto& particle = particles[i];
-		if (ellipse.contains(particle.pos.xy())) {
-			particle.alive = false;
+		if (ellipse.contains(Vector2f(particles.posX[i], particles.posY[i]))) {
+			particles.alive[i] = 0;
 		}
 	}
 }
@@ -400,9 +404,8 @@ void Particles::destroyOverlapping(const Ellipse& ellipse)
 void Particles::destroyOverlapping(const Circle& circle)
 {
 	for (size_t i = 0; i < nParticlesAlive; ++i) {
-		auto& particle = particles[i];
-		if (circle.contains(particle.pos.xy())) {
-			particle.alive = false;
+		if (circle.contains(Vector2f(particles.posX[i], particles.posY[i]))) {
+			particles.alive[i] = 0;
 		}
 	}
 }
@@ -435,19 +438,19 @@ void Particles::initializeParticle(size_t index, float time, float totalTime)
 	const auto startAzimuth = Angle1f::fromDegrees(rng->getFloat(azimuth));
 	const auto startElevation = Angle1f::fromDegrees(rng->getFloat(altitude));
 	
-	auto& particle = particles[index];
-	particle.firstFrame = true;
-	particle.alive = true;
-	particle.time = time;
-	particle.ttl = rng->getFloat(ttl);
-	//particle.angle = rotateTowardsMovement ? startAzimuth : Angle1f();
-	particle.scale = rng->getFloat(initialScale);
-
-	particle.vel = Vector3f(rng->getFloat(speed) * speedMultiplier, startAzimuth, startElevation);
-	const bool stopped = stopTime > 0.00001f && particle.time + stopTime >= particle.ttl;
+	auto& p = particles;
+	p.moving[index] = 0;
+	p.alive[index] = 1;
+	p.time[index] = time;
+	p.ttl[index] = rng->getFloat(ttl);
+	p.scale[index] = rng->getFloat(initialScale);
+
+	const auto vel = Vector3f(rng->getFloat(speed) * speedMultiplier, startAzimuth, startElevation);
+	const bool stopped = stopTime > 0.00001f && time + stopTime >= p.ttl[index];
 	const auto a = stopped ? Vector3f() : acceleration;
 	const auto spawnPosSmear = totalTime > 0.00001f ? lerp(position - lastPosition, Vector3f(), time / totalTime) : Vector3f();
-	particle.pos = getSpawnPosition() + spawnPosSmear + (particle.vel * time + a * (0.5f * time * time)) * velScale;
+	p.setVel(index, vel);
+	p.setPos(index, getSpawnPosition() + spawnPosSmear + (vel * time + a * (0.5f * time * time)) * velScale);
 
 	auto& sprite = sprites[index];
 	if (isAnimated()) {
@@ -461,100 +464,164 @@ void Particles::initializeParticle(size_t index, float time, float totalTime)
 	}
 
 	if (onSpawn) {
-		onSecondarySpawn(particle, onSpawn);
+		onSecondarySpawn(index, onSpawn);
 	}
 }
 
 void Particles::updateParticles(float time)
 {
-	const bool hasAnim = isAnimated();
-
-	for (size_t i = 0; i < nParticlesAlive; ++i) {
-		if (hasAnim) {
+	if (isAnimated()) {
+		for (size_t i = 0; i < nParticlesAlive; ++i) {
 			animationPlayers[i].update(time, sprites[i]);
 		}
+	}
 
-		auto& particle = particles[i];
-
-		particle.time += time;
-		if (particle.time >= particle.ttl) {
-			particle.alive = false;
-		}
-		else {
-			const bool stopped = stopTime > 0.00001f && particle.time + stopTime >= particle.ttl;
-			const auto a = stopped ? Vector3f() : acceleration;
-			if (particle.firstFrame) {
-				particle.firstFrame = false;
-			}
-			else {
-				particle.pos += (particle.vel * time + a * (0.5f * time * time)) * velScale;
-				particle.vel += a * time;
-			}
-
-			if (minHeight && particle.pos.z < minHeight) {
-				particle.alive = false;
-			}
+	integrateParticles(time);
 
-			if (stopped) {
-				particle.vel = damp(particle.vel, Vector3f(), 10.0f, time);
+	if (directionScatter > 0.00001f) {
+		// Needs a random number per particle, so it stays scalar
+		for (size_t i = 0; i < nParticlesAlive; ++i) {
+			if (particles.time[i] < particles.ttl[i]) {
+				const auto vel = Vector2f(particles.velX[i], particles.velY[i]).rotate(Angle1f::fromDegrees(rng->getFloat(-directionScatter * time, directionScatter * time)));
+				particles.velX[i] = vel.x;
+				particles.velY[i] = vel.y;
 			}
+		}
+	}
 
-			if (speedDamp > 0.0001f) {
-				particle.vel = damp(particle.vel, Vector3f(), speedDamp, time);
-			}
+	removeDeadParticles();
+}
 
-			if (directionScatter > 0.00001f) {
-				particle.vel = Vector3f(particle.vel.xy().rotate(Angle1f::fromDegrees(rng->getFloat(-directionScatter * time, directionScatter * time))), particle.vel.z);
+void Particles::integrateParticles(float dt)
+{
+	auto& p = particles;
+	const size_t n = alignUp(nParticlesAlive, size_t(4));
+
+	const auto zero = SIMDVec4::loadZero();
+	const auto one = SIMDVec4::loadSingleValue(1.0f);
+	const auto vdt = SIMDVec4::loadSingleValue(dt);
+	const auto halfDt2 = SIMDVec4::loadSingleValue(0.5f * dt * dt);
+	const auto accX = SIMDVec4::loadSingleValue(acceleration.x);
+	const auto accY = SIMDVec4::loadSingleValue(acceleration.y);
+	const auto accZ = SIMDVec4::loadSingleValue(acceleration.z);
+	const auto scaleX = SIMDVec4::loadSingleValue(velScale.x);
+	const auto scaleY = SIMDVec4::loadSingleValue(velScale.y);
+	const auto scaleZ = SIMDVec4::loadSingleValue(velScale.z);
+
+	// damp(v, 0, lambda, dt) is v * exp(-lambda * dt), so both dampings become per-lane factors
+	const bool hasStopTime = stopTime > 0.00001f;
+	const auto vStopTime = SIMDVec4::loadSingleValue(stopTime);
+	const auto stopDamp = SIMDVec4::loadSingleValue(std::exp(-10.0f * dt));
+	const auto speedDampFactor = SIMDVec4::loadSingleValue(speedDamp > 0.0001f ? std::exp(-speedDamp * dt) : 1.0f);
+	const auto vMinHeight = SIMDVec4::loadSingleValue(minHeight.value_or(-std::numeric_limits<float>::infinity()));
+
+	for (size_t i = 0; i < n; i += 4) {
+		const auto time = SIMDVec4::loadUnaligned(&p.time[i]) + vdt;
+		const auto ttl = SIMDVec4::loadUnaligned(&p.ttl[i]);
+		const auto expired = time.greaterOrEqual(ttl);
+		const auto stopped = hasStopTime ? (time + vStopTime).greaterOrEqual(ttl) : zero;
+		const auto moving = SIMDVec4::loadUnaligned(&p.moving[i]);
+
+		const auto ax = SIMDVec4::select(stopped, zero, accX) * moving;
+		const auto ay = SIMDVec4::select(stopped, zero, accY) * moving;
+		const auto az = SIMDVec4::select(stopped, zero, accZ) * moving;
+		const auto damping = SIMDVec4::select(stopped, stopDamp, one) * speedDampFactor;
+
+		const auto posX = SIMDVec4::loadUnaligned(&p.posX[i]);
+		const auto posY = SIMDVec4::loadUnaligned(&p.posY[i]);
+		const auto posZ = SIMDVec4::loadUnaligned(&p.posZ[i]);
+		const auto velX = SIMDVec4::loadUnaligned(&p.velX[i]);
+		const auto velY = SIMDVec4::loadUnaligned(&p.velY[i]);
+		const auto velZ = SIMDVec4::loadUnaligned(&p.velZ[i]);
+
+		const auto newPosZ = posZ + (velZ * vdt * moving + az * halfDt2) * scaleZ;
+
+		// Expired particles keep their last state, for onDeath
+		SIMDVec4::select(expired, posX, posX + (velX * vdt * moving + ax * halfDt2) * scaleX).storeUnaligned(&p.posX[i]);
+		SIMDVec4::select(expired, posY, posY + (velY * vdt * moving + ay * halfDt2) * scaleY).storeUnaligned(&p.posY[i]);
+		SIMDVec4::select(expired, posZ, newPosZ).storeUnaligned(&p.posZ[i]);
+		SIMDVec4::select(expired, velX, (velX + ax * vdt) * damping).storeUnaligned(&p.velX[i]);
+		SIMDVec4::select(expired, velY, (velY + ay * vdt) * damping).storeUnaligned(&p.velY[i]);
+		SIMDVec4::select(expired, velZ, (velZ + az * vdt) * damping).storeUnaligned(&p.velZ[i]);
+		SIMDVec4::select(expired, moving, one).storeUnaligned(&p.moving[i]);
+		time.storeUnaligned(&p.time[i]);
+
+		const int dead = expired.moveMask() | newPosZ.lessThan(vMinHeight).moveMask();
+		if (dead != 0) {
+			for (size_t j = 0; j < 4; ++j) {
+				if (dead & (1 << j)) {
+					p.alive[i + j] = 0;
+				}
 			}
 		}
 	}
-
-	removeDeadParticles();
 }
 
 void Particles::updateSprites(Time t)
 {
+	auto& p = particles;
+	const size_t n = alignUp(nParticlesAlive, size_t(4));
+
+	// Normalised age of every particle, four at a time
+	if (normalisedTimes.size() < n) {
+		normalisedTimes.resize(p.size());
+	}
+	for (size_t i = 0; i < n; i += 4) {
+		(SIMDVec4::loadUnaligned(&p.time[i]) / SIMDVec4::loadUnaligned(&p.ttl[i])).storeUnaligned(&normalisedTimes[i]);
+	}
+
 	for (size_t i = 0; i < nParticlesAlive; ++i) {
-		const auto& particle = particles[i];
+		const auto pos = Vector2f(p.posX[i], p.posY[i]);
 
 		Angle1f angle;
-		if (rotateTowardsMovement && particle.vel.squaredLength() > 0.001f) {
-			angle = (particle.vel.xy() + Vector2f(0, particle.vel.z)).angle();
+		if (rotateTowardsMovement) {
+			const auto vel = p.getVel(i);
+			if (vel.squaredLength() > 0.001f) {
+				angle = (vel.xy() + Vector2f(0, vel.z)).angle();
+			}
 		}
 
-		const float t = particle.time / particle.ttl;
+		const float time = normalisedTimes[i];
 
 		sprites[i]
-			.setPosition(particle.pos.xy() + Vector2f(0, -particle.pos.z))
+			.setPosition(pos + Vector2f(0, -p.posZ[i]))
 			.setRotation(angle)
-			.setScale(scaleCurve.evaluate(t) * particle.scale)
-			.setColour(colourGradient.evaluatePrecomputed(t))
-			.setCustom1(Vector4f(particle.pos.xy(), 0, 0));
+			.setScale(scaleCurve.evaluate(time) * p.scale[i])
+			.setColour(colourGradient.evaluatePrecomputed(time))
+			.setCustom1(Vector4f(pos, 0, 0));
 	}
 }
 
 void Particles::removeDeadParticles()
 {
-	for (size_t i = 0; i < nParticlesAlive; ) {
-		if (!particles[i].alive) {
-			if (onDeath) {
-				onSecondarySpawn(particles[i], onDeath);
+	if (onDeath) {
+		for (size_t i = 0; i < nParticlesAlive; ++i) {
+			if (!particles.alive[i]) {
+				onSecondarySpawn(i, onDeath);
 			}
+		}
+	}
 
-			if (i != nParticlesAlive - 1) {
-				// Swap with last particle that's alive
-				std::swap(particles[i], particles[nParticlesAlive - 1]);
-				std::swap(sprites[i], sprites[nParticlesAlive - 1]);
-				if (isAnimated()) {
-					std::swap(animationPlayers[i], animationPlayers[nParticlesAlive - 1]);
-				}
+	// Compact in a single pass, filling each dead slot with the last live particle
+	size_t last = nParticlesAlive;
+	for (size_t i = 0; i < last; ++i) {
+		if (particles.alive[i]) {
+			continue;
+		}
+
+		do {
+			--last;
+		} while (last > i && !particles.alive[last]);
+
+		if (last > i) {
+			particles.move(last, i);
+			std::swap(sprites[i], sprites[last]);
+			if (isAnimated()) {
+				std::swap(animationPlayers[i], animationPlayers[last]);
 			}
-			--nParticlesAlive;
-			// Don't increment i here, since i is now a new particle that's still alive
-		} else {
-			++i;
 		}
 	}
+	nParticlesAlive = last;
 }
 
 Vector3f Particles::getSpawnPosition() const
@@ -570,10 +637,10 @@ Vector3f Particles::getSpawnPosition() const
 	return position + Vector3f(pos + spawnPositionOffset, startHeight);
 }
 
-void Particles::onSecondarySpawn(const Particle& particle, EntityId target)
+void Particles::onSecondarySpawn(size_t idx, EntityId target)
 {
 	if (secondarySpawner && target) {
-		secondarySpawner->spawn(particle.pos, target);
+		secondarySpawner->spawn(particles.getPos(idx), target);
 	}
 }
 
@@ -583,13 +650,41 @@ std::optional<Rect4f> Particles::getAABB() const
 		return {};
 	}
 
-	Vector2f minPos = particles[0].pos.xy() + Vector2f(0, -particles[0].pos.z);
+	const auto& p = particles;
+	Vector2f minPos = Vector2f(p.posX[0], p.posY[0] - p.posZ[0]);
 	Vector2f maxPos = minPos;
 
-	for (size_t i = 1; i < nParticlesAlive; ++i) {
-		const auto p = particles[i].pos.xy() + Vector2f(0, -particles[i].pos.z);
-		minPos = Vector2f::min(minPos, p);
-		maxPos = Vector2f::max(maxPos, p);
+	// Four at a time, then the remainder
+	const size_t nSimd = nParticlesAlive & ~size_t(3);
+	if (nSimd > 0) {
+		auto minX = SIMDVec4::loadSingleValue(minPos.x);
+		auto minY = SIMDVec4::loadSingleValue(minPos.y);
+		auto maxX = minX;
+		auto maxY = minY;
+		for (size_t i = 0; i < nSimd; i += 4) {
+			const auto x = SIMDVec4::loadUnaligned(&p.posX[i]);
+			const auto y = SIMDVec4::loadUnaligned(&p.posY[i]) - SIMDVec4::loadUnaligned(&p.posZ[i]);
+			minX = minX.min(x);
+			minY = minY.min(y);
+			maxX = maxX.max(x);
+			maxY = maxY.max(y);
+		}
+
+		alignas(16) float lanes[4][4];
+		minX.storeAligned(lanes[0]);
+		minY.storeAligned(lanes[1]);
+		maxX.storeAligned(lanes[2]);
+		maxY.storeAligned(lanes[3]);
+		for (size_t j = 0; j < 4; ++j) {
+			minPos = Vector2f::min(minPos, Vector2f(lanes[0][j], lanes[1][j]));
+			maxPos = Vector2f::max(maxPos, Vector2f(lanes[2][j], lanes[3][j]));
+		}
+	}
+
+	for (size_t i = nSimd; i < nParticlesAlive; ++i) {
+		const auto pos = Vector2f(p.posX[i], p.posY[i] - p.posZ[i]);
+		minPos = Vector2f::min(minPos, pos);
+		maxPos = Vector2f::max(maxPos, pos);
 	}
 
 	if (!maxBorder) {
@@ -637,3 +732,48 @@ void ConfigNodeSerializer<Particles>::deserialize(const EntitySerializationConte
 	target.load(node, *context.resources, context);
 }
 
+size_t Particles::ParticleArrays::size() const
+{
+	return time.size();
+}
+
+void Particles::ParticleArrays::resize(size_t size)
+{
+	Expects(size % 4 == 0);
+	for (auto* v: { &posX, &posY, &posZ, &velX, &velY, &velZ, &scale, &time, &ttl, &moving }) {
+		v->resize(size);
+	}
+	alive.resize(size);
+}
+
+void Particles::ParticleArrays::move(size_t from, size_t to)
+{
+	for (auto* v: { &posX, &posY, &posZ, &velX, &velY, &velZ, &scale, &time, &ttl, &moving }) {
+		(*v)[to] = (*v)[from];
+	}
+	alive[to] = alive[from];
+}
+
+Vector3f Particles::ParticleArrays::getPos(size_t idx) const
+{
+	return Vector3f(posX[idx], posY[idx], posZ[idx]);
+}
+
+void Particles::ParticleArrays::setPos(size_t idx, Vector3f pos)
+{
+	posX[idx] = pos.x;
+	posY[idx] = pos.y;
+	posZ[idx] = pos.z;
+}
+
+Vector3f Particles::ParticleArrays::getVel(size_t idx) const
+{
+	return Vector3f(velX[idx], velY[idx], velZ[idx]);
+}
+
+void Particles::ParticleArrays::setVel(size_t idx, Vector3f vel)
+{
+	velX[idx] = vel.x;
+	velY[idx] = vel.y;
+	velZ[idx] = vel.z;
+}
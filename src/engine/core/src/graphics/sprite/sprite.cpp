@@ -673,6 +673,13 @@ void Sprite::computeSize()
 	}
 }
 
+void Sprite::copyQuadVertexData(char* dst) const
+{
+	const auto& def = material->getDefinition();
+	Expects(def.getVertexStride() == vertexDataSize);
+	Painter::expandSpriteVertices(getVertexAttrib(), 1, def.getVertexSize(), vertexDataSize, def.getVertexPosOffset(), dst);
+}
+
 const void* Sprite::getVertexAttrib() const
 {
 	return reinterpret_cast<const char*>(&vertexAttrib) - sizeof(Vector4f);
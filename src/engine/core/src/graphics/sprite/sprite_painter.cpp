@@ -6,6 +6,7 @@
 #include "halley/graphics/material/material.h"
 #include "halley/graphics/material/material_definition.h"
 #include "halley/graphics/text/text_renderer.h"
+#include "halley/concurrency/concurrent.h"
 #include "halley/utils/algorithm.h"
 
 using namespace Halley;
@@ -289,11 +290,7 @@ void SpritePainter::add(Rect4f bounds)
 void SpritePainter::draw(int mask, Painter& painter)
 {
 	if (dirty) {
-		// TODO: implement hierarchical bucketing.
-		// - one bucket per layer
-		// - for each layer, one bucket per vertical band of the screen (32px or so)
-		// - sort each leaf bucket
-		std::sort(sprites.begin(), sprites.end()); // lol
+		sortEntries();
 		dirty = false;
 	}
 
@@ -302,22 +299,31 @@ void SpritePainter::draw(int mask, Painter& painter)
 	Rect4f view = cam.getClippingRectangle();
 
 	// Draw!
-	for (auto& s : sprites) {
-		if ((s.getMask() & mask) != 0) {
+	if (parallelRecording) {
+		// Runs of unclipped sprite entries are recorded in parallel, everything else is drawn as usual, in order
+		const auto isRecordable = [] (const SpritePainterEntry& s)
+		{
 			const auto type = s.getType();
-			
-			if (type == SpritePainterEntryType::SpriteRef) {
-				draw(s.getSprites(), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::SpriteCached) {
-				draw(gsl::span<const Sprite>(cachedSprites.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::TextRef) {
-				draw(s.getTexts(), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::TextCached) {
-				draw(gsl::span<const TextRenderer>(cachedText.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::Callback) {
-				draw(callbacks.at(s.getIndex()), painter, s.getClip());
+			return (type == SpritePainterEntryType::SpriteRef || type == SpritePainterEntryType::SpriteCached) && !s.getClip();
+		};
+
+		for (size_t i = 0; i < sprites.size(); ) {
+			if (isRecordable(sprites[i])) {
+				size_t end = i + 1;
+				while (end < sprites.size() && isRecordable(sprites[end])) {
+					++end;
+				}
+				drawRecorded(gsl::span<const SpritePainterEntry>(sprites.data() + i, end - i), mask, painter, view);
+				i = end;
+			} else {
+				draw(sprites[i], mask, painter, view);
+				++i;
 			}
 		}
+	} else {
+		for (auto& s : sprites) {
+			draw(s, mask, painter, view);
+		}
 	}
 	painter.flush();
 }
@@ -379,23 +385,138 @@ void SpritePainter::setWaitForSpriteLoad(bool wait)
 	waitForSpriteLoad = wait;
 }
 
+void SpritePainter::setParallelRecording(bool enabled)
+{
+	parallelRecording = enabled;
+}
+
+void SpritePainter::sortEntries()
+{
+	// TODO: implement hierarchical bucketing.
+	// - one bucket per layer
+	// - for each layer, one bucket per vertical band of the screen (32px or so)
+	// - sort each leaf bucket
+	if (parallelRecording) {
+		// Entries compare on insertOrder last, so this gives exactly the same order as std::sort
+		Concurrent::parallel_sort(sprites.begin(), sprites.end(), 4096);
+	} else {
+		std::sort(sprites.begin(), sprites.end());
+	}
+}
+
+void SpritePainter::drawRecorded(gsl::span<const SpritePainterEntry> entries, int mask, Painter& painter, Rect4f view)
+{
+	recordSprites.clear();
+	for (const auto& s: entries) {
+		if ((s.getMask() & mask) != 0) {
+			const auto span = s.getType() == SpritePainterEntryType::SpriteRef ? s.getSprites() : gsl::span<const Sprite>(cachedSprites.data() + s.getIndex(), s.getCount());
+			for (const auto& sprite: span) {
+				recordSprites.push_back(&sprite);
+			}
+		}
+	}
+	if (recordSprites.empty()) {
+		return;
+	}
+
+	constexpr size_t spritesPerChunk = 1024;
+	const size_t nChunks = (recordSprites.size() + spritesPerChunk - 1) / spritesPerChunk;
+	if (recordChunks.size() < nChunks) {
+		recordChunks.resize(nChunks);
+	}
+
+	Concurrent::parallel_for(0, nChunks, 1, [&] (size_t i)
+	{
+		const size_t start = i * spritesPerChunk;
+		const size_t count = std::min(spritesPerChunk, recordSprites.size() - start);
+		recordChunk(recordChunks[i], gsl::span<const Sprite* const>(recordSprites.data() + start, count), view);
+	});
+
+	// Submit in order. Consecutive batches sharing a material, including across chunk boundaries, get merged by the
+	// painter into a single draw call.
+	for (size_t i = 0; i < nChunks; ++i) {
+		const auto& chunk = recordChunks[i];
+		for (const auto& batch: chunk.batches) {
+			if (batch.direct) {
+				draw(*batch.first, painter, {});
+			} else {
+				painter.drawQuads(batch.first->getMaterialPtr(), batch.count * 4, chunk.vertices.data() + batch.vertexOffset);
+			}
+		}
+	}
+}
+
+void SpritePainter::recordChunk(RecordedChunk& chunk, gsl::span<const Sprite* const> sprites, Rect4f view) const
+{
+	// Vertices are fully expanded here, so the render thread only has to copy each batch into the painter
+	constexpr size_t spriteSize = Sprite::quadVertexDataSize;
+
+	chunk.vertices.clear();
+	chunk.batches.clear();
+	chunk.vertices.reserve(sprites.size() * spriteSize);
+
+	for (const auto* sprite: sprites) {
+		if (!sprite->isInView(view) || !(waitForSpriteLoad || sprite->isLoaded())) {
+			continue;
+		}
+
+		if (!sprite->hasMaterial() || sprite->isSliced() || sprite->getClip() || paramUpdater.needsToPreProcessessMaterial(*sprite)) {
+			chunk.batches.push_back(RecordedBatch{ sprite, 0, 1, true });
+			continue;
+		}
+
+		if (chunk.batches.empty() || chunk.batches.back().direct || chunk.batches.back().first->getMaterialPtr() != sprite->getMaterialPtr()) {
+			chunk.batches.push_back(RecordedBatch{ sprite, chunk.vertices.size(), 0, false });
+		}
+
+		const size_t offset = chunk.vertices.size();
+		chunk.vertices.resize(offset + spriteSize);
+		sprite->copyQuadVertexData(chunk.vertices.data() + offset);
+		++chunk.batches.back().count;
+	}
+}
+
+void SpritePainter::draw(const SpritePainterEntry& s, int mask, Painter& painter, Rect4f view) const
+{
+	if ((s.getMask() & mask) != 0) {
+		const auto type = s.getType();
+		
+		if (type == SpritePainterEntryType::SpriteRef) {
+			draw(s.getSprites(), painter, view, s.getClip());
+		} else if (type == SpritePainterEntryType::SpriteCached) {
+			draw(gsl::span<const Sprite>(cachedSprites.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
+		} else if (type == SpritePainterEntryType::TextRef) {
+			draw(s.getTexts(), painter, view, s.getClip());
+		} else if (type == SpritePainterEntryType::TextCached) {
+			draw(gsl::span<const TextRenderer>(cachedText.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
+		} else if (type == SpritePainterEntryType::Callback) {
+			draw(callbacks.at(s.getIndex()), painter, s.getClip());
+		}
+	}
+}
+
 void SpritePainter::draw(gsl::span<const Sprite> sprites, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const
 {
 	for (const auto& sprite: sprites) {
 		// The logic is a bit confusing here - if we're waiting, just go ahead, as the code will eventually wait
 		// If we're not waiting, skip this sprite if it's not loaded
 		if (sprite.isInView(view) && (waitForSpriteLoad || sprite.isLoaded())) {
-			if (paramUpdater.needsToPreProcessessMaterial(sprite)) {
-				auto s2 = sprite;
-				paramUpdater.preProcessMaterial(s2);
-				s2.draw(painter, clip);
-			} else {
-				sprite.draw(painter, clip);
-			}
+			draw(sprite, painter, clip);
 		}
 	}
 }
 
+void SpritePainter::draw(const Sprite& sprite, Painter& painter, const std::optional<Rect4f>& clip) const
+{
+	if (paramUpdater.needsToPreProcessessMaterial(sprite)) {
+		auto s2 = sprite;
+		paramUpdater.preProcessMaterial(s2);
+		s2.draw(painter, clip);
+	} else {
+		sprite.draw(painter, clip);
+	}
+}
+
 void SpritePainter::draw(gsl::span<const TextRenderer> texts, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const
 {
 	for (const auto& text: texts) {
@@ -486,6 +486,10 @@ std::unique_ptr<Image> SpriteSheet::generateAtlas(Vector<ImageData>& images, Con
 	const int maxSize = 4096;
 	int curSize = std::min(maxSize, std::max(32, static_cast<int>(minSize)));
 
+	// Trying every MaxRects heuristic gets expensive with many sprites, as it runs once per size tried, so large sheets only try one
+	constexpr size_t maxEntriesForTightPack = 512;
+	const bool tightPack = entries.size() <= maxEntriesForTightPack;
+
 	// Try packing
 	bool wide = guessArea > 2 * totalImageArea;
 	while (true) {
@@ -496,8 +500,7 @@ std::unique_ptr<Image> SpriteSheet::generateAtlas(Vector<ImageData>& images, Con
 		}
 
 		//Logger::logInfo("Trying " + toString(size.x) + "x" + toString(size.y) + " px...");
-		//auto res = entries.size() < 50 ? BinPack::pack(entries, size) : BinPack::fastPack(entries, size);
-		auto res = BinPack::fastPack(entries, size);
+		auto res = tightPack ? BinPack::pack(entries, size) : BinPack::quickPack(entries, size);
 		if (res) {
 			// Found a pack
 			return makeAtlas(res.value(), spriteInfo, powerOfTwo);
@@ -666,17 +669,17 @@ size_t SpriteResource::getIdx() const
 
 std::shared_ptr<const SpriteSheet> SpriteResource::getSpriteSheet() const
 {
-	return spriteSheet.lock();
+	return spriteSheet;
 }
 
 std::shared_ptr<Material> SpriteResource::getMaterial(std::string_view name) const
 {
-	return spriteSheet.lock()->getMaterial(name);
+	return spriteSheet->getMaterial(name);
 }
 
 const String& SpriteResource::getDefaultMaterialName() const
 {
-	return spriteSheet.lock()->getDefaultMaterialName();
+	return spriteSheet->getDefaultMaterialName();
 }
 
 std::unique_ptr<SpriteResource> SpriteResource::loadResource(ResourceLoader& loader)
@@ -715,8 +718,7 @@ const String& SpriteResource::getHotReloaderId() const
 
 void SpriteResource::serialize(Serializer& s) const
 {
-	const auto ss = spriteSheet.lock();
-	s << ss->getAssetId();
+	s << spriteSheet->getAssetId();
 	s << idx;
 }
 
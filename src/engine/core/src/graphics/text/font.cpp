@@ -81,6 +81,43 @@ Font::Font(String name, String imageName, float ascender, float height, float si
 {
 }
 
+Font::Font(Font&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+Font& Font::operator=(Font&& other) noexcept
+{
+	Resource::operator=(std::move(other));
+	name = std::move(other.name);
+	imageName = std::move(other.imageName);
+	ascender = other.ascender;
+	height = other.height;
+	sizePt = other.sizePt;
+	smoothRadius = other.smoothRadius;
+	replacementScale = other.replacementScale;
+	imageSize = other.imageSize;
+	distanceField = other.distanceField;
+	fallbackFont = std::move(other.fallbackFont);
+	fallback = std::move(other.fallback);
+	floorGlyphPosition = other.floorGlyphPosition;
+	material = std::move(other.material);
+	glyphs = std::move(other.glyphs);
+
+	// The lookup tables point into glyphs, so they are rebuilt against ours rather than moved
+	denseGlyphs.clear();
+	kerningTable.clear();
+	lookupTablesBuilt = false;
+	if (other.lookupTablesBuilt) {
+		buildLookupTables();
+	}
+	other.denseGlyphs.clear();
+	other.kerningTable.clear();
+	other.lookupTablesBuilt = false;
+
+	return *this;
+}
+
 std::unique_ptr<Font> Font::loadResource(ResourceLoader& loader)
 {
 	auto data = loader.getStatic(false);
@@ -120,23 +157,20 @@ std::pair<const Font::Glyph&, const Font&> Font::getGlyph(int code) const
 
 const Font::Glyph& Font::getGlyphHere(int code) const
 {
-	auto iter = glyphs.find(code);
-	if (iter == glyphs.end()) {
-		iter = glyphs.find(0);
-		if (iter == glyphs.end()) {
-			throw Exception("Unable to load fallback character, needed for character " + toString(code), HalleyExceptions::Graphics);
-		}
-		return iter->second;
+	if (const auto* glyph = findGlyph(code)) {
+		return *glyph;
+	}
+	if (const auto* glyph = findGlyph(0)) {
+		return *glyph;
 	}
-	return iter->second;
+	throw Exception("Unable to load fallback character, needed for character " + toString(code), HalleyExceptions::Graphics);
 }
 
 const Font& Font::getFontForGlyph(int code) const
 {
-	const auto iter = glyphs.find(code);
-	if (iter == glyphs.end()) {
+	if (!findGlyph(code)) {
 		for (const auto& font: fallbackFont) {
-			if (font->glyphs.find(code) != font->glyphs.end()) {
+			if (font->findGlyph(code)) {
 				return *font;
 			}
 		}
@@ -144,6 +178,61 @@ const Font& Font::getFontForGlyph(int code) const
 	return *this;
 }
 
+Vector2f Font::getKerning(int32_t from, int32_t to) const
+{
+	if (!lookupTablesBuilt) {
+		const auto* glyph = findGlyph(from);
+		return glyph ? glyph->getKerning(to) : Vector2f();
+	}
+	if (kerningTable.empty()) {
+		return Vector2f();
+	}
+
+	const auto key = KerningPair{ (uint64_t(uint32_t(from)) << 32) | uint32_t(to), Vector2f() };
+	const auto iter = std::lower_bound(kerningTable.begin(), kerningTable.end(), key);
+	if (iter != kerningTable.end() && iter->key == key.key) {
+		return iter->kerning;
+	}
+	return Vector2f();
+}
+
+const Font::Glyph* Font::findGlyph(int code) const
+{
+	if (code >= 0 && code < static_cast<int>(denseGlyphs.size())) {
+		return denseGlyphs[code];
+	}
+	const auto iter = glyphs.find(code);
+	return iter != glyphs.end() ? &iter->second : nullptr;
+}
+
+void Font::buildLookupTables()
+{
+	// Only as large as the highest dense codepoint actually present
+	int denseSize = 0;
+	size_t nKerning = 0;
+	for (const auto& [code, glyph]: glyphs) {
+		if (code >= 0 && code < denseGlyphRange) {
+			denseSize = std::max(denseSize, code + 1);
+		}
+		nKerning += glyph.kerning.size();
+	}
+
+	denseGlyphs.clear();
+	denseGlyphs.resize(denseSize, nullptr);
+	kerningTable.clear();
+	kerningTable.reserve(nKerning);
+	for (const auto& [code, glyph]: glyphs) {
+		if (code >= 0 && code < denseSize) {
+			denseGlyphs[code] = &glyph;
+		}
+		for (const auto& [next, kerning]: glyph.kerning) {
+			kerningTable.push_back(KerningPair{ (uint64_t(uint32_t(code)) << 32) | uint32_t(next), kerning });
+		}
+	}
+	std::sort(kerningTable.begin(), kerningTable.end());
+	lookupTablesBuilt = true;
+}
+
 float Font::getLineHeightAtSize(float size) const
 {
 	return height * size / sizePt;
@@ -197,6 +286,9 @@ bool Font::shouldFloorGlyphPosition() const
 void Font::addGlyph(const Glyph& glyph)
 {
 	glyphs[glyph.charcode] = glyph;
+	denseGlyphs.clear();
+	kerningTable.clear();
+	lookupTablesBuilt = false;
 }
 
 std::shared_ptr<Material> Font::getMaterial() const
@@ -238,6 +330,7 @@ void Font::deserialize(Deserializer& s)
 	for (auto& g: glyphs) {
 		g.second.charcode = g.first;
 	}
+	buildLookupTables();
 
 	//printGlyphs();
 }
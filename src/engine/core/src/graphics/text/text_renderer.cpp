@@ -2,6 +2,7 @@
 #include "halley/graphics/text/font.h"
 #include "halley/graphics/painter.h"
 #include "halley/graphics/material/material.h"
+#include "halley/graphics/material/material_definition.h"
 #include "halley/graphics/material/material_parameter.h"
 #include <gsl/assert>
 
@@ -10,6 +11,13 @@
 
 using namespace Halley;
 
+namespace {
+	Vector2f floorAlign(Vector2f a, bool enabled)
+	{
+		return enabled ? a.floor() : a;
+	}
+}
+
 TextRenderer::TextRenderer()
 {
 }
@@ -37,6 +45,7 @@ TextRenderer& TextRenderer::setFont(std::shared_ptr<const Font> v)
 {
 	if (font != v) {
 		font = v;
+		glyphsDirty = true;
 
 		if (font->isDistanceField()) {
 			materialDirty = true;
@@ -265,138 +274,190 @@ void TextRenderer::generateSprites(Vector<Sprite>& sprites) const
 		return;
 	}
 
-	bool floorEnabled = font->shouldFloorGlyphPosition();
-	auto floorAlign = [floorEnabled] (Vector2f a) -> Vector2f
-	{
-		if (floorEnabled) {
-			return a.floor();
-		} else {
-			return a;
+	updateLayout();
+
+	sprites.resize(layout.size());
+	size_t i = 0;
+	for (const auto& [material, count]: layoutMaterials) {
+		for (size_t j = 0; j < count; ++j, ++i) {
+			const auto& glyph = layout[i];
+			sprites[i] = Sprite()
+				.setMaterial(material)
+				.setSize(glyph.size)
+				.setTexRect(glyph.texRect)
+				.setColour(glyph.colour)
+				.setPivot(glyph.pivot)
+				.setScale(glyph.scale)
+				.setPos(getGlyphRenderPosition(glyph))
+				.setRotation(angle);
 		}
-	};
+	}
+}
 
-	const bool hasMaterialOverride = font->isDistanceField();
-	if (hasMaterialOverride && materialDirty) {
+void TextRenderer::draw(Painter& painter, const std::optional<Rect4f>& extClip) const
+{
+	if (!font) {
+		return;
+	}
+
+	const std::optional<Rect4f> myClip = clip ? clip.value() + position : std::optional<Rect4f>();
+	const auto finalClip = Rect4f::optionalIntersect(myClip, extClip);
+	if (finalClip) {
+		painter.setRelativeClip(finalClip.value());
+	}
+
+	if (spriteFilter) {
+		// We don't know what the user will do with glyphs, so they're regenerated from the layout every time
+		generateSprites(spritesCache);
+		spriteFilter(gsl::span<Sprite>(spritesCache.data(), spritesCache.size()));
+		Sprite::drawMixedMaterials(spritesCache.data(), spritesCache.size(), painter);
+	} else {
+		updateLayout();
+		generateQuads();
+
+		size_t start = 0;
+		for (const auto& [material, count]: layoutMaterials) {
+			Expects(material->getDefinition().getVertexStride() == sizeof(GlyphQuad));
+			painter.drawSprites(material, count, quadsCache.data() + start);
+			start += count;
+		}
+	}
+
+	if (finalClip) {
+		painter.setClip();
+	}
+}
+
+void TextRenderer::updateLayout() const
+{
+	if (font->isDistanceField() && materialDirty) {
 		updateMaterials();
 		materialDirty = false;
 	}
 
-	if (glyphsDirty || positionDirty) {
-		float mainScale = getScale(*font);
-		Vector2f p = floorAlign(position + Vector2f(0, font->getAscenderDistance() * mainScale));
-		if (offset != Vector2f(0, 0)) {
-			p -= floorAlign(getExtents() * offset);
-		}
+	if (glyphsDirty) {
+		generateLayout();
+		glyphsDirty = false;
+		positionDirty = true;
+	}
 
-		size_t startPos = 0;
-		size_t spritesInserted = 0;
-		Vector2f lineOffset;
-
-		auto flush = [&] ()
-		{
-			// Line break, update previous characters!
-			if (align != 0) {
-				Vector2f off = floorAlign(-lineOffset * align).rotate(angle);
-				for (size_t j = startPos; j < spritesInserted; j++) {
-					auto& sprite = sprites[j];
-					sprite.setPos(sprite.getPosition() + off);
-				}
-			}
+	if (positionDirty) {
+		const float mainScale = getScale(*font);
+		penStart = floorAlign(position + Vector2f(0, font->getAscenderDistance() * mainScale), font->shouldFloorGlyphPosition()) - layoutAnchor;
+		positionDirty = false;
+		++layoutVersion;
+	}
+}
 
-			// Move pen
-			p.y += getLineHeight();
+void TextRenderer::generateLayout() const
+{
+	layout.clear();
+	layoutMaterials.clear();
 
-			// Reset
-			startPos = spritesInserted;
-			lineOffset.x = 0;
-		};
+	const bool floorEnabled = font->shouldFloorGlyphPosition();
+	const bool hasMaterialOverride = font->isDistanceField();
 
-		auto curCol = colour;
-		size_t curOverride = 0;
+	layoutAnchor = offset != Vector2f(0, 0) ? floorAlign(getExtents() * offset, floorEnabled) : Vector2f();
 
-		const size_t n = text.size();
+	// Everything here is relative to the pen start
+	Vector2f p;
+	size_t startPos = 0;
+	Vector2f lineOffset;
 
-		size_t nGlyphs = 0;
-		for (size_t i = 0; i < n; i++) {
-			if (text[i] != '\n') {
-				++nGlyphs;
+	auto flush = [&] ()
+	{
+		// Line break, update previous characters!
+		if (align != 0) {
+			const Vector2f off = floorAlign(-lineOffset * align, floorEnabled);
+			for (size_t j = startPos; j < layout.size(); j++) {
+				layout[j].offset += off;
 			}
 		}
-		sprites.resize(nGlyphs);
 
-		const Font::Glyph* lastGlyph = nullptr;
-		const Font* lastFont = nullptr;
+		// Move pen
+		p.y += getLineHeight();
 
-		for (size_t i = 0; i < n; i++) {
-			int c = text[i];
+		// Reset
+		startPos = layout.size();
+		lineOffset.x = 0;
+	};
+
+	auto curCol = colour;
+	size_t curOverride = 0;
+
+	const size_t n = text.size();
+	layout.reserve(n);
+
+	const Font::Glyph* lastGlyph = nullptr;
+	const Font* lastGlyphFont = nullptr;
 
-			// Check for colour override
-			while (curOverride < colourOverrides.size() && colourOverrides[curOverride].first == i) {
-				curCol = colourOverrides[curOverride].second ? colourOverrides[curOverride].second.value() : colour;
-				++curOverride;
+	for (size_t i = 0; i < n; i++) {
+		int c = text[i];
+
+		// Check for colour override
+		while (curOverride < colourOverrides.size() && colourOverrides[curOverride].first == i) {
+			curCol = colourOverrides[curOverride].second ? colourOverrides[curOverride].second.value() : colour;
+			++curOverride;
+		}
+		
+		if (c == '\n') {
+			flush();
+		} else {
+			const auto& [glyph, fontForGlyph] = font->getGlyph(c);
+			const float scale = getScale(fontForGlyph);
+			const auto fontAdjustment = floorAlign(Vector2f(0, fontForGlyph.getAscenderDistance() - font->getAscenderDistance()) * scale, floorEnabled);
+
+			const auto kerning = lastGlyph ? lastGlyphFont->getKerning(lastGlyph->charcode, c) : Vector2f();
+			const auto glyphPos = p + lineOffset + pixelOffset + fontAdjustment + kerning * scale;
+
+			layout.push_back(GlyphLayout{ glyphPos, glyph.size, glyph.horizontalBearing / glyph.size * Vector2f(-1, 1), glyph.area, scale, curCol });
+
+			auto material = hasMaterialOverride ? getMaterial(fontForGlyph) : fontForGlyph.getMaterial();
+			if (layoutMaterials.empty() || layoutMaterials.back().first != material) {
+				layoutMaterials.emplace_back(std::move(material), 0);
 			}
-			
-			if (c == '\n') {
+			++layoutMaterials.back().second;
+
+			lineOffset.x += (glyph.advance.x + kerning.x) * scale;
+
+			lastGlyph = &glyph;
+			lastGlyphFont = &fontForGlyph;
+
+			if (i == n - 1) {
 				flush();
-			} else {
-				const auto& [glyph, fontForGlyph] = font->getGlyph(c);
-				const float scale = getScale(fontForGlyph);
-				const auto fontAdjustment = floorAlign(Vector2f(0, fontForGlyph.getAscenderDistance() - font->getAscenderDistance()) * scale);
-
-				const auto kerning = lastGlyph && lastFont == font.get() ? lastGlyph->getKerning(c) : Vector2f();
-				const auto glyphPos = p + lineOffset + pixelOffset + fontAdjustment + kerning * scale;
-				const auto renderPos = (glyphPos - position).rotate(angle) + position;
-
-				std::shared_ptr<Material> materialToUse = hasMaterialOverride ? getMaterial(fontForGlyph) : fontForGlyph.getMaterial();
-
-				sprites[spritesInserted++] = Sprite()
-					.setMaterial(std::move(materialToUse))
-					.setSize(glyph.size)
-					.setTexRect(glyph.area)
-					.setColour(curCol)
-					.setPivot(glyph.horizontalBearing / glyph.size * Vector2f(-1, 1))
-					.setScale(scale)
-					.setPos(renderPos)
-					.setRotation(angle);
-
-				lineOffset.x += (glyph.advance.x + kerning.x) * scale;
-
-				lastGlyph = &glyph;
-				lastFont = font.get();
-
-				if (i == n - 1) {
-					flush();
-				}
 			}
 		}
-
-		glyphsDirty = false;
-		positionDirty = false;
 	}
 }
 
-void TextRenderer::draw(Painter& painter, const std::optional<Rect4f>& extClip) const
+void TextRenderer::generateQuads() const
 {
-	generateSprites(spritesCache);
+	static_assert(sizeof(GlyphQuad) == Sprite::vertexDataSize);
 
-	if (spriteFilter) {
-		// We don't know what the user will do with glyphs, so mark them as dirty
-		spriteFilter(gsl::span<Sprite>(spritesCache.data(), spritesCache.size()));
-		glyphsDirty = true;
-		positionDirty = true;
+	if (quadsVersion == layoutVersion) {
+		return;
 	}
 
-	const std::optional<Rect4f> myClip = clip ? clip.value() + position : std::optional<Rect4f>();
-	const auto finalClip = Rect4f::optionalIntersect(myClip, extClip);
-	if (finalClip) {
-		painter.setRelativeClip(finalClip.value());
+	const float rotation = angle.getRadians();
+	quadsCache.resize(layout.size());
+	for (size_t i = 0; i < layout.size(); ++i) {
+		const auto& glyph = layout[i];
+		auto& attrib = quadsCache[i].attrib;
+		attrib = SpriteVertexAttrib();
+		attrib.pos = getGlyphRenderPosition(glyph);
+		attrib.pivot = glyph.pivot;
+		attrib.size = glyph.size;
+		attrib.scale = Vector2f(glyph.scale, glyph.scale);
+		attrib.colour = glyph.colour;
+		attrib.texRect0 = glyph.texRect.toVector4();
+		attrib.rotation = rotation;
 	}
-	
-	Sprite::drawMixedMaterials(spritesCache.data(), spritesCache.size(), painter);
+	quadsVersion = layoutVersion;
+}
 
-	if (finalClip) {
-		painter.setClip();
-	}
+Vector2f TextRenderer::getGlyphRenderPosition(const GlyphLayout& glyph) const
+{
+	return (penStart + glyph.offset - position).rotate(angle) + position;
 }
 
 void TextRenderer::setSpriteFilter(SpriteFilter f)
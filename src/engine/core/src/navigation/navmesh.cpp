@@ -386,6 +386,31 @@ Vector<Navmesh::NodeAndConn> Navmesh::makeResult(const Vector<State>& state, int
 	return result;
 }
 
+void Navmesh::Scratch::begin(size_t nNodes)
+{
+	if (state.size() < nNodes) {
+		state.resize(nNodes);
+	}
+	if (++generation == 0) {
+		// Wrapped around, old entries could look current
+		for (auto& s: state) {
+			s.generation = 0;
+		}
+		generation = 1;
+	}
+	openSet.clear();
+}
+
+Navmesh::State& Navmesh::Scratch::get(size_t id)
+{
+	auto& s = state[id];
+	if (s.generation != generation) {
+		s = State();
+		s.generation = generation;
+	}
+	return s;
+}
+
 std::optional<Vector<Navmesh::NodeAndConn>> Navmesh::pathfind(int fromId, int toId) const
 {
 	// Ensure the query is valid
@@ -394,13 +419,9 @@ std::optional<Vector<Navmesh::NodeAndConn>> Navmesh::pathfind(int fromId, int to
 		return {};
 	}
 
-	// State map. Using vector for perf, trading space for CPU.
-	// TODO: measure this vs unordered_map or some other hashtable, it's not impossible that it'd perform better (compact memory)
-	Vector<State> state(nodes.size(), State{});
-
-	// Open set
-	auto openSet = PriorityQueue<NodeId, NodeComparator>(NodeComparator(state));
-	openSet.reserve(std::min(static_cast<size_t>(100), nodes.size()));
+	thread_local Scratch scratch;
+	scratch.begin(nodes.size());
+	auto& openSet = scratch.openSet;
 
 	// Define heuristic function
 	const Vector2f endPos = nodes[toId].pos;
@@ -412,45 +433,43 @@ std::optional<Vector<Navmesh::NodeAndConn>> Navmesh::pathfind(int fromId, int to
 
 	// Initialize the query
 	{
-		auto& firstNodeState = state[fromId];
+		auto& firstNodeState = scratch.get(fromId);
 		firstNodeState.cameFrom = NodeAndConn();
 		firstNodeState.gScore = 0;
 		firstNodeState.fScore = h(nodes[fromId].pos);
-		firstNodeState.inOpenSet = true;
-		openSet.push(fromId);
+		openSet.push(OpenNode{ firstNodeState.fScore, static_cast<NodeId>(fromId) });
 	}
 
 	// Run A*
+	// Nodes are pushed again when their score improves rather than updated in place, so stale entries are skipped when popped
 	while (!openSet.empty()) {
-		const auto curId = openSet.top();
+		const auto curId = openSet.top().id;
+		openSet.pop();
+
+		auto& curState = scratch.get(curId);
+		if (curState.inClosedSet) {
+			continue;
+		}
 		if (curId == toId) {
 			// Done!
-			return makeResult(state, fromId, toId);
+			return makeResult(scratch.state, fromId, toId);
 		}
-
-		state[curId].inOpenSet = false;
-		state[curId].inClosedSet = true;
-		openSet.pop();
+		curState.inClosedSet = true;
 		
-		const float gScore = state[curId].gScore;
+		const float gScore = curState.gScore;
 		const auto& curNode = nodes[curId];
 		for (size_t i = 0; i < curNode.nConnections; ++i) {
 			if (curNode.connections[i]) {
 				const auto nodeId = curNode.connections[i].value();
-				if (!state[nodeId].inClosedSet) {
-					auto& neighState = state[nodeId];
+				auto& neighState = scratch.get(nodeId);
+				if (!neighState.inClosedSet) {
 					const float neighScore = gScore + curNode.costs[i];
 
 					if (neighScore < neighState.gScore) {
 						neighState.cameFrom = NodeAndConn(curId, static_cast<uint16_t>(i));
 						neighState.gScore = neighScore;
 						neighState.fScore = neighScore + h(nodes[nodeId].pos);
-						if (!neighState.inOpenSet) {
-							neighState.inOpenSet = true;
-							openSet.push(nodeId);
-						} else {
-							openSet.update(nodeId);
-						}
+						openSet.push(OpenNode{ neighState.fScore, nodeId });
 					}
 				}
 			}
@@ -0,0 +1,63 @@
+#include "halley/navigation/navmesh_query_service.h"
+
+#include "halley/concurrency/concurrent.h"
+#include "halley/support/logger.h"
+using namespace Halley;
+
+NavmeshQueryService::NavmeshQueryService(std::shared_ptr<const NavmeshSet> navmeshSet)
+	: NavmeshQueryService(std::move(navmeshSet), ExecutionQueue::getDefault())
+{
+}
+
+NavmeshQueryService::NavmeshQueryService(std::shared_ptr<const NavmeshSet> navmeshSet, ExecutionQueue& queue)
+	: navmeshSet(std::move(navmeshSet))
+	, queue(queue)
+{
+}
+
+void NavmeshQueryService::setNavmeshSet(std::shared_ptr<const NavmeshSet> set)
+{
+	navmeshSet = std::move(set);
+}
+
+Future<std::optional<NavigationPath>> NavmeshQueryService::request(NavigationQuery query, float anisotropy, float nudge)
+{
+	auto& req = pending.emplace_back(Request{ std::move(query), anisotropy, nudge, {} });
+	return req.promise.getFuture();
+}
+
+Future<void> NavmeshQueryService::dispatch()
+{
+	if (pending.empty()) {
+		return Future<void>::makeImmediate(VoidWrapper());
+	}
+
+	Expects(navmeshSet);
+
+	auto batch = std::move(pending);
+	pending.clear();
+
+	// The batch task owns the requests and keeps the navmesh set alive until it's done
+	return Concurrent::execute(queue, [&queue = queue, set = navmeshSet, batch = std::move(batch)] () mutable
+	{
+		Concurrent::parallel_for(queue, 0, batch.size(), 4, [&] (size_t i)
+		{
+			// Every promise must be fulfilled, even if its query fails, or whoever waits on it will hang
+			auto& req = batch[i];
+			std::optional<NavigationPath> path;
+			try {
+				path = set->pathfind(req.query, nullptr, req.anisotropy, req.nudge);
+			} catch (const std::exception& e) {
+				Logger::logException(e);
+			} catch (...) {
+				Logger::logError("Unknown exception in navmesh query.");
+			}
+			req.promise.setValue(std::move(path));
+		});
+	});
+}
+
+size_t NavmeshQueryService::getNumPending() const
+{
+	return pending.size();
+}
@@ -73,11 +73,13 @@ void NavmeshSet::addRaw(NavmeshSet navmeshSet)
 void NavmeshSet::clear()
 {
 	navmeshes.clear();
+	portalPathCache.clear();
 }
 
 void NavmeshSet::clearSubWorld(int subWorld)
 {
 	navmeshes.erase(std::remove_if(navmeshes.begin(), navmeshes.end(), [&] (const Navmesh& nav) { return nav.getSubWorld() == subWorld; }), navmeshes.end());
+	portalPathCache.clear();
 }
 
 std::optional<NavigationPath> NavmeshSet::pathfind(const NavigationQuery& query, String* errorOut, float anisotropy, float nudge) const
@@ -214,6 +216,7 @@ void NavmeshSet::linkNavmeshes()
 	regionNodes.clear();
 	regionNodes.resize(navmeshes.size());
 	portalNodes.clear();
+	portalPathCache.clear();
 
 	for (auto& navmesh: navmeshes) {
 		navmesh.markPortalsDisconnected();
@@ -237,8 +240,9 @@ void NavmeshSet::linkNavmeshes()
 		
 		portalNode.connections.reserve(dstRegion.portals.size() - 1);
 		for (size_t i = 0; i < dstRegion.portals.size(); ++i) {
-			if (curPortalId != portalNode.toPortal) {
-				const auto dstPortalId = dstRegion.portals[i];
+			// Skip the twin of this portal, which only leads back to where we came from
+			const auto dstPortalId = dstRegion.portals[i];
+			if (dstPortalId != (curPortalId ^ 1)) {
 				const auto& other = portalNodes[dstPortalId];
 				portalNode.connections.emplace_back(dstPortalId, portalNode.toRegion, (other.pos - curPos).length());
 			}
@@ -341,87 +345,127 @@ Vector<NavmeshSet::NodeAndConn> NavmeshSet::findRegionPath(Vector2f startPos, Ve
 		return {};
 	}
 
-	// State map. Using vector for perf, trading space for CPU.
-	// TODO: measure this vs unordered_map or some other hashtable, it's not impossible that it'd perform better (compact memory)
-	Vector<State> state(portalNodes.size(), State{});
-
-	// Open set
-	auto openSet = PriorityQueue<NodeId, NodeComparator>(NodeComparator(state));
-	openSet.reserve(std::min(static_cast<size_t>(100), portalNodes.size()));
-
-	// Define heuristic function
-	auto h = [&] (Vector2f pos) -> float
-	{
-		return (pos - endPos).length();
-	};
-
-	// Initialize the query
-	{
-		const auto& startRegion = regionNodes[fromRegionId];
-		for (const auto portalId : startRegion.portals) {
-			auto& nodeState = state[portalId];
-			const auto pos = portalNodes[portalId].pos;
-			nodeState.cameFrom = std::numeric_limits<uint16_t>::max();
-			nodeState.gScore = (pos - startPos).length();
-			nodeState.fScore = h(pos);
-			nodeState.inOpenSet = true;
-			openSet.push(portalId);
+	// Portals are created in pairs, so the ones leading into the destination are the twins of the ones leading out of it
+	constexpr auto noPortal = std::numeric_limits<uint16_t>::max();
+	float bestCost = std::numeric_limits<float>::infinity();
+	NodeId bestStart = noPortal;
+	NodeId bestEnd = noPortal;
+	std::shared_ptr<const PortalTree> bestTree;
+
+	for (const auto startId: regionNodes[fromRegionId].portals) {
+		auto tree = getPortalTree(startId);
+		const float startCost = (portalNodes[startId].pos - startPos).length();
+		for (const auto exitId: regionNodes[toRegionId].portals) {
+			const NodeId endId = exitId ^ 1;
+			const float cost = startCost + tree->costs[endId] + (portalNodes[endId].pos - endPos).length();
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestStart = startId;
+				bestEnd = endId;
+				bestTree = tree;
+			}
 		}
 	}
 
-	// Run A*
-	while (!openSet.empty()) {
-		const auto curId = openSet.top();
-		const auto& curNode = portalNodes[curId];
-		if (curNode.toRegion == toRegionId) {
-			// A* is done! Generate result and return it
-			Vector<NodeAndConn> result;
-			uint16_t portal = std::numeric_limits<uint16_t>::max();
-			for (uint16_t i = curId; true;) {
-				const auto& nodeData = portalNodes[i];
-				result.push_back(NodeAndConn(nodeData.toRegion, portal));
-				portal = nodeData.fromPortal;
-				
-				i = state[i].cameFrom;
-				if (i == std::numeric_limits<uint16_t>::max()) {
-					result.push_back(NodeAndConn(fromRegionId, portal));
-					break;
-				}
-			}
-			std::reverse(result.begin(), result.end());
-			return result;
+	if (!bestTree) {
+		return {};
+	}
+
+	Vector<NodeAndConn> result;
+	uint16_t portal = noPortal;
+	for (NodeId i = bestEnd; true; i = bestTree->cameFrom[i]) {
+		const auto& nodeData = portalNodes[i];
+		result.push_back(NodeAndConn(nodeData.toRegion, portal));
+		portal = nodeData.fromPortal;
+
+		if (i == bestStart) {
+			result.push_back(NodeAndConn(fromRegionId, portal));
+			break;
 		}
+	}
+	std::reverse(result.begin(), result.end());
+	return result;
+}
+
+std::shared_ptr<const NavmeshSet::PortalTree> NavmeshSet::getPortalTree(NodeId startId) const
+{
+	if (auto tree = portalPathCache.get(startId)) {
+		return tree;
+	}
+
+	// Not cached, run Dijkstra from this portal to everywhere
+	auto tree = std::make_shared<PortalTree>();
+	tree->costs.resize(portalNodes.size(), std::numeric_limits<float>::infinity());
+	tree->cameFrom.resize(portalNodes.size(), std::numeric_limits<uint16_t>::max());
 
-		// Process current node
-		state[curId].inOpenSet = false;
-		state[curId].inClosedSet = true;
+	thread_local PriorityQueue<OpenNode, std::less<>> openSet(std::less<>{});
+	openSet.clear();
+
+	tree->costs[startId] = 0;
+	openSet.push(OpenNode{ 0, startId });
+
+	while (!openSet.empty()) {
+		const auto cur = openSet.top();
 		openSet.pop();
+		if (cur.cost > tree->costs[cur.id]) {
+			// Stale entry, this node was reached more cheaply since it was pushed
+			continue;
+		}
 
-		// Process neighbours
-		const float gScore = state[curId].gScore;
-		for (size_t i = 0; i < curNode.connections.size(); ++i) {
-			const auto nodeId = curNode.connections[i].portalId;
-			if (!state[nodeId].inClosedSet) {
-				auto& neighState = state[nodeId];
-				const float neighScore = gScore + curNode.connections[i].cost;
-
-				// This neighbour needs updating
-				if (neighScore < neighState.gScore) {
-					neighState.cameFrom = curId;
-					neighState.gScore = neighScore;
-					neighState.fScore = neighScore + h(portalNodes[nodeId].pos);
-					if (!neighState.inOpenSet) {
-						neighState.inOpenSet = true;
-						openSet.push(nodeId);
-					} else {
-						openSet.update(nodeId);
-					}
-				}
+		for (const auto& conn: portalNodes[cur.id].connections) {
+			const float cost = cur.cost + conn.cost;
+			if (cost < tree->costs[conn.portalId]) {
+				tree->costs[conn.portalId] = cost;
+				tree->cameFrom[conn.portalId] = cur.id;
+				openSet.push(OpenNode{ cost, conn.portalId });
 			}
 		}
 	}
-	
-	return {};
+
+	portalPathCache.put(startId, tree);
+	return tree;
+}
+
+NavmeshSet::PortalPathCache& NavmeshSet::PortalPathCache::operator=(const PortalPathCache&)
+{
+	clear();
+	return *this;
+}
+
+std::shared_ptr<const NavmeshSet::PortalTree> NavmeshSet::PortalPathCache::get(NodeId portalId) const
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	const auto iter = trees.find(portalId);
+	return iter != trees.end() ? iter->second : nullptr;
+}
+
+void NavmeshSet::PortalPathCache::put(NodeId portalId, std::shared_ptr<const PortalTree> tree)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (trees.find(portalId) != trees.end()) {
+		// Another thread got here first
+		return;
+	}
+
+	if (insertionOrder.size() >= maxTrees) {
+		trees.erase(insertionOrder.front());
+		insertionOrder.erase(insertionOrder.begin());
+	}
+	trees[portalId] = std::move(tree);
+	insertionOrder.push_back(portalId);
+}
+
+void NavmeshSet::PortalPathCache::clear()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	trees.clear();
+	insertionOrder.clear();
+}
+
+size_t NavmeshSet::PortalPathCache::size() const
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return trees.size();
 }
 
 std::pair<uint16_t, uint16_t> NavmeshSet::getPortalDestination(uint16_t region, uint16_t edge) const
@@ -441,3 +485,8 @@ std::pair<uint16_t, uint16_t> NavmeshSet::getPortalDestination(uint16_t region,
 	
 	return { maxVal, maxVal };
 }
+
+size_t NavmeshSet::getNumCachedPortalTrees() const
+{
+	return portalPathCache.size();
+}
@@ -38,7 +38,7 @@ size_t NetworkPacketBase::getSize() const
 
 gsl::span<const gsl::byte> NetworkPacketBase::getBytes() const
 {
-	return gsl::span<const gsl::byte>(data).subspan(dataStart, getSize());
+	return gsl::as_bytes(gsl::span<const Byte>(data)).subspan(dataStart, getSize());
 }
 
 OutboundNetworkPacket::OutboundNetworkPacket(const OutboundNetworkPacket& other)
@@ -56,12 +56,12 @@ OutboundNetworkPacket::OutboundNetworkPacket(OutboundNetworkPacket&& other) noex
 }
 
 OutboundNetworkPacket::OutboundNetworkPacket(gsl::span<const gsl::byte> data)
-	: NetworkPacketBase(data, 128)
+	: NetworkPacketBase(data, headerSpace)
 {
 }
 
 OutboundNetworkPacket::OutboundNetworkPacket(const Bytes& data)
-	: NetworkPacketBase(gsl::as_bytes(gsl::span<const Byte>(data)), 128)
+	: NetworkPacketBase(gsl::as_bytes(gsl::span<const Byte>(data)), headerSpace)
 {
 }
 
@@ -0,0 +1,499 @@
+#include "halley/net/entity/entity_network_delta_codec.h"
+
+#include <cstring>
+#include "halley/entity/ecs_reflection.h"
+#include "halley/entity/entity_data.h"
+#include "halley/entity/entity_data_delta.h"
+#include "halley/entity/world_reflection.h"
+#include "halley/support/exception.h"
+
+using namespace Halley;
+
+namespace {
+	constexpr uint8_t xorFlag = 0x40; // Value is coded against the baseline
+	constexpr uint8_t genericTag = 0x3F; // Value is a plain ConfigNode
+	constexpr size_t maxMaskFields = 64;
+
+	enum class ComponentEncoding : uint8_t {
+		Generic,
+		Map,
+		DeltaMap
+	};
+
+	uint32_t floatToBits(float value)
+	{
+		uint32_t result;
+		std::memcpy(&result, &value, sizeof(result));
+		return result;
+	}
+
+	float bitsToFloat(uint32_t bits)
+	{
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	// Close or quantized values share the sign, exponent and top of the mantissa, so the XOR is mostly zeros;
+	// strip the trailing zeros and store the rest as a varint
+	void writeFloatXor(Serializer& s, float value, float baseline)
+	{
+		uint32_t bits = floatToBits(value) ^ floatToBits(baseline);
+		if (bits == 0) {
+			s << uint8_t(32);
+			return;
+		}
+		uint8_t trailing = 0;
+		while ((bits & 1) == 0) {
+			bits >>= 1;
+			++trailing;
+		}
+		s << trailing << bits;
+	}
+
+	float readFloatXor(Deserializer& s, float baseline)
+	{
+		uint8_t trailing;
+		s >> trailing;
+		if (trailing >= 32) {
+			return baseline;
+		}
+		uint32_t bits;
+		s >> bits;
+		return bitsToFloat((bits << trailing) ^ floatToBits(baseline));
+	}
+
+	const ConfigNode* tryGetBaselineComponent(const EntityData& baseline, const String& name)
+	{
+		for (const auto& [compName, data]: baseline.getComponents()) {
+			if (compName == name) {
+				return &data;
+			}
+		}
+		return nullptr;
+	}
+
+	const ConfigNode* tryGetBaselineField(const ConfigNode* component, const String& field)
+	{
+		if (component && (component->getType() == ConfigNodeType::Map || component->getType() == ConfigNodeType::DeltaMap)) {
+			const auto& map = component->asMap();
+			const auto iter = map.find(field);
+			if (iter != map.end()) {
+				return &iter->second;
+			}
+		}
+		return nullptr;
+	}
+}
+
+EntityNetworkDeltaCodec::EntityNetworkDeltaCodec(Mode mode, const WorldReflection& reflection, SerializerOptions options)
+	: mode(mode)
+	, options(std::move(options))
+{
+	const auto n = reflection.getNumComponents();
+	componentNames.reserve(n);
+	componentFields.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		const auto& reflector = reflection.getComponentReflector(static_cast<int>(i));
+		componentIds[reflector.getName()] = static_cast<int>(i);
+		componentNames.push_back(reflector.getName());
+
+		auto& fields = componentFields.emplace_back();
+		for (const auto* field: reflector.getNetworkFieldNames()) {
+			fields.push_back(field);
+		}
+	}
+}
+
+EntityNetworkDeltaCodec::Mode EntityNetworkDeltaCodec::getMode() const
+{
+	return mode;
+}
+
+Bytes EntityNetworkDeltaCodec::encode(const EntityDataDelta& delta, const EntityData& baseline) const
+{
+	if (mode == Mode::ConfigNode) {
+		return Serializer::toBytes(delta, options);
+	}
+
+	return Serializer::toBytes([&] (Serializer& s)
+	{
+		encodeDelta(s, delta, baseline);
+	}, options);
+}
+
+EntityDataDelta EntityNetworkDeltaCodec::decode(gsl::span<const gsl::byte> bytes, const EntityData& baseline) const
+{
+	if (mode == Mode::ConfigNode) {
+		return Deserializer::fromBytes<EntityDataDelta>(bytes, options);
+	}
+
+	EntityDataDelta result;
+	Deserializer s(bytes, options);
+	decodeDelta(s, result, baseline);
+	return result;
+}
+
+void EntityNetworkDeltaCodec::encodeDelta(Serializer& s, const EntityDataDelta& delta, const EntityData& baseline) const
+{
+	using FieldId = EntityDataDelta::FieldId;
+
+	const uint16_t fieldsPresent = delta.getFieldsPresent();
+	s << fieldsPresent;
+
+	auto encodeField = [&] (auto& v, FieldId id)
+	{
+		if (EntityDataDelta::isFieldPresent(fieldsPresent, id)) {
+			s << v;
+		}
+	};
+
+	auto encodeOptField = [&] (auto& v, FieldId id)
+	{
+		if (EntityDataDelta::isFieldPresent(fieldsPresent, id)) {
+			s << v.value();
+		}
+	};
+
+	// Same layout as EntityDataDelta::serialize, except for components
+	encodeOptField(delta.name, FieldId::Name);
+	encodeOptField(delta.prefab, FieldId::Prefab);
+	encodeOptField(delta.instanceUUID, FieldId::InstanceUUID);
+	encodeOptField(delta.prefabUUID, FieldId::PrefabUUID);
+	encodeOptField(delta.parentUUID, FieldId::ParentUUID);
+	encodeField(delta.childrenChanged, FieldId::ChildrenChanged);
+	encodeField(delta.childrenAdded, FieldId::ChildrenAdded);
+	encodeField(delta.childrenRemoved, FieldId::ChildrenRemoved);
+	encodeField(delta.childrenOrder, FieldId::ChildrenOrder);
+	if (EntityDataDelta::isFieldPresent(fieldsPresent, FieldId::ComponentsChanged)) {
+		s << static_cast<uint32_t>(delta.componentsChanged.size());
+		for (const auto& [name, data]: delta.componentsChanged) {
+			encodeComponent(s, name, data, tryGetBaselineComponent(baseline, name));
+		}
+	}
+	encodeField(delta.componentsRemoved, FieldId::ComponentsRemoved);
+	encodeField(delta.componentOrder, FieldId::ComponentsOrder);
+	encodeOptField(delta.icon, FieldId::Icon);
+	encodeOptField(delta.flags, FieldId::Flags);
+	encodeOptField(delta.variant, FieldId::Variant);
+}
+
+void EntityNetworkDeltaCodec::decodeDelta(Deserializer& s, EntityDataDelta& delta, const EntityData& baseline) const
+{
+	using FieldId = EntityDataDelta::FieldId;
+
+	uint16_t fieldsPresent;
+	s >> fieldsPresent;
+
+	auto decodeField = [&] (auto& v, FieldId id)
+	{
+		if (EntityDataDelta::isFieldPresent(fieldsPresent, id)) {
+			s >> v;
+		}
+	};
+
+	auto decodeOptField = [&] (auto& v, FieldId id)
+	{
+		if (EntityDataDelta::isFieldPresent(fieldsPresent, id)) {
+			std::remove_reference_t<decltype(*v)> tmp;
+			s >> tmp;
+			v = std::move(tmp);
+		}
+	};
+
+	decodeOptField(delta.name, FieldId::Name);
+	decodeOptField(delta.prefab, FieldId::Prefab);
+	decodeOptField(delta.instanceUUID, FieldId::InstanceUUID);
+	decodeOptField(delta.prefabUUID, FieldId::PrefabUUID);
+	decodeOptField(delta.parentUUID, FieldId::ParentUUID);
+	decodeField(delta.childrenChanged, FieldId::ChildrenChanged);
+	decodeField(delta.childrenAdded, FieldId::ChildrenAdded);
+	decodeField(delta.childrenRemoved, FieldId::ChildrenRemoved);
+	decodeField(delta.childrenOrder, FieldId::ChildrenOrder);
+	if (EntityDataDelta::isFieldPresent(fieldsPresent, FieldId::ComponentsChanged)) {
+		// Not reserved up front, the count could come from a malformed packet; reading past the end throws instead
+		uint32_t count;
+		s >> count;
+		for (uint32_t i = 0; i < count; ++i) {
+			delta.componentsChanged.push_back(decodeComponent(s, baseline));
+		}
+	}
+	decodeField(delta.componentsRemoved, FieldId::ComponentsRemoved);
+	decodeField(delta.componentOrder, FieldId::ComponentsOrder);
+	decodeOptField(delta.icon, FieldId::Icon);
+	decodeOptField(delta.flags, FieldId::Flags);
+	decodeOptField(delta.variant, FieldId::Variant);
+
+	if (delta.deserializeChildrenComponentsAsDeltas) {
+		for (auto& c : delta.childrenAdded) {
+			c.makeComponentChangesIntoDeltas();
+		}
+	}
+}
+
+void EntityNetworkDeltaCodec::encodeComponent(Serializer& s, const String& name, const ConfigNode& data, const ConfigNode* baseline) const
+{
+	// Component index + 1, or 0 followed by the name if it's not known to reflection
+	const auto idIter = componentIds.find(name);
+	if (idIter != componentIds.end()) {
+		s << static_cast<uint32_t>(idIter->second + 1);
+	} else {
+		s << uint32_t(0);
+		s << name;
+	}
+
+	const auto type = data.getType();
+	if (type != ConfigNodeType::Map && type != ConfigNodeType::DeltaMap) {
+		s << ComponentEncoding::Generic;
+		s << data;
+		return;
+	}
+	s << (type == ConfigNodeType::Map ? ComponentEncoding::Map : ComponentEncoding::DeltaMap);
+
+	// Fields known to codegen go in a bitmask, the rest by name
+	static const Vector<String> noFields{};
+	const auto& fields = idIter != componentIds.end() ? componentFields[idIter->second] : noFields;
+	const auto& map = data.asMap();
+
+	uint64_t mask = 0;
+	size_t nExtra = map.size();
+	for (size_t i = 0; i < std::min(fields.size(), maxMaskFields); ++i) {
+		if (map.find(fields[i]) != map.end()) {
+			mask |= uint64_t(1) << i;
+			--nExtra;
+		}
+	}
+
+	s << mask;
+	for (size_t i = 0; i < std::min(fields.size(), maxMaskFields); ++i) {
+		if (mask & (uint64_t(1) << i)) {
+			encodeValue(s, map.at(fields[i]), tryGetBaselineField(baseline, fields[i]));
+		}
+	}
+
+	s << static_cast<uint32_t>(nExtra);
+	if (nExtra > 0) {
+		for (const auto& [key, value]: map) {
+			const auto fieldIter = std::find(fields.begin(), fields.end(), key);
+			if (fieldIter == fields.end() || size_t(fieldIter - fields.begin()) >= maxMaskFields) {
+				s << key;
+				encodeValue(s, value, tryGetBaselineField(baseline, key));
+			}
+		}
+	}
+}
+
+std::pair<String, ConfigNode> EntityNetworkDeltaCodec::decodeComponent(Deserializer& s, const EntityData& baseline) const
+{
+	uint32_t id;
+	s >> id;
+
+	String name;
+	static const Vector<String> noFields{};
+	const Vector<String>* fields = &noFields;
+	if (id == 0) {
+		s >> name;
+	} else if (id - 1 < componentNames.size()) {
+		name = componentNames[id - 1];
+		fields = &componentFields[id - 1];
+	} else {
+		throw Exception("Unknown component index " + toString(id - 1) + " in network entity delta", HalleyExceptions::Network);
+	}
+
+	ComponentEncoding encoding;
+	s >> encoding;
+	if (encoding > ComponentEncoding::DeltaMap) {
+		throw Exception("Invalid component encoding " + toString(int(encoding)) + " in network entity delta", HalleyExceptions::Network);
+	}
+	if (encoding == ComponentEncoding::Generic) {
+		ConfigNode data;
+		s >> data;
+		return { std::move(name), std::move(data) };
+	}
+
+	const auto* baselineComponent = tryGetBaselineComponent(baseline, name);
+	ConfigNode::MapType map;
+
+	uint64_t mask;
+	s >> mask;
+	if (fields->size() < maxMaskFields && (mask >> fields->size()) != 0) {
+		throw Exception("Unknown field in network entity delta for component " + name, HalleyExceptions::Network);
+	}
+	for (size_t i = 0; i < std::min(fields->size(), maxMaskFields); ++i) {
+		if (mask & (uint64_t(1) << i)) {
+			const auto& key = (*fields)[i];
+			map[key] = decodeValue(s, tryGetBaselineField(baselineComponent, key));
+		}
+	}
+
+	uint32_t nExtra;
+	s >> nExtra;
+	for (uint32_t i = 0; i < nExtra; ++i) {
+		String key;
+		s >> key;
+		map[key] = decodeValue(s, tryGetBaselineField(baselineComponent, key));
+	}
+
+	ConfigNode data(std::move(map));
+	if (encoding == ComponentEncoding::DeltaMap) {
+		// Component roots are always coded with auxData 0, so only the type needs restoring
+		data.ensureType(ConfigNodeType::DeltaMap);
+	}
+	return { std::move(name), std::move(data) };
+}
+
+void EntityNetworkDeltaCodec::encodeValue(Serializer& s, const ConfigNode& value, const ConfigNode* baseline) const
+{
+	const auto type = value.getType();
+	const bool hasBaseline = baseline && baseline->getType() == type;
+	const uint8_t xorTag = hasBaseline ? xorFlag : 0;
+
+	switch (type) {
+	case ConfigNodeType::Undefined:
+	case ConfigNodeType::Noop:
+	case ConfigNodeType::Del:
+		s << static_cast<uint8_t>(type);
+		break;
+
+	case ConfigNodeType::Bool:
+		s << static_cast<uint8_t>(type) << value.asBool();
+		break;
+
+	case ConfigNodeType::Int:
+		s << static_cast<uint8_t>(uint8_t(type) | xorTag);
+		s << static_cast<int64_t>(value.asInt()) - (hasBaseline ? int64_t(baseline->asInt()) : 0);
+		break;
+
+	case ConfigNodeType::Int64:
+		s << static_cast<uint8_t>(uint8_t(type) | xorTag);
+		s << value.asInt64() - (hasBaseline ? baseline->asInt64() : 0);
+		break;
+
+	case ConfigNodeType::Int2:
+	{
+		s << static_cast<uint8_t>(uint8_t(type) | xorTag);
+		const auto v = value.asVector2i() - (hasBaseline ? baseline->asVector2i() : Vector2i());
+		s << v.x << v.y;
+		break;
+	}
+
+	case ConfigNodeType::Float:
+		s << static_cast<uint8_t>(uint8_t(type) | xorTag);
+		if (hasBaseline) {
+			writeFloatXor(s, value.asFloat(), baseline->asFloat());
+		} else {
+			s << value.asFloat();
+		}
+		break;
+
+	case ConfigNodeType::Float2:
+	{
+		s << static_cast<uint8_t>(uint8_t(type) | xorTag);
+		const auto v = value.asVector2f();
+		if (hasBaseline) {
+			const auto b = baseline->asVector2f();
+			writeFloatXor(s, v.x, b.x);
+			writeFloatXor(s, v.y, b.y);
+		} else {
+			s << v.x << v.y;
+		}
+		break;
+	}
+
+	case ConfigNodeType::String:
+		s << static_cast<uint8_t>(type) << value.asString();
+		break;
+
+	default:
+		s << genericTag << value;
+		break;
+	}
+}
+
+ConfigNode EntityNetworkDeltaCodec::decodeValue(Deserializer& s, const ConfigNode* baseline) const
+{
+	uint8_t tag;
+	s >> tag;
+
+	if (tag == genericTag) {
+		ConfigNode result;
+		s >> result;
+		return result;
+	}
+
+	const bool useBaseline = (tag & xorFlag) != 0;
+	const auto type = static_cast<ConfigNodeType>(tag & ~xorFlag);
+	if (useBaseline && (!baseline || baseline->getType() != type)) {
+		throw Exception("Network entity delta refers to a baseline value that is missing", HalleyExceptions::Network);
+	}
+
+	switch (type) {
+	case ConfigNodeType::Undefined:
+		return ConfigNode();
+
+	case ConfigNodeType::Noop:
+		return ConfigNode(ConfigNode::NoopType());
+
+	case ConfigNodeType::Del:
+		return ConfigNode(ConfigNode::DelType());
+
+	case ConfigNodeType::Bool:
+	{
+		bool v;
+		s >> v;
+		return ConfigNode(v);
+	}
+
+	case ConfigNodeType::Int:
+	{
+		int64_t v;
+		s >> v;
+		return ConfigNode(static_cast<int>(v + (useBaseline ? int64_t(baseline->asInt()) : 0)));
+	}
+
+	case ConfigNodeType::Int64:
+	{
+		int64_t v;
+		s >> v;
+		return ConfigNode(v + (useBaseline ? baseline->asInt64() : 0));
+	}
+
+	case ConfigNodeType::Int2:
+	{
+		Vector2i v;
+		s >> v.x >> v.y;
+		return ConfigNode(v + (useBaseline ? baseline->asVector2i() : Vector2i()));
+	}
+
+	case ConfigNodeType::Float:
+		if (useBaseline) {
+			return ConfigNode(readFloatXor(s, baseline->asFloat()));
+		} else {
+			float v;
+			s >> v;
+			return ConfigNode(v);
+		}
+
+	case ConfigNodeType::Float2:
+		if (useBaseline) {
+			const auto b = baseline->asVector2f();
+			const float x = readFloatXor(s, b.x);
+			const float y = readFloatXor(s, b.y);
+			return ConfigNode(Vector2f(x, y));
+		} else {
+			Vector2f v;
+			s >> v.x >> v.y;
+			return ConfigNode(v);
+		}
+
+	case ConfigNodeType::String:
+	{
+		String v;
+		s >> v;
+		return ConfigNode(std::move(v));
+	}
+
+	default:
+		throw Exception("Invalid value tag " + toString(int(tag)) + " in network entity delta", HalleyExceptions::Network);
+	}
+}
@@ -0,0 +1,187 @@
+#include "halley/net/entity/entity_network_interest.h"
+
+#include "halley/entity/world.h"
+#include "halley/entity/components/transform_2d_component.h"
+#include "halley/net/entity/entity_network_session.h"
+#include "halley/utils/algorithm.h"
+
+using namespace Halley;
+
+EntityNetworkInterestManager::EntityNetworkInterestManager()
+	: EntityNetworkInterestManager(Config())
+{
+}
+
+EntityNetworkInterestManager::EntityNetworkInterestManager(Config config)
+	: config(config)
+{
+	Expects(config.cellSize > 0);
+	Expects(config.leaveMargin >= config.enterMargin);
+}
+
+const EntityNetworkInterestManager::Config& EntityNetworkInterestManager::getConfig() const
+{
+	return config;
+}
+
+void EntityNetworkInterestManager::update(Time t, World& w, gsl::span<const EntityNetworkUpdateInfo> updateInfos)
+{
+	world = &w;
+	++tick;
+
+	for (auto& [cell, ids]: grid) {
+		ids.clear();
+	}
+	unpositioned.clear();
+
+	for (const auto& info: updateInfos) {
+		auto& entry = entities[info.entityId];
+		const auto pos = getEntityPosition(world->getEntity(info.entityId));
+
+		entry.speed = pos && entry.position && t > 0 ? static_cast<float>((*pos - *entry.position).length() / t) : 0.0f;
+		entry.position = pos;
+		entry.tick = tick;
+
+		if (pos) {
+			grid[getCell(*pos)].push_back(info.entityId);
+		} else {
+			unpositioned.push_back(info.entityId);
+		}
+	}
+
+	std_ex::erase_if_value(entities, [&] (const EntityInfo& e) { return e.tick != tick; });
+	std_ex::erase_if_value(grid, [] (const Vector<EntityId>& ids) { return ids.empty(); });
+}
+
+void EntityNetworkInterestManager::updatePeer(Time t, NetworkSession::PeerId peerId, const EntityClientSharedData& clientData)
+{
+	Expects(world);
+
+	auto& peer = peers[peerId];
+	if (config.bytesPerSecond > 0) {
+		peer.budget = std::min(peer.budget + static_cast<float>(config.bytesPerSecond * t), static_cast<float>(config.bytesPerSecond * maxBudgetTime));
+	}
+
+	HashMap<EntityId, float> relevant;
+	auto addRelevant = [&] (EntityId id, float distance, float speed)
+	{
+		const auto iter = peer.relevant.find(id);
+		const float accumulated = iter != peer.relevant.end() ? iter->second : 0.0f;
+		relevant[id] = accumulated + static_cast<float>(t) * getEntityPriority(world->getEntity(id), distance, speed);
+	};
+
+	for (const auto id: unpositioned) {
+		addRelevant(id, 0, 0);
+	}
+
+	if (clientData.viewRect) {
+		const auto view = *clientData.viewRect;
+
+		// Newly relevant entities, from the cells around the view
+		const auto enterRect = view.grow(config.enterMargin);
+		const auto c0 = getCell(Vector2f(enterRect.getTopLeft()));
+		const auto c1 = getCell(Vector2f(enterRect.getBottomRight()));
+		for (int y = c0.y; y <= c1.y; ++y) {
+			for (int x = c0.x; x <= c1.x; ++x) {
+				const auto cellIter = grid.find(Vector2i(x, y));
+				if (cellIter == grid.end()) {
+					continue;
+				}
+				for (const auto id: cellIter->second) {
+					const auto& info = entities.at(id);
+					const float distance = getDistance(view, *info.position);
+					if (distance <= static_cast<float>(config.enterMargin)) {
+						addRelevant(id, distance, info.speed);
+					}
+				}
+			}
+		}
+
+		// Entities that were already relevant stay that way until they're past the leave margin
+		for (const auto& [id, accumulated]: peer.relevant) {
+			const auto iter = entities.find(id);
+			if (iter != entities.end() && iter->second.position && !relevant.contains(id)) {
+				const float distance = getDistance(view, *iter->second.position);
+				if (distance <= static_cast<float>(config.leaveMargin)) {
+					addRelevant(id, distance, iter->second.speed);
+				}
+			}
+		}
+	}
+
+	peer.relevant = std::move(relevant);
+}
+
+void EntityNetworkInterestManager::removePeer(NetworkSession::PeerId peerId)
+{
+	peers.erase(peerId);
+}
+
+bool EntityNetworkInterestManager::isRelevant(NetworkSession::PeerId peerId, EntityId entityId) const
+{
+	const auto iter = peers.find(peerId);
+	return iter != peers.end() && iter->second.relevant.contains(entityId);
+}
+
+float EntityNetworkInterestManager::getPriority(NetworkSession::PeerId peerId, EntityId entityId) const
+{
+	const auto iter = peers.find(peerId);
+	if (iter != peers.end()) {
+		const auto entityIter = iter->second.relevant.find(entityId);
+		if (entityIter != iter->second.relevant.end()) {
+			return entityIter->second;
+		}
+	}
+	return 0;
+}
+
+bool EntityNetworkInterestManager::hasBudget(NetworkSession::PeerId peerId) const
+{
+	if (config.bytesPerSecond <= 0) {
+		return true;
+	}
+	const auto iter = peers.find(peerId);
+	return iter != peers.end() && iter->second.budget > 0;
+}
+
+void EntityNetworkInterestManager::markUpToDate(NetworkSession::PeerId peerId, EntityId entityId, size_t bytesSent)
+{
+	const auto iter = peers.find(peerId);
+	if (iter != peers.end()) {
+		auto& peer = iter->second;
+		if (config.bytesPerSecond > 0) {
+			// May go negative, the debt is paid over the next ticks
+			peer.budget -= static_cast<float>(bytesSent);
+		}
+		if (const auto entityIter = peer.relevant.find(entityId); entityIter != peer.relevant.end()) {
+			entityIter->second = 0;
+		}
+	}
+}
+
+std::optional<Vector2f> EntityNetworkInterestManager::getEntityPosition(EntityRef entity) const
+{
+	if (const auto* transform = entity.tryGetComponent<Transform2DComponent>()) {
+		return transform->getGlobalPosition();
+	}
+	return std::nullopt;
+}
+
+float EntityNetworkInterestManager::getEntityPriority(EntityRef entity, float distanceToView, float speed) const
+{
+	return (1.0f + speed * config.speedPriority) / (1.0f + distanceToView / static_cast<float>(config.cellSize));
+}
+
+Vector2i EntityNetworkInterestManager::getCell(Vector2f pos) const
+{
+	return Vector2i((pos / static_cast<float>(config.cellSize)).floor());
+}
+
+float EntityNetworkInterestManager::getDistance(Rect4i rect, Vector2f pos)
+{
+	const auto p0 = Vector2f(rect.getTopLeft());
+	const auto p1 = Vector2f(rect.getBottomRight());
+	const float dx = std::max(std::max(p0.x - pos.x, pos.x - p1.x), 0.0f);
+	const float dy = std::max(std::max(p0.y - pos.y, pos.y - p1.y), 0.0f);
+	return std::sqrt(dx * dx + dy * dy);
+}
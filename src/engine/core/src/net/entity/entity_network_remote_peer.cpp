@@ -31,6 +31,11 @@ void EntityNetworkRemotePeer::sendEntities(Time t, gsl::span<const EntityNetwork
 	}
 
 	timeSinceSend += t;
+
+	auto* interest = parent->getInterestManager();
+	if (interest) {
+		interest->updatePeer(t, peerId, clientData);
+	}
 	
 	// Mark all as not alive
 	for (auto& e: outboundEntities) {
@@ -47,7 +52,8 @@ void EntityNetworkRemotePeer::sendEntities(Time t, gsl::span<const EntityNetwork
 		}
 
 		const auto entity = parent->getWorld().getEntity(entry.entityId);
-		if (peerId == 0 || parent->isEntityInView(entity, clientData)) { // Always send to host
+		const bool relevant = interest ? interest->isRelevant(peerId, entry.entityId) : parent->isEntityInView(entity, clientData);
+		if (peerId == 0 || relevant) { // Always send to host
 			if (const auto iter = outboundEntities.find(entry.entityId); iter == outboundEntities.end()) {
 				parent->setupOutboundInterpolators(entity);
 				toCreate.push_back(entity);
@@ -69,6 +75,13 @@ void EntityNetworkRemotePeer::sendEntities(Time t, gsl::span<const EntityNetwork
 	}
 
 	// Update existing entities
+	if (interest) {
+		// Highest priority first, so whatever doesn't fit in the budget is what matters least
+		std::sort(toUpdate.begin(), toUpdate.end(), [&] (const auto& a, const auto& b)
+		{
+			return interest->getPriority(peerId, a.first.getEntityId()) > interest->getPriority(peerId, b.first.getEntityId());
+		});
+	}
 	for (auto& [e, oe] : toUpdate) {
 		sendUpdateEntity(t, *oe, e);
 	}
@@ -171,13 +184,18 @@ void EntityNetworkRemotePeer::sendCreateEntity(EntityRef entity)
 	OutboundEntity result;
 
 	result.networkId = assignId();
-	result.data = parent->getFactory().serializeEntity(entity, parent->getEntitySerializationOptions());
+	parent->getEntitySnapshot(entity);
+	const auto& state = parent->getEntityCreateState(entity);
+	result.data = state.data;
+	result.version = state.version;
 
-	auto deltaData = parent->getFactory().entityDataToPrefabDelta(result.data, entity.getPrefab(), parent->getEntityDeltaOptions());
-	auto bytes = Serializer::toBytes(deltaData, parent->getByteSerializationOptions());
+	auto bytes = *state.bytes;
 	//Logger::logDev("Send Create: " + entity.getName() + " (" + entity.getInstanceUUID() + ") to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B):\n" + deltaData.toYAML() + "\n");
 	Logger::logDev("Send Create: " + entity.getName() + " (" + entity.getInstanceUUID() + ") to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B)");
 
+	if (auto* interest = parent->getInterestManager()) {
+		interest->markUpToDate(peerId, entity.getEntityId(), bytes.size());
+	}
 	send(EntityNetworkMessageCreate(result.networkId, std::move(bytes)));
 	
 	outboundEntities[entity.getEntityId()] = std::move(result);
@@ -190,18 +208,32 @@ void EntityNetworkRemotePeer::sendUpdateEntity(Time t, OutboundEntity& remote, E
 		return;
 	}
 
-	// Encode delta using interpolators
-	auto newData = parent->getFactory().serializeEntity(entity, parent->getEntitySerializationOptions());
-	auto retriever = DataInterpolatorSetRetriever(entity, true);
-	auto options = parent->getEntityDeltaOptions();
-	options.interpolatorSet = &retriever;
-	auto deltaData = EntityDataDelta(remote.data, newData, options);
-	
-	if (deltaData.hasChange()) {
-		remote.data = std::move(newData);
+	auto* interest = parent->getInterestManager();
+	const auto& snapshot = parent->getEntitySnapshot(entity);
+	if (snapshot.version == remote.version) {
+		// Nothing changed since the last state sent to this peer
+		if (interest) {
+			interest->markUpToDate(peerId, entity.getEntityId(), 0);
+		}
+		return;
+	}
+
+	if (interest && !interest->hasBudget(peerId)) {
+		// Out of bandwidth for this tick, it'll keep accumulating priority until it gets sent
+		return;
+	}
+
+	// The delta is shared with any other peer on the same baseline
+	const auto& update = parent->getEntityUpdateState(entity, *remote.data, remote.version);
+	if (interest) {
+		interest->markUpToDate(peerId, entity.getEntityId(), update.bytes ? update.bytes->size() : 0);
+	}
+	if (update.bytes) {
+		remote.data = update.data;
+		remote.version = update.version;
 		remote.timeSinceSend = 0;
 
-		auto bytes = Serializer::toBytes(deltaData, parent->getByteSerializationOptions());
+		auto bytes = *update.bytes;
 		//Logger::logDev("Send Update " + entity.getName() + " to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B):\n" + deltaData.toYAML() + "\n");
 		//Logger::logDev("Send Update " + entity.getName() + " to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B)");
 		
@@ -237,7 +269,7 @@ void EntityNetworkRemotePeer::receiveCreateEntity(const EntityNetworkMessageCrea
 		return;
 	}
 
-	const auto delta = Deserializer::fromBytes<EntityDataDelta>(msg.bytes, parent->getByteSerializationOptions());
+	const auto delta = parent->decodeEntityDelta(msg.bytes, EntityData());
 
 	auto [entityData, prefab, prefabUUID] = parent->getFactory().prefabDeltaToEntityData(delta, *delta.getInstanceUUID());
 	if (!entityData) {
@@ -283,12 +315,12 @@ void EntityNetworkRemotePeer::receiveUpdateEntity(const EntityNetworkMessageUpda
 	auto entity = parent->getWorld().tryGetEntity(remote.worldId);
 	if (!entity.isValid()) {
 		Logger::logWarning("Entity with network id (" + toString(static_cast<int>(msg.entityId)) + ") and EntityId (" + toString(remote.worldId) + ") not alive in the world from peer " + toString(static_cast<int>(peerId)));
-		const auto delta = Deserializer::fromBytes<EntityDataDelta>(msg.bytes, parent->getByteSerializationOptions());
+		const auto delta = parent->decodeEntityDelta(msg.bytes, remote.data);
 		Logger::logWarning("Caused by trying to update entity:\n" + delta.toYAML());
 		return;
 	}
 	
-	const auto delta = Deserializer::fromBytes<EntityDataDelta>(msg.bytes, parent->getByteSerializationOptions());
+	const auto delta = parent->decodeEntityDelta(msg.bytes, remote.data);
 
 	auto retriever = DataInterpolatorSetRetriever(entity, false);
 	//Logger::logDev("Receive Update " + entity.getName() + " (" + toString(msg.bytes.size()) + " B)");
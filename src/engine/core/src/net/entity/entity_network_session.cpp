@@ -7,8 +7,10 @@
 #include "halley/entity/entity_factory.h"
 #include "halley/entity/system.h"
 #include "halley/entity/world.h"
+#include "halley/entity/components/transform_2d_component.h"
 #include "halley/support/logger.h"
 #include "halley/utils/algorithm.h"
+#include "halley/utils/hash.h"
 
 class NetworkComponent;
 using namespace Halley;
@@ -48,6 +50,7 @@ void EntityNetworkSession::setWorld(World& world, SystemMessageBridge bridge)
 	factory = std::make_shared<EntityFactory>(world, resources);
 	factory->setNetworkFactory(true);
 	messageBridge = bridge;
+	codec = EntityNetworkDeltaCodec(codecMode, world.getReflection(), byteSerializationOptions);
 
 	// Clear queue
 	if (!queuedPackets.empty()) {
@@ -58,6 +61,43 @@ void EntityNetworkSession::setWorld(World& world, SystemMessageBridge bridge)
 	}
 }
 
+void EntityNetworkSession::setDeltaCodecMode(EntityNetworkDeltaCodec::Mode mode)
+{
+	codecMode = mode;
+	if (factory) {
+		codec = EntityNetworkDeltaCodec(codecMode, factory->getWorld().getReflection(), byteSerializationOptions);
+	}
+	snapshots.clear();
+}
+
+EntityDataDelta EntityNetworkSession::decodeEntityDelta(const Bytes& bytes, const EntityData& baseline) const
+{
+	return codec.decode(gsl::as_bytes(bytes.span()), baseline);
+}
+
+void EntityNetworkSession::setInterestManager(std::unique_ptr<EntityNetworkInterestManager> manager)
+{
+	interestManager = std::move(manager);
+}
+
+void EntityNetworkSession::setDirtyTracking(bool enabled, Time maxAge)
+{
+	dirtyTracking = enabled;
+	maxSnapshotAge = maxAge;
+}
+
+void EntityNetworkSession::markEntityDirty(EntityId entityId)
+{
+	if (dirtyTracking) {
+		dirtyEntities.insert(entityId);
+	}
+}
+
+EntityNetworkInterestManager* EntityNetworkSession::getInterestManager() const
+{
+	return interestManager.get();
+}
+
 void EntityNetworkSession::update(Time t)
 {
 	session->update(t);
@@ -81,9 +121,24 @@ void EntityNetworkSession::sendEntityUpdates(Time t, Rect4i viewRect, gsl::span<
 	}
 
 	// Update entities
+	// Snapshots are taken lazily, at most once per entity per tick, and shared by all peers
+	++snapshotTick;
+	snapshotTime += t;
+	if (interestManager) {
+		interestManager->update(t, getWorld(), entityIds);
+	}
 	for (auto& peer: peers) {
 		peer.sendEntities(t, entityIds, session->getClientSharedData<EntityClientSharedData>(peer.getPeerId()));
 	}
+
+	// Forget snapshots of entities that are no longer networked
+	for (const auto& entry: entityIds) {
+		if (const auto iter = snapshots.find(entry.entityId); iter != snapshots.end()) {
+			iter->second.lastSeenTick = snapshotTick;
+		}
+	}
+	std_ex::erase_if_value(snapshots, [&] (const EntitySnapshot& snapshot) { return snapshot.lastSeenTick != snapshotTick; });
+	dirtyEntities.clear();
 }
 
 void EntityNetworkSession::sendToAll(EntityNetworkMessage msg)
@@ -122,9 +177,11 @@ void EntityNetworkSession::setLobbyInfo(ConfigNode info)
 
 void EntityNetworkSession::sendMessages()
 {
+	SerializerBuffer buffer;
 	auto tryCompress = [&](size_t startIdx, size_t count, const Vector<EntityNetworkMessage>& msgs) -> std::optional<Bytes>
 	{
-		auto data = Serializer::toBytes(msgs.span().subspan(startIdx, count), byteSerializationOptions);
+		auto& data = buffer.getBytes();
+		Serializer::toBytes(msgs.span().subspan(startIdx, count), data, byteSerializationOptions);
 		auto compressed = Compression::lz4Compress(gsl::as_bytes(gsl::span<const Byte>(data)));
 		if (compressed.size() <= 16000) {
 			return std::move(compressed);
@@ -429,6 +486,110 @@ Time EntityNetworkSession::getMinSendInterval() const
 	return 0.05;
 }
 
+const EntityNetworkSession::EntitySnapshot& EntityNetworkSession::getEntitySnapshot(EntityRef entity)
+{
+	auto& snapshot = snapshots[entity.getEntityId()];
+	if (snapshot.tick != snapshotTick) {
+		snapshot.tick = snapshotTick;
+		if (!needsSnapshot(snapshot, entity)) {
+			return snapshot;
+		}
+
+		snapshot.serializedTime = snapshotTime;
+		auto data = factory->serializeEntity(entity, entitySerializationOptions);
+		if (!snapshot.data || !(*snapshot.data == data)) {
+			snapshot.data = std::make_shared<const EntityData>(std::move(data));
+			snapshot.version = nextSnapshotVersion++;
+			snapshot.create.reset();
+			snapshot.updates.clear();
+		}
+	}
+	return snapshot;
+}
+
+bool EntityNetworkSession::needsSnapshot(EntitySnapshot& snapshot, EntityRef entity) const
+{
+	if (!dirtyTracking) {
+		return true;
+	}
+
+	// Structural changes and transforms are tracked by revisions, everything else must be marked dirty by the game
+	bool dirty = false;
+	Hash::Hasher hasher;
+	const auto visit = [&] (const auto& self, EntityRef e) -> void
+	{
+		dirty = dirty || dirtyEntities.count(e.getEntityId()) != 0;
+		hasher.feed(e.getComponentRevision());
+		hasher.feed(e.getHierarchyRevision());
+		hasher.feed(e.getChildrenRevision());
+		if (const auto* transform = e.tryGetComponent<Transform2DComponent>()) {
+			hasher.feed(transform->getRevision());
+		}
+		for (auto child: e.getChildren()) {
+			self(self, child);
+		}
+	};
+	visit(visit, entity);
+
+	const auto revisions = hasher.digest();
+	const bool changed = dirty || revisions != snapshot.revisions || !snapshot.data || snapshotTime - snapshot.serializedTime >= maxSnapshotAge;
+	snapshot.revisions = revisions;
+	return changed;
+}
+
+const EntityNetworkSession::EncodedEntityState& EntityNetworkSession::getEntityCreateState(EntityRef entity)
+{
+	auto& snapshot = snapshots.at(entity.getEntityId());
+	if (!snapshot.create) {
+		const auto deltaData = factory->entityDataToPrefabDelta(*snapshot.data, entity.getPrefab(), deltaOptions);
+		auto& result = snapshot.create.emplace();
+		result.bytes = codec.encode(deltaData, EntityData());
+
+		// The receiver rebuilds the entity data from the prefab, do the same to get its baseline
+		auto wireData = std::get<0>(factory->prefabDeltaToEntityData(deltaData, *deltaData.getInstanceUUID()));
+		setWireState(result, snapshot, wireData ? std::move(*wireData) : EntityData());
+	}
+	return *snapshot.create;
+}
+
+const EntityNetworkSession::EncodedEntityState& EntityNetworkSession::getEntityUpdateState(EntityRef entity, const EntityData& baseline, uint32_t baselineVersion)
+{
+	auto& snapshot = snapshots.at(entity.getEntityId());
+	const auto iter = snapshot.updates.find(baselineVersion);
+	if (iter != snapshot.updates.end()) {
+		return iter->second;
+	}
+
+	// Encode delta using interpolators
+	auto retriever = DataInterpolatorSetRetriever(entity, true);
+	auto options = deltaOptions;
+	options.interpolatorSet = &retriever;
+	const auto deltaData = EntityDataDelta(baseline, *snapshot.data, options);
+
+	auto& result = snapshot.updates[baselineVersion];
+	if (deltaData.hasChange()) {
+		result.bytes = codec.encode(deltaData, baseline);
+
+		auto wireData = baseline;
+		wireData.applyDelta(deltaData);
+		setWireState(result, snapshot, std::move(wireData));
+	}
+	return result;
+}
+
+void EntityNetworkSession::setWireState(EncodedEntityState& state, const EntitySnapshot& snapshot, EntityData wireData)
+{
+	// Interpolators can hold back or quantize changes, so what the peer ends up with can differ from the snapshot.
+	// Binary deltas are coded against what the peer has, so track that separately when it differs.
+	if (codec.getMode() == EntityNetworkDeltaCodec::Mode::ConfigNode || wireData == *snapshot.data) {
+		state.data = snapshot.data;
+		state.version = snapshot.version;
+	} else {
+		state.data = std::make_shared<const EntityData>(std::move(wireData));
+		state.version = nextSnapshotVersion++;
+	}
+}
+
 void EntityNetworkSession::onRemoteEntityCreated(EntityRef entity, NetworkSession::PeerId peerId)
 {
 	if (listener) {
@@ -572,6 +733,9 @@ void EntityNetworkSession::onPeerDisconnected(NetworkSession::PeerId peerId)
 		}
 	}
 	std_ex::erase_if(peers, [](const EntityNetworkRemotePeer& p) { return !p.isAlive(); });
+	if (interestManager) {
+		interestManager->removePeer(peerId);
+	}
 
 	if (listener) {
 		listener->setLobbyInfo(peerId, {});
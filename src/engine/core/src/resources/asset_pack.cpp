@@ -10,12 +10,23 @@ using namespace Halley;
 
 void AssetPackHeader::init(size_t assetDbSize)
 {
-	memcpy(identifier.data(), "HALLEYPK", 8);
+	memcpy(identifier.data(), "HALLEYP2", 8);
 	assetDbStartPos = sizeof(AssetPackHeader);
 	dataStartPos = assetDbStartPos + assetDbSize;
 	memset(iv.data(), 0, iv.size());
 }
 
+int AssetPackHeader::getVersion() const
+{
+	if (memcmp(identifier.data(), "HALLEYPK", 8) == 0) {
+		return 1;
+	}
+	if (memcmp(identifier.data(), "HALLEYP2", 8) == 0) {
+		return 2;
+	}
+	return 0;
+}
+
 AssetPack::AssetPack()
 	: assetDb(std::make_unique<AssetDatabase>())
 	, hasReader(false)
@@ -32,6 +43,8 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 	: reader(std::move(_reader))
 	, hasReader(true)
 {
+	mappedData = reader->getMappedData();
+
 	// Read header
 	size_t totalSize = reader->size();
 	if (totalSize < sizeof(AssetPackHeader)) {
@@ -42,7 +55,8 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 	if (nRead != int(sizeof(header))) {
 		throw Exception("Unable to read header", HalleyExceptions::Resources);
 	}
-	if (memcmp(header.identifier.data(), "HALLEYPK", 8) != 0) {
+	const int version = header.getVersion();
+	if (version == 0) {
 		throw Exception("Asset pack is invalid (invalid identifier)", HalleyExceptions::Resources);
 	}
 	iv = header.iv;
@@ -51,26 +65,47 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 	// Read asset database
 	{
 		const size_t assetDbSize = size_t(header.dataStartPos - header.assetDbStartPos);
-		auto assetDbBytes = Bytes(assetDbSize);
-		nRead = reader->read(gsl::as_writable_bytes(gsl::span<Byte>(assetDbBytes)));
-		if (nRead != int(assetDbBytes.size())) {
-			throw Exception("Unable to read header", HalleyExceptions::Resources);
+		Bytes assetDbBytes;
+		gsl::span<const gsl::byte> assetDbSpan;
+		if (!mappedData.empty()) {
+			if (header.dataStartPos > mappedData.size()) {
+				throw Exception("Asset pack is invalid (truncated)", HalleyExceptions::Resources);
+			}
+			assetDbSpan = mappedData.subspan(size_t(header.assetDbStartPos), assetDbSize);
+		} else {
+			assetDbBytes.resize(assetDbSize);
+			nRead = reader->read(gsl::as_writable_bytes(gsl::span<Byte>(assetDbBytes)));
+			if (nRead != int(assetDbBytes.size())) {
+				throw Exception("Unable to read header", HalleyExceptions::Resources);
+			}
+			assetDbSpan = gsl::as_bytes(gsl::span<const Byte>(assetDbBytes));
 		}
+
 		assetDb = std::make_unique<AssetDatabase>();
-		Deserializer::fromBytes<AssetDatabase>(*assetDb, Compression::decompress(assetDbBytes));
+		if (version == 1) {
+			Deserializer::fromBytes<AssetDatabase>(*assetDb, Compression::decompress(assetDbSpan));
+		} else {
+			Deserializer::fromBytes<AssetDatabase>(*assetDb, Compression::lz4DecompressFile(assetDbSpan, {}));
+		}
 	}
 
 	std::array<char, 16> ivEmpty;
 	memset(ivEmpty.data(), 0, ivEmpty.size());
 	const bool hasCrypt = memcmp(iv.data(), ivEmpty.data(), iv.size()) != 0 && !encryptionKey.isEmpty();
 
-	if (preLoad || hasCrypt) {
+	// A memory-mapped pack is already as good as preloaded, unless it needs decrypting
+	if ((preLoad && mappedData.empty()) || hasCrypt) {
 		readToMemory();
 	}
 
 	if (hasCrypt) {
 		decrypt(encryptionKey);
 	}
+
+	if (!mappedData.empty()) {
+		// Static resource data points into the mapping, and keeps it alive after the pack is gone
+		mapping = std::move(reader);
+	}
 }
 
 AssetPack::~AssetPack()
@@ -87,11 +122,15 @@ AssetPack& AssetPack::operator=(AssetPack&& other) noexcept
 	assetDb = std::move(other.assetDb);
 	dataOffset = other.dataOffset;
 	reader = std::move(other.reader);
+	mapping = std::move(other.mapping);
 	data = std::move(other.data);
-	hasReader = !!reader;
+	mappedData = other.mappedData;
+	hasReader = reader || mapping;
 
 	other.hasReader = false;
 	other.reader.reset();
+	other.mapping.reset();
+	other.mappedData = {};
 
 	return *this;
 }
@@ -118,7 +157,7 @@ const Bytes& AssetPack::getData() const
 
 Bytes AssetPack::writeOut() const
 {
-	auto assetDbBytes = Compression::compress(Serializer::toBytes(*assetDb));
+	auto assetDbBytes = Compression::lz4CompressFile(gsl::as_bytes(gsl::span<const Byte>(Serializer::toBytes(*assetDb))), {});
 	AssetPackHeader header;
 	header.init(assetDbBytes.size());
 	header.iv = iv;
@@ -130,6 +169,43 @@ Bytes AssetPack::writeOut() const
 	return result;
 }
 
+String AssetPack::appendAsset(gsl::span<const gsl::byte> asset, bool compress)
+{
+	auto append = [&] (gsl::span<const gsl::byte> bytes)
+	{
+		const size_t pos = data.size();
+		data.reserve(nextPowerOf2(pos + bytes.size()));
+		data.resize(pos + bytes.size());
+		memcpy(data.data() + pos, bytes.data(), bytes.size());
+	};
+
+	const size_t pos = data.size();
+
+	if (compress && !asset.empty()) {
+		// Table of compressed block sizes, followed by the blocks. Blocks are independent, so streams can seek.
+		const size_t nBlocks = getBlockCount(asset.size());
+		Bytes encoded(nBlocks * sizeof(uint32_t));
+		Compression::LZ4Options options;
+		options.mode = Compression::LZ4Mode::HC;
+		for (size_t i = 0; i < nBlocks; ++i) {
+			const auto block = asset.subspan(i * assetBlockSize, std::min(assetBlockSize, asset.size() - i * assetBlockSize));
+			const auto compressed = Compression::lz4Compress(block, options);
+			const auto compressedSize = static_cast<uint32_t>(compressed.size());
+			memcpy(encoded.data() + i * sizeof(uint32_t), &compressedSize, sizeof(uint32_t));
+			encoded.insert(encoded.end(), compressed.begin(), compressed.end());
+		}
+
+		// Not worth decompressing if it doesn't save at least an eighth
+		if (encoded.size() < asset.size() - asset.size() / 8) {
+			append(gsl::as_bytes(gsl::span<const Byte>(encoded)));
+			return toString(pos) + ":" + toString(encoded.size()) + ":" + toString(asset.size());
+		}
+	}
+
+	append(asset);
+	return toString(pos) + ":" + toString(asset.size());
+}
+
 std::unique_ptr<ResourceData> AssetPack::getData(const String& asset, AssetType type, bool stream)
 {
 	auto path = asset;
@@ -140,28 +216,43 @@ std::unique_ptr<ResourceData> AssetPack::getData(const String& asset, AssetType
 	auto ps = assetInfo->path.split(':');
 	size_t pos = size_t(ps.at(0).toInteger());
 	size_t size = size_t(ps.at(1).toInteger());
+	const std::optional<size_t> uncompressedSize = ps.size() > 2 ? size_t(ps[2].toInteger()) : std::optional<size_t>();
 
 	if (stream) {
 		return std::make_unique<ResourceDataStream>(path, [=] () -> std::unique_ptr<ResourceDataReader> {
+			if (uncompressedSize) {
+				return std::make_unique<PackDataReader>(*this, pos, size, *uncompressedSize);
+			}
 			return std::make_unique<PackDataReader>(*this, pos, size);
 		});
+	} else if (uncompressedSize) {
+		// Decompress straight into the buffer owned by the resource data
+		auto result = new char[*uncompressedSize];
+		try {
+			decompressAsset(pos, size, gsl::as_writable_bytes(gsl::span<char>(result, *uncompressedSize)));
+			return std::make_unique<ResourceDataStatic>(result, *uncompressedSize, path, true);
+		} catch (...) {
+			delete[] result;
+			throw;
+		}
+	} else if (!mappedData.empty()) {
+		// Point straight at the mapping, sharing ownership of it
+		const auto span = tryGetDataSpan(pos, size);
+		return std::make_unique<ResourceDataStatic>(std::shared_ptr<const char>(mapping, reinterpret_cast<const char*>(span.data())), size, path);
+	} else if (!hasReader) {
+		// Preloaded
+		if (const auto span = tryGetDataSpan(pos, size); span.size() == size) {
+			return std::make_unique<ResourceDataStatic>(span.data(), size, path, false);
+		}
+		throw Exception("Asset \"" + asset + "\" is out of pack bounds.", HalleyExceptions::Resources);
 	} else {
-		if (hasReader) {
-			auto result = new char[size];
-			try {
-				readData(pos, gsl::as_writable_bytes(gsl::span<char>(result, size)));
-				return std::make_unique<ResourceDataStatic>(result, size, path, true);
-			} catch (...) {
-				delete[] result;
-				throw;
-			}
-		} else {
-			// Preloaded
-			if (pos + size > data.size()) {
-				throw Exception("Asset \"" + asset + "\" is out of pack bounds.", HalleyExceptions::Resources);
-			}
-
-			return std::make_unique<ResourceDataStatic>(data.data() + pos, size, path, false);
+		auto result = new char[size];
+		try {
+			readData(pos, gsl::as_writable_bytes(gsl::span<char>(result, size)));
+			return std::make_unique<ResourceDataStatic>(result, size, path, true);
+		} catch (...) {
+			delete[] result;
+			throw;
 		}
 	}
 }
@@ -169,10 +260,18 @@ std::unique_ptr<ResourceData> AssetPack::getData(const String& asset, AssetType
 void AssetPack::readToMemory()
 {
 	std::unique_lock<std::mutex> lock(readerMutex);
-	reader->seek(dataOffset, SEEK_SET);
-	data = reader->readAll();
+	if (!mappedData.empty()) {
+		const auto src = mappedData.subspan(dataOffset);
+		data.resize(src.size());
+		memcpy(data.data(), src.data(), src.size());
+	} else {
+		reader->seek(dataOffset, SEEK_SET);
+		data = reader->readAll();
+	}
+	mappedData = {};
 	hasReader = false;
 	reader.reset();
+	mapping.reset();
 }
 
 void AssetPack::encrypt(const String& key)
@@ -195,6 +294,13 @@ void AssetPack::decrypt(const String& key)
 
 void AssetPack::readData(size_t pos, gsl::span<gsl::byte> dst)
 {
+	if (!mappedData.empty()) {
+		// No locking needed, the mapping is read-only
+		const auto src = tryGetDataSpan(pos, dst.size());
+		memcpy(dst.data(), src.data(), dst.size());
+		return;
+	}
+
 	if (hasReader) {
 		std::unique_lock<std::mutex> lock(readerMutex);
 		if (reader) {
@@ -211,10 +317,63 @@ void AssetPack::readData(size_t pos, gsl::span<gsl::byte> dst)
 	memcpy(dst.data(), data.data() + pos, dst.size());
 }
 
+gsl::span<const gsl::byte> AssetPack::tryGetDataSpan(size_t pos, size_t size) const
+{
+	if (!mappedData.empty()) {
+		if (dataOffset + pos + size > mappedData.size()) {
+			throw Exception("Asset data is out of pack bounds.", HalleyExceptions::Resources);
+		}
+		return mappedData.subspan(dataOffset + pos, size);
+	}
+
+	if (!hasReader) {
+		if (pos + size > data.size()) {
+			throw Exception("Asset data is out of pack bounds.", HalleyExceptions::Resources);
+		}
+		return gsl::as_bytes(gsl::span<const Byte>(data)).subspan(pos, size);
+	}
+
+	return {};
+}
+
+size_t AssetPack::getBlockCount(size_t uncompressedSize)
+{
+	return (uncompressedSize + assetBlockSize - 1) / assetBlockSize;
+}
+
+void AssetPack::decompressAsset(size_t pos, size_t storedSize, gsl::span<gsl::byte> dst)
+{
+	Bytes buffer;
+	auto src = tryGetDataSpan(pos, storedSize);
+	if (src.size() != storedSize) {
+		buffer.resize(storedSize);
+		readData(pos, gsl::as_writable_bytes(gsl::span<Byte>(buffer)));
+		src = gsl::as_bytes(gsl::span<const Byte>(buffer));
+	}
+
+	const size_t nBlocks = getBlockCount(dst.size());
+	size_t srcPos = nBlocks * sizeof(uint32_t);
+	if (srcPos > src.size()) {
+		throw Exception("Compressed asset data is corrupted.", HalleyExceptions::Resources);
+	}
+
+	for (size_t i = 0; i < nBlocks; ++i) {
+		uint32_t blockSize;
+		memcpy(&blockSize, src.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+		const auto dstBlock = dst.subspan(i * assetBlockSize, std::min(assetBlockSize, dst.size() - i * assetBlockSize));
+		if (srcPos + blockSize > src.size() || Compression::lz4Decompress(src.subspan(srcPos, blockSize), dstBlock) != dstBlock.size()) {
+			throw Exception("Compressed asset data is corrupted.", HalleyExceptions::Resources);
+		}
+		srcPos += blockSize;
+	}
+}
+
 std::unique_ptr<ResourceDataReader> AssetPack::extractReader()
 {
 	std::unique_lock<std::mutex> lock(readerMutex);
 	hasReader = false;
+	mappedData = {};
+	mapping.reset(); // Can't be handed out as a unique reader, resources still using it keep it alive
 	return std::move(reader);
 }
 
@@ -239,6 +398,27 @@ PackDataReader::PackDataReader(AssetPack& pack, size_t startPos, size_t fileSize
 {
 }
 
+PackDataReader::PackDataReader(AssetPack& pack, size_t startPos, size_t storedSize, size_t uncompressedSize)
+	: pack(pack)
+	, startPos(startPos)
+	, fileSize(uncompressedSize)
+	, aliveToken(pack.getAliveToken())
+	, compressed(true)
+{
+	const size_t nBlocks = AssetPack::getBlockCount(uncompressedSize);
+	Vector<uint32_t> blockSizes(nBlocks);
+	pack.readData(startPos, gsl::as_writable_bytes(gsl::span<uint32_t>(blockSizes)));
+
+	blockOffsets.resize(nBlocks + 1);
+	blockOffsets[0] = nBlocks * sizeof(uint32_t);
+	for (size_t i = 0; i < nBlocks; ++i) {
+		blockOffsets[i + 1] = blockOffsets[i] + blockSizes[i];
+	}
+	if (blockOffsets.back() > storedSize) {
+		throw Exception("Compressed asset data is corrupted.", HalleyExceptions::Resources);
+	}
+}
+
 size_t PackDataReader::size() const
 {
 	return fileSize;
@@ -254,7 +434,20 @@ int PackDataReader::read(gsl::span<gsl::byte> dst)
 	size_t available = fileSize - curPos;
 	size_t toRead = std::min(available, size_t(dst.size()));
 
-	pack.readData(startPos + curPos, dst.subspan(0, toRead));
+	if (compressed) {
+		for (size_t done = 0; done < toRead; ) {
+			const size_t pos = curPos + done;
+			const size_t block = pos / AssetPack::assetBlockSize;
+			loadBlock(block);
+
+			const size_t offset = pos - block * AssetPack::assetBlockSize;
+			const size_t n = std::min(toRead - done, blockData.size() - offset);
+			memcpy(dst.data() + done, blockData.data() + offset, n);
+			done += n;
+		}
+	} else {
+		pack.readData(startPos + curPos, dst.subspan(0, toRead));
+	}
 	curPos += toRead;
 
 	return int(toRead);
@@ -299,3 +492,25 @@ bool PackDataReader::isAvailable() const
 	return *aliveToken;
 }
 
+
+void PackDataReader::loadBlock(size_t block)
+{
+	if (loadedBlock == block) {
+		return;
+	}
+
+	const size_t srcPos = startPos + blockOffsets[block];
+	const size_t srcSize = blockOffsets[block + 1] - blockOffsets[block];
+	auto src = pack.tryGetDataSpan(srcPos, srcSize);
+	if (src.size() != srcSize) {
+		compressedBlock.resize(srcSize);
+		pack.readData(srcPos, gsl::as_writable_bytes(gsl::span<Byte>(compressedBlock)));
+		src = gsl::as_bytes(gsl::span<const Byte>(compressedBlock));
+	}
+
+	blockData.resize(std::min(AssetPack::assetBlockSize, fileSize - block * AssetPack::assetBlockSize));
+	if (Compression::lz4Decompress(src, gsl::as_writable_bytes(gsl::span<Byte>(blockData))) != blockData.size()) {
+		throw Exception("Compressed asset data is corrupted.", HalleyExceptions::Resources);
+	}
+	loadedBlock = block;
+}
@@ -45,6 +45,36 @@ namespace {
 
 
 
+namespace {
+	// Shared by all collections, so ages can be compared across asset types
+	std::atomic<uint64_t> useCounter = 0;
+}
+
+ResourceCollectionBase::Wrapper::Wrapper(std::shared_ptr<Resource> resource, int loadDepth)
+	: res(std::move(resource))
+	, depth(loadDepth)
+	, lastUsed(++useCounter)
+{}
+
+ResourceCollectionBase::Wrapper::Wrapper(Wrapper&& other) noexcept
+	: res(std::move(other.res))
+	, depth(other.depth)
+	, lastUsed(other.lastUsed.load())
+{}
+
+ResourceCollectionBase::Wrapper& ResourceCollectionBase::Wrapper::operator=(Wrapper&& other) noexcept
+{
+	res = std::move(other.res);
+	depth = other.depth;
+	lastUsed = other.lastUsed.load();
+	return *this;
+}
+
+void ResourceCollectionBase::Wrapper::touch() const
+{
+	lastUsed.store(++useCounter, std::memory_order_relaxed);
+}
+
 ResourceCollectionBase::ResourceCollectionBase(Resources& parent, AssetType type)
 	: parent(parent)
 	, type(type)
@@ -107,6 +137,17 @@ std::shared_ptr<Resource> ResourceCollectionBase::getUntyped(std::string_view na
 	return doGet(name, priority, true);
 }
 
+std::shared_ptr<Resource> ResourceCollectionBase::getIfLoaded(std::string_view name) const
+{
+	std::shared_lock lock(mutex);
+	const auto res = resources.find(name);
+	if (res != resources.end()) {
+		res->second.touch();
+		return res->second.res;
+	}
+	return {};
+}
+
 Vector<String> ResourceCollectionBase::enumerate() const
 {
 	if (resourceEnumerator) {
@@ -191,6 +232,91 @@ void ResourceCollectionBase::notifyResourcesUnloaded()
 	}
 }
 
+void ResourceCollectionBase::setMemoryBudget(size_t bytes)
+{
+	memoryBudget = bytes;
+}
+
+size_t ResourceCollectionBase::getMemoryBudget() const
+{
+	return memoryBudget;
+}
+
+void ResourceCollectionBase::pin(std::string_view assetId)
+{
+	std::unique_lock lock(mutex);
+	pinned.insert(assetId);
+}
+
+void ResourceCollectionBase::unpin(std::string_view assetId)
+{
+	std::unique_lock lock(mutex);
+	pinned.erase(assetId);
+}
+
+bool ResourceCollectionBase::isPinned(std::string_view assetId) const
+{
+	std::shared_lock lock(mutex);
+	return pinned.contains(assetId);
+}
+
+ResourceCollectionStats ResourceCollectionBase::getStats() const
+{
+	ResourceCollectionStats stats;
+	stats.type = type;
+	stats.memoryBudget = memoryBudget;
+	stats.hits = hits;
+	stats.misses = misses;
+	stats.evictions = evictions;
+
+	std::shared_lock lock(mutex);
+	stats.numResident = resources.size();
+	for (auto& r: resources) {
+		stats.memoryUsage += r.second.res->getMemoryUsage();
+		if (pinned.contains(r.first)) {
+			++stats.numPinned;
+		}
+	}
+
+	return stats;
+}
+
+void ResourceCollectionBase::getEvictionCandidates(Vector<EvictionCandidate>& dst) const
+{
+	const uint64_t now = useCounter;
+	std::shared_lock lock(mutex);
+
+	for (auto& r: resources) {
+		// Only the collection holds it, so nothing will notice it going away
+		if (r.second.res.use_count() == 1 && !pinned.contains(r.first)) {
+			const auto lastUsed = r.second.lastUsed.load(std::memory_order_relaxed);
+			dst.push_back(EvictionCandidate{ const_cast<ResourceCollectionBase*>(this), r.first, now > lastUsed ? now - lastUsed : 0, r.second.res->getMemoryUsage().getTotal() });
+		}
+	}
+}
+
+ResourceMemoryUsage ResourceCollectionBase::evict(std::string_view assetId)
+{
+	std::shared_ptr<Resource> res;
+
+	{
+		std::unique_lock lock(mutex);
+		const auto iter = resources.find(assetId);
+		if (iter == resources.end() || iter->second.res.use_count() != 1 || pinned.contains(assetId)) {
+			// Picked up again since it was chosen
+			return {};
+		}
+		res = std::move(iter->second.res);
+		resources.erase(iter);
+		++evictions;
+	}
+
+	// Delete out of the lock
+	const auto usage = res->getMemoryUsage();
+	res->setUnloaded();
+	return usage;
+}
+
 ResourceMemoryUsage ResourceCollectionBase::getMemoryUsageAndAge(float time)
 {
 	ResourceMemoryUsage usage;
@@ -209,7 +335,7 @@ ResourceMemoryUsage ResourceCollectionBase::getMemoryUsageAndAge(float time)
 	return usage;
 }
 
-std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback)
+std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback, std::unique_ptr<ResourceDataStatic> prefetched)
 {
 	//assert(!isRunningFromDLL());
 
@@ -220,7 +346,8 @@ std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std
 		newRes = resourceLoader(assetId, priority);
 	} else {
 		// Normal loading
-		auto resLoader = ResourceLoader(*(parent.locator), assetId, type, priority, parent.api, parent);		
+		auto resLoader = ResourceLoader(*(parent.locator), assetId, type, priority, parent.api, parent);
+		resLoader.prefetched = std::move(prefetched);
 		newRes = loadResource(resLoader);
 		if (newRes) {
 			newRes->setMeta(resLoader.getMeta());
@@ -253,10 +380,18 @@ std::shared_ptr<Resource> ResourceCollectionBase::doGet(std::string_view assetId
 			const auto res = resources.find(assetId);
 			if (res != resources.end()) {
 				// Found resource, all good
+				res->second.touch();
+				if (i == 0) {
+					++hits;
+				}
 				return res->second.res;
 			}
 		}
 
+		if (i == 0) {
+			++misses;
+		}
+
 		{
 			// Resource not found; claim loading it
 			std::unique_lock lock(mutex);
@@ -297,6 +432,42 @@ std::shared_ptr<Resource> ResourceCollectionBase::doGet(std::string_view assetId
 	}
 }
 
+std::unique_ptr<ResourceDataStatic> ResourceCollectionBase::prefetch(std::string_view assetId, ResourceLoadPriority priority)
+{
+	if (resourceLoader) {
+		return {};
+	}
+
+	auto resLoader = ResourceLoader(*(parent.locator), assetId, type, priority, parent.api, parent);
+	if (!resLoader.metadata) {
+		return {};
+	}
+
+	// Streamed assets read their data lazily when played/accessed, so there's nothing to fetch ahead of time
+	if (type == AssetType::BinaryFile || resLoader.getMeta().getBool("streaming", false)) {
+		return {};
+	}
+
+	return resLoader.getStatic(false);
+}
+
+std::shared_ptr<Resource> ResourceCollectionBase::storeStreamed(std::string_view assetId, std::shared_ptr<Resource> resource)
+{
+	{
+		std::unique_lock lock(mutex);
+		const auto res = resources.find(assetId);
+		if (res != resources.end()) {
+			// Someone loaded it synchronously while it was streaming, keep that one
+			return res->second.res;
+		}
+		resources.emplace(assetId, Wrapper(resource, 0));
+		resourceLoaded.notify_all();
+	}
+
+	resource->onLoaded(parent);
+	return resource;
+}
+
 bool ResourceCollectionBase::exists(std::string_view assetId) const
 {
 	// Look in cache
@@ -7,6 +7,19 @@
 #include "halley/api/halley_api.h"
 #include "halley/support/profiler.h"
 
+#if defined(_WIN32) && !defined(WINDOWS_STORE)
+#define HALLEY_MMAP_WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define HALLEY_MMAP_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace Halley;
 
 Bytes ResourceDataReader::readAll()
@@ -85,6 +98,119 @@ void ResourceDataReaderFileSystem::close()
 	}
 }
 
+std::unique_ptr<ResourceDataReaderMemoryMapped> ResourceDataReaderMemoryMapped::tryOpen(const Path& path)
+{
+#if defined(HALLEY_MMAP_WIN32)
+	HANDLE file = CreateFileW(path.getNativeString().getUTF16().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return {};
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return {};
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return {};
+	}
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return {};
+	}
+	return std::unique_ptr<ResourceDataReaderMemoryMapped>(new ResourceDataReaderMemoryMapped(static_cast<const gsl::byte*>(view), size_t(size.QuadPart), file, mapping));
+#elif defined(HALLEY_MMAP_POSIX)
+	const int fd = open(path.getNativeString().c_str(), O_RDONLY);
+	if (fd < 0) {
+		return {};
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return {};
+	}
+	void* view = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // The mapping keeps the file alive
+	if (view == MAP_FAILED) {
+		return {};
+	}
+	return std::unique_ptr<ResourceDataReaderMemoryMapped>(new ResourceDataReaderMemoryMapped(static_cast<const gsl::byte*>(view), size_t(st.st_size), nullptr, nullptr));
+#else
+	return {};
+#endif
+}
+
+ResourceDataReaderMemoryMapped::ResourceDataReaderMemoryMapped(const gsl::byte* data, size_t size, void* fileHandle, void* mappingHandle)
+	: data(data)
+	, fileSize(size)
+	, fileHandle(fileHandle)
+	, mappingHandle(mappingHandle)
+{
+}
+
+ResourceDataReaderMemoryMapped::~ResourceDataReaderMemoryMapped()
+{
+	close();
+}
+
+size_t ResourceDataReaderMemoryMapped::size() const
+{
+	return fileSize;
+}
+
+int ResourceDataReaderMemoryMapped::read(gsl::span<gsl::byte> dst)
+{
+	const size_t toRead = std::min(size_t(dst.size()), fileSize - std::min(pos, fileSize));
+	if (toRead > 0) {
+		memcpy(dst.data(), data + pos, toRead);
+		pos += toRead;
+	}
+	return static_cast<int>(toRead);
+}
+
+void ResourceDataReaderMemoryMapped::seek(int64_t offset, int whence)
+{
+	switch (whence) {
+	case SEEK_SET:
+		pos = size_t(offset);
+		break;
+	case SEEK_CUR:
+		pos = size_t(int64_t(pos) + offset);
+		break;
+	case SEEK_END:
+		pos = size_t(int64_t(fileSize) + offset);
+		break;
+	}
+}
+
+size_t ResourceDataReaderMemoryMapped::tell() const
+{
+	return pos;
+}
+
+void ResourceDataReaderMemoryMapped::close()
+{
+	if (data) {
+#if defined(HALLEY_MMAP_WIN32)
+		UnmapViewOfFile(data);
+		CloseHandle(static_cast<HANDLE>(mappingHandle));
+		CloseHandle(static_cast<HANDLE>(fileHandle));
+#elif defined(HALLEY_MMAP_POSIX)
+		munmap(const_cast<gsl::byte*>(data), fileSize);
+#endif
+		data = nullptr;
+		fileSize = 0;
+		pos = 0;
+	}
+}
+
+gsl::span<const gsl::byte> ResourceDataReaderMemoryMapped::getMappedData() const
+{
+	return gsl::span<const gsl::byte>(data, fileSize);
+}
 
 ResourceData::ResourceData(String p)
 	: path(p)
@@ -104,6 +230,14 @@ ResourceDataStatic::ResourceDataStatic(const void* _data, size_t _size, String p
 	set(_data, _size, owning);
 }
 
+ResourceDataStatic::ResourceDataStatic(std::shared_ptr<const char> data, size_t size, String path)
+	: ResourceData(path)
+	, data(std::move(data))
+	, size(size)
+	, loaded(true)
+{
+}
+
 static void deleter(const char* data)
 {
 	delete[] data;
@@ -197,6 +331,7 @@ ResourceLoader::ResourceLoader(ResourceLoader&& loader) noexcept
 	, name(std::move(loader.name))
 	, priority(loader.priority)
 	, api(loader.api)
+	, prefetched(std::move(loader.prefetched))
 {
 }
 
@@ -217,6 +352,11 @@ ResourceLoader::ResourceLoader(IResourceLocator& locator, const String& name, As
 
 std::unique_ptr<ResourceDataStatic> ResourceLoader::getStatic(bool throwOnFail)
 {
+	if (prefetched) {
+		loaded = true;
+		return std::move(prefetched);
+	}
+
 	auto result = locator.getStatic(name, type, throwOnFail);
 	if (result) {
 		try {
@@ -248,6 +388,10 @@ std::unique_ptr<ResourceDataStream> ResourceLoader::getStream(bool throwOnFail)
 
 Future<std::unique_ptr<ResourceDataStatic>> ResourceLoader::getAsync(bool throwOnFail) const
 {
+	if (prefetched) {
+		return Future<std::unique_ptr<ResourceDataStatic>>::makeImmediate(std::move(prefetched));
+	}
+
 	std::reference_wrapper<IResourceLocator> loc = locator;
 	auto n = name;
 	auto t = type;
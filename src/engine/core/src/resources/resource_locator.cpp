@@ -133,7 +133,10 @@ void ResourceLocator::addFileSystem(const Path& path, IFileSystemCache* cache)
 
 void ResourceLocator::addPack(const Path& path, const String& encryptionKey, bool preLoad, bool allowFailure, std::optional<int> priority)
 {
-	auto dataReader = system.getDataReader(path.string());
+	std::unique_ptr<ResourceDataReader> dataReader = ResourceDataReaderMemoryMapped::tryOpen(path);
+	if (!dataReader) {
+		dataReader = system.getDataReader(path.string());
+	}
 	if (dataReader) {
 		auto resourceLocator = std::make_unique<PackResourceLocator>(std::move(dataReader), path, encryptionKey, preLoad, priority);
 		add(std::move(resourceLocator), path);
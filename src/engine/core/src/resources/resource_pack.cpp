@@ -54,7 +54,11 @@ bool PackResourceLocator::purgeIfAffected(SystemAPI& system, gsl::span<const Str
 
 void PackResourceLocator::loadAfterPurge()
 {
-	assetPack = std::make_unique<AssetPack>(system->getDataReader(path.string()), encryptionKey, preLoad);
+	std::unique_ptr<ResourceDataReader> dataReader = ResourceDataReaderMemoryMapped::tryOpen(path);
+	if (!dataReader) {
+		dataReader = system->getDataReader(path.string());
+	}
+	assetPack = std::make_unique<AssetPack>(std::move(dataReader), encryptionKey, preLoad);
 }
 
 int PackResourceLocator::getPriority() const
@@ -0,0 +1,181 @@
+#include "halley/resources/resource_streamer.h"
+#include <chrono>
+#include <thread>
+#include "halley/concurrency/executor.h"
+#include "halley/resources/resource.h"
+#include "halley/resources/resource_collection.h"
+#include "halley/support/logger.h"
+#include "halley/support/profiler.h"
+#include "halley/utils/scoped_guard.h"
+
+using namespace Halley;
+
+ResourceStreamer::Request::Request(ResourceCollectionBase& collection, std::string_view assetId, String key, ResourceLoadPriority priority)
+	: collection(collection)
+	, assetId(assetId)
+	, key(std::move(key))
+	, priority(priority)
+{
+}
+
+ResourceStreamer::~ResourceStreamer()
+{
+	abort();
+}
+
+Future<std::shared_ptr<Resource>> ResourceStreamer::request(ResourceCollectionBase& collection, std::string_view assetId, ResourceLoadPriority priority)
+{
+	if (auto res = collection.getIfLoaded(assetId)) {
+		++collection.hits;
+		return Future<std::shared_ptr<Resource>>::makeImmediate(std::move(res));
+	}
+
+	if (!Executors::hasInstance()) {
+		// Nowhere to stream from, just load it
+		return Future<std::shared_ptr<Resource>>::makeImmediate(collection.getUntyped(assetId, priority));
+	}
+
+	++collection.misses;
+	auto key = toString(collection.getAssetType()) + ":" + assetId;
+
+	{
+		std::unique_lock lock(mutex);
+
+		const auto iter = inFlight.find(key);
+		if (iter != inFlight.end()) {
+			auto& req = *iter->second;
+			if (req.queued && priority > req.priority) {
+				// Queue it again in the new bucket, popNext() skips the stale entry
+				req.priority = priority;
+				pending[int(priority)].push_back(iter->second);
+			}
+			return req.promise.getFuture();
+		}
+
+		auto req = std::make_shared<Request>(collection, assetId, key, priority);
+		inFlight[key] = req;
+		pending[int(priority)].push_back(req);
+		auto future = req->promise.getFuture();
+		lock.unlock();
+
+		// Each task reads whatever has the highest priority when it runs, not necessarily this request
+		enqueue(Executors::getDiskIO(), [this] () { read(); });
+		return future;
+	}
+}
+
+void ResourceStreamer::update(Time maxTime)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	while (true) {
+		std::shared_ptr<Request> req;
+		{
+			std::unique_lock lock(mutex);
+			if (toFinalize.empty()) {
+				break;
+			}
+			req = std::move(toFinalize.front());
+			toFinalize.pop_front();
+		}
+
+		if (req->result && req->loaded) {
+			req->result = req->collection.storeStreamed(req->assetId, std::move(req->result));
+		}
+
+		{
+			// Only remove it once it's in the collection, so requests arriving in the meantime don't load it again
+			std::unique_lock lock(mutex);
+			inFlight.erase(req->key);
+		}
+		req->promise.setValue(std::move(req->result));
+
+		const auto elapsed = std::chrono::duration<Time>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= maxTime) {
+			break;
+		}
+	}
+}
+
+void ResourceStreamer::abort()
+{
+	aborted = true;
+	while (running > 0) {
+		std::this_thread::yield();
+	}
+}
+
+size_t ResourceStreamer::getNumPending() const
+{
+	std::unique_lock lock(mutex);
+	return inFlight.size();
+}
+
+template <typename F>
+void ResourceStreamer::enqueue(ExecutionQueue& queue, F f)
+{
+	queue.addToQueue([self = shared_from_this(), f = std::move(f)] () mutable
+	{
+		// Count first, so abort() either sees this task running or this task sees the abort
+		++self->running;
+		auto guard = ScopedGuard([&] () { --self->running; });
+		if (!self->aborted) {
+			f();
+		}
+	});
+}
+
+std::shared_ptr<ResourceStreamer::Request> ResourceStreamer::popNext()
+{
+	std::unique_lock lock(mutex);
+	for (int i = int(pending.size()); --i >= 0;) {
+		auto& queue = pending[i];
+		while (!queue.empty()) {
+			auto req = std::move(queue.front());
+			queue.pop_front();
+			if (req->queued && int(req->priority) == i) {
+				req->queued = false;
+				return req;
+			}
+		}
+	}
+	return {};
+}
+
+void ResourceStreamer::read()
+{
+	auto req = popNext();
+	if (!req) {
+		return;
+	}
+
+	try {
+		ProfilerEvent event(ProfilerEventType::DiskIO, req->key);
+		req->data = req->collection.prefetch(req->assetId, req->priority);
+	} catch (const std::exception& e) {
+		// The decode stage will try again and report it properly
+		Logger::logDev("Failed to prefetch " + req->key + ": " + e.what());
+	}
+
+	enqueue(Executors::getCPU(), [this, req = std::move(req)] () { decode(req); });
+}
+
+void ResourceStreamer::decode(const std::shared_ptr<Request>& request)
+{
+	auto& req = *request;
+	if (auto res = req.collection.getIfLoaded(req.assetId)) {
+		req.data.reset();
+		req.result = std::move(res);
+	} else {
+		try {
+			std::tie(req.result, req.loaded) = req.collection.loadAsset(req.assetId, req.priority, true, std::move(req.data));
+		} catch (const std::exception& e) {
+			Logger::logError("Error streaming " + req.key + ": " + e.what());
+		} catch (...) {
+			Logger::logError("Unknown error streaming " + req.key);
+		}
+	}
+
+	std::unique_lock lock(mutex);
+	toFinalize.push_back(request);
+}
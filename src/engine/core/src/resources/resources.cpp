@@ -1,5 +1,6 @@
 #include "halley/resources/resources.h"
 #include "halley/resources/resource_locator.h"
+#include "halley/resources/resource_streamer.h"
 #include "halley/api/halley_api.h"
 #include "halley/support/logger.h"
 
@@ -9,9 +10,29 @@ Resources::Resources(std::unique_ptr<ResourceLocator> locator, const HalleyAPI&
 	: locator(std::move(locator))
 	, api(&api)
 	, options(options)
+	, streamer(std::make_shared<ResourceStreamer>())
 {
 }
 
+Future<std::shared_ptr<Resource>> Resources::requestAsync(AssetType type, std::string_view name, ResourceLoadPriority priority) const
+{
+	return streamer->request(ofType(type), name, priority);
+}
+
+void Resources::update(Time maxTime)
+{
+	streamer->update(maxTime);
+
+	if (hasMemoryBudgets) {
+		enforceMemoryBudgets();
+	}
+}
+
+size_t Resources::getNumStreamingRequests() const
+{
+	return streamer->getNumPending();
+}
+
 void Resources::reloadAssets(const Vector<String>& ids, const Vector<String>& packIds)
 {
 	// Early out
@@ -63,29 +84,129 @@ void Resources::reloadAssets(const std::map<AssetType, Vector<String>>& byType)
 	}
 }
 
-void Resources::generateMemoryReport()
+void Resources::setMemoryBudget(size_t bytes)
 {
-	Vector<std::pair<AssetType, ResourceMemoryUsage>> usage;
-	ResourceMemoryUsage total;
+	memoryBudget = bytes;
+	updateHasMemoryBudgets();
+}
+
+void Resources::setMemoryBudget(AssetType type, size_t bytes)
+{
+	ofType(type).setMemoryBudget(bytes);
+	updateHasMemoryBudgets();
+}
+
+void Resources::updateHasMemoryBudgets()
+{
+	hasMemoryBudgets = memoryBudget > 0 || std::any_of(resources.begin(), resources.end(), [] (const auto& r) { return r && r->getMemoryBudget() > 0; });
+}
 
+size_t Resources::getMemoryBudget() const
+{
+	return memoryBudget;
+}
+
+namespace {
+	ResourceMemoryUsage evictUntil(Vector<ResourceCollectionBase::EvictionCandidate>& candidates, size_t bytesToFree)
+	{
+		// Size-aware LRU: staleness weighted by size, so one big texture that hasn't been used in a while goes before
+		// lots of small resources that were used just as long ago
+		std::sort(candidates.begin(), candidates.end(), [] (const auto& a, const auto& b)
+		{
+			return double(a.age) * double(a.size) > double(b.age) * double(b.size);
+		});
+
+		ResourceMemoryUsage freed;
+		for (const auto& candidate: candidates) {
+			if (freed.getTotal() >= bytesToFree) {
+				break;
+			}
+			freed += candidate.collection->evict(candidate.assetId);
+		}
+		return freed;
+	}
+}
+
+ResourceMemoryUsage Resources::enforceMemoryBudgets()
+{
+	ResourceMemoryUsage freed;
+	Vector<ResourceCollectionBase::EvictionCandidate> candidates;
+	size_t total = 0;
+
+	// Per type budgets first
 	for (auto& res: resources) {
 		if (res) {
-			usage.emplace_back(res->getAssetType(), res->getMemoryUsage());
-			total += usage.back().second;
+			auto usage = res->getMemoryUsage().getTotal();
+			const auto budget = res->getMemoryBudget();
+			if (budget > 0 && usage > budget) {
+				candidates.clear();
+				res->getEvictionCandidates(candidates);
+				const auto typeFreed = evictUntil(candidates, usage - budget);
+				usage -= std::min(usage, typeFreed.getTotal());
+				freed += typeFreed;
+			}
+			total += usage;
 		}
 	}
 
-	std::sort(usage.begin(), usage.end(), [](const auto& a, const auto& b) { return a.second.getTotal() > b.second.getTotal(); });
+	// Then the global budget, with candidates of all types competing
+	if (memoryBudget > 0 && total > memoryBudget) {
+		candidates.clear();
+		for (auto& res: resources) {
+			if (res) {
+				res->getEvictionCandidates(candidates);
+			}
+		}
+		freed += evictUntil(candidates, total - memoryBudget);
+	}
 
-	Logger::logInfo("Resource memory usage: " + total.toString());
+	if (freed.getTotal() > 0) {
+		for (auto& res: resources) {
+			if (res) {
+				res->notifyResourcesUnloaded();
+			}
+		}
+	}
 
-	for (const auto& [assetType, memoryUsage] : usage) {
-		if (memoryUsage.ramUsage > 0 || memoryUsage.vramUsage > 0) {
-			Logger::logInfo(String("\t") + toString(assetType) + ": " + memoryUsage.toString());
+	return freed;
+}
+
+Vector<ResourceCollectionStats> Resources::getStats() const
+{
+	Vector<ResourceCollectionStats> result;
+	for (auto& res: resources) {
+		if (res) {
+			result.push_back(res->getStats());
+		}
+	}
+	return result;
+}
+
+void Resources::generateMemoryReport()
+{
+	auto stats = getStats();
+	ResourceMemoryUsage total;
+	for (const auto& s: stats) {
+		total += s.memoryUsage;
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) { return a.memoryUsage.getTotal() > b.memoryUsage.getTotal(); });
+
+	Logger::logInfo("Resource memory usage: " + total.toString() + (memoryBudget > 0 ? " / " + String::prettySize(memoryBudget) : ""));
+
+	for (const auto& s: stats) {
+		if (s.memoryUsage.ramUsage > 0 || s.memoryUsage.vramUsage > 0) {
+			Logger::logInfo(String("\t") + toString(s.type) + ": " + s.memoryUsage.toString()
+				+ (s.memoryBudget > 0 ? " / " + String::prettySize(s.memoryBudget) : "")
+				+ ", " + toString(s.numResident) + " resident, " + toString(lroundl(s.getHitRate() * 100)) + "% hits, " + toString(s.evictions) + " evicted");
 		}
 	}
 
 	locator->generateMemoryReport();
 }
 
-Resources::~Resources() = default;
+Resources::~Resources()
+{
+	// Make sure nothing is still streaming into the collections as they go away
+	streamer->abort();
+}
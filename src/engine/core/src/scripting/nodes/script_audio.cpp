@@ -83,7 +83,7 @@ IScriptNodeType::Result ScriptAudioEvent::doUpdate(ScriptEnvironment& environmen
 	auto variableNames = node.getSettings()["variables"].asVector<String>({});
 	for (size_t i = 0; i < variableNames.size(); ++i) {
 		const auto value = readDataPin(environment, node, i + 3).asFloat(0);
-		environment.getInterface<IAudioSystemInterface>().setVariable(entityId, variableNames[i], value);
+		environment.setAudioVariable(entityId, variableNames[i], value);
 	}
 
 	if (data.active) {
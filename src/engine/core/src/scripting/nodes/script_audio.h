@@ -17,6 +17,7 @@ namespace Halley {
 		String getName() const override { return "Audio Event"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/play_sound.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -19,6 +19,7 @@ namespace Halley {
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/flow_gate.png"; }
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::State; }
+		bool canRunInParallel() const override { return true; }
 
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 		String getPinDescription(const BaseGraphNode& node, PinType elementType, GraphPinId elementIdx) const override;
@@ -43,6 +44,7 @@ namespace Halley {
 		String getName() const override { return "Switch Gate"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/switch.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::State; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -70,6 +72,7 @@ namespace Halley {
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/flow_once.png"; }
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 		String getPinDescription(const BaseGraphNode& node, PinType elementType, GraphPinId elementIdx) const override;
@@ -95,6 +98,7 @@ namespace Halley {
 		String getName() const override { return "Latch"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/latch.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -125,6 +129,7 @@ namespace Halley {
 		String getName() const override { return "Cache"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/cache.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -151,6 +156,7 @@ namespace Halley {
 		String getName() const override { return "Fence"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/fence.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
@@ -177,6 +183,7 @@ namespace Halley {
 		String getName() const override { return "Breaker"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/breaker.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::State; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
@@ -194,6 +201,7 @@ namespace Halley {
 		String getName() const override { return "Signal"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/signal.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
@@ -219,6 +227,7 @@ namespace Halley {
 		String getName() const override { return "Line Reset"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/line_reset.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::State; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -238,6 +247,7 @@ namespace Halley {
 		String getName() const override { return "Detach Flow"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/detach_flow.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
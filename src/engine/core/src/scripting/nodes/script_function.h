@@ -8,6 +8,7 @@ namespace Halley {
 		String getName() const override { return "Call Function (External)"; }
 		String getIconName(const BaseGraphNode& node) const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Function; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
@@ -33,6 +34,7 @@ namespace Halley {
 		String getName() const override { return "Return"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/function_return.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Terminator; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
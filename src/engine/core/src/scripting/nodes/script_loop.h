@@ -17,6 +17,7 @@ namespace Halley {
 		String getName() const override { return "For Loop"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/loop.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 
 		String getLabel(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -39,6 +40,7 @@ namespace Halley {
 		String getName() const override { return "While Loop"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/loop.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 		String getPinDescription(const BaseGraphNode& node, PinType elementType, GraphPinId elementIdx) const override;
@@ -62,6 +64,7 @@ namespace Halley {
 		String getName() const override { return "For Each Loop"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/loop.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -98,6 +101,7 @@ namespace Halley {
 		String getName() const override { return "Lerp Loop"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/lerp.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 		bool canKeepData() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
@@ -129,6 +133,7 @@ namespace Halley {
 		String getName() const override { return "Every Frame"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/every_frame.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 		bool canKeepData() const override;
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -158,6 +163,7 @@ namespace Halley {
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/every_time.png"; }
 		String getLabel(const BaseGraphNode& node) const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
@@ -378,7 +378,7 @@ gsl::span<const IScriptNodeType::PinType> ScriptSendSystemMessage::getPinConfigu
 	using ET = ScriptNodeElementType;
 	using PD = GraphNodePinDirection;
 
-	static Vector<PinType> data;
+	static thread_local Vector<PinType> data;
 	data.clear();
 	data.push_back(PinType{ ET::FlowPin, PD::Input });
 	data.push_back(PinType{ ET::FlowPin, PD::Output });
@@ -8,6 +8,7 @@ namespace Halley {
 		String getName() const override { return "Send Message"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/send_message.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -23,6 +24,7 @@ namespace Halley {
 		String getName() const override { return "Send Generic Message"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/send_message.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -46,6 +48,7 @@ namespace Halley {
 		String getName() const override { return "Receive Message"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/receive_message.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Terminator; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -85,6 +88,7 @@ namespace Halley {
 		String getName() const override { return "Send System Msg"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/send_system_message.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -106,6 +110,7 @@ namespace Halley {
 		String getName() const override { return "Send Entity Msg"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/send_entity_message.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -8,6 +8,7 @@ namespace Halley {
 		String getName() const override { return "Comment"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/comment.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Comment; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
@@ -21,6 +22,7 @@ namespace Halley {
 		String getName() const override { return "Debug Display"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/debug_display.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::DebugDisplay; }
+		bool canRunInParallel() const override { return true; }
 
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -32,6 +34,7 @@ namespace Halley {
 		String getName() const override { return "Log"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/comment.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
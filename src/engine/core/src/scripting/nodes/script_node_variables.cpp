@@ -1,5 +1,7 @@
 #include "script_node_variables.h"
 
+#include "halley/scripting/script_graph_program.h"
+
 #include "halley/maths/interpolation_curve.h"
 #include "halley/maths/ops.h"
 #include "halley/maths/tween.h"
@@ -48,14 +50,14 @@ std::pair<String, Vector<ColourOverride>> ScriptVariable::getNodeDescription(con
 
 ConfigNode ScriptVariable::doGetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN) const
 {
-	const auto& vars = environment.getVariables(getScope(node));
-	return ConfigNode(vars.getVariable(node.getSettings()["variable"].asString("")));
+	const auto& variable = getVariable(environment, node);
+	return ConfigNode(environment.getVariables(variable.scope).getVariable(variable.id));
 }
 
 EntityId ScriptVariable::doGetEntityId(ScriptEnvironment& environment, const ScriptGraphNode& node, GraphPinId pinN) const
 {
-	const auto& vars = environment.getVariables(getScope(node));
-	const auto& data = vars.getVariable(node.getSettings()["variable"].asString(""));
+	const auto& variable = getVariable(environment, node);
+	const auto& data = environment.getVariables(variable.scope).getVariable(variable.id);
 	if (data.getType() == ConfigNodeType::EntityId || data.getType() == ConfigNodeType::Int || data.getType() == ConfigNodeType::Float) {
 		return data.asEntityId();
 	} else {
@@ -65,16 +67,14 @@ EntityId ScriptVariable::doGetEntityId(ScriptEnvironment& environment, const Scr
 
 void ScriptVariable::doSetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN, ConfigNode data) const
 {
-	const auto scope = getScope(node);
-	const auto variable = node.getSettings()["variable"].asString("");
+	const auto& variable = getVariable(environment, node);
 
-	if (scope != ScriptVariableScope::Local && !environment.hasNetworkAuthorityOver(environment.getCurrentEntityId())) {
-		Logger::logError(environment.getCurrentGraph()->getAssetId() + ": Cannot write to Script/Entity Variable \"" + variable + "\", not owned by this client");
+	if (variable.scope != ScriptVariableScope::Local && !environment.hasNetworkAuthorityOver(environment.getCurrentEntityId())) {
+		Logger::logError(environment.getCurrentGraph()->getAssetId() + ": Cannot write to Script/Entity Variable \"" + variable.id.getName() + "\", not owned by this client");
 		return;
 	}
 
-	auto& vars = environment.getVariables(scope);
-	vars.setVariable(variable, std::move(data));
+	environment.getVariables(variable.scope).setVariable(variable.id, std::move(data));
 }
 
 ConfigNode ScriptVariable::doGetDevConData(ScriptEnvironment& environment, const ScriptGraphNode& node) const
@@ -82,9 +82,15 @@ ConfigNode ScriptVariable::doGetDevConData(ScriptEnvironment& environment, const
 	return doGetData(environment, node, 1);
 }
 
-ScriptVariableScope ScriptVariable::getScope(const ScriptGraphNode& node) const
+std::optional<ScriptVariableRef> ScriptVariable::getVariableRef(const ScriptGraphNode& node) const
+{
+	const auto& settings = node.getSettings();
+	return ScriptVariableRef{ ScriptVariableId(settings["variable"].asString("")), fromString<ScriptVariableScope>(settings["scope"].asString("local")) };
+}
+
+const ScriptVariableRef& ScriptVariable::getVariable(ScriptEnvironment& environment, const ScriptGraphNode& node) const
 {
-	return fromString<ScriptVariableScope>(node.getSettings()["scope"].asString("local"));
+	return *environment.getCurrentGraph()->getProgram().tryGetVariable(node.getId());
 }
 
 
@@ -132,13 +138,13 @@ std::pair<String, Vector<ColourOverride>> ScriptEntityVariable::getNodeDescripti
 ConfigNode ScriptEntityVariable::doGetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN) const
 {
 	const auto& vars = environment.getEntityVariables(readEntityId(environment, node, 0));
-	return ConfigNode(vars.getVariable(node.getSettings()["variable"].asString("")));
+	return ConfigNode(vars.getVariable(getVariable(environment, node).id));
 }
 
 EntityId ScriptEntityVariable::doGetEntityId(ScriptEnvironment& environment, const ScriptGraphNode& node, GraphPinId pinN) const
 {
 	const auto& vars = environment.getEntityVariables(readEntityId(environment, node, 0));
-	return vars.getVariable(node.getSettings()["variable"].asString("")).asEntityId({});
+	return vars.getVariable(getVariable(environment, node).id).asEntityId({});
 }
 
 ConfigNode ScriptEntityVariable::doGetDevConData(ScriptEnvironment& environment, const ScriptGraphNode& node) const
@@ -151,14 +157,25 @@ void ScriptEntityVariable::doSetData(ScriptEnvironment& environment, const Scrip
 {
 	auto e = environment.tryGetEntity(readEntityId(environment, node, 0));
 	if (e.isValid()) {
+		const auto& variable = getVariable(environment, node);
 		if (!environment.hasNetworkAuthorityOver(e)) {
-			Logger::logError(environment.getCurrentGraph()->getAssetId() + ": Cannot write to Entity Variable \"" + node.getSettings()["variable"].asString("") + "\", not owned by this client");
+			Logger::logError(environment.getCurrentGraph()->getAssetId() + ": Cannot write to Entity Variable \"" + variable.id.getName() + "\", not owned by this client");
 			return;
 		}
-		environment.setEntityVariable(e.getEntityId(), node.getSettings()["variable"].asString(""), std::move(data));
+		environment.setEntityVariable(e.getEntityId(), variable.id, std::move(data));
 	}
 }
 
+std::optional<ScriptVariableRef> ScriptEntityVariable::getVariableRef(const ScriptGraphNode& node) const
+{
+	return ScriptVariableRef{ ScriptVariableId(node.getSettings()["variable"].asString("")), ScriptVariableScope::Entity };
+}
+
+const ScriptVariableRef& ScriptEntityVariable::getVariable(ScriptEnvironment& environment, const ScriptGraphNode& node) const
+{
+	return *environment.getCurrentGraph()->getProgram().tryGetVariable(node.getId());
+}
+
 
 String ScriptLiteral::getLargeLabel(const BaseGraphNode& node) const
 {
@@ -220,6 +237,14 @@ std::pair<String, Vector<ColourOverride>> ScriptLiteral::getNodeDescription(cons
 }
 
 ConfigNode ScriptLiteral::doGetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN) const
+{
+	if (const auto* value = environment.getCurrentGraph()->getProgram().tryGetConstant(node.getId())) {
+		return ConfigNode(*value);
+	}
+	return getConfigNode(node);
+}
+
+std::optional<ConfigNode> ScriptLiteral::getConstantValue(const ScriptGraphNode& node) const
 {
 	return getConfigNode(node);
 }
@@ -8,6 +8,7 @@ namespace Halley {
 		String getName() const override { return "Variable"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/variable.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Variable; }
+		bool canRunInParallel() const override { return true; }
 
 		String getLargeLabel(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -19,9 +20,10 @@ namespace Halley {
 		EntityId doGetEntityId(ScriptEnvironment& environment, const ScriptGraphNode& node, GraphPinId pinN) const override;
 		void doSetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN, ConfigNode data) const override;
 		ConfigNode doGetDevConData(ScriptEnvironment& environment, const ScriptGraphNode& node) const override;
+		std::optional<ScriptVariableRef> getVariableRef(const ScriptGraphNode& node) const override;
 
 	private:
-		ScriptVariableScope getScope(const ScriptGraphNode& node) const;
+		const ScriptVariableRef& getVariable(ScriptEnvironment& environment, const ScriptGraphNode& node) const;
 	};
 
 	class ScriptEntityVariable final : public ScriptNodeTypeBase<void> {
@@ -41,6 +43,10 @@ namespace Halley {
 		EntityId doGetEntityId(ScriptEnvironment& environment, const ScriptGraphNode& node, GraphPinId pinN) const override;
 		ConfigNode doGetDevConData(ScriptEnvironment& environment, const ScriptGraphNode& node) const override;
 		void doSetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN, ConfigNode data) const override;
+		std::optional<ScriptVariableRef> getVariableRef(const ScriptGraphNode& node) const override;
+
+	private:
+		const ScriptVariableRef& getVariable(ScriptEnvironment& environment, const ScriptGraphNode& node) const;
 	};
 	
 	class ScriptLiteral final : public ScriptNodeTypeBase<void> {
@@ -53,9 +59,11 @@ namespace Halley {
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		Vector<SettingType> getSettingTypes() const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Variable; }
+		bool canRunInParallel() const override { return true; }
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 
 		ConfigNode doGetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN) const override;
+		std::optional<ConfigNode> getConstantValue(const ScriptGraphNode& node) const override;
 
 	private:
 		ConfigNode getConfigNode(const BaseGraphNode& node) const;
@@ -68,6 +76,7 @@ namespace Halley {
 		String getName() const override { return "Variable Table"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/variable_table.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Variable; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		String getLargeLabel(const BaseGraphNode& node) const override;
@@ -106,6 +115,7 @@ namespace Halley {
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		Vector<SettingType> getSettingTypes() const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Variable; }
+		bool canRunInParallel() const override { return true; }
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 
 		ConfigNode doGetData(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN) const override;
@@ -117,6 +127,7 @@ namespace Halley {
 		String getName() const override { return "Comparison"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/comparison.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 		
 		String getLargeLabel(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -133,6 +144,7 @@ namespace Halley {
 		String getName() const override { return "Arithmetic"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/arithmetic.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		String getLargeLabel(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -149,6 +161,7 @@ namespace Halley {
 		String getName() const override { return "Value Or"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/value_or.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -163,6 +176,7 @@ namespace Halley {
 		String getName() const override { return "Conditional Operator"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/value_or.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -177,6 +191,7 @@ namespace Halley {
 		String getName() const override { return "Lerp"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/lerp.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -193,6 +208,7 @@ namespace Halley {
 		String getName() const override { return "Advance Variable To"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/advanceTo.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getPinDescription(const BaseGraphNode& node, PinType elementType, GraphPinId elementIdx) const override;
@@ -209,6 +225,7 @@ namespace Halley {
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/set_variable.png"; }
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 		Vector<SettingType> getSettingTypes() const override;
 		std::pair<String, Vector<ColourOverride>> getNodeDescription(const BaseGraphNode& node, const BaseGraph& graph) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -233,6 +250,7 @@ namespace Halley {
 		String getLabel(const BaseGraphNode& node) const override;
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/set_variable.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Action; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		bool hasDestructor(const ScriptGraphNode& node) const override { return true; }
@@ -250,6 +268,7 @@ namespace Halley {
 		String getName() const override { return "Conv EntityId->Data"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/convEntityIdToData.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -265,6 +284,7 @@ namespace Halley {
 		String getName() const override { return "Conv Data->EntityId"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/convDataToEntityId.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 		
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -279,6 +299,7 @@ namespace Halley {
 		String getName() const override { return "To Vector2"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/toVector.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 		
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -294,6 +315,7 @@ namespace Halley {
 		String getName() const override { return "From Vector2"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/fromVector.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 		
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -309,6 +331,7 @@ namespace Halley {
 		String getName() const override { return "Insert Value->Map"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/convDataToEntityId.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -324,6 +347,7 @@ namespace Halley {
 		String getName() const override { return "Get Value<-Map"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/convEntityIdToData.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -339,6 +363,7 @@ namespace Halley {
 		String getName() const override { return "Pack Map"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/map_pack.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -355,6 +380,7 @@ namespace Halley {
 		String getName() const override { return "Unpack Map"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/map_unpack.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		Vector<SettingType> getSettingTypes() const override;
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
@@ -371,6 +397,7 @@ namespace Halley {
 		String getName() const override { return "Insert Value->Sequence"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/convDataToEntityId.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
@@ -386,6 +413,7 @@ namespace Halley {
 		String getName() const override { return "Has Sequence Value"; }
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/convEntityIdToData.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::Expression; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		String getShortDescription(const ScriptGraphNode& node, const ScriptGraph& graph, GraphPinId elementIdx) const override;
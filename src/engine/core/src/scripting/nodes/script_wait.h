@@ -19,6 +19,7 @@ namespace Halley {
 		String getLabel(const BaseGraphNode& node) const override;
 		String getIconName(const BaseGraphNode& node) const override { return "script_icons/wait.png"; }
 		ScriptNodeClassification getClassification() const override { return ScriptNodeClassification::FlowControl; }
+		bool canRunInParallel() const override { return true; }
 
 		gsl::span<const PinType> getPinConfiguration(const BaseGraphNode& node) const override;
 		Vector<SettingType> getSettingTypes() const override;
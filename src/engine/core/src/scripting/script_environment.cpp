@@ -7,6 +7,7 @@
 #include "halley/support/logger.h"
 #include "halley/utils/algorithm.h"
 #include "halley/scripting/script_graph.h"
+#include "halley/scripting/script_graph_program.h"
 #include "halley/scripting/script_state.h"
 #include "halley/api/audio_api.h"
 #include "halley/audio/audio_event.h"
@@ -115,6 +116,7 @@ bool ScriptEnvironment::updateThread(ScriptState& graphState, ScriptStateThread&
 {
 	currentThread = &thread;
 	float& timeLeft = thread.getTimeSlice();
+	const auto& program = currentGraph->getProgram();
 
 	while (timeLeft > 0 && thread.isRunning()) {
 		// Get node type
@@ -144,7 +146,7 @@ bool ScriptEnvironment::updateThread(ScriptState& graphState, ScriptStateThread&
 			// Still running this node, suspend
 			timeLeft = 0;
 		} else if (result.state == ScriptNodeExecutionState::Fork || result.state == ScriptNodeExecutionState::ForkAndConvertToWatcher) {
-			forkThread(thread, nodeType.getOutputNodes(node, result.outputsActive), pendingThreads);
+			forkThread(thread, program.getOutputNodes(nodeId, result.outputsActive), pendingThreads);
 			if (result.state == ScriptNodeExecutionState::ForkAndConvertToWatcher) {
 				setWatcher(thread, true);
 			}
@@ -160,11 +162,11 @@ bool ScriptEnvironment::updateThread(ScriptState& graphState, ScriptStateThread&
 					mergeThread(thread, false);
 				}
 
-				const auto outputNodes = nodeType.getOutputNodes(node, result.outputsActive);
+				const auto outputNodes = program.getOutputNodes(nodeId, result.outputsActive);
 				forkThread(thread, outputNodes, pendingThreads, 1);
 				advanceThread(thread, outputNodes[0].dstNode, outputNodes[0].outputPin, outputNodes[0].inputPin);
 			} else if (result.state == ScriptNodeExecutionState::Detach) {
-				const auto outputNodes = nodeType.getOutputNodes(node, result.outputsActive);
+				const auto outputNodes = program.getOutputNodes(nodeId, result.outputsActive);
 				advanceThread(thread, {}, 0, 0);
 				forkThread(thread, outputNodes, pendingThreads, 0);
 			} else if (result.state == ScriptNodeExecutionState::Terminate) {
@@ -189,6 +191,7 @@ void ScriptEnvironment::terminateStateWith(const ScriptGraph* scriptGraph)
 	if (scriptGraph) {
 		const auto* prevGraph = currentGraph;
 		currentGraph = scriptGraph;
+		currentGraph->assignTypes(*nodeTypeCollection);
 		doTerminateState();
 		currentGraph = prevGraph;
 		Logger::logDev("Script restarted after changing");
@@ -425,9 +428,8 @@ void ScriptEnvironment::cancelOutputs(GraphNodeId nodeId, uint8_t cancelMask)
 	} else {
 		for (uint8_t i = 0; i < 8; ++i) {
 			if ((cancelMask & (1 << i)) != 0) {
-				auto& node = currentGraph->getNodes()[nodeId];
-				const auto pinIdx = node.getNodeType().getNthOutputPinIdx(node, i);
-				assert(node.getPinType(pinIdx).isCancellable);
+				const auto pinIdx = currentGraph->getProgram().getNthOutputPinIdx(nodeId, i);
+				assert(currentGraph->getNodes()[nodeId].getPinType(pinIdx).isCancellable);
 				abortCodePath(nodeId, pinIdx, false);
 			}
 		}
@@ -457,9 +459,7 @@ void ScriptEnvironment::returnFromFunction(ScriptStateThread& thread, uint8_t ou
 	const auto nodeId = currentGraph->getReturnTo(returnNodeId);
 
 	if (nodeId) {
-		const auto& node = currentGraph->getNodes()[*nodeId];
-		const auto& nodeType = node.getNodeType();
-		const auto outputNodes = nodeType.getOutputNodes(node, outputPins);
+		const auto outputNodes = currentGraph->getProgram().getOutputNodes(*nodeId, outputPins);
 
 		forkThread(thread, outputNodes, pendingThreads, 1);
 		advanceThread(thread, outputNodes[0].dstNode, outputNodes[0].outputPin, outputNodes[0].inputPin);
@@ -484,7 +484,7 @@ void ScriptEnvironment::processControlEvents(Time time, Vector<ScriptStateThread
 			const auto& node = currentGraph->getNodes()[event.nodeId];
 			const auto& nodeType = node.getNodeType();
 
-			const auto outputs = nodeType.getOutputNodes(node, 1);
+			const auto outputs = currentGraph->getProgram().getOutputNodes(event.nodeId, 1);
 			if (const auto dstNode = outputs[0].dstNode) {
 				const auto dstPin = outputs[0].inputPin;
 				pending.push_back(startThread(ScriptStateThread(*dstNode, dstPin)));
@@ -494,9 +494,7 @@ void ScriptEnvironment::processControlEvents(Time time, Vector<ScriptStateThread
 			auto* nodeData = dynamic_cast<ScriptTransferToHostData*>(getNodeData(event.nodeId));
 			dynamic_cast<const ScriptTransferToHost&>(nodeType).setParameters(node, *nodeData, std::move(event.params));
 		} else if (event.type == ScriptState::ControlEventType::CancelThread) {
-			const auto& node = currentGraph->getNodes()[event.nodeId];
-			const auto& nodeType = node.getNodeType();
-			const auto outputs = nodeType.getOutputNodes(node, 1);
+			const auto outputs = currentGraph->getProgram().getOutputNodes(event.nodeId, 1);
 			if (const auto dstNode = outputs[0].dstNode) {
 				abortCodePath(*dstNode, {}, true);
 			}
@@ -680,6 +678,15 @@ void ScriptEnvironment::sendEntityMessage(EntityMessageData message)
 }
 
 void ScriptEnvironment::sendSystemMessage(SystemMessageData message)
+{
+	if (deferSideEffects) {
+		systemMessageOutbox.push_back(std::move(message));
+	} else {
+		doSendSystemMessage(std::move(message));
+	}
+}
+
+void ScriptEnvironment::doSendSystemMessage(SystemMessageData message)
 {
 	auto msg = world.deserializeSystemMessage(message.messageName, message.messageData);
 	const auto dst = msg->getMessageDestination();
@@ -724,6 +731,58 @@ Vector<ScriptEnvironment::ScriptExecutionRequest> ScriptEnvironment::getScriptEx
 	return std::move(scriptExecutionRequestOutbox);
 }
 
+void ScriptEnvironment::setDeferSideEffects(bool defer)
+{
+	deferSideEffects = defer;
+}
+
+ScriptEnvironment::Outbox ScriptEnvironment::takeOutbox()
+{
+	Outbox result;
+	result.scriptMessages = std::move(scriptOutbox);
+	result.entityMessages = std::move(entityOutbox);
+	result.executionRequests = std::move(scriptExecutionRequestOutbox);
+	result.systemMessages = std::move(systemMessageOutbox);
+	result.audioCommands = std::move(audioOutbox);
+	scriptOutbox.clear();
+	entityOutbox.clear();
+	scriptExecutionRequestOutbox.clear();
+	systemMessageOutbox.clear();
+	audioOutbox.clear();
+	return result;
+}
+
+void ScriptEnvironment::mergeOutbox(Outbox outbox)
+{
+	for (auto& msg: outbox.scriptMessages) {
+		scriptOutbox.push_back(std::move(msg));
+	}
+	for (auto& msg: outbox.entityMessages) {
+		entityOutbox.push_back(std::move(msg));
+	}
+	for (auto& request: outbox.executionRequests) {
+		scriptExecutionRequestOutbox.push_back(std::move(request));
+	}
+	for (auto& msg: outbox.systemMessages) {
+		sendSystemMessage(std::move(msg));
+	}
+	for (auto& command: outbox.audioCommands) {
+		if (deferSideEffects) {
+			audioOutbox.push_back(std::move(command));
+		} else {
+			doAudioCommand(command);
+		}
+	}
+}
+
+void ScriptEnvironment::copySettingsFrom(const ScriptEnvironment& other)
+{
+	scriptTargetRetriever = other.scriptTargetRetriever;
+	variableTable = other.variableTable;
+	isHost = other.isHost;
+	inputEnabled = other.inputEnabled;
+}
+
 void ScriptEnvironment::startHostThread(int node, ConfigNode params)
 {
 	getInterface<IScriptSystemInterface>().startHostThread(currentEntity, currentGraph->getAssetId(), node, std::move(params));
@@ -819,21 +878,19 @@ void ScriptEnvironment::assignTypes(const ScriptGraph& graph)
 
 ConfigNode ScriptEnvironment::readInputDataPin(const ScriptGraphNode& node, GraphPinId pinN)
 {
-	const auto& pins = node.getPins();
-	if (pinN >= pins.size()) {
+	const auto& program = currentGraph->getProgram();
+	const auto& link = program.getLink(node.getId(), pinN);
+	if (!link.node) {
 		return {};
 	}
 
-	const auto& pin = pins[pinN];
-	if (pin.connections.empty() || !pin.connections[0].dstNode) {
-		return {};
+	const auto dstNodeId = link.node.value();
+	if (const auto* constant = program.tryGetConstant(dstNodeId)) {
+		return ConfigNode(*constant);
 	}
-	assert(pin.connections.size() == 1);
 
-	const auto& dst = pin.connections[0];
-	const auto& nodes = currentGraph->getNodes();
-	const auto& dstNode = nodes[dst.dstNode.value()];
-	return dstNode.getNodeType().getData(*this, dstNode, dst.dstPin, getNodeData(dst.dstNode.value()));
+	const auto& dstNode = currentGraph->getNodes()[dstNodeId];
+	return dstNode.getNodeType().getData(*this, dstNode, link.pin, getNodeData(dstNodeId));
 }
 
 ConfigNode ScriptEnvironment::readOutputDataPin(const ScriptGraphNode& node, GraphPinId pinN)
@@ -843,16 +900,11 @@ ConfigNode ScriptEnvironment::readOutputDataPin(const ScriptGraphNode& node, Gra
 
 EntityId ScriptEnvironment::readInputEntityId(const ScriptGraphNode& node, GraphPinId pinN, bool disconnectedIsSelf)
 {
-	if (pinN < node.getPins().size()) {
-		const auto& pin = node.getPins()[pinN];
-		if (!pin.connections.empty()) {
-			const auto& conn = pin.connections[0];
-			if (conn.dstNode) {
-				const auto& nodes = getCurrentGraph()->getNodes();
-				const auto& dstNode = nodes.at(conn.dstNode.value());
-				return dstNode.getNodeType().getEntityId(*this, dstNode, conn.dstPin, getNodeData(conn.dstNode.value()));
-			}
-		}
+	const auto& link = currentGraph->getProgram().getLink(node.getId(), pinN);
+	if (link.node) {
+		const auto dstNodeId = link.node.value();
+		const auto& dstNode = currentGraph->getNodes()[dstNodeId];
+		return dstNode.getNodeType().getEntityId(*this, dstNode, link.pin, getNodeData(dstNodeId));
 	}
 	return disconnectedIsSelf ? currentEntity : EntityId();
 }
@@ -875,7 +927,32 @@ EntityId ScriptEnvironment::readOutputEntityId(const ScriptGraphNode& node, Grap
 void ScriptEnvironment::postAudioEvent(const String& id, EntityId entityId)
 {
 	if (!id.isEmpty()) {
-		getInterface<IAudioSystemInterface>().playAudio(id, entityId);
+		auto command = AudioCommand{ entityId, id, std::nullopt };
+		if (deferSideEffects) {
+			audioOutbox.push_back(std::move(command));
+		} else {
+			doAudioCommand(command);
+		}
+	}
+}
+
+void ScriptEnvironment::setAudioVariable(EntityId entityId, const String& variable, float value)
+{
+	auto command = AudioCommand{ entityId, variable, value };
+	if (deferSideEffects) {
+		audioOutbox.push_back(std::move(command));
+	} else {
+		doAudioCommand(command);
+	}
+}
+
+void ScriptEnvironment::doAudioCommand(const AudioCommand& command)
+{
+	auto& audio = getInterface<IAudioSystemInterface>();
+	if (command.variableValue) {
+		audio.setVariable(command.entityId, command.id, *command.variableValue);
+	} else {
+		audio.playAudio(command.id, command.entityId);
 	}
 }
 
@@ -922,12 +999,17 @@ const ScriptVariables& ScriptEnvironment::getEntityVariables(EntityId entityId)
 }
 
 void ScriptEnvironment::setEntityVariable(EntityId entityId, const String& name, ConfigNode value) const
+{
+	setEntityVariable(entityId, ScriptVariableId(name), std::move(value));
+}
+
+void ScriptEnvironment::setEntityVariable(EntityId entityId, const ScriptVariableId& id, ConfigNode value) const
 {
 	auto entity = tryGetEntity(entityId);
 	if (entity.isValid()) {
 		auto* scriptable = entity.tryGetComponent<ScriptableComponent>();
 		if (scriptable) {
-			scriptable->variables.setVariable(name, std::move(value));
+			scriptable->variables.setVariable(id, std::move(value));
 		}
 	}
 }
@@ -7,6 +7,7 @@
 #include "halley/utils/hash.h"
 #include "nodes/script_messaging.h"
 #include "halley/scripting/script_node_type.h"
+#include "halley/scripting/script_graph_program.h"
 using namespace Halley;
 
 ScriptGraphNode::PinConnection::PinConnection(const ConfigNode& node)
@@ -378,6 +379,20 @@ uint64_t ScriptGraph::getHash() const
 	return hash;
 }
 
+const ScriptGraphProgram& ScriptGraph::getProgram() const
+{
+	// Never built here, as this is called from the worker threads running scripts in parallel
+	if (!program || program->getGraphHash() != hash) {
+		throw Exception("Script graph \"" + getAssetId() + "\" has no program for its current version, types must be assigned first.", HalleyExceptions::Entity);
+	}
+	return *program;
+}
+
+void ScriptGraph::onTypesAssigned() const
+{
+	program = std::make_shared<const ScriptGraphProgram>(*this);
+}
+
 uint64_t ScriptGraph::getAssetHash() const
 {
 	return assetHash;
@@ -0,0 +1,108 @@
+#include "halley/scripting/script_graph_program.h"
+#include "halley/scripting/script_graph.h"
+using namespace Halley;
+
+ScriptGraphProgram::ScriptGraphProgram(const ScriptGraph& graph)
+	: graphHash(graph.getHash())
+{
+	const auto& graphNodes = graph.getNodes();
+	nodes.resize(graphNodes.size());
+
+	for (size_t i = 0; i < graphNodes.size(); ++i) {
+		const auto& node = graphNodes[i];
+		const auto& nodeType = node.getNodeType();
+		const auto& pins = node.getPins();
+		const auto& pinConfig = nodeType.getPinConfiguration(node);
+		auto& entry = nodes[i];
+
+		parallel = parallel && nodeType.canRunInParallel();
+
+		entry.firstLink = static_cast<uint32_t>(links.size());
+		entry.numLinks = static_cast<GraphPinId>(pins.size());
+		for (const auto& pin: pins) {
+			if (!pin.connections.empty() && pin.connections[0].dstNode) {
+				links.push_back(PinLink{ pin.connections[0].dstNode, pin.connections[0].dstPin });
+			} else {
+				links.push_back(PinLink{});
+			}
+		}
+
+		// Same order as the flow output bits in IScriptNodeType::Result
+		entry.firstFlowOutput = static_cast<uint32_t>(flowOutputs.size());
+		for (size_t j = 0; j < pinConfig.size(); ++j) {
+			if (pinConfig[j].type == GraphElementType(ScriptNodeElementType::FlowPin) && pinConfig[j].direction == GraphNodePinDirection::Output) {
+				auto& output = flowOutputs.emplace_back();
+				output.pin = static_cast<GraphPinId>(j);
+				output.firstTarget = static_cast<uint32_t>(targets.size());
+				if (j < pins.size()) {
+					for (const auto& conn: pins[j].connections) {
+						if (conn.dstNode) {
+							targets.push_back(OutputNode{ conn.dstNode, static_cast<GraphPinId>(j), conn.dstPin });
+						}
+					}
+				}
+				output.numTargets = static_cast<uint32_t>(targets.size()) - output.firstTarget;
+			}
+		}
+		entry.numFlowOutputs = static_cast<uint8_t>(flowOutputs.size() - entry.firstFlowOutput);
+
+		if (auto constant = nodeType.getConstantValue(node)) {
+			entry.constantIdx = static_cast<int>(constants.size());
+			constants.push_back(std::move(*constant));
+		}
+
+		if (auto variable = nodeType.getVariableRef(node)) {
+			entry.variableIdx = static_cast<int>(variables.size());
+			variables.push_back(std::move(*variable));
+		}
+	}
+}
+
+const ScriptGraphProgram::PinLink& ScriptGraphProgram::getLink(GraphNodeId node, GraphPinId pin) const
+{
+	const auto& entry = nodes[node];
+	if (pin >= entry.numLinks) {
+		return emptyLink;
+	}
+	return links[entry.firstLink + pin];
+}
+
+std::array<ScriptGraphProgram::OutputNode, 8> ScriptGraphProgram::getOutputNodes(GraphNodeId node, uint8_t outputActiveMask) const
+{
+	std::array<OutputNode, 8> result;
+	result.fill({});
+
+	const auto& entry = nodes[node];
+	size_t nOutputsFound = 0;
+	for (size_t i = 0; i < entry.numFlowOutputs; ++i) {
+		if ((outputActiveMask & (1 << i)) != 0) {
+			const auto& output = flowOutputs[entry.firstFlowOutput + i];
+			for (uint32_t j = 0; j < output.numTargets; ++j) {
+				result[nOutputsFound++] = targets[output.firstTarget + j];
+			}
+		}
+	}
+
+	return result;
+}
+
+GraphPinId ScriptGraphProgram::getNthOutputPinIdx(GraphNodeId node, size_t n) const
+{
+	const auto& entry = nodes[node];
+	if (n >= entry.numFlowOutputs) {
+		return 0xFF;
+	}
+	return flowOutputs[entry.firstFlowOutput + n].pin;
+}
+
+const ConfigNode* ScriptGraphProgram::tryGetConstant(GraphNodeId node) const
+{
+	const auto idx = nodes[node].constantIdx;
+	return idx >= 0 ? &constants[idx] : nullptr;
+}
+
+const ScriptVariableRef* ScriptGraphProgram::tryGetVariable(GraphNodeId node) const
+{
+	const auto idx = nodes[node].variableIdx;
+	return idx >= 0 ? &variables[idx] : nullptr;
+}
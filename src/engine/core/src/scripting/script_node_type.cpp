@@ -1,4 +1,5 @@
 #include "halley/scripting/script_node_type.h"
+#include "halley/scripting/script_graph_program.h"
 
 #include <cassert>
 
@@ -85,21 +86,15 @@ ConfigNode IScriptNodeType::readDataPin(ScriptEnvironment& environment, const Sc
 
 void IScriptNodeType::writeDataPin(ScriptEnvironment& environment, const ScriptGraphNode& node, size_t pinN, ConfigNode data) const
 {
-	const auto& pins = node.getPins();
-	if (pinN >= pins.size()) {
+	const auto* graph = environment.getCurrentGraph();
+	const auto& link = graph->getProgram().getLink(node.getId(), static_cast<GraphPinId>(pinN));
+	if (!link.node) {
 		return;
 	}
 
-	const auto& pin = pins[pinN];
-	if (pin.connections.empty() || !pin.connections[0].dstNode) {
-		return;
-	}
-	assert(pin.connections.size() == 1);
-
-	const auto& dst = pin.connections[0];
-	const auto& nodes = environment.getCurrentGraph()->getNodes();
-	const auto& dstNode = nodes[dst.dstNode.value()];
-	dstNode.getNodeType().setData(environment, dstNode, dst.dstPin, std::move(data), environment.getNodeData(dst.dstNode.value()));
+	const auto dstNodeId = link.node.value();
+	const auto& dstNode = graph->getNodes()[dstNodeId];
+	dstNode.getNodeType().setData(environment, dstNode, link.pin, std::move(data), environment.getNodeData(dstNodeId));
 }
 
 String IScriptNodeType::getConnectedNodeName(const BaseGraphNode& node, const BaseGraph& graph, size_t pinN) const
@@ -147,49 +142,6 @@ EntityId IScriptNodeType::readRawEntityId(ScriptEnvironment& environment, const
 	return environment.readInputEntityIdRaw(node, static_cast<GraphPinId>(idx));
 }
 
-std::array<IScriptNodeType::OutputNode, 8> IScriptNodeType::getOutputNodes(const ScriptGraphNode& node, uint8_t outputActiveMask) const
-{
-	std::array<OutputNode, 8> result;
-	result.fill({});
-	
-	const auto& pinConfig = getPinConfiguration(node);
-
-	size_t curOutputPin = 0;
-	size_t nOutputsFound = 0;
-	for (size_t i = 0; i < pinConfig.size(); ++i) {
-		if (pinConfig[i].type == GraphElementType(ScriptNodeElementType::FlowPin) && pinConfig[i].direction == GraphNodePinDirection::Output) {
-			const bool outputActive = (outputActiveMask & (1 << curOutputPin)) != 0;
-			if (outputActive) {
-				const auto& output = node.getPin(i);
-				for (auto& conn: output.connections) {
-					if (conn.dstNode) {
-						result[nOutputsFound++] = OutputNode{ conn.dstNode, static_cast<GraphPinId>(i), conn.dstPin };
-					}
-				}
-			}
-
-			++curOutputPin;
-		}
-	}
-
-	return result;
-}
-
-GraphPinId IScriptNodeType::getNthOutputPinIdx(const ScriptGraphNode& node, size_t n) const
-{
-	const auto& pinConfig = getPinConfiguration(node);
-	size_t curOutputPin = 0;
-	for (size_t i = 0; i < pinConfig.size(); ++i) {
-		if (pinConfig[i].type == GraphElementType(ScriptNodeElementType::FlowPin) && pinConfig[i].direction == GraphNodePinDirection::Output) {
-			if (curOutputPin == n) {
-				return static_cast<GraphPinId>(i);
-			}
-			++curOutputPin;
-		}
-	}
-	return 0xFF;
-}
-
 String IScriptNodeType::addParentheses(String str)
 {
 	if (str.contains(' ')) {
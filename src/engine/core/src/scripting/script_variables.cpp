@@ -4,6 +4,12 @@
 
 using namespace Halley;
 
+ScriptVariableId::ScriptVariableId(String n)
+	: name(std::move(n))
+	, hash(std::hash<String>()(name))
+{
+}
+
 ScriptVariables::ScriptVariables(const ConfigNode& node, const EntitySerializationContext& context)
 {
 	load(node, context);
@@ -16,25 +22,27 @@ void ScriptVariables::load(const ConfigNode& node, const EntitySerializationCont
 		for (const auto& [k, v]: node.asMap()) {
 			if (k.startsWith("entity!")) {
 				const auto entityId = ConfigNodeSerializer<EntityId>().deserialize(context, v);
-				variables[k.mid(7)] = entityId;
+				getOrCreate(ScriptVariableId(k.mid(7))) = entityId;
 			} else {
-				variables[k] = v;
+				getOrCreate(ScriptVariableId(k)) = ConfigNode(v);
 			}
 		}
 	} else if (node.getType() != ConfigNodeType::Undefined) {
 		for (const auto& [k, v]: node.asMap()) {
 			if (k.startsWith("entity!")) {
+				const auto id = ScriptVariableId(k.mid(7));
 				if (v.getType() == ConfigNodeType::Del) {
-					variables.erase(k.mid(7));
+					erase(id);
 				} else {
 					const auto entityId = ConfigNodeSerializer<EntityId>().deserialize(context, v);
-					variables[k.mid(7)] = entityId;
+					getOrCreate(id) = entityId;
 				}
 			} else {
+				const auto id = ScriptVariableId(k);
 				if (v.getType() == ConfigNodeType::Del) {
-					variables.erase(k);
+					erase(id);
 				} else {
-					variables[k].applyDelta(v);
+					getOrCreate(id).applyDelta(v);
 				}
 			}
 		}
@@ -44,11 +52,11 @@ void ScriptVariables::load(const ConfigNode& node, const EntitySerializationCont
 ConfigNode ScriptVariables::toConfigNode(const EntitySerializationContext& context) const
 {
 	ConfigNode::MapType result;
-	for (const auto& [k, v]: variables) {
-		if (v.getType() == ConfigNodeType::EntityId) {
-			result["entity!" + k] = ConfigNodeSerializer<EntityId>().serialize(v.asEntityId(), context);
+	for (const auto& [id, value]: variables) {
+		if (value.getType() == ConfigNodeType::EntityId) {
+			result["entity!" + id.getName()] = ConfigNodeSerializer<EntityId>().serialize(value.asEntityId(), context);
 		} else {
-			result[k] = v;
+			result[id.getName()] = ConfigNode(value);
 		}
 	}
 	return result;
@@ -56,7 +64,12 @@ ConfigNode ScriptVariables::toConfigNode(const EntitySerializationContext& conte
 
 const ConfigNode& ScriptVariables::getVariable(const String& name) const
 {
-	const auto iter = variables.find(name);
+	return getVariable(ScriptVariableId(name));
+}
+
+const ConfigNode& ScriptVariables::getVariable(const ScriptVariableId& id) const
+{
+	const auto iter = variables.find(id);
 	if (iter != variables.end()) {
 		return iter->second;
 	}
@@ -65,12 +78,17 @@ const ConfigNode& ScriptVariables::getVariable(const String& name) const
 
 void ScriptVariables::setVariable(const String& name, ConfigNode value)
 {
-	variables[name] = std::move(value);
+	setVariable(ScriptVariableId(name), std::move(value));
+}
+
+void ScriptVariables::setVariable(const ScriptVariableId& id, ConfigNode value)
+{
+	getOrCreate(id) = std::move(value);
 }
 
 bool ScriptVariables::hasVariable(const String& name) const
 {
-	return variables.find(name) != variables.end();
+	return variables.find(ScriptVariableId(name)) != variables.end();
 }
 
 bool ScriptVariables::empty() const
@@ -83,6 +101,16 @@ void ScriptVariables::clear()
 	variables.clear();
 }
 
+ConfigNode& ScriptVariables::getOrCreate(const ScriptVariableId& id)
+{
+	return variables[id];
+}
+
+void ScriptVariables::erase(const ScriptVariableId& id)
+{
+	variables.erase(id);
+}
+
 ConfigNode ConfigNodeSerializer<ScriptVariables>::serialize(const ScriptVariables& variables, const EntitySerializationContext& context)
 {
 	return variables.toConfigNode(context);
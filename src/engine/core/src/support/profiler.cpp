@@ -1,5 +1,10 @@
 #include "halley/support/profiler.h"
 
+#include <fstream>
+#include <sstream>
+#include "halley/support/exception.h"
+#include "halley/support/logger.h"
+#include "halley/text/string_converter.h"
 #include "halley/utils/algorithm.h"
 
 using namespace Halley;
@@ -137,11 +142,115 @@ void ProfilerData::processEvents()
 	std::sort(threads.begin(), threads.end());
 }
 
-ProfilerCapture::ProfilerCapture(size_t maxEvents)
-	: recording(false)
-	, curId(0)
+namespace {
+	int64_t toNanoseconds(std::chrono::steady_clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	}
+
+	std::chrono::steady_clock::time_point fromNanoseconds(int64_t ns)
+	{
+		return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(ns)));
+	}
+
+	std::atomic<uint64_t> nextInstanceId = 1;
+
+	template <typename T>
+	void writeValue(Bytes& dst, T value)
+	{
+		const auto pos = dst.size();
+		dst.resize(pos + sizeof(T));
+		memcpy(dst.data() + pos, &value, sizeof(T));
+	}
+
+	template <typename T>
+	T readValue(gsl::span<const gsl::byte> data, size_t& pos)
+	{
+		if (pos + sizeof(T) > data.size()) {
+			throw Exception("Truncated profiler trace", HalleyExceptions::Utils);
+		}
+		T value;
+		memcpy(&value, data.data() + pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+}
+
+// Keyed by instance id rather than pointer, in case a capture is destroyed and another one takes its address
+struct ProfilerCapture::ThreadBufferCache {
+	uint64_t owner = 0;
+	ThreadBuffer* buffer = nullptr;
+	std::shared_ptr<std::atomic<ThreadBuffer::OwnerState>> ownerState; // Shared, as the capture might be gone by the time this thread exits
+
+	~ThreadBufferCache()
+	{
+		release();
+	}
+
+	void release()
+	{
+		if (ownerState) {
+			ownerState->store(ThreadBuffer::OwnerState::Exited, std::memory_order_release);
+			ownerState.reset();
+		}
+	}
+};
+
+thread_local ProfilerCapture::ThreadBufferCache ProfilerCapture::threadBufferCache;
+
+ProfilerCapture::ThreadBuffer::ThreadBuffer(size_t capacity, uint32_t index)
+	: index(index)
+	, threadId(std::this_thread::get_id())
+	, ownerState(std::make_shared<std::atomic<OwnerState>>(OwnerState::Alive))
+	, capacity(capacity)
+	, slots(new Slot[capacity])
+	, writePos(0)
+{
+	for (size_t i = 0; i < capacity; ++i) {
+		slots[i].seq = std::numeric_limits<uint64_t>::max();
+	}
+}
+
+uint64_t ProfilerCapture::ThreadBuffer::getWritePos() const
+{
+	return writePos.load(std::memory_order_acquire);
+}
+
+bool ProfilerCapture::ThreadBuffer::read(uint64_t seq, ReadEvent& dst) const
 {
-	events.resize(maxEvents);
+	// The owner thread might be overwriting this slot as we read it, so only accept it if the sequence number is the
+	// same before and after reading
+	const auto& slot = slots[seq % capacity];
+	if (slot.seq.load(std::memory_order_acquire) != seq) {
+		return false;
+	}
+	dst.seq = seq;
+	dst.startTime = slot.startTime.load(std::memory_order_relaxed);
+	dst.endTime = slot.endTime.load(std::memory_order_relaxed);
+	dst.nameId = slot.nameId.load(std::memory_order_relaxed);
+	dst.type = slot.type.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.seq.load(std::memory_order_relaxed) == seq;
+}
+
+ProfilerCapture::ProfilerCapture(size_t maxEventsPerThread)
+	: instanceId(nextInstanceId++)
+	, maxEventsPerThread(maxEventsPerThread)
+	, recording(false)
+	, numThreadBuffers(0)
+	, warnedMaxThreads(false)
+	, streaming(false)
+{
+	for (auto& b: threadBuffers) {
+		b = nullptr;
+	}
+	names.push_back("");
+	nameIds[""] = 0;
+}
+
+ProfilerCapture::~ProfilerCapture()
+{
+	stopStreaming();
 }
 
 ProfilerCapture& ProfilerCapture::get()
@@ -163,27 +272,44 @@ void ProfilerCapture::recordEventEnd(EventId id)
 
 ProfilerCapture::EventId ProfilerCapture::recordEventStart(ProfilerEventType type, std::string_view name, std::chrono::steady_clock::time_point time)
 {
-	if (recording) {
-		const auto id = curId++; // I think this is thread-safe?
-		if (id < endId) {
-			const auto pos = id % events.size();
-			const auto threadId = type == ProfilerEventType::GPU ? std::thread::id() : std::this_thread::get_id();
-			events[pos] = ProfilerData::Event{ name, threadId, type, 0, id, time, {} };
-			return id;
-		} else {
-			--curId;
-		}
+	if (!recording) {
+		return 0;
+	}
+
+	auto* buffer = getThreadBuffer();
+	if (!buffer) {
+		return 0;
 	}
-	return 0;
+
+	const auto nameId = getNameId(*buffer, name);
+	const auto seq = buffer->writePos.load(std::memory_order_relaxed);
+	auto& slot = buffer->slots[seq % buffer->capacity];
+
+	// Invalidate the slot while it's written, readers will skip it
+	slot.seq.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.startTime.store(toNanoseconds(time), std::memory_order_relaxed);
+	slot.endTime.store(0, std::memory_order_relaxed);
+	slot.nameId.store(nameId, std::memory_order_relaxed);
+	slot.type.store(type, std::memory_order_relaxed);
+	slot.seq.store(seq, std::memory_order_release);
+	buffer->writePos.store(seq + 1, std::memory_order_release);
+
+	return (EventId(buffer->index + 1) << seqBits) | seq;
 }
 
 void ProfilerCapture::recordEventEnd(EventId id, std::chrono::steady_clock::time_point time)
 {
-	if (recording && id != 0) {
-		const auto pos = id % events.size();
-		if (events[pos].id == id) { // Dodgy, potential race condition here
-			events[pos].endTime = time;
-		}
+	if (id == 0) {
+		return;
+	}
+
+	const auto bufferIdx = (id >> seqBits) - 1;
+	const auto seq = id & ((EventId(1) << seqBits) - 1);
+	const auto* buffer = threadBuffers[bufferIdx].load(std::memory_order_acquire);
+	auto& slot = buffer->slots[seq % buffer->capacity];
+	if (slot.seq.load(std::memory_order_relaxed) == seq) {
+		slot.endTime.store(toNanoseconds(time), std::memory_order_release);
 	}
 }
 
@@ -203,10 +329,20 @@ void ProfilerCapture::startFrame(bool rec)
 	}
 	frameEndTime = {};
 
-	startId = curId.fetch_add(events.size()) + events.size();
-	endId = startId + events.size();
+	const auto n = numThreadBuffers.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < n; ++i) {
+		auto* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		buffer->frameStart = buffer->getWritePos();
 
-	recording = rec;
+		// The last capture that could include the exited owner's events is done, so another thread can have it.
+		// Traces name each thread only once, so nothing is recycled while streaming.
+		auto exited = ThreadBuffer::OwnerState::Exited;
+		if (!streaming) {
+			buffer->ownerState->compare_exchange_strong(exited, ThreadBuffer::OwnerState::Free, std::memory_order_acq_rel);
+		}
+	}
+
+	recording = rec || streaming;
 	state = State::FrameStarted;
 }
 
@@ -215,6 +351,13 @@ void ProfilerCapture::endFrame()
 	Expects(state == State::FrameStarted);
 	
 	frameEndTime = std::chrono::steady_clock::now();
+
+	const auto n = numThreadBuffers.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < n; ++i) {
+		auto* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		buffer->frameEnd = buffer->getWritePos();
+	}
+
 	state = State::FrameEnded;
 }
 
@@ -222,18 +365,31 @@ ProfilerData ProfilerCapture::getCapture()
 {
 	Expects(state == State::FrameEnded);
 
-	const auto startIdx = startId % events.size();
-	const auto endIdx = curId % events.size();
-
-	Vector<ProfilerData::Event> eventsCopy;
-	if (startIdx < endIdx) {
-		eventsCopy.insert(eventsCopy.end(), events.begin() + startIdx, events.begin() + endIdx);
-	} else {
-		eventsCopy.insert(eventsCopy.end(), events.begin() + startIdx, events.end());
-		eventsCopy.insert(eventsCopy.end(), events.begin(), events.begin() + endIdx);
+	Vector<ProfilerData::Event> events;
+	std::unique_lock lock(namesMutex);
+
+	const auto n = numThreadBuffers.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < n; ++i) {
+		const auto* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		const auto end = buffer->frameEnd;
+		const auto start = std::max(buffer->frameStart, end > buffer->capacity ? end - buffer->capacity : 0);
+
+		ReadEvent e;
+		for (auto seq = start; seq < end; ++seq) {
+			if (buffer->read(seq, e)) {
+				const auto threadId = e.type == ProfilerEventType::GPU ? std::thread::id() : buffer->threadId.load(std::memory_order_relaxed);
+				const auto endTime = e.endTime != 0 ? fromNanoseconds(e.endTime) : std::chrono::steady_clock::time_point();
+				events.push_back(ProfilerData::Event{ names[e.nameId], threadId, e.type, 0, (EventId(buffer->index + 1) << seqBits) | seq, fromNanoseconds(e.startTime), endTime });
+			}
+		}
 	}
+
+	lock.unlock();
+
+	// Events are only ordered within each thread
+	std::stable_sort(events.begin(), events.end(), [] (const ProfilerData::Event& a, const ProfilerData::Event& b) { return a.startTime < b.startTime; });
 	
-	return ProfilerData(frameStartTime, frameEndTime, std::move(eventsCopy));
+	return ProfilerData(frameStartTime, frameEndTime, std::move(events));
 }
 
 Time ProfilerCapture::getFrameTime() const
@@ -243,6 +399,342 @@ Time ProfilerCapture::getFrameTime() const
 	return std::chrono::duration<Time>(frameEndTime - frameStartTime).count();
 }
 
+bool ProfilerCapture::startStreaming(const Path& path)
+{
+	stopStreaming();
+
+#ifdef _WIN32
+	auto out = std::make_unique<std::ofstream>(path.getString().getUTF16().c_str(), std::ios::binary | std::ios::out);
+#else
+	auto out = std::make_unique<std::ofstream>(path.string(), std::ios::binary | std::ios::out);
+#endif
+	if (!out->is_open()) {
+		Logger::logError("Unable to open \"" + path.getNativeString() + "\" to write profiler trace.");
+		return false;
+	}
+
+	out->write(ProfilerTrace::magic.data(), ProfilerTrace::magic.size());
+	out->write(reinterpret_cast<const char*>(&ProfilerTrace::version), sizeof(ProfilerTrace::version));
+
+	// Only record events from now on, so older ones in the buffers don't end up in the trace
+	const auto n = numThreadBuffers.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < n; ++i) {
+		auto* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		buffer->streamed = buffer->getWritePos();
+	}
+
+	streaming = true;
+	recording = true;
+	streamThread = std::thread([this, out = std::shared_ptr<std::ofstream>(std::move(out))] () mutable
+	{
+		runStreaming(*out);
+	});
+	return true;
+}
+
+void ProfilerCapture::stopStreaming()
+{
+	if (streamThread.joinable()) {
+		{
+			std::unique_lock lock(streamMutex);
+			streaming = false;
+		}
+		streamCondition.notify_all();
+		streamThread.join();
+	}
+}
+
+bool ProfilerCapture::isStreaming() const
+{
+	return streaming;
+}
+
+ProfilerCapture::ThreadBuffer* ProfilerCapture::getThreadBuffer()
+{
+	if (threadBufferCache.owner == instanceId) {
+		return threadBufferCache.buffer;
+	}
+
+	// This thread might have been recording into another capture before
+	threadBufferCache.release();
+
+	std::unique_lock lock(threadBuffersMutex);
+	ThreadBuffer* buffer = nullptr;
+	if (!streaming) {
+		for (auto& b: ownedThreadBuffers) {
+			auto free = ThreadBuffer::OwnerState::Free;
+			if (b->ownerState->compare_exchange_strong(free, ThreadBuffer::OwnerState::Alive, std::memory_order_acq_rel)) {
+				buffer = b.get();
+				buffer->threadId.store(std::this_thread::get_id(), std::memory_order_relaxed);
+				break;
+			}
+		}
+	}
+
+	if (!buffer) {
+		const auto idx = numThreadBuffers.load(std::memory_order_relaxed);
+		if (idx >= maxThreads) {
+			if (!warnedMaxThreads.exchange(true)) {
+				Logger::logWarning("Profiler is recording from more than " + toString(maxThreads) + " threads at once, events from new threads will be ignored.");
+			}
+			return nullptr;
+		}
+
+		buffer = ownedThreadBuffers.emplace_back(std::make_unique<ThreadBuffer>(maxEventsPerThread, idx)).get();
+		threadBuffers[idx].store(buffer, std::memory_order_release);
+		numThreadBuffers.store(idx + 1, std::memory_order_release);
+	}
+
+	threadBufferCache.owner = instanceId;
+	threadBufferCache.buffer = buffer;
+	threadBufferCache.ownerState = buffer->ownerState;
+	return buffer;
+}
+
+uint32_t ProfilerCapture::getNameId(ThreadBuffer& buffer, std::string_view name)
+{
+	if (name.empty()) {
+		return 0;
+	}
+
+	const auto iter = buffer.nameCache.find(name);
+	if (iter != buffer.nameCache.end()) {
+		return iter->second;
+	}
+
+	uint32_t id;
+	{
+		std::unique_lock lock(namesMutex);
+		const auto globalIter = nameIds.find(name);
+		if (globalIter != nameIds.end()) {
+			id = globalIter->second;
+		} else {
+			id = static_cast<uint32_t>(names.size());
+			names.push_back(String(name));
+			nameIds[String(name)] = id;
+		}
+	}
+
+	buffer.nameCache[String(name)] = id;
+	return id;
+}
+
+void ProfilerCapture::runStreaming(std::ostream& out)
+{
+	uint32_t threadsWritten = 0;
+	uint32_t namesWritten = 0;
+
+	std::unique_lock lock(streamMutex);
+	while (streaming) {
+		streamCondition.wait_for(lock, std::chrono::milliseconds(50));
+		lock.unlock();
+		writeStreamed(out, threadsWritten, namesWritten, !streaming);
+		lock.lock();
+	}
+	out.flush();
+}
+
+void ProfilerCapture::writeStreamed(std::ostream& out, uint32_t& threadsWritten, uint32_t& namesWritten, bool final)
+{
+	Bytes eventData;
+	ReadEvent e;
+
+	const auto n = numThreadBuffers.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < n; ++i) {
+		auto* buffer = threadBuffers[i].load(std::memory_order_acquire);
+		const auto end = buffer->getWritePos();
+		if (end > buffer->capacity && buffer->streamed < end - buffer->capacity) {
+			// Writer couldn't keep up with this thread
+			writeValue(eventData, ProfilerTrace::RecordType::Dropped);
+			writeValue(eventData, uint32_t(i));
+			writeValue(eventData, uint64_t(end - buffer->capacity - buffer->streamed));
+			buffer->streamed = end - buffer->capacity;
+		}
+
+		for (; buffer->streamed < end; ++buffer->streamed) {
+			const auto seq = buffer->streamed;
+			if (!buffer->read(seq, e)) {
+				continue;
+			}
+
+			// Wait for events to end before writing them, unless they're about to be overwritten
+			if (e.endTime == 0 && !final && end - seq < buffer->capacity / 2) {
+				break;
+			}
+
+			writeValue(eventData, ProfilerTrace::RecordType::Event);
+			writeValue(eventData, uint32_t(i));
+			writeValue(eventData, e.type);
+			writeValue(eventData, e.nameId);
+			writeValue(eventData, e.startTime);
+			writeValue(eventData, e.endTime);
+		}
+	}
+
+	// Threads and names are written after reading the events, so everything the events refer to is already there
+	Bytes header;
+	for (; threadsWritten < n; ++threadsWritten) {
+		const auto* buffer = threadBuffers[threadsWritten].load(std::memory_order_acquire);
+		writeValue(header, ProfilerTrace::RecordType::Thread);
+		writeValue(header, threadsWritten);
+		writeValue(header, uint64_t(std::hash<std::thread::id>()(buffer->threadId.load(std::memory_order_relaxed))));
+	}
+	{
+		std::unique_lock lock(namesMutex);
+		for (; namesWritten < names.size(); ++namesWritten) {
+			const auto& name = names[namesWritten];
+			writeValue(header, ProfilerTrace::RecordType::Name);
+			writeValue(header, namesWritten);
+			writeValue(header, uint32_t(name.size()));
+			const auto pos = header.size();
+			header.resize(pos + name.size());
+			memcpy(header.data() + pos, name.c_str(), name.size());
+		}
+	}
+
+	out.write(reinterpret_cast<const char*>(header.data()), header.size());
+	out.write(reinterpret_cast<const char*>(eventData.data()), eventData.size());
+}
+
+ProfilerTrace::ProfilerTrace(gsl::span<const gsl::byte> data)
+{
+	size_t pos = 0;
+	if (data.size() < magic.size() + sizeof(version) || memcmp(data.data(), magic.data(), magic.size()) != 0) {
+		throw Exception("Not a profiler trace", HalleyExceptions::Utils);
+	}
+	pos += magic.size();
+	if (readValue<uint32_t>(data, pos) != version) {
+		throw Exception("Unsupported profiler trace version", HalleyExceptions::Utils);
+	}
+
+	while (pos < data.size()) {
+		switch (readValue<RecordType>(data, pos)) {
+		case RecordType::Thread:
+			{
+				Thread thread;
+				thread.index = readValue<uint32_t>(data, pos);
+				thread.threadId = readValue<uint64_t>(data, pos);
+				threads.push_back(thread);
+				break;
+			}
+		case RecordType::Name:
+			{
+				const auto id = readValue<uint32_t>(data, pos);
+				const auto len = readValue<uint32_t>(data, pos);
+				if (pos + len > data.size()) {
+					throw Exception("Truncated profiler trace", HalleyExceptions::Utils);
+				}
+				if (names.size() <= id) {
+					names.resize(id + 1);
+				}
+				names[id] = String(reinterpret_cast<const char*>(data.data() + pos), len);
+				pos += len;
+				break;
+			}
+		case RecordType::Event:
+			{
+				Event event;
+				event.threadIndex = readValue<uint32_t>(data, pos);
+				event.type = readValue<ProfilerEventType>(data, pos);
+				event.nameId = readValue<uint32_t>(data, pos);
+				event.startTime = readValue<int64_t>(data, pos);
+				event.endTime = readValue<int64_t>(data, pos);
+				events.push_back(event);
+				break;
+			}
+		case RecordType::Dropped:
+			{
+				readValue<uint32_t>(data, pos);
+				droppedEvents += readValue<uint64_t>(data, pos);
+				break;
+			}
+		default:
+			throw Exception("Invalid record in profiler trace", HalleyExceptions::Utils);
+		}
+	}
+}
+
+const Vector<ProfilerTrace::Thread>& ProfilerTrace::getThreads() const
+{
+	return threads;
+}
+
+const Vector<ProfilerTrace::Event>& ProfilerTrace::getEvents() const
+{
+	return events;
+}
+
+const String& ProfilerTrace::getName(uint32_t nameId) const
+{
+	static const String empty;
+	return nameId < names.size() ? names[nameId] : empty;
+}
+
+uint64_t ProfilerTrace::getDroppedEvents() const
+{
+	return droppedEvents;
+}
+
+String ProfilerTrace::toChromeJSON() const
+{
+	const auto escape = [] (std::string_view str)
+	{
+		std::string result;
+		result.reserve(str.size());
+		for (const char c: str) {
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			} else if (static_cast<unsigned char>(c) < 0x20) {
+				result += "\\u00";
+				result += toString(int(c), 16, 2).cppStr();
+			} else {
+				result += c;
+			}
+		}
+		return result;
+	};
+
+	int64_t origin = std::numeric_limits<int64_t>::max();
+	for (const auto& e: events) {
+		origin = std::min(origin, e.startTime);
+	}
+
+	std::stringstream out;
+	out << "{\"traceEvents\":[";
+	bool first = true;
+	const auto separator = [&] ()
+	{
+		if (!first) {
+			out << ",\n";
+		}
+		first = false;
+	};
+
+	for (const auto& thread: threads) {
+		separator();
+		out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread.index << ",\"args\":{\"name\":\"Thread " << thread.index << "\"}}";
+	}
+	separator();
+	out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << gpuThreadIndex << ",\"args\":{\"name\":\"GPU\"}}";
+
+	for (const auto& e: events) {
+		const auto& name = getName(e.nameId);
+		const auto typeName = toString(e.type);
+		const auto start = e.startTime - origin;
+		const auto duration = e.endTime != 0 ? e.endTime - e.startTime : 0;
+
+		separator();
+		out << "{\"ph\":\"X\",\"name\":\"" << escape(name.isEmpty() ? typeName : name) << "\",\"cat\":\"" << typeName << "\"";
+		out << ",\"pid\":1,\"tid\":" << (e.type == ProfilerEventType::GPU ? gpuThreadIndex : e.threadIndex);
+		out << ",\"ts\":" << (start / 1000) << "." << toString(start % 1000, 10, 3);
+		out << ",\"dur\":" << (duration / 1000) << "." << toString(duration % 1000, 10, 3) << "}";
+	}
+
+	out << "]}";
+	return out.str();
+}
+
 constexpr static bool isDevMode()
 {
 #ifdef DEV_BUILD
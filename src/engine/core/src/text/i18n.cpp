@@ -47,7 +47,7 @@ void I18N::setFallbackLanguage(const I18NLanguage& code)
 
 void I18N::loadLocalisationFile(const ConfigFile& config)
 {
-	loadLocalisation(config.getRoot());
+	loadLocalisation(config.getView());
 #ifdef DEV_BUILD
 	observers[config.getAssetId()] = ConfigObserver(config);
 #endif
@@ -65,6 +65,17 @@ void I18N::loadLocalisation(const ConfigNode& root)
 	++version;
 }
 
+void I18N::loadLocalisation(ConfigNodeView root)
+{
+	for (const auto& [langCode, language]: root.asMap()) {
+		auto& lang = strings[I18NLanguage(String(langCode))];
+		for (const auto& [key, value]: language.asMap()) {
+			lang[String(key)] = value.asString();
+		}
+	}
+	++version;
+}
+
 Vector<I18NLanguage> I18N::getLanguagesAvailable() const
 {
 	Vector<I18NLanguage> result;
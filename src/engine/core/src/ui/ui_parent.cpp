@@ -105,6 +105,8 @@ bool UIParent::isWaitingToSpawnChildren() const
 
 void UIParent::markAsNeedingLayout() {}
 
+void UIParent::markAsNeedingRelayout() {}
+
 Vector<std::shared_ptr<UIWidget>>& UIParent::getChildren()
 {
 	/*
@@ -63,11 +63,28 @@ Rect4f UIRoot::getRect() const
 
 void UIRoot::runLayout()
 {
+	const bool rectChanged = lastLayoutRect != uiRect;
+	lastLayoutRect = uiRect;
+
+	laidOutChildren.clear();
 	for (auto& c: getChildren()) {
-		c->layout();
+		if (rectChanged || !incrementalLayout || c->layoutDirty) {
+			c->layout();
+			laidOutChildren.push_back(c);
+		}
 	}
 }
 
+void UIRoot::setIncrementalLayout(bool enabled)
+{
+	incrementalLayout = enabled;
+}
+
+bool UIRoot::isIncrementalLayout() const
+{
+	return incrementalLayout;
+}
+
 void UIRoot::update(Time t, UIInputType activeInputType, spInputDevice mouse, spInputDevice manual)
 {
 	auto joystickType = manual ? manual->getJoystickType() : JoystickType::Generic;
@@ -93,13 +110,15 @@ void UIRoot::update(Time t, UIInputType activeInputType, spInputDevice mouse, sp
 		first = false;
 		removeDeadChildren();
 
-		// Layout all widgets
+		// Layout widgets that changed
 		runLayout();
 
 		// Update again, to reflect what happened >_>
-		for (auto& c: getChildren()) {
+		// Subtrees that weren't laid out didn't move, so they can be skipped
+		for (auto& c: laidOutChildren) {
 			c->doUpdate(UIWidgetUpdateType::Partial, 0, activeInputType, joystickType);
 		}
+		laidOutChildren.clear();
 
 		// For subsequent iterations, make sure t = 0
 		t = 0;
@@ -498,6 +517,11 @@ UIRoot::WidgetUnderMouseResult UIRoot::getWidgetUnderMouse(const std::shared_ptr
 		return {};
 	}
 
+	// Nothing in this subtree can be under the mouse
+	if (const auto bounds = curWidget->getMouseBounds(); bounds && !bounds->contains(mousePos)) {
+		return {};
+	}
+
 	// Depth first
 	if (!curWidget->canPropagateMouseToChildren()) {
 		ignoreMouseInteraction = true;
@@ -189,6 +189,7 @@ void UISizer::add(std::shared_ptr<IUIElement> element, float proportion, Vector4
 {
 	entries.emplace(entries.begin() + std::min(entries.size(), insertPos), UISizerEntry(element, proportion, border, fillFlags));
 	reparentEntry(entries.back());
+	markParentAsNeedingLayout();
 }
 
 void UISizer::addSpacer(float size)
@@ -205,6 +206,7 @@ void UISizer::addStretchSpacer(float proportion)
 void UISizer::remove(IUIElement& element)
 {
 	entries.erase(std::remove_if(entries.begin(), entries.end(), [&] (const UISizerEntry& e) { return e.getPointer().get() == &element; }), entries.end());
+	markParentAsNeedingLayout();
 }
 
 void UISizer::reparent(UIParent& parent)
@@ -296,6 +298,7 @@ void UISizer::updateEnabled() const
 void UISizer::swapItems(int idxA, int idxB)
 {
 	std::swap(entries[idxA], entries[idxB]);
+	markParentAsNeedingLayout();
 }
 
 void UISizer::clear()
@@ -312,6 +315,7 @@ void UISizer::clear()
 		}
 	}
 	entries.clear();
+	markParentAsNeedingLayout();
 }
 
 bool UISizer::isActive() const
@@ -329,6 +333,7 @@ void UISizer::setColumnProportions(const Vector<float>& values)
 	if (gridProportions) {
 		gridProportions->columnProportions = values;
 		gridProportions->columnProportions.resize(gridProportions->nColumns, 0);
+		markParentAsNeedingLayout();
 	}
 }
 
@@ -339,6 +344,7 @@ void UISizer::setEvenColumns()
 		for (auto& c: gridProportions->columnProportions) {
 			c = 1.0f;
 		}
+		markParentAsNeedingLayout();
 	}
 }
 
@@ -347,6 +353,7 @@ void UISizer::setRowProportions(const Vector<float>& values)
 {
 	if (gridProportions) {
 		gridProportions->rowProportions = values;
+		markParentAsNeedingLayout();
 	}
 }
 
@@ -679,4 +686,12 @@ void UISizer::sortChildrenBySizerOrder()
 			children[i] = std::dynamic_pointer_cast<UIWidget>(entries[i].getPointer());
 		}
 	}
+	markParentAsNeedingLayout();
+}
+
+void UISizer::markParentAsNeedingLayout()
+{
+	if (curParent) {
+		curParent->markAsNeedingLayout();
+	}
 }
@@ -124,24 +124,30 @@ Vector2f UIWidget::getLayoutMinimumSize(bool force) const
 	if (!isActive() && !force) {
 		return {};
 	}
-	Vector2f minSize = getMinimumSize();
 
-	if (sizer) {
-		if (layoutNeeded > 0) {
-			--layoutNeeded;
+	// Cached until markAsNeedingLayout is called on this widget or one of its descendants
+	if (layoutNeeded > 0) {
+		--layoutNeeded;
+		layoutSize = getMinimumSize();
+		if (sizer) {
 			auto border = getInnerBorder();
-			layoutSize = sizer->getLayoutMinimumSize(false);
-			if (layoutSize.x > 0.1f || layoutSize.y > 0.1f) {
-				layoutSize += Vector2f(border.x + border.z, border.y + border.w);
+			auto sizerSize = sizer->getLayoutMinimumSize(false);
+			if (sizerSize.x > 0.1f || sizerSize.y > 0.1f) {
+				sizerSize += Vector2f(border.x + border.z, border.y + border.w);
 			}
+			layoutSize = Vector2f::max(layoutSize, sizerSize);
 		}
-		return Vector2f::max(minSize, layoutSize);
 	}
-	return minSize;
+	return layoutSize;
 }
 
 void UIWidget::setRect(Rect4f rect, IUIElementListener* listener)
 {
+	if (canSkipLayout(rect, listener)) {
+		return;
+	}
+
+	layoutDirty = false;
 	setWidgetRect(rect);
 	if (sizer) {
 		const auto border = getInnerBorder();
@@ -335,7 +341,10 @@ bool UIWidget::canPropagateMouseToChildren() const
 
 void UIWidget::setPropagateMouseToChildren(bool enabled)
 {
-	propagateMouseToChildren = enabled;
+	if (propagateMouseToChildren != enabled) {
+		propagateMouseToChildren = enabled;
+		markMouseBoundsDirty();
+	}
 }
 
 void UIWidget::notifyWidgetUnderMouse(const std::shared_ptr<UIWidget>& widget)
@@ -395,8 +404,12 @@ bool UIWidget::ignoreClip() const
 void UIWidget::setPosition(Vector2f pos)
 {
 	Expects(pos.isValid());
-	
-	position = pos;
+
+	if (position != pos) {
+		position = pos;
+		markAsNeedingRelayout();
+		markMouseBoundsDirty();
+	}
 	positionUpdated = true;
 }
 
@@ -653,12 +666,18 @@ void UIWidget::setMouseClip(std::optional<Rect4f> clip, bool force)
 {
 	if (force || clip != mouseClip) {
 		mouseClip = clip;
+		markMouseBoundsDirty();
 		for (auto& c: getChildren()) {
 			c->setMouseClip(clip, force);
 		}
 	}
 }
 
+const std::optional<Rect4f>& UIWidget::getMouseClip() const
+{
+	return mouseClip;
+}
+
 void UIWidget::onManualControlCycleValue(int delta)
 {
 }
@@ -902,6 +921,20 @@ std::optional<Vector2f> UIWidget::transformToChildSpace(Vector2f pos) const
 	return pos;
 }
 
+Rect4f UIWidget::transformFromChildSpace(Rect4f rect) const
+{
+	return rect;
+}
+
+std::optional<Rect4f> UIWidget::getMouseBounds() const
+{
+	if (mouseBoundsDirty) {
+		mouseBounds = computeMouseBounds();
+		mouseBoundsDirty = false;
+	}
+	return mouseBounds;
+}
+
 std::optional<MouseCursorMode> UIWidget::getMouseCursorMode() const
 {
 	return std::nullopt;
@@ -1014,6 +1047,8 @@ bool UIWidget::needsLayout() const
 void UIWidget::markAsNeedingLayout()
 {
 	layoutNeeded = 1;
+	layoutDirty = true;
+	mouseBoundsDirty = true;
 	if (parent) {
 		parent->markAsNeedingLayout();
 	}
@@ -1022,6 +1057,15 @@ void UIWidget::markAsNeedingLayout()
 	}
 }
 
+void UIWidget::markAsNeedingRelayout()
+{
+	layoutDirty = true;
+	mouseBoundsDirty = true;
+	if (parent) {
+		parent->markAsNeedingRelayout();
+	}
+}
+
 bool UIWidget::canReceiveFocus() const
 {
 	return false;
@@ -1085,14 +1129,59 @@ void UIWidget::playStyleSound(const String& keyId)
 
 void UIWidget::setWidgetRect(Rect4f rect)
 {
-	if (position != rect.getTopLeft()) {
+	if (rect != getRect()) {
 		position = rect.getTopLeft();
-		positionUpdated = true;
-	}
-	if (size != rect.getSize()) {
 		size = rect.getSize();
 		positionUpdated = true;
+		markMouseBoundsDirty();
+	}
+}
+
+void UIWidget::markMouseBoundsDirty()
+{
+	// If this is already dirty, so are all of its ancestors
+	if (!mouseBoundsDirty) {
+		mouseBoundsDirty = true;
+		if (auto* parentWidget = dynamic_cast<UIWidget*>(parent)) {
+			parentWidget->markMouseBoundsDirty();
+		}
+	}
+}
+
+std::optional<Rect4f> UIWidget::computeMouseBounds() const
+{
+	std::optional<Rect4f> bounds;
+	bool unbounded = !canPropagateMouseToChildren(); // Needs to be notified of the widget under mouse even when it's not over it
+
+	const auto addRect = [&] (Rect4f rect)
+	{
+		if (rect.getWidth() > 0 && rect.getHeight() > 0) {
+			bounds = bounds ? bounds->merge(rect) : rect;
+		}
+	};
+
+	addRect(getMouseRect());
+	for (const auto& c: getChildren()) {
+		if (c->isActive()) {
+			// Visit every child even if this is unbounded, so none of them is left dirty under a clean parent
+			if (const auto childBounds = c->getMouseBounds()) {
+				addRect(transformFromChildSpace(*childBounds));
+			} else {
+				unbounded = true;
+			}
+		}
 	}
+
+	if (unbounded) {
+		return std::nullopt;
+	}
+	return bounds.value_or(Rect4f(getPosition(), getPosition()));
+}
+
+bool UIWidget::canSkipLayout(Rect4f rect, IUIElementListener* listener) const
+{
+	// Nothing in this subtree changed since it was last placed, and it's being placed in the same spot
+	return !layoutDirty && !listener && root && root->isIncrementalLayout() && rect == getRect();
 }
 
 void UIWidget::resetInputResults()
@@ -187,7 +187,10 @@ void UIClickable::onMouseDoubleClicked(Vector2f mousePos, int button, KeyMods ke
 
 void UIClickable::setMouseExtraBorder(std::optional<Vector4f> override)
 {
-	mouseExtraBorder = override;
+	if (mouseExtraBorder != override) {
+		mouseExtraBorder = override;
+		markMouseBoundsDirty();
+	}
 }
 
 std::optional<MouseCursorMode> UIClickable::getMouseCursorMode() const
@@ -176,9 +176,22 @@ std::optional<Vector2f> UIRenderSurface::transformToChildSpace(Vector2f pos) con
 	}
 }
 
+Rect4f UIRenderSurface::transformFromChildSpace(Rect4f rect) const
+{
+	if (isRendering()) {
+		const auto p0 = getPosition();
+		return Rect4f((rect.getTopLeft() - p0) * scale + p0, (rect.getBottomRight() - p0) * scale + p0);
+	} else {
+		return rect;
+	}
+}
+
 void UIRenderSurface::setBypass(bool bypass)
 {
-	this->bypass = bypass;
+	if (this->bypass != bypass) {
+		this->bypass = bypass;
+		markAsNeedingLayout();
+	}
 }
 
 void UIRenderSurface::setAutoBypass(bool autoBypass)
@@ -214,7 +227,7 @@ void UIRenderSurface::update(Time t, bool moved)
 	}
 
 	if (autoBypass) {
-		bypass = Colour4c(colour) == Colour4c(255, 255, 255, 255) && std::abs(scale.x - 1.0f) < 0.00001f && std::abs(scale.y - 1.0f) < 0.00001f;
+		setBypass(Colour4c(colour) == Colour4c(255, 255, 255, 255) && std::abs(scale.x - 1.0f) < 0.00001f && std::abs(scale.y - 1.0f) < 0.00001f);
 	}
 }
 
@@ -58,7 +58,10 @@ Vector2f UIScrollPane::getRelativeScrollEndPosition() const
 
 void UIScrollPane::setClipSize(Vector2f clipSize)
 {
-	this->clipSize = clipSize;
+	if (this->clipSize != clipSize) {
+		this->clipSize = clipSize;
+		markAsNeedingLayout();
+	}
 }
 
 void UIScrollPane::scrollTo(Vector2f position)
@@ -75,6 +78,7 @@ void UIScrollPane::scrollTo(Vector2f position)
 	}
 
 	if (scrollPos != old) {
+		markAsNeedingRelayout();
 		sendEventDown(UIEvent(UIEventType::ScrollPositionChanged, getId(), Vector2f(scrollPos)));
 	}
 }
@@ -0,0 +1,381 @@
+#include "halley/ui/widgets/ui_virtual_list.h"
+#include "halley/ui/ui_style.h"
+#include "halley/input/input_keyboard.h"
+
+using namespace Halley;
+
+UIVirtualList::UIVirtualList(String id, UIStyle style, float rowHeight, MakeRowCallback makeRow, BindRowCallback bindRow)
+	: UIClickable(std::move(id), {}, UISizer(UISizerType::Free), style.getBorder("innerBorder"))
+	, makeRow(std::move(makeRow))
+	, bindRow(std::move(bindRow))
+	, rowHeight(rowHeight)
+	, gap(style.getFloat("gap"))
+{
+	Expects(rowHeight > 0);
+
+	styles.emplace_back(style);
+	sprite = style.getSprite("background");
+
+	const auto itemStyle = style.getSubStyle("item");
+	itemSprite = itemStyle.getSprite("normal");
+	hoverSprite = itemStyle.getSprite("hover");
+	if (itemStyle.hasSprite("selected")) {
+		selectedSprite = itemStyle.getSprite("selected");
+	}
+}
+
+void UIVirtualList::setCount(int c)
+{
+	c = std::max(c, 0);
+	if (count != c) {
+		count = c;
+		rowsDirty = true;
+		markAsNeedingLayout();
+
+		if (curOption >= count) {
+			setSelectedOption(count - 1);
+		}
+		if (curHover >= count) {
+			setHover(-1);
+		}
+	}
+}
+
+int UIVirtualList::getCount() const
+{
+	return count;
+}
+
+void UIVirtualList::setRowHeight(float height)
+{
+	Expects(height > 0);
+	if (rowHeight != height) {
+		rowHeight = height;
+		for (auto& row: rows) {
+			row.widget->setMinSize(Vector2f(0, rowHeight));
+		}
+		rowsDirty = true;
+		markAsNeedingLayout();
+	}
+}
+
+float UIVirtualList::getRowHeight() const
+{
+	return rowHeight;
+}
+
+void UIVirtualList::setItemIdCallback(GetItemIdCallback callback)
+{
+	getItemIdCallback = std::move(callback);
+}
+
+String UIVirtualList::getItemId(int index) const
+{
+	if (index < 0 || index >= count) {
+		return "";
+	}
+	return getItemIdCallback ? getItemIdCallback(index) : toString(index);
+}
+
+void UIVirtualList::refresh()
+{
+	rowsDirty = true;
+}
+
+bool UIVirtualList::setSelectedOption(int option)
+{
+	const int newOption = count > 0 ? clamp(option, -1, count - 1) : -1;
+	if (newOption == curOption) {
+		return false;
+	}
+
+	curOption = newOption;
+	sendEvent(UIEvent(UIEventType::ListSelectionChanged, getId(), getSelectedOptionId(), curOption));
+	if (curOption >= 0) {
+		sendEvent(UIEvent(UIEventType::MakeAreaVisible, getId(), getOptionRect(curOption)));
+	}
+	return true;
+}
+
+int UIVirtualList::getSelectedOption() const
+{
+	return curOption;
+}
+
+String UIVirtualList::getSelectedOptionId() const
+{
+	return getItemId(curOption);
+}
+
+std::optional<int> UIVirtualList::getHoveredOption() const
+{
+	if (curHover >= 0) {
+		return curHover;
+	}
+	return std::nullopt;
+}
+
+void UIVirtualList::showCurSelection(bool centre)
+{
+	if (curOption >= 0) {
+		sendEvent(UIEvent(centre ? UIEventType::MakeAreaVisibleCentered : UIEventType::MakeAreaVisible, getId(), getOptionRect(curOption)));
+	}
+}
+
+Rect4f UIVirtualList::getOptionRect(int option) const
+{
+	const auto border = getInnerBorder();
+	const auto p0 = Vector2f(border.x, border.y + clamp(option, 0, std::max(count - 1, 0)) * getRowStride());
+	const auto rect = Rect4f(p0, p0 + Vector2f(getSize().x - border.x - border.z, rowHeight));
+	return rect.grow(styles[0].getBorder("scrollBorder", Vector4f()));
+}
+
+std::optional<int> UIVirtualList::getOptionAt(Vector2f pos) const
+{
+	const auto border = getInnerBorder();
+	const auto localPos = pos - getPosition() - border.xy();
+	if (localPos.x < 0 || localPos.y < 0 || localPos.x >= getSize().x - border.x - border.z) {
+		return std::nullopt;
+	}
+
+	const auto stride = getRowStride();
+	const int option = static_cast<int>(localPos.y / stride);
+	if (option >= count || localPos.y - option * stride >= rowHeight) {
+		return std::nullopt;
+	}
+	return option;
+}
+
+bool UIVirtualList::canReceiveFocus() const
+{
+	return true;
+}
+
+Vector2f UIVirtualList::getMinimumSize() const
+{
+	const auto border = getInnerBorder();
+	const float contentsHeight = count > 0 ? count * getRowStride() - gap : 0.0f;
+	return Vector2f::max(UIClickable::getMinimumSize(), Vector2f(border.x + border.z, contentsHeight + border.y + border.w));
+}
+
+void UIVirtualList::onClicked(Vector2f mousePos, KeyMods keyMods)
+{
+	if (const auto option = getOptionAt(mousePos)) {
+		setSelectedOption(*option);
+	}
+}
+
+void UIVirtualList::onDoubleClicked(Vector2f mousePos, KeyMods keyMods)
+{
+	if (const auto option = getOptionAt(mousePos); option && *option == curOption) {
+		playStyleSound("acceptSound");
+		sendEvent(UIEvent(UIEventType::ListAccept, getId(), getSelectedOptionId(), curOption));
+	}
+}
+
+void UIVirtualList::onMouseOver(Vector2f mousePos)
+{
+	setHover(getOptionAt(mousePos).value_or(-1));
+}
+
+void UIVirtualList::onMouseLeft(Vector2f mousePos)
+{
+	setHover(-1);
+}
+
+void UIVirtualList::draw(UIPainter& painter) const
+{
+	if (sprite.hasMaterial()) {
+		painter.draw(sprite);
+	}
+
+	for (int i = visibleRange.start; i < visibleRange.end; ++i) {
+		const auto& rowSprite = i == curOption && selectedSprite.hasMaterial() ? selectedSprite : (i == curHover ? hoverSprite : itemSprite);
+		if (rowSprite.hasMaterial()) {
+			const auto rect = getOptionRect(i) + getPosition();
+			auto s = rowSprite;
+			s.scaleTo(rect.getSize()).setPos(rect.getTopLeft());
+			painter.draw(std::move(s));
+		}
+	}
+}
+
+void UIVirtualList::update(Time t, bool moved)
+{
+	UIClickable::update(t, moved);
+
+	if (moved) {
+		if (sprite.hasMaterial()) {
+			sprite.scaleTo(getSize()).setPos(getPosition());
+		}
+	}
+
+	updateRows();
+}
+
+void UIVirtualList::doSetState(State state)
+{
+}
+
+bool UIVirtualList::onKeyPress(KeyboardKeyPress key)
+{
+	const int pageSize = std::max(visibleRange.getLength() - 1, 1);
+
+	if (key.is(KeyCode::Up)) {
+		moveSelection(-1);
+		return true;
+	}
+
+	if (key.is(KeyCode::Down)) {
+		moveSelection(1);
+		return true;
+	}
+
+	if (key.is(KeyCode::PageUp)) {
+		moveSelection(-pageSize);
+		return true;
+	}
+
+	if (key.is(KeyCode::PageDown)) {
+		moveSelection(pageSize);
+		return true;
+	}
+
+	if (key.is(KeyCode::Home)) {
+		setSelectedOption(0);
+		return true;
+	}
+
+	if (key.is(KeyCode::End)) {
+		setSelectedOption(count - 1);
+		return true;
+	}
+
+	if (key.is(KeyCode::Enter) && curOption >= 0) {
+		playStyleSound("acceptSound");
+		sendEvent(UIEvent(UIEventType::ListAccept, getId(), getSelectedOptionId(), curOption));
+		return true;
+	}
+
+	return false;
+}
+
+float UIVirtualList::getRowStride() const
+{
+	return rowHeight + gap;
+}
+
+Range<int> UIVirtualList::getVisibleRange() const
+{
+	if (count == 0) {
+		return {};
+	}
+
+	// Scroll panes clip the mouse of their contents to the area they show
+	auto visible = getRect();
+	if (const auto& clip = getMouseClip()) {
+		visible = visible.intersection(*clip);
+	}
+	if (const auto* root = getRoot()) {
+		visible = visible.intersection(root->getRect());
+	}
+	if (visible.getHeight() <= 0) {
+		return {};
+	}
+
+	const auto top = getPosition().y + getInnerBorder().y;
+	const auto stride = getRowStride();
+	const int first = clamp(static_cast<int>(std::floor((visible.getTop() - top) / stride)), 0, count);
+	const int last = clamp(static_cast<int>(std::ceil((visible.getBottom() - top) / stride)), first, count);
+	return Range<int>(first, last);
+}
+
+void UIVirtualList::updateRows()
+{
+	const auto range = getVisibleRange();
+	if (!rowsDirty && range == visibleRange && getRect() == lastRect) {
+		return;
+	}
+
+	// Rows that are still visible keep their contents, everything else is up for reuse
+	for (auto& row: rows) {
+		if (rowsDirty || !range.contains(row.index)) {
+			row.index = -1;
+		}
+	}
+	rowsDirty = false;
+	visibleRange = range;
+	lastRect = getRect();
+
+	const auto nVisible = static_cast<size_t>(range.getLength());
+	while (rows.size() < nVisible) {
+		auto widget = makeRow();
+		widget->setMinSize(Vector2f(0, rowHeight));
+		add(widget, 0, {}, UISizerFillFlags::FillHorizontal | UISizerAlignFlags::Top);
+		rows.push_back(Row{ std::move(widget), -1 });
+	}
+
+	Vector<Row*> slots(nVisible, nullptr);
+	Vector<Row*> freeRows;
+	for (auto& row: rows) {
+		if (row.index >= 0) {
+			slots[row.index - range.start] = &row;
+		} else {
+			freeRows.push_back(&row);
+		}
+	}
+
+	for (size_t i = 0; i < nVisible; ++i) {
+		if (!slots[i]) {
+			auto& row = *freeRows.back();
+			freeRows.pop_back();
+			row.index = range.start + static_cast<int>(i);
+			row.widget->setActive(true);
+			bindRow(*row.widget, row.index);
+		}
+	}
+	for (auto* row: freeRows) {
+		row->widget->setActive(false);
+	}
+
+	for (auto& row: rows) {
+		if (row.index >= 0) {
+			placeRow(row);
+		}
+	}
+}
+
+void UIVirtualList::placeRow(Row& row)
+{
+	// Rows are placed by the free sizer at their entry border, so keep it in sync for the next regular layout
+	const float offset = row.index * getRowStride();
+	if (auto* entry = getSizer().tryGetEntry(row.widget.get())) {
+		entry->setBorder(Vector4f(0, offset, 0, 0));
+	}
+
+	const auto border = getInnerBorder();
+	const auto minSize = row.widget->getLayoutMinimumSize(false);
+	const auto p0 = getPosition() + border.xy() + Vector2f(0, offset);
+	const auto size = Vector2f(std::max(minSize.x, getSize().x - border.x - border.z), minSize.y);
+	row.widget->setRect(Rect4f(p0, p0 + size), nullptr);
+}
+
+void UIVirtualList::setHover(int option)
+{
+	if (curHover != option) {
+		curHover = option;
+		if (curHover >= 0) {
+			sendEvent(UIEvent(UIEventType::ListHoveredChanged, getId(), getItemId(curHover), curHover));
+			playStyleSound("hoverSound");
+		} else {
+			sendEvent(UIEvent(UIEventType::ListHoveredChanged, getId(), String(), -1));
+		}
+	}
+}
+
+void UIVirtualList::moveSelection(int delta)
+{
+	if (count > 0) {
+		setSelectedOption(clamp(curOption + delta, 0, count - 1));
+	}
+}
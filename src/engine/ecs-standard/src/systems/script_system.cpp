@@ -1,4 +1,6 @@
 #include <systems/script_system.h>
+#include "halley/concurrency/concurrent.h"
+#include "halley/scripting/script_graph_program.h"
 
 using namespace Halley;
 
@@ -221,19 +223,71 @@ private:
 
 	void updateScripts(Time t)
 	{
+		if (getScriptingService().hasWorkerEnvironments()) {
+			updateScriptsParallel(t);
+			return;
+		}
+
 		auto& env = getScriptingService().getEnvironment();
 		for (auto& e : scriptableFamily) {
 			e.scriptable.activeStates.terminateMarkedDead(env, e.entityId, e.scriptable.variables);
+			updateEntityScripts(env, e, t);
+			eraseDeadScripts(e);
+		}
+	}
 
-			for (auto& state: e.scriptable.activeStates) {
-				if (!state->getFrameFlag()) {
-					env.update(t, *state, e.entityId, e.scriptable.variables);
-					state->setFrameFlag(true);
-				}
+	void updateScriptsParallel(Time t)
+	{
+		auto& env = getScriptingService().getEnvironment();
+
+		// Types and programs are assigned in prepare, as that can't happen on the worker threads
+		getScriptingService().updateInParallel(ExecutionQueue::getDefault(), scriptableFamily.size(), [&] (size_t i)
+		{
+			auto& e = scriptableFamily[i];
+			e.scriptable.activeStates.terminateMarkedDead(env, e.entityId, e.scriptable.variables);
+			return canUpdateInParallel(env, e);
+		}, [&] (ScriptEnvironment& updateEnv, size_t i)
+		{
+			updateEntityScripts(updateEnv, scriptableFamily[i], t);
+		}, [&] (size_t i)
+		{
+			eraseDeadScripts(scriptableFamily[i]);
+		});
+	}
+
+	void updateEntityScripts(ScriptEnvironment& env, ScriptableFamily& e, Time t)
+	{
+		for (auto& state: e.scriptable.activeStates) {
+			if (!state->getFrameFlag()) {
+				env.update(t, *state, e.entityId, e.scriptable.variables);
+				state->setFrameFlag(true);
 			}
+		}
+	}
 
-			eraseDeadScripts(e);
+	bool canUpdateInParallel(ScriptEnvironment& env, ScriptableFamily& e)
+	{
+		bool any = false;
+		for (auto& state: e.scriptable.activeStates) {
+			if (state->getFrameFlag()) {
+				continue;
+			}
+
+			const auto* graph = state->getScriptGraphPtr();
+			if (!graph) {
+				return false;
+			}
+			env.assignTypes(*graph);
+			if (!graph->getProgram().canRunInParallel()) {
+				return false;
+			}
+			if (state->hasStarted() && state->getGraphHash() != graph->getHash()) {
+				// Restarting after a script change goes through the previous version of the graph
+				return false;
+			}
+			any = true;
 		}
+		return any;
 	}
 
 	void eraseDeadScripts(ScriptableFamily& e)
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <halley.hpp>
+
+namespace Halley {
+	// Input API with no devices attached
+	class TestInputAPI final : public InputAPI {
+	public:
+		size_t getNumberOfKeyboards() const override { return 0; }
+		std::shared_ptr<InputKeyboard> getKeyboard(int id) const override { return {}; }
+		size_t getNumberOfJoysticks() const override { return 0; }
+		std::shared_ptr<InputDevice> getJoystick(int id) const override { return {}; }
+		size_t getNumberOfMice() const override { return 0; }
+		std::shared_ptr<InputDevice> getMouse(int id) const override { return {}; }
+		Vector<std::shared_ptr<InputTouch>> getNewTouchEvents() override { return {}; }
+		Vector<std::shared_ptr<InputTouch>> getTouchEvents() override { return {}; }
+		void setMouseRemapping(std::function<Vector2f(Vector2i)> remapFunction) override {}
+	};
+
+	// A UIRoot that can be updated without a game running
+	class TestUIRoot {
+	public:
+		explicit TestUIRoot(Rect4f rect = Rect4f(0, 0, 1000, 1000))
+		{
+			api.input = &input;
+			root = std::make_unique<UIRoot>(api, rect);
+		}
+
+		UIRoot& operator*() { return *root; }
+		UIRoot* operator->() { return root.get(); }
+
+		void update(Time t = 0.1)
+		{
+			root->update(t, UIInputType::Mouse, {}, {});
+		}
+
+	private:
+		TestInputAPI input;
+		HalleyAPI api{};
+		std::unique_ptr<UIRoot> root;
+	};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <halley.hpp>
+
+namespace Halley {
+	// Minimal core API, enough to run a World without a game
+	class TestCoreAPI final : public CoreAPI {
+	public:
+		void quit(int exitCode) override {}
+		void setStage(StageID stage) override {}
+		void setStage(std::unique_ptr<Stage> stage) override {}
+		void initStage(Stage& stage) override {}
+		Stage& getCurrentStage() override { throw Exception("No stage", HalleyExceptions::Core); }
+		HalleyStatics& getStatics() override { throw Exception("No statics", HalleyExceptions::Core); }
+		const Environment& getEnvironment() override { throw Exception("No environment", HalleyExceptions::Core); }
+		void addProfilerCallback(IProfileCallback* callback) override {}
+		void removeProfilerCallback(IProfileCallback* callback) override {}
+		void addStartFrameCallback(IStartFrameCallback* callback) override {}
+		void removeStartFrameCallback(IStartFrameCallback* callback) override {}
+		Future<std::unique_ptr<RenderSnapshot>> requestRenderSnapshot() override { return {}; }
+		bool isDevMode() override { return false; }
+		DevConClient* getDevConClient() const override { return nullptr; }
+	};
+
+	// A World with no systems or resources
+	class TestWorld {
+	public:
+		explicit TestWorld(std::shared_ptr<WorldReflection> reflection = std::make_shared<WorldReflection>())
+		{
+			api.core = &core;
+			resources = std::make_unique<Resources>(nullptr, api, ResourceOptions());
+			world = std::make_unique<World>(api, *resources, std::move(reflection));
+		}
+
+		World& operator*() { return *world; }
+		World* operator->() { return world.get(); }
+		const HalleyAPI& getAPI() const { return api; }
+		Resources& getResources() { return *resources; }
+
+	private:
+		TestCoreAPI core;
+		HalleyAPI api;
+		std::unique_ptr<Resources> resources;
+		std::unique_ptr<World> world;
+	};
+}
@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_world.h"
+
+#define DONT_INCLUDE_HALLEY_HPP
+#include "halley/entity/archetype_storage.h"
+#include "halley/entity/components/transform_2d_component.h"
+#include "components/velocity_component.h"
+using namespace Halley;
+
+namespace {
+	class ArchetypeWorld : public TestWorld {
+	public:
+		ArchetypeWorld()
+		{
+			(*this)->setArchetypeStorage(true);
+		}
+	};
+
+	class MovingFamily : public FamilyBaseOf<MovingFamily> {
+	public:
+		Transform2DComponent& transform2D;
+		MaybeRef<VelocityComponent> velocity;
+
+		using Type = FamilyType<Transform2DComponent, MaybeRef<VelocityComponent>>;
+
+	protected:
+		MovingFamily(Transform2DComponent& transform2D, MaybeRef<VelocityComponent> velocity)
+			: transform2D(transform2D)
+			, velocity(velocity)
+		{
+		}
+	};
+
+	struct ChunkVisit {
+		HashMap<float, int> visits; // By x position
+		size_t chunks = 0;
+		size_t looseMembers = 0;
+		size_t withVelocity = 0;
+	};
+
+	ChunkVisit visitChunks(const FamilyImpl<MovingFamily>& family)
+	{
+		ChunkVisit result;
+		family.forEachChunk([&] (const FamilyImpl<MovingFamily>::Chunk& chunk)
+		{
+			if (chunk.entities) {
+				++result.chunks;
+			} else {
+				++result.looseMembers;
+			}
+			for (size_t i = 0; i < chunk.count; ++i) {
+				if (chunk.has(i)) {
+					++result.visits[chunk.get<0>(i).getLocalPosition().x];
+					if (chunk.tryGet<1>(i)) {
+						++result.withVelocity;
+					}
+				}
+			}
+		});
+		return result;
+	}
+
+	// Moves the parent and checks that the child follows it through its cached parent pointer
+	void expectChildFollowsParent(EntityRef parent, EntityRef child, Vector2f parentPos)
+	{
+		parent.getComponent<Transform2DComponent>().setGlobalPosition(parentPos);
+		EXPECT_EQ(child.getComponent<Transform2DComponent>().getGlobalPosition(), parentPos + Vector2f(1, 2));
+	}
+}
+
+TEST(HalleyArchetypeStorage, PlacesNewEntities)
+{
+	ArchetypeWorld world;
+	auto parent = world->createEntity("parent").addComponent(Transform2DComponent(Vector2f(10, 0)));
+	auto child = world->createEntity("child", parent).addComponent(Transform2DComponent(Vector2f(1, 2)));
+	world->spawnPending();
+
+	const auto& storage = *world->getArchetypeStorage();
+	EXPECT_EQ(storage.getNumEntities(), 2);
+	EXPECT_EQ(storage.getNumArchetypes(), 1);
+	EXPECT_TRUE(storage.owns(&parent.getComponent<Transform2DComponent>()));
+	EXPECT_TRUE(storage.owns(&child.getComponent<Transform2DComponent>()));
+	EXPECT_EQ(child.getComponent<Transform2DComponent>().getGlobalPosition(), Vector2f(11, 2));
+	expectChildFollowsParent(parent, child, Vector2f(20, 5));
+}
+
+TEST(HalleyArchetypeStorage, AddComponentRelocatesOnceStable)
+{
+	ArchetypeWorld world;
+	auto parent = world->createEntity("parent").addComponent(Transform2DComponent(Vector2f(10, 0)));
+	auto child = world->createEntity("child", parent).addComponent(Transform2DComponent(Vector2f(1, 2)));
+	world->spawnPending();
+	const auto& storage = *world->getArchetypeStorage();
+	const auto* oldTransform = &parent.getComponent<Transform2DComponent>();
+
+	// The first update after the change leaves the existing components alone
+	parent.addComponent(VelocityComponent(Vector2f(1, 1)));
+	world->spawnPending();
+	EXPECT_EQ(&parent.getComponent<Transform2DComponent>(), oldTransform);
+	EXPECT_FALSE(storage.owns(&parent.getComponent<VelocityComponent>()));
+	expectChildFollowsParent(parent, child, Vector2f(20, 5));
+
+	// The next one moves the whole entity into its new archetype
+	world->spawnPending();
+	EXPECT_NE(&parent.getComponent<Transform2DComponent>(), oldTransform);
+	EXPECT_TRUE(storage.owns(&parent.getComponent<Transform2DComponent>()));
+	EXPECT_TRUE(storage.owns(&parent.getComponent<VelocityComponent>()));
+	EXPECT_EQ(parent.getComponent<VelocityComponent>().velocity, Vector2f(1, 1));
+	EXPECT_EQ(storage.getNumArchetypes(), 2);
+	expectChildFollowsParent(parent, child, Vector2f(30, 7));
+}
+
+TEST(HalleyArchetypeStorage, RemoveComponentRelocatesOnceStable)
+{
+	ArchetypeWorld world;
+	auto parent = world->createEntity("parent")
+		.addComponent(Transform2DComponent(Vector2f(10, 0)))
+		.addComponent(VelocityComponent(Vector2f(1, 1)));
+	auto child = world->createEntity("child", parent).addComponent(Transform2DComponent(Vector2f(1, 2)));
+	world->spawnPending();
+	const auto& storage = *world->getArchetypeStorage();
+	const auto* oldTransform = &parent.getComponent<Transform2DComponent>();
+
+	parent.removeComponent<VelocityComponent>();
+	world->spawnPending();
+	EXPECT_EQ(&parent.getComponent<Transform2DComponent>(), oldTransform);
+	expectChildFollowsParent(parent, child, Vector2f(20, 5));
+
+	world->spawnPending();
+	EXPECT_NE(&parent.getComponent<Transform2DComponent>(), oldTransform);
+	EXPECT_FALSE(parent.hasComponent<VelocityComponent>());
+	expectChildFollowsParent(parent, child, Vector2f(30, 7));
+}
+
+TEST(HalleyArchetypeStorage, ToggledComponentsDontRelocate)
+{
+	ArchetypeWorld world;
+	auto parent = world->createEntity("parent").addComponent(Transform2DComponent(Vector2f(10, 0)));
+	auto child = world->createEntity("child", parent).addComponent(Transform2DComponent(Vector2f(1, 2)));
+	world->spawnPending();
+	const auto* oldTransform = &parent.getComponent<Transform2DComponent>();
+
+	for (int i = 0; i < 4; ++i) {
+		if (i % 2 == 0) {
+			parent.addComponent(VelocityComponent());
+		} else {
+			parent.removeComponent<VelocityComponent>();
+		}
+		world->spawnPending();
+		EXPECT_EQ(&parent.getComponent<Transform2DComponent>(), oldTransform);
+	}
+	expectChildFollowsParent(parent, child, Vector2f(20, 5));
+}
+
+TEST(HalleyArchetypeStorage, ChildRelocatesUnderParent)
+{
+	ArchetypeWorld world;
+	auto parent = world->createEntity("parent").addComponent(Transform2DComponent(Vector2f(10, 0)));
+	auto child = world->createEntity("child", parent).addComponent(Transform2DComponent(Vector2f(1, 2)));
+	world->spawnPending();
+
+	// Both move in the same update
+	parent.addComponent(VelocityComponent());
+	child.addComponent(VelocityComponent());
+	world->spawnPending();
+	world->spawnPending();
+	EXPECT_TRUE(world->getArchetypeStorage()->owns(&child.getComponent<VelocityComponent>()));
+	expectChildFollowsParent(parent, child, Vector2f(20, 5));
+
+	world->destroyEntity(parent);
+	world->spawnPending();
+	EXPECT_EQ(world->getArchetypeStorage()->getNumEntities(), 0);
+}
+
+TEST(HalleyArchetypeStorage, FamilyWalksChunks)
+{
+	ArchetypeWorld world;
+	auto& family = static_cast<FamilyImpl<MovingFamily>&>(world->getFamily<MovingFamily>());
+
+	constexpr int n = 1000;
+	Vector<EntityRef> entities;
+	for (int i = 0; i < n; ++i) {
+		auto e = world->createEntity().addComponent(Transform2DComponent(Vector2f(float(i), 0)));
+		if (i % 3 == 0) {
+			e.addComponent(VelocityComponent(Vector2f(1, 0)));
+		}
+		entities.push_back(e);
+	}
+	world->spawnPending();
+	ASSERT_EQ(family.count(), n);
+
+	// Every member is visited exactly once, straight from the chunks of both archetypes
+	auto visit = visitChunks(family);
+	EXPECT_EQ(visit.visits.size(), n);
+	EXPECT_TRUE(std::all_of(visit.visits.begin(), visit.visits.end(), [] (const auto& v) { return v.second == 1; }));
+	EXPECT_EQ(visit.looseMembers, 0);
+	EXPECT_EQ(visit.withVelocity, (n + 2) / 3);
+	EXPECT_LT(visit.chunks, size_t(n / 10));
+
+	// Disabled entities leave the family, and are skipped by the chunks they're still stored in
+	entities[1].setEnabled(false);
+	world->spawnPending();
+	visit = visitChunks(family);
+	EXPECT_EQ(visit.visits.size(), n - 1);
+	EXPECT_EQ(visit.visits.count(1.0f), 0);
+
+	// An entity whose components changed is walked on its own until it's relocated
+	entities[2].addComponent(VelocityComponent());
+	world->spawnPending();
+	visit = visitChunks(family);
+	EXPECT_EQ(visit.visits.size(), n - 1);
+	EXPECT_EQ(visit.looseMembers, 1);
+	EXPECT_EQ(visit.visits[2.0f], 1);
+
+	world->spawnPending();
+	visit = visitChunks(family);
+	EXPECT_EQ(visit.looseMembers, 0);
+	EXPECT_EQ(visit.visits[2.0f], 1);
+	EXPECT_EQ(visit.withVelocity, (n + 2) / 3 + 1);
+
+	// Destroyed entities are gone from both
+	world->destroyEntity(entities[0]);
+	world->spawnPending();
+	visit = visitChunks(family);
+	EXPECT_EQ(family.count(), n - 2);
+	EXPECT_EQ(visit.visits.size(), n - 2);
+	EXPECT_EQ(visit.visits.count(0.0f), 0);
+}
+
+TEST(HalleyArchetypeStorage, RelocationInvalidatesComponentPointers)
+{
+	ArchetypeWorld world;
+	auto& family = static_cast<FamilyImpl<MovingFamily>&>(world->getFamily<MovingFamily>());
+	auto entity = world->createEntity().addComponent(Transform2DComponent(Vector2f(5, 0)));
+	world->spawnPending();
+
+	const auto revision = entity.getComponentRevision();
+	const auto* oldTransform = &entity.getComponent<Transform2DComponent>();
+	ASSERT_EQ(family.count(), 1);
+	EXPECT_EQ(&static_cast<MovingFamily*>(family.getElement(0))->transform2D, oldTransform);
+
+	// Nothing moves (or gets invalidated) while the entity's components are settling
+	entity.addComponent(VelocityComponent(Vector2f(3, 4)));
+	world->spawnPending();
+	const auto settlingRevision = entity.getComponentRevision();
+	EXPECT_EQ(&entity.getComponent<Transform2DComponent>(), oldTransform);
+
+	// Once it moves, the revision tells anyone caching pointers to re-fetch them, and families already point at the new place
+	world->spawnPending();
+	auto& transform = entity.getComponent<Transform2DComponent>();
+	EXPECT_NE(&transform, oldTransform);
+	EXPECT_NE(entity.getComponentRevision(), revision);
+	EXPECT_NE(entity.getComponentRevision(), settlingRevision);
+	EXPECT_EQ(transform.getLocalPosition(), Vector2f(5, 0));
+
+	auto& member = *static_cast<MovingFamily*>(family.getElement(0));
+	EXPECT_EQ(&member.transform2D, &transform);
+	ASSERT_TRUE(member.velocity.hasValue());
+	EXPECT_EQ(&member.velocity.get(), &entity.getComponent<VelocityComponent>());
+	EXPECT_EQ(member.velocity.get().velocity, Vector2f(3, 4));
+}
+
+TEST(HalleyArchetypeStorage, DisablingStorageMovesMembersOutOfChunks)
+{
+	ArchetypeWorld world;
+	auto& family = static_cast<FamilyImpl<MovingFamily>&>(world->getFamily<MovingFamily>());
+	auto entity = world->createEntity().addComponent(Transform2DComponent(Vector2f(5, 0)));
+	world->spawnPending();
+	EXPECT_EQ(visitChunks(family).chunks, 1);
+
+	world->setArchetypeStorage(false);
+	const auto visit = visitChunks(family);
+	EXPECT_EQ(visit.chunks, 0);
+	EXPECT_EQ(visit.looseMembers, 1);
+	EXPECT_EQ(&static_cast<MovingFamily*>(family.getElement(0))->transform2D, &entity.getComponent<Transform2DComponent>());
+}
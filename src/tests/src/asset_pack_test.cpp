@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/resources/asset_pack.h"
+#include "halley/resources/asset_database.h"
+using namespace Halley;
+
+namespace {
+	// Reads a pack from memory, optionally exposing it as mapped
+	class MemoryReader final : public ResourceDataReader {
+	public:
+		MemoryReader(Bytes bytes, bool mapped, std::shared_ptr<bool> alive)
+			: bytes(std::move(bytes))
+			, mapped(mapped)
+			, alive(std::move(alive))
+		{
+			*this->alive = true;
+		}
+
+		~MemoryReader() override
+		{
+			*alive = false;
+		}
+
+		size_t size() const override { return bytes.size(); }
+		void seek(int64_t p, int whence) override { pos = size_t(whence == SEEK_SET ? p : whence == SEEK_CUR ? int64_t(pos) + p : int64_t(bytes.size()) + p); }
+		size_t tell() const override { return pos; }
+		void close() override {}
+
+		int read(gsl::span<gsl::byte> dst) override
+		{
+			const size_t n = std::min(size_t(dst.size()), bytes.size() - std::min(pos, bytes.size()));
+			memcpy(dst.data(), bytes.data() + pos, n);
+			pos += n;
+			return int(n);
+		}
+
+		gsl::span<const gsl::byte> getMappedData() const override
+		{
+			return mapped ? gsl::as_bytes(gsl::span<const Byte>(bytes)) : gsl::span<const gsl::byte>();
+		}
+
+	private:
+		Bytes bytes;
+		bool mapped;
+		size_t pos = 0;
+		std::shared_ptr<bool> alive;
+	};
+
+	// Compressible, but different in every block
+	Bytes makeAsset(size_t size)
+	{
+		Bytes result(size);
+		for (size_t i = 0; i < size; ++i) {
+			result[i] = Byte((i / 7) ^ (i >> 12));
+		}
+		return result;
+	}
+
+	gsl::span<const gsl::byte> asSpan(const Bytes& bytes)
+	{
+		return gsl::as_bytes(gsl::span<const Byte>(bytes));
+	}
+
+	struct Location {
+		size_t pos;
+		size_t storedSize;
+		size_t size;
+	};
+
+	Location parseLocation(const String& location)
+	{
+		const auto ps = location.split(':');
+		const size_t stored = size_t(ps.at(1).toInteger());
+		return { size_t(ps.at(0).toInteger()), stored, ps.size() > 2 ? size_t(ps[2].toInteger()) : stored };
+	}
+}
+
+TEST(HalleyAssetPack, CompressedRoundTrip)
+{
+	AssetPack pack;
+	for (const size_t size: { size_t(1), size_t(1000), AssetPack::assetBlockSize, AssetPack::assetBlockSize + 1, 3 * AssetPack::assetBlockSize + 123 }) {
+		const auto asset = makeAsset(size);
+		const auto location = parseLocation(pack.appendAsset(asSpan(asset), true));
+		Bytes result(location.size);
+		if (location.storedSize != location.size) {
+			pack.decompressAsset(location.pos, location.storedSize, gsl::as_writable_bytes(gsl::span<Byte>(result)));
+		} else {
+			pack.readData(location.pos, gsl::as_writable_bytes(gsl::span<Byte>(result)));
+		}
+		EXPECT_EQ(result, asset) << "Size " << size;
+	}
+}
+
+TEST(HalleyAssetPack, IncompressibleAssetStoredRaw)
+{
+	Bytes asset(10000);
+	Random(uint32_t(1234)).getBytes(gsl::as_writable_bytes(gsl::span<Byte>(asset)));
+
+	AssetPack pack;
+	const auto location = pack.appendAsset(asSpan(asset), true);
+	EXPECT_EQ(location.split(':').size(), 2);
+	EXPECT_EQ(parseLocation(location).storedSize, asset.size());
+}
+
+TEST(HalleyAssetPack, CorruptedBlockThrows)
+{
+	AssetPack pack;
+	const auto location = parseLocation(pack.appendAsset(asSpan(makeAsset(2 * AssetPack::assetBlockSize)), true));
+	ASSERT_NE(location.storedSize, location.size);
+
+	// Truncated
+	Bytes result(location.size);
+	EXPECT_ANY_THROW(pack.decompressAsset(location.pos, location.storedSize - 10, gsl::as_writable_bytes(gsl::span<Byte>(result))));
+
+	// Wrong size in the block table
+	const uint32_t badSize = 1;
+	memcpy(pack.getData().data() + location.pos, &badSize, sizeof(badSize));
+	EXPECT_ANY_THROW(pack.decompressAsset(location.pos, location.storedSize, gsl::as_writable_bytes(gsl::span<Byte>(result))));
+}
+
+TEST(HalleyAssetPack, WriteOutAndLoad)
+{
+	const auto compressed = makeAsset(2 * AssetPack::assetBlockSize + 5);
+	const auto raw = makeAsset(100);
+
+	AssetPack source;
+	source.getAssetDatabase().addAsset("compressed", AssetType::BinaryFile, AssetDatabase::Entry(source.appendAsset(asSpan(compressed), true), Metadata()));
+	source.getAssetDatabase().addAsset("raw", AssetType::BinaryFile, AssetDatabase::Entry(source.appendAsset(asSpan(raw), false), Metadata()));
+	const auto packBytes = source.writeOut();
+	EXPECT_EQ(memcmp(packBytes.data(), "HALLEYP2", 8), 0);
+
+	for (const bool mapped: { false, true }) {
+		auto alive = std::make_shared<bool>(false);
+		AssetPack pack(std::make_unique<MemoryReader>(packBytes, mapped, alive));
+		for (const auto& [name, expected]: Vector<std::pair<String, Bytes>>{ { "compressed", compressed }, { "raw", raw } }) {
+			const auto data = pack.getData(name, AssetType::BinaryFile, false);
+			ASSERT_TRUE(data) << name;
+			const auto span = dynamic_cast<ResourceDataStatic&>(*data).getSpan();
+			EXPECT_TRUE(std::equal(span.begin(), span.end(), asSpan(expected).begin(), asSpan(expected).end())) << name << (mapped ? " mapped" : "");
+		}
+		EXPECT_FALSE(pack.getData("missing", AssetType::BinaryFile, false));
+	}
+}
+
+TEST(HalleyAssetPack, MappedDataOutlivesPack)
+{
+	const auto raw = makeAsset(1000);
+	AssetPack source;
+	source.getAssetDatabase().addAsset("raw", AssetType::BinaryFile, AssetDatabase::Entry(source.appendAsset(asSpan(raw), false), Metadata()));
+
+	auto alive = std::make_shared<bool>(false);
+	auto pack = std::make_unique<AssetPack>(std::make_unique<MemoryReader>(source.writeOut(), true, alive));
+	auto data = pack->getData("raw", AssetType::BinaryFile, false);
+	pack.reset();
+
+	// The resource data keeps the mapping alive until it's gone
+	EXPECT_TRUE(*alive);
+	const auto span = dynamic_cast<ResourceDataStatic&>(*data).getSpan();
+	EXPECT_TRUE(std::equal(span.begin(), span.end(), asSpan(raw).begin(), asSpan(raw).end()));
+	data.reset();
+	EXPECT_FALSE(*alive);
+}
+
+TEST(HalleyAssetPack, PackDataReaderSeeksAcrossBlocks)
+{
+	constexpr size_t blockSize = AssetPack::assetBlockSize;
+	const auto asset = makeAsset(3 * blockSize + 1000);
+	AssetPack pack;
+	const auto location = parseLocation(pack.appendAsset(asSpan(asset), true));
+	ASSERT_NE(location.storedSize, location.size);
+
+	PackDataReader reader(pack, location.pos, location.storedSize, location.size);
+	EXPECT_EQ(reader.size(), asset.size());
+
+	auto expectRead = [&] (size_t pos, size_t len)
+	{
+		reader.seek(int64_t(pos), SEEK_SET);
+		Bytes result(len);
+		const size_t expected = std::min(len, asset.size() - pos);
+		EXPECT_EQ(reader.read(gsl::as_writable_bytes(gsl::span<Byte>(result))), int(expected)) << "At " << pos;
+		EXPECT_TRUE(std::equal(result.begin(), result.begin() + expected, asset.begin() + pos)) << "At " << pos;
+		EXPECT_EQ(reader.tell(), pos + expected);
+	};
+
+	// Straddling each boundary, backwards and forwards, and spanning a whole block
+	expectRead(blockSize - 10, 20);
+	expectRead(3 * blockSize - 1, 2);
+	expectRead(5, 10);
+	expectRead(2 * blockSize - 100, blockSize + 200);
+	expectRead(0, asset.size());
+	expectRead(asset.size() - 50, 100);
+
+	reader.seek(-int64_t(blockSize) - 3, SEEK_END);
+	reader.seek(1, SEEK_CUR);
+	Bytes result(4);
+	reader.read(gsl::as_writable_bytes(gsl::span<Byte>(result)));
+	const size_t pos = asset.size() - blockSize - 2;
+	EXPECT_TRUE(std::equal(result.begin(), result.end(), asset.begin() + pos));
+}
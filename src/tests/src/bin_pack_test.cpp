@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/data_structures/bin_pack.h"
+using namespace Halley;
+
+namespace {
+	Vector<BinPackEntry> makeEntries(size_t n, bool canRotate)
+	{
+		Vector<BinPackEntry> entries;
+		for (size_t i = 0; i < n; ++i) {
+			const auto size = Vector2i(4 + int(i * 7 % 29), 3 + int(i * 13 % 23));
+			entries.emplace_back(size, reinterpret_cast<void*>(i + 1), canRotate);
+		}
+		return entries;
+	}
+
+	void checkPacking(const Vector<BinPackEntry>& entries, const Vector<BinPackResult>& results, Vector2i binSize)
+	{
+		ASSERT_EQ(results.size(), entries.size());
+		for (size_t i = 0; i < results.size(); ++i) {
+			const auto& r = results[i];
+			EXPECT_GE(r.rect.getLeft(), 0);
+			EXPECT_GE(r.rect.getTop(), 0);
+			EXPECT_LE(r.rect.getRight(), binSize.x);
+			EXPECT_LE(r.rect.getBottom(), binSize.y);
+
+			const auto& entry = entries[reinterpret_cast<size_t>(r.data) - 1];
+			const auto size = r.rotated ? Vector2i(entry.size.y, entry.size.x) : entry.size;
+			EXPECT_EQ(r.rect.getSize(), size);
+			EXPECT_TRUE(!r.rotated || entry.canRotate);
+
+			for (size_t j = i + 1; j < results.size(); ++j) {
+				EXPECT_FALSE(r.rect.overlaps(results[j].rect));
+			}
+		}
+	}
+
+	int64_t getBoundingArea(const Vector<BinPackResult>& results)
+	{
+		Vector2i size;
+		for (const auto& r: results) {
+			size = Vector2i::max(size, r.rect.getBottomRight());
+		}
+		return int64_t(size.x) * size.y;
+	}
+}
+
+TEST(HalleyBinPack, Pack)
+{
+	for (const bool canRotate: { false, true }) {
+		const auto entries = makeEntries(150, canRotate);
+		const auto binSize = Vector2i(256, 256);
+
+		const auto result = BinPack::pack(entries, binSize);
+		ASSERT_TRUE(result.has_value());
+		checkPacking(entries, *result, binSize);
+
+		const auto quickResult = BinPack::quickPack(entries, binSize);
+		ASSERT_TRUE(quickResult.has_value());
+		checkPacking(entries, *quickResult, binSize);
+
+		const auto fastResult = BinPack::fastPack(entries, binSize);
+		ASSERT_TRUE(fastResult.has_value());
+		checkPacking(entries, *fastResult, binSize);
+	}
+}
+
+TEST(HalleyBinPack, QuickPackLargeInput)
+{
+	const auto entries = makeEntries(1000, false);
+	const auto binSize = Vector2i(1024, 512);
+
+	const auto quickResult = BinPack::quickPack(entries, binSize);
+	ASSERT_TRUE(quickResult.has_value());
+	checkPacking(entries, *quickResult, binSize);
+
+	const auto fastResult = BinPack::fastPack(entries, binSize);
+	ASSERT_TRUE(fastResult.has_value());
+	EXPECT_LE(getBoundingArea(*quickResult), getBoundingArea(*fastResult));
+}
+
+TEST(HalleyBinPack, PackFails)
+{
+	const auto entries = makeEntries(150, false);
+	EXPECT_FALSE(BinPack::pack(entries, Vector2i(64, 64)).has_value());
+	EXPECT_FALSE(BinPack::fastPack(entries, Vector2i(64, 64)).has_value());
+
+	Vector<BinPackEntry> tooBig;
+	tooBig.emplace_back(Vector2i(100, 10));
+	EXPECT_FALSE(BinPack::pack(tooBig, Vector2i(64, 128)).has_value());
+	EXPECT_FALSE(BinPack::quickPack(tooBig, Vector2i(64, 128)).has_value());
+}
+
+TEST(HalleyBinPack, Repack)
+{
+	auto entries = makeEntries(100, false);
+	const auto binSize = Vector2i(256, 256);
+	const auto first = BinPack::pack(entries, binSize);
+	ASSERT_TRUE(first.has_value());
+
+	// Change a few entries, and check that everything else stays where it was
+	entries[3].size = Vector2i(9, 9);
+	entries[50].size = Vector2i(20, 4);
+	entries.emplace_back(Vector2i(12, 12), reinterpret_cast<void*>(entries.size() + 1));
+
+	const auto second = BinPack::repack(entries, first.value(), binSize);
+	ASSERT_TRUE(second.has_value());
+	checkPacking(entries, *second, binSize);
+
+	size_t kept = 0;
+	for (const auto& r: *second) {
+		for (const auto& prev: *first) {
+			if (prev.data == r.data && prev.rect == r.rect) {
+				++kept;
+			}
+		}
+	}
+	EXPECT_GE(kept, entries.size() - 3);
+}
+
+TEST(HalleyBinPack, RepackFallsBackToFullPack)
+{
+	// Three quadrants of the bin are used, so whichever two entries don't share a row leave no room for a full-width one
+	Vector<BinPackEntry> entries;
+	for (size_t i = 0; i < 3; ++i) {
+		entries.emplace_back(Vector2i(50, 50), reinterpret_cast<void*>(i + 1));
+	}
+	const auto binSize = Vector2i(100, 100);
+	const auto first = BinPack::pack(entries, binSize);
+	ASSERT_TRUE(first.has_value());
+
+	const auto& rects = first.value();
+	size_t grown = 0;
+	while (grown < 3 && rects[(grown + 1) % 3].rect.getTop() == rects[(grown + 2) % 3].rect.getTop()) {
+		++grown;
+	}
+	ASSERT_LT(grown, 3);
+	auto& entry = entries[reinterpret_cast<size_t>(rects[grown].data) - 1];
+
+	entry.size = Vector2i(100, 50);
+	const auto second = BinPack::repack(entries, first.value(), binSize);
+	ASSERT_TRUE(second.has_value());
+	checkPacking(entries, *second, binSize);
+
+	entry.size = Vector2i(100, 100);
+	EXPECT_FALSE(BinPack::repack(entries, first.value(), binSize).has_value());
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	std::thread makeThread(String name, std::function<void()> f)
+	{
+		return std::thread(std::move(f));
+	}
+}
+
+TEST(HalleyConcurrent, ParallelForVisitsEveryIndexOnce)
+{
+	ExecutionQueue queue;
+	ThreadPool pool("Test", queue, 4, makeThread);
+
+	std::vector<std::atomic<int>> visits(10000);
+	Concurrent::parallel_for(queue, 0, visits.size(), 16, [&] (size_t i)
+	{
+		++visits[i];
+	});
+
+	for (auto& v: visits) {
+		EXPECT_EQ(v.load(), 1);
+	}
+}
+
+TEST(HalleyConcurrent, NestedParallelFor)
+{
+	ExecutionQueue queue;
+	ThreadPool pool("Test", queue, 4, makeThread);
+
+	std::atomic<int> total = 0;
+	Concurrent::parallel_for(queue, 0, 32, 1, [&] (size_t)
+	{
+		Concurrent::parallel_for(queue, 0, 100, 8, [&] (size_t)
+		{
+			++total;
+		});
+	});
+
+	EXPECT_EQ(total.load(), 3200);
+}
+
+TEST(HalleyConcurrent, ParallelForRethrows)
+{
+	ExecutionQueue queue;
+	ThreadPool pool("Test", queue, 2, makeThread);
+
+	EXPECT_THROW(Concurrent::parallel_for(queue, 0, 100, 1, [&] (size_t i)
+	{
+		if (i == 50) {
+			throw Exception("Test", HalleyExceptions::Concurrency);
+		}
+	}), Exception);
+}
+
+TEST(HalleyConcurrent, ParallelForCallerOnlyRunsItsOwnChunks)
+{
+	ExecutionQueue queue;
+	ThreadPool pool("Test", queue, 2, makeThread);
+
+	std::mutex mutex;
+	std::set<std::thread::id> unrelatedThreads;
+	std::atomic<int> unrelatedLeft = 16;
+
+	Concurrent::parallel_for(queue, 0, 3, 1, [&] (size_t i)
+	{
+		if (i == 0) {
+			// Queue unrelated work while the other chunks are still running
+			for (int j = 0; j < 16; ++j) {
+				queue.addToQueue([&] ()
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					unrelatedThreads.insert(std::this_thread::get_id());
+					--unrelatedLeft;
+				});
+			}
+		} else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+	});
+
+	while (unrelatedLeft > 0) {
+		std::this_thread::yield();
+	}
+	EXPECT_EQ(unrelatedThreads.count(std::this_thread::get_id()), 0);
+}
+
+TEST(HalleyConcurrent, WorkStealingDequeOrder)
+{
+	// Small enough that it has to grow a few times
+	WorkStealingDeque deque(2);
+	Vector<int> ran;
+	for (int i = 0; i < 20; ++i) {
+		deque.push([&ran, i] () { ran.push_back(i); });
+	}
+	EXPECT_EQ(deque.size(), 20);
+
+	// The owner takes the newest, thieves the oldest
+	deque.pop()();
+	deque.steal()();
+	deque.steal()();
+	deque.pop()();
+	EXPECT_EQ(ran, Vector<int>({ 19, 0, 1, 18 }));
+	EXPECT_EQ(deque.size(), 16);
+
+	while (auto task = deque.pop()) {
+		task();
+	}
+	EXPECT_EQ(ran.size(), 20);
+	EXPECT_FALSE(deque.pop());
+	EXPECT_FALSE(deque.steal());
+	EXPECT_EQ(deque.size(), 0);
+}
+
+TEST(HalleyConcurrent, WorkStealingDequeRunsEveryTaskOnce)
+{
+	constexpr int nTasks = 100000;
+	WorkStealingDeque deque(4);
+	std::vector<std::atomic<int>> runs(nTasks);
+	std::atomic<bool> done = false;
+
+	std::vector<std::thread> thieves;
+	for (int i = 0; i < 3; ++i) {
+		thieves.emplace_back([&] ()
+		{
+			while (!done) {
+				if (auto task = deque.steal()) {
+					task();
+				}
+			}
+		});
+	}
+
+	// The owner keeps pushing and popping, so it races the thieves both for the last task and while growing
+	for (int i = 0; i < nTasks; ++i) {
+		deque.push([&runs, i] () { ++runs[i]; });
+		if (i % 3 == 0) {
+			if (auto task = deque.pop()) {
+				task();
+			}
+		}
+	}
+	while (auto task = deque.pop()) {
+		task();
+	}
+	done = true;
+	for (auto& t: thieves) {
+		t.join();
+	}
+
+	EXPECT_EQ(deque.size(), 0);
+	for (auto& r: runs) {
+		EXPECT_EQ(r.load(), 1);
+	}
+}
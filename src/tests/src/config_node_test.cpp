@@ -30,3 +30,126 @@ TEST(HalleyConfigNode, Sequence)
 	EXPECT_TRUE(node.getType() == ConfigNodeType::Sequence);
 	EXPECT_EQ(node.asSequence().size(), 1);
 }
+
+namespace {
+	ConfigNode makeFrozenTestNode()
+	{
+		ConfigNode::MapType transform;
+		transform["position"] = ConfigNode(Vector2f(10.0f, -2.5f));
+		transform["rotation"] = ConfigNode(0.5f);
+
+		ConfigNode::MapType entity;
+		entity["name"] = ConfigNode("player");
+		entity["uuid"] = ConfigNode(Bytes(16, 7));
+		entity["visible"] = ConfigNode(true);
+		entity["layer"] = ConfigNode(3);
+		entity["Transform2D"] = ConfigNode(std::move(transform));
+		entity["tags"] = ConfigNode(ConfigNode::SequenceType({ ConfigNode("a"), ConfigNode("b"), ConfigNode(Vector2i(1, 2)) }));
+		return ConfigNode(std::move(entity));
+	}
+}
+
+TEST(HalleyConfigNode, FrozenRead)
+{
+	const auto node = makeFrozenTestNode();
+	const auto frozen = FrozenConfigNode(node);
+	const auto root = frozen.getRoot();
+
+	EXPECT_EQ(root.getType(), ConfigNodeType::Map);
+	EXPECT_TRUE(root.hasKey("name"));
+	EXPECT_FALSE(root.hasKey("missing"));
+	EXPECT_EQ(root["missing"].getType(), ConfigNodeType::Undefined);
+	EXPECT_EQ(root["missing"].asInt(5), 5);
+	EXPECT_EQ(root["name"].asStringView(), "player");
+	EXPECT_EQ(root["layer"].asInt(), 3);
+	EXPECT_EQ(root["layer"].asFloat(), 3.0f);
+	EXPECT_TRUE(root["visible"].asBool());
+	EXPECT_EQ(root["uuid"].asBytes().size(), size_t(16));
+	EXPECT_EQ(root["Transform2D"]["position"].asVector2f(), Vector2f(10.0f, -2.5f));
+	EXPECT_EQ(root["tags"].getSequenceSize(), size_t(3));
+	EXPECT_EQ(root["tags"][2].asVector2i(), Vector2i(1, 2));
+	EXPECT_EQ(root["tags"].asVector<String>()[1], "b");
+
+	size_t nKeys = 0;
+	std::string_view prevKey;
+	for (const auto& [key, value]: root.asMap()) {
+		EXPECT_LT(prevKey, key);
+		EXPECT_EQ(node[key], value.toConfigNode());
+		prevKey = key;
+		++nKeys;
+	}
+	EXPECT_EQ(nKeys, node.asMap().size());
+}
+
+TEST(HalleyConfigNode, FrozenDeserialize)
+{
+	const auto node = makeFrozenTestNode();
+
+	for (int version = 0; version <= SerializerOptions::maxVersion; ++version) {
+		const auto options = SerializerOptions(version);
+		const auto bytes = Serializer::toBytes(node, options);
+		const auto frozen = Deserializer::fromBytes<FrozenConfigNode>(bytes, options);
+		EXPECT_EQ(node, frozen.getRoot().toConfigNode());
+	}
+
+}
+
+TEST(HalleyConfigNode, ConfigFileLoadsFrozen)
+{
+	const auto node = makeFrozenTestNode();
+	const auto bytes = Serializer::toBytes(ConfigFile(ConfigNode(node)));
+	auto file = Deserializer::fromBytes<ConfigFile>(bytes);
+
+	// Reading through the view doesn't build the ConfigNode tree
+	const auto frozenSize = file.getSizeBytes();
+	EXPECT_EQ(file.getView()["name"].asStringView(), "player");
+	EXPECT_EQ(node, file.getView().toConfigNode());
+	EXPECT_EQ(file.getSizeBytes(), frozenSize);
+
+	// The tree is built the first time it's asked for
+	EXPECT_EQ(node, std::as_const(file).getRoot());
+	EXPECT_GT(file.getSizeBytes(), frozenSize);
+	EXPECT_EQ(&std::as_const(file).getRoot(), &std::as_const(file).getRoot());
+
+	// Edits through the mutable root show up in later views
+	file.getRoot()["name"] = ConfigNode("enemy");
+	EXPECT_EQ(file.getView()["name"].asStringView(), "enemy");
+
+	// Moving and round-tripping keep the data
+	auto moved = ConfigFile(std::move(file));
+	EXPECT_EQ(moved.getView()["layer"].asInt(), 3);
+	const auto again = Deserializer::fromBytes<ConfigFile>(Serializer::toBytes(moved));
+	EXPECT_EQ(again.getRoot()["name"].asString(), "enemy");
+}
+
+#if defined(STORE_CONFIG_NODE_PARENTING)
+TEST(HalleyConfigNode, ConfigFileKeepsPositionsWhenThawed)
+{
+	auto node = makeFrozenTestNode();
+	node["layer"].setOriginalPosition(12, 4);
+	const auto bytes = Serializer::toBytes(ConfigFile(std::move(node)));
+
+	const auto file = Deserializer::fromBytes<ConfigFile>(bytes);
+	EXPECT_EQ(file.getRoot()["layer"].getOriginalPosition(), std::make_pair(12, 4));
+}
+#endif
+
+TEST(HalleyConfigNode, SceneVariantsReadFromFrozenGameData)
+{
+	Scene scene;
+	scene.setGameData("variants", ConfigNode(ConfigNode::SequenceType({ SceneVariant("day").toConfigNode(), SceneVariant("night", LuaExpression("isNight")).toConfigNode() })));
+	scene.setGameData("other", ConfigNode(42));
+
+	const auto bytes = Serializer::toBytes(scene, SerializerOptions(SerializerOptions::maxVersion));
+	Scene loaded;
+	Deserializer::fromBytes(loaded, bytes, SerializerOptions(SerializerOptions::maxVersion));
+
+	const auto variants = loaded.getVariants();
+	ASSERT_EQ(variants.size(), 2);
+	EXPECT_EQ(variants[0].id, "day");
+	EXPECT_EQ(variants[1].id, "night");
+	EXPECT_EQ(variants[1].conditions.getExpression(), "isNight");
+	EXPECT_EQ(loaded.tryGetGameData("other")->asInt(), 42);
+
+	EXPECT_EQ(Scene().getVariants().at(0).id, "default");
+}
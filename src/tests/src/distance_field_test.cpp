@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include <iostream>
+#include "halley/tools/distance_field/distance_field_generator.h"
+using namespace Halley;
+
+namespace {
+	std::thread makeThread(String name, std::function<void()> f)
+	{
+		return std::thread(std::move(f));
+	}
+
+	// generateSDF splits its passes across the default CPU queue, so tests attach workers to it (or run without any)
+	class SDFExecutors {
+	public:
+		explicit SDFExecutors(int nThreads)
+		{
+			static Executors executors;
+			Executors::setInstance(executors);
+			if (nThreads > 0) {
+				pool = std::make_unique<ThreadPool>("SDF", Executors::getCPU(), nThreads, makeThread);
+			}
+		}
+
+	private:
+		std::unique_ptr<ThreadPool> pool;
+	};
+
+	constexpr int opaque = int(0xFF000000);
+
+	Image makeImage(Vector2i size, const std::function<bool(int, int)>& isInside)
+	{
+		Image image(Image::Format::RGBA, size);
+		auto pixels = image.getPixels4BPP();
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				pixels[x + y * size.x] = isInside(x, y) ? opaque : 0;
+			}
+		}
+		return image;
+	}
+
+	Image makeRandomImage(Vector2i size, uint32_t seed, float fill)
+	{
+		Random rng(seed);
+		return makeImage(size, [&] (int, int) { return rng.getFloat(0, 1) < fill; });
+	}
+
+	bool isInside(const Image& image, int x, int y)
+	{
+		return (uint32_t(image.getPixels4BPP()[x + y * int(image.getWidth())]) >> 24) > 127;
+	}
+
+	// Searches the whole image for the closest pixel of the other colour; only valid for hard-edged images
+	float getBruteForceDistance(const Image& image, int x, int y, float srcRadius)
+	{
+		const bool inside = isInside(image, x, y);
+		if (srcRadius < 0.001f) {
+			return inside ? 1.0f : 0.0f;
+		}
+
+		int bestDistSqr = std::numeric_limits<int>::max();
+		for (int j = 0; j < int(image.getHeight()); ++j) {
+			for (int i = 0; i < int(image.getWidth()); ++i) {
+				if (isInside(image, i, j) != inside) {
+					bestDistSqr = std::min(bestDistSqr, (i - x) * (i - x) + (j - y) * (j - y));
+				}
+			}
+		}
+
+		const float maxDist = std::ceil(srcRadius) + 1.0f;
+		const float dist = bestDistSqr == std::numeric_limits<int>::max() ? maxDist : std::min(std::sqrt(float(bestDistSqr)) - 0.5f, maxDist);
+		return 0.5f * (inside ? 1.0f + dist / srcRadius : 1.0f - dist / srcRadius);
+	}
+
+	// The search generateSDF used to do: only within the radius of each pixel
+	float getWindowedDistance(const Image& image, int xCentre, int yCentre, float radius)
+	{
+		const bool inside = isInside(image, xCentre, yCentre);
+		const int iRadius = int(std::ceil(radius));
+		const int x0 = std::max(0, xCentre - iRadius);
+		const int x1 = std::min(xCentre + iRadius, int(image.getWidth()) - 1);
+		const int y0 = std::max(0, yCentre - iRadius);
+		const int y1 = std::min(yCentre + iRadius, int(image.getHeight()) - 1);
+
+		int bestDistSqr = std::numeric_limits<int>::max();
+		for (int y = y0; y <= y1; ++y) {
+			for (int x = x0; x <= x1; ++x) {
+				if (isInside(image, x, y) != inside) {
+					bestDistSqr = std::min(bestDistSqr, (x - xCentre) * (x - xCentre) + (y - yCentre) * (y - yCentre));
+				}
+			}
+		}
+
+		const float normalDistance = (2 * std::sqrt(float(bestDistSqr)) - 1) / (2 * radius);
+		return 0.5f * (inside ? 1.0f + normalDistance : 1.0f - normalDistance);
+	}
+
+	template <typename F>
+	Vector<uint8_t> downsample(const Image& image, Vector2i size, F getDistance)
+	{
+		const int srcW = int(image.getWidth());
+		const int srcH = int(image.getHeight());
+		const int texelW = srcW / size.x;
+		const int texelH = srcH / size.y;
+
+		Vector<uint8_t> result(size_t(size.x * size.y));
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				float distAcc = 0;
+				for (int j = 0; j < texelH; ++j) {
+					for (int i = 0; i < texelW; ++i) {
+						distAcc += getDistance(x * srcW / size.x + i, y * srcH / size.y + j);
+					}
+				}
+				result[x + y * size.x] = uint8_t(clamp(int(distAcc * 255 / (texelW * texelH)), 0, 255));
+			}
+		}
+		return result;
+	}
+
+	Vector<uint8_t> generateBruteForce(const Image& image, Vector2i size, float radius)
+	{
+		const float srcRadius = radius * int(image.getWidth()) / size.x;
+		return downsample(image, size, [&] (int x, int y) { return getBruteForceDistance(image, x, y, srcRadius); });
+	}
+
+	Vector<uint8_t> toBytes(const Image& image)
+	{
+		// The pixel buffer may be padded past the last row
+		const auto bytes = image.getPixelBytes().subspan(0, size_t(image.getWidth()) * image.getHeight());
+		return Vector<uint8_t>(bytes.begin(), bytes.end());
+	}
+
+	void expectMatchesBruteForce(Image& image, Vector2i size, float radius)
+	{
+		const auto actual = toBytes(*DistanceFieldGenerator::generateSDF(image, size, radius));
+		const auto expected = generateBruteForce(image, size, radius);
+		ASSERT_EQ(actual.size(), expected.size());
+		for (size_t i = 0; i < actual.size(); ++i) {
+			// Allow for float rounding right at an integer boundary
+			EXPECT_NEAR(int(actual[i]), int(expected[i]), 1) << "Pixel " << (i % size.x) << ", " << (i / size.x) << " of " << image.getSize() << " -> " << size;
+		}
+	}
+}
+
+TEST(HalleyDistanceField, MatchesBruteForce)
+{
+	SDFExecutors executors(4);
+
+	// Several sizes wider and taller than the 32 lines each worker task takes
+	const Vector<Vector2i> sizes = { { 7, 5 }, { 33, 17 }, { 70, 45 }, { 16, 100 } };
+	uint32_t seed = 1;
+	for (const auto size: sizes) {
+		for (const float fill: { 0.05f, 0.5f, 0.95f }) {
+			auto image = makeRandomImage(size, seed++, fill);
+			expectMatchesBruteForce(image, size, 3.0f);
+		}
+	}
+
+	auto blob = makeImage(Vector2i(64, 64), [] (int x, int y) { return Vector2f(float(x - 30), float(y - 20)).length() < 15.0f; });
+	expectMatchesBruteForce(blob, Vector2i(64, 64), 8.0f);
+	expectMatchesBruteForce(blob, Vector2i(16, 16), 2.0f);
+}
+
+TEST(HalleyDistanceField, EdgeCases)
+{
+	SDFExecutors executors(4);
+
+	// Single pixels and single lines
+	auto onePixel = makeImage(Vector2i(1, 1), [] (int, int) { return true; });
+	expectMatchesBruteForce(onePixel, Vector2i(1, 1), 2.0f);
+
+	auto row = makeImage(Vector2i(50, 1), [] (int x, int) { return x % 7 == 3; });
+	expectMatchesBruteForce(row, Vector2i(50, 1), 4.0f);
+
+	auto column = makeImage(Vector2i(1, 50), [] (int, int y) { return y > 40; });
+	expectMatchesBruteForce(column, Vector2i(1, 50), 4.0f);
+
+	// Sites only on the borders and corners
+	auto corner = makeImage(Vector2i(40, 35), [] (int x, int y) { return x == 39 && y == 34; });
+	expectMatchesBruteForce(corner, Vector2i(40, 35), 6.0f);
+
+	auto frame = makeImage(Vector2i(40, 35), [] (int x, int y) { return x == 0 || y == 0 || x == 39 || y == 34; });
+	expectMatchesBruteForce(frame, Vector2i(40, 35), 6.0f);
+
+	// Zero radius just thresholds
+	auto random = makeRandomImage(Vector2i(20, 20), 99, 0.5f);
+	expectMatchesBruteForce(random, Vector2i(20, 20), 0.0f);
+}
+
+TEST(HalleyDistanceField, EmptyImages)
+{
+	SDFExecutors executors(4);
+
+	// No pixel of the other colour anywhere, so everything is as far from the edge as the radius allows
+	auto empty = makeImage(Vector2i(40, 40), [] (int, int) { return false; });
+	const auto emptyResult = toBytes(*DistanceFieldGenerator::generateSDF(empty, Vector2i(40, 40), 4.0f));
+	EXPECT_TRUE(std::all_of(emptyResult.begin(), emptyResult.end(), [] (uint8_t v) { return v == 0; }));
+
+	auto full = makeImage(Vector2i(40, 40), [] (int, int) { return true; });
+	const auto fullResult = toBytes(*DistanceFieldGenerator::generateSDF(full, Vector2i(40, 40), 4.0f));
+	EXPECT_TRUE(std::all_of(fullResult.begin(), fullResult.end(), [] (uint8_t v) { return v == 255; }));
+}
+
+TEST(HalleyDistanceField, ThreadCountDoesNotChangeResult)
+{
+	auto image = makeRandomImage(Vector2i(130, 97), 1234, 0.3f);
+
+	Vector<uint8_t> singleThreaded;
+	{
+		SDFExecutors executors(0);
+		singleThreaded = toBytes(*DistanceFieldGenerator::generateSDF(image, Vector2i(130, 97), 5.0f));
+	}
+	for (const int nThreads: { 1, 3, 8 }) {
+		SDFExecutors executors(nThreads);
+		EXPECT_EQ(toBytes(*DistanceFieldGenerator::generateSDF(image, Vector2i(130, 97), 5.0f)), singleThreaded) << nThreads << " threads";
+	}
+}
+
+// Run with --gtest_also_run_disabled_tests; prints generateSDF's cost against the windowed search it replaced
+TEST(HalleyDistanceField, DISABLED_BenchmarkGenerateSDF)
+{
+	const auto srcSize = Vector2i(512, 512);
+	const auto dstSize = Vector2i(128, 128);
+	constexpr float radius = 4.0f;
+	auto image = makeImage(srcSize, [] (int x, int y) { return (x / 37 + y / 23) % 3 == 0 || Vector2f(float(x - 256), float(y - 256)).length() < 100.0f; });
+
+	for (const int nThreads: { 0, 4 }) {
+		SDFExecutors executors(nThreads);
+		Stopwatch timer;
+		DistanceFieldGenerator::generateSDF(image, dstSize, radius);
+		timer.pause();
+		std::cout << "generateSDF " << srcSize << " -> " << dstSize << ", " << nThreads << " workers: " << timer.elapsedMicroseconds() << " us" << std::endl;
+	}
+
+	const float srcRadius = radius * srcSize.x / dstSize.x;
+	Stopwatch timer;
+	downsample(image, dstSize, [&] (int x, int y) { return getWindowedDistance(image, x, y, srcRadius); });
+	timer.pause();
+	std::cout << "Windowed search " << srcSize << " -> " << dstSize << ": " << timer.elapsedMicroseconds() << " us" << std::endl;
+}
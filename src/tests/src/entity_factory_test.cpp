@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_world.h"
+
+#define DONT_INCLUDE_HALLEY_HPP
+#include "halley/entity/ecs_reflection_impl.h"
+#include "halley/entity/entity_scene.h"
+#include "halley/entity/prefab_template.h"
+#include "halley/entity/components/transform_2d_component.h"
+#include "components/velocity_component.h"
+#include "components/scriptable_component.h"
+using namespace Halley;
+
+namespace {
+	class TestCodegenFunctions final : public CodegenFunctions {
+	public:
+		Vector<SystemReflector> makeSystemReflectors() override { return {}; }
+		Vector<std::unique_ptr<MessageReflector>> makeMessageReflectors() override { return {}; }
+		Vector<std::unique_ptr<SystemMessageReflector>> makeSystemMessageReflectors() override { return {}; }
+
+		Vector<std::unique_ptr<ComponentReflector>> makeComponentReflectors() override
+		{
+			Vector<std::unique_ptr<ComponentReflector>> result;
+			result.push_back(std::make_unique<ComponentReflectorImpl<Transform2DComponent>>());
+			result.push_back(std::make_unique<ComponentReflectorImpl<VelocityComponent>>());
+			result.push_back(std::make_unique<ComponentReflectorImpl<ScriptableComponent>>());
+			return result;
+		}
+	};
+
+	std::shared_ptr<WorldReflection> makeReflection()
+	{
+		TestCodegenFunctions codegen;
+		return std::make_shared<WorldReflection>(codegen);
+	}
+
+	EntityData makeEntityData(const String& name, const UUID& uuid, Vector2f position)
+	{
+		EntityData data;
+		data.setName(name);
+		data.setPrefabUUID(uuid);
+
+		ConfigNode::MapType transform;
+		transform["position"] = ConfigNode(position);
+		data.getComponents().emplace_back("Transform2D", ConfigNode(std::move(transform)));
+		return data;
+	}
+
+	// Root with a velocity and a reference to its second child, which has a child of its own
+	class PrefabFactory : public TestWorld {
+	public:
+		UUID rootUUID = UUID::generate();
+		UUID childUUID = UUID::generate();
+		UUID otherChildUUID = UUID::generate();
+		UUID grandChildUUID = UUID::generate();
+		std::shared_ptr<Prefab> prefab;
+		EntityFactory factory;
+
+		PrefabFactory()
+			: TestWorld(makeReflection())
+			, factory(**this, getResources())
+		{
+			auto root = makeEntityData("root", rootUUID, Vector2f(1, 2));
+			ConfigNode::MapType velocity;
+			velocity["velocity"] = ConfigNode(Vector2f(3, 4));
+			root.getComponents().emplace_back("Velocity", ConfigNode(std::move(velocity)));
+			ConfigNode::MapType references;
+			references["target"] = ConfigNode(otherChildUUID.toString());
+			ConfigNode::MapType scriptable;
+			scriptable["entityReferences"] = ConfigNode(std::move(references));
+			root.getComponents().emplace_back("Scriptable", ConfigNode(std::move(scriptable)));
+
+			auto otherChild = makeEntityData("otherChild", otherChildUUID, Vector2f(0, 5));
+			otherChild.getChildren().push_back(makeEntityData("grandChild", grandChildUUID, Vector2f(7, 0)));
+			root.getChildren().push_back(makeEntityData("child", childUUID, Vector2f(5, 0)));
+			root.getChildren().push_back(std::move(otherChild));
+
+			prefab = std::make_shared<Prefab>();
+			prefab->setAssetId("test");
+			prefab->getEntityData() = std::move(root);
+
+			getResources().init<Prefab>();
+			getResources().of<Prefab>().setResource(0, "test", prefab);
+		}
+	};
+
+	void expectSameEntity(EntityRef expected, EntityRef actual, const UUID& rootUUID)
+	{
+		ASSERT_TRUE(actual.isValid());
+		EXPECT_EQ(actual.getName(), expected.getName());
+		EXPECT_EQ(actual.getPrefabUUID(), expected.getPrefabUUID());
+		EXPECT_EQ(actual.getPrefabAssetId(), expected.getPrefabAssetId());
+		EXPECT_EQ(actual.isEnabled(), expected.isEnabled());
+		EXPECT_EQ(actual.getComponent<Transform2DComponent>().getLocalPosition(), expected.getComponent<Transform2DComponent>().getLocalPosition());
+		EXPECT_EQ(actual.getComponent<Transform2DComponent>().getGlobalPosition(), expected.getComponent<Transform2DComponent>().getGlobalPosition());
+		EXPECT_EQ(actual.hasComponent<VelocityComponent>(), expected.hasComponent<VelocityComponent>());
+		EXPECT_EQ(actual.hasComponent<ScriptableComponent>(), expected.hasComponent<ScriptableComponent>());
+
+		const auto children = actual.getRawChildren();
+		const auto expectedChildren = expected.getRawChildren();
+		ASSERT_EQ(children.size(), expectedChildren.size());
+		for (size_t i = 0; i < children.size(); ++i) {
+			EntityRef child(*children[i], actual.getWorld());
+			EXPECT_EQ(child.getParent(), actual);
+			// Instance UUIDs of children derive from the root's, the same way createEntity does it
+			EXPECT_EQ(child.getInstanceUUID(), UUID::generateFromUUIDs(child.getPrefabUUID(), rootUUID));
+			expectSameEntity(EntityRef(*expectedChildren[i], expected.getWorld()), child, rootUUID);
+		}
+	}
+
+	void expectReferencesOwnChild(EntityRef root)
+	{
+		const auto& references = root.getComponent<ScriptableComponent>().entityReferences;
+		ASSERT_EQ(references.count("target"), 1);
+		const auto target = root.getWorld().getEntity(references.at("target"));
+		EXPECT_EQ(target.getParent(), root);
+		EXPECT_EQ(target.getName(), "otherChild");
+	}
+}
+
+TEST(HalleyEntityFactory, SpawnBatchMatchesCreateEntity)
+{
+	PrefabFactory world;
+	auto expected = world.factory.createEntity("test");
+	world->spawnPending();
+	expectReferencesOwnChild(expected);
+
+	size_t initialized = 0;
+	const auto batch = world.factory.spawnBatch(world.prefab, 3, [&] (EntityRef e, size_t i)
+	{
+		EXPECT_EQ(i, initialized++);
+		EXPECT_EQ(e.getName(), "root");
+	});
+	world->spawnPending();
+	ASSERT_EQ(batch.size(), 3);
+	EXPECT_EQ(initialized, 3);
+
+	for (const auto& e: batch) {
+		expectSameEntity(expected, e, e.getInstanceUUID());
+		expectReferencesOwnChild(e);
+		EXPECT_EQ(e.getComponent<VelocityComponent>().velocity, Vector2f(3, 4));
+		EXPECT_NE(e.getInstanceUUID(), expected.getInstanceUUID());
+	}
+	EXPECT_NE(batch[0].getInstanceUUID(), batch[1].getInstanceUUID());
+	EXPECT_NE(&batch[0].getComponent<Transform2DComponent>(), &batch[1].getComponent<Transform2DComponent>());
+}
+
+TEST(HalleyEntityFactory, SpawnBatchUnderParent)
+{
+	PrefabFactory world;
+	auto parent = world->createEntity("parent").addComponent(Transform2DComponent(Vector2f(100, 0)));
+	auto expected = world.factory.createEntity("test", parent);
+	const auto batch = world.factory.spawnBatch(world.prefab, 2, {}, parent);
+	world->spawnPending();
+
+	ASSERT_EQ(parent.getRawChildren().size(), 3);
+	for (const auto& e: batch) {
+		EXPECT_EQ(e.getParent(), parent);
+		expectSameEntity(expected, e, e.getInstanceUUID());
+		EXPECT_EQ(e.getComponent<Transform2DComponent>().getGlobalPosition(), Vector2f(101, 2));
+	}
+}
+
+TEST(HalleyEntityFactory, SpawnBatchCopiesPrototypes)
+{
+	PrefabFactory world;
+	const auto prefabTemplate = world.prefab->getTemplate(world->getReflection(), world.getResources());
+	ASSERT_TRUE(prefabTemplate);
+
+	const auto nodes = prefabTemplate->getNodes();
+	ASSERT_EQ(nodes.size(), 4);
+	EXPECT_EQ(nodes[0].parent, -1);
+	EXPECT_EQ(nodes[1].parent, 0);
+	EXPECT_EQ(nodes[2].parent, 0);
+	EXPECT_EQ(nodes[3].parent, 2);
+
+	// Plain data is deserialized once, but entity references have to be resolved for every instance
+	for (const auto& component: prefabTemplate->getComponents(nodes[0])) {
+		EXPECT_EQ(component.prototype == nullptr, String(component.reflector->getName()) == "Scriptable");
+	}
+	for (const auto& component: prefabTemplate->getComponents(nodes[3])) {
+		EXPECT_NE(component.prototype, nullptr);
+	}
+}
+
+TEST(HalleyEntityFactory, SpawnBatchRegistersWithScene)
+{
+	PrefabFactory world;
+	EntityScene expectedScene(true);
+	world.factory.createEntity("test", EntityRef(), &expectedScene);
+	world.prefab->increaseAssetVersion();
+	EXPECT_TRUE(expectedScene.needsUpdate());
+
+	EntityScene scene(true);
+	const auto batch = world.factory.spawnBatch(world.prefab, 3, {}, EntityRef(), &scene);
+	world->spawnPending();
+	ASSERT_EQ(scene.getEntities().size(), 3);
+	for (size_t i = 0; i < batch.size(); ++i) {
+		EXPECT_EQ(scene.getEntities()[i], batch[i].getEntityId());
+	}
+	world.prefab->increaseAssetVersion();
+	EXPECT_TRUE(scene.needsUpdate());
+
+	// Instances under a parent entity are not scene roots, but are still reloaded with the prefab
+	auto parent = world->createEntity("parent");
+	EntityScene childScene(true);
+	world.factory.spawnBatch(world.prefab, 2, {}, parent, &childScene);
+	EXPECT_TRUE(childScene.getEntities().empty());
+	world.prefab->increaseAssetVersion();
+	EXPECT_TRUE(childScene.needsUpdate());
+}
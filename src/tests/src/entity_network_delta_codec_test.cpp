@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/net/entity/entity_network_delta_codec.h"
+using namespace Halley;
+
+namespace {
+	using Mode = EntityNetworkDeltaCodec::Mode;
+
+	gsl::span<const gsl::byte> asSpan(const Bytes& bytes)
+	{
+		return gsl::as_bytes(gsl::span<const Byte>(bytes));
+	}
+
+	class DeltaCodecTest : public ::testing::TestWithParam<Mode> {
+	protected:
+		DeltaCodecTest()
+			: codec(GetParam(), reflection, makeOptions())
+		{
+		}
+
+		static SerializerOptions makeOptions()
+		{
+			SerializerOptions options;
+			options.version = SerializerOptions::maxVersion;
+			return options;
+		}
+
+		static EntityDataDelta::Options makeDeltaOptions()
+		{
+			EntityDataDelta::Options options;
+			options.deltaComponents = true;
+			options.omitEmptyComponents = true;
+			return options;
+		}
+
+		static EntityData makeEntity()
+		{
+			EntityData data(UUID::generate());
+			data.setName("entity");
+			ConfigNode::MapType transform;
+			transform["position"] = Vector2f(10.5f, -3.25f);
+			transform["rotation"] = 1.5f;
+			transform["subWorld"] = 2;
+			data.getComponents().emplace_back("Transform2D", ConfigNode(std::move(transform)));
+			ConfigNode::MapType sprite;
+			sprite["layer"] = 3;
+			sprite["visible"] = true;
+			sprite["image"] = "player.png";
+			data.getComponents().emplace_back("Sprite", ConfigNode(std::move(sprite)));
+			return data;
+		}
+
+		// Encodes the delta from baseline to target, decodes it and applies it back to baseline
+		EntityData roundTrip(const EntityData& baseline, const EntityData& target) const
+		{
+			const auto delta = EntityDataDelta(baseline, target, makeDeltaOptions());
+			const auto bytes = codec.encode(delta, baseline);
+			const auto decoded = codec.decode(asSpan(bytes), baseline);
+			EXPECT_EQ(decoded.hasChange(), delta.hasChange());
+			return EntityData::applyDelta(baseline, decoded);
+		}
+
+		WorldReflection reflection;
+		EntityNetworkDeltaCodec codec;
+	};
+}
+
+TEST_P(DeltaCodecTest, ModifyComponent)
+{
+	const auto baseline = makeEntity();
+	auto target = baseline;
+	auto& transform = target.getComponents()[0].second;
+	transform["position"] = Vector2f(11.0f, -3.25f);
+	transform["rotation"] = -0.25f;
+	transform["subWorld"] = -7;
+
+	EXPECT_EQ(roundTrip(baseline, target), target);
+}
+
+TEST_P(DeltaCodecTest, AddComponent)
+{
+	const auto baseline = makeEntity();
+	auto target = baseline;
+	ConfigNode::MapType velocity;
+	velocity["velocity"] = Vector2f(1, 2);
+	velocity["tile"] = Vector2i(-4, 9);
+	velocity["ticks"] = int64_t(1) << 40;
+	target.getComponents().emplace_back("Velocity", ConfigNode(std::move(velocity)));
+
+	EXPECT_EQ(roundTrip(baseline, target), target);
+}
+
+TEST_P(DeltaCodecTest, RemoveComponent)
+{
+	const auto baseline = makeEntity();
+	auto target = baseline;
+	target.getComponents().erase(target.getComponents().begin());
+
+	EXPECT_EQ(roundTrip(baseline, target), target);
+}
+
+TEST_P(DeltaCodecTest, RemoveField)
+{
+	const auto baseline = makeEntity();
+	auto target = baseline;
+	target.getComponents()[1].second.asMap().erase("image");
+
+	EXPECT_EQ(roundTrip(baseline, target), target);
+}
+
+TEST_P(DeltaCodecTest, EmptyDelta)
+{
+	const auto baseline = makeEntity();
+	const auto delta = EntityDataDelta(baseline, baseline, makeDeltaOptions());
+	EXPECT_FALSE(delta.hasChange());
+
+	const auto decoded = codec.decode(asSpan(codec.encode(delta, baseline)), baseline);
+	EXPECT_FALSE(decoded.hasChange());
+	EXPECT_EQ(EntityData::applyDelta(baseline, decoded), baseline);
+}
+
+TEST_P(DeltaCodecTest, TruncatedInputThrows)
+{
+	const auto baseline = makeEntity();
+	auto target = baseline;
+	target.getComponents()[0].second["position"] = Vector2f(0, 0);
+	target.setName("renamed");
+	const auto bytes = codec.encode(EntityDataDelta(baseline, target, makeDeltaOptions()), baseline);
+
+	for (size_t len = 0; len < bytes.size(); ++len) {
+		EXPECT_ANY_THROW(codec.decode(asSpan(bytes).subspan(0, len), baseline)) << "Length " << len;
+	}
+}
+
+TEST_P(DeltaCodecTest, GarbageInputThrows)
+{
+	const auto baseline = makeEntity();
+	for (const auto fill: { 0xFF, 0x7F, 0x3F }) {
+		Bytes bytes(64, static_cast<Byte>(fill));
+		EXPECT_ANY_THROW(codec.decode(asSpan(bytes), baseline)) << "Fill " << fill;
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(HalleyEntityNetworkDeltaCodec, DeltaCodecTest, ::testing::Values(Mode::ConfigNode, Mode::Binary));
+
+TEST(HalleyEntityNetworkDeltaCodec, BinaryNeedsMatchingBaseline)
+{
+	SerializerOptions options;
+	options.version = SerializerOptions::maxVersion;
+	WorldReflection reflection;
+	EntityNetworkDeltaCodec codec(Mode::Binary, reflection, options);
+
+	EntityData baseline(UUID::generate());
+	ConfigNode::MapType transform;
+	transform["rotation"] = 1.0f;
+	baseline.getComponents().emplace_back("Transform2D", ConfigNode(std::move(transform)));
+	auto target = baseline;
+	target.getComponents()[0].second["rotation"] = 2.0f;
+
+	// Floats are coded against the baseline, which the receiver must have
+	const auto bytes = codec.encode(EntityDataDelta(baseline, target), baseline);
+	EXPECT_ANY_THROW(codec.decode(asSpan(bytes), EntityData(baseline.getInstanceUUID())));
+}
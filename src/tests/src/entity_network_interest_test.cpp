@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_world.h"
+
+#define DONT_INCLUDE_HALLEY_HPP
+#include "halley/net/entity/entity_network_interest.h"
+#include "halley/net/entity/entity_network_session.h"
+#include "halley/entity/components/transform_2d_component.h"
+using namespace Halley;
+
+namespace {
+	constexpr NetworkSession::PeerId peerId = 1;
+
+	EntityNetworkInterestManager::Config makeConfig(float bytesPerSecond = 0)
+	{
+		EntityNetworkInterestManager::Config config;
+		config.cellSize = 100;
+		config.enterMargin = 100;
+		config.leaveMargin = 200;
+		config.bytesPerSecond = bytesPerSecond;
+		return config;
+	}
+
+	// A world of networked entities, and a peer looking at (0, 0)-(100, 100)
+	class InterestWorld : public TestWorld {
+	public:
+		EntityNetworkInterestManager interest;
+		EntityClientSharedData clientData;
+		Vector<EntityNetworkUpdateInfo> networked;
+
+		explicit InterestWorld(EntityNetworkInterestManager::Config config = makeConfig())
+			: interest(config)
+		{
+			clientData.viewRect = Rect4i(0, 0, 100, 100);
+		}
+
+		EntityRef add(std::optional<Vector2f> pos)
+		{
+			auto e = (*this)->createEntity();
+			if (pos) {
+				e.addComponent(Transform2DComponent(*pos));
+			}
+			(*this)->spawnPending();
+			networked.push_back(EntityNetworkUpdateInfo{ e.getEntityId(), 0 });
+			return e;
+		}
+
+		void move(EntityRef e, Vector2f pos)
+		{
+			e.getComponent<Transform2DComponent>().setGlobalPosition(pos);
+		}
+
+		void tick(Time t = 0.1)
+		{
+			interest.update(t, **this, networked);
+			interest.updatePeer(t, peerId, clientData);
+		}
+
+		bool isRelevant(EntityRef e) const
+		{
+			return interest.isRelevant(peerId, e.getEntityId());
+		}
+	};
+}
+
+TEST(HalleyEntityNetworkInterest, HysteresisAtMargins)
+{
+	InterestWorld world;
+	auto e = world.add(Vector2f(250, 50));
+
+	// 150 away from the view: outside the enter margin
+	world.tick();
+	EXPECT_FALSE(world.isRelevant(e));
+
+	// Exactly on the enter margin
+	world.move(e, Vector2f(200, 50));
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(e));
+
+	// Past the enter margin, but it was already relevant, so it stays that way up to and including the leave margin
+	world.move(e, Vector2f(250, 50));
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(e));
+	world.move(e, Vector2f(300, 50));
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(e));
+
+	world.move(e, Vector2f(301, 50));
+	world.tick();
+	EXPECT_FALSE(world.isRelevant(e));
+
+	// Coming back into the band between the margins isn't enough to become relevant again
+	world.move(e, Vector2f(250, 50));
+	world.tick();
+	EXPECT_FALSE(world.isRelevant(e));
+	world.move(e, Vector2f(199, 50));
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(e));
+
+	// Margins apply diagonally too, by distance to the nearest corner
+	auto diagonal = world.add(Vector2f(171, 171));
+	world.tick();
+	EXPECT_FALSE(world.isRelevant(diagonal));
+	world.move(diagonal, Vector2f(170, 170));
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(diagonal));
+}
+
+TEST(HalleyEntityNetworkInterest, RelevanceFollowsTheView)
+{
+	InterestWorld world;
+	auto e = world.add(Vector2f(50, 50));
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(e));
+
+	// The view moving away drops it the same way the entity moving away would
+	world.clientData.viewRect = Rect4i(1000, 0, 100, 100);
+	world.tick();
+	EXPECT_FALSE(world.isRelevant(e));
+
+	// Entities that stop being networked stop being relevant
+	world.clientData.viewRect = Rect4i(0, 0, 100, 100);
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(e));
+	world.networked.clear();
+	world.tick();
+	EXPECT_FALSE(world.isRelevant(e));
+
+	world.interest.removePeer(peerId);
+	EXPECT_FALSE(world.isRelevant(e));
+}
+
+TEST(HalleyEntityNetworkInterest, EntitiesWithoutPositionAreAlwaysRelevant)
+{
+	InterestWorld world;
+	auto global = world.add(std::nullopt);
+	auto positioned = world.add(Vector2f(5000, 5000));
+
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(global));
+	EXPECT_FALSE(world.isRelevant(positioned));
+
+	// Even for a peer that hasn't told us what it's looking at yet, which only gets those
+	world.clientData.viewRect.reset();
+	world.tick();
+	EXPECT_TRUE(world.isRelevant(global));
+	EXPECT_FALSE(world.isRelevant(positioned));
+
+	// They're treated as being in view, so they accumulate priority at the base rate
+	EXPECT_FLOAT_EQ(world.interest.getPriority(peerId, global.getEntityId()), 0.2f);
+	world.interest.markUpToDate(peerId, global.getEntityId(), 0);
+	EXPECT_FLOAT_EQ(world.interest.getPriority(peerId, global.getEntityId()), 0.0f);
+	world.tick(0.5);
+	EXPECT_FLOAT_EQ(world.interest.getPriority(peerId, global.getEntityId()), 0.5f);
+}
+
+TEST(HalleyEntityNetworkInterest, PriorityByDistanceAndSpeed)
+{
+	InterestWorld world;
+	auto inView = world.add(Vector2f(50, 50));
+	auto nearby = world.add(Vector2f(200, 50));
+	auto moving = world.add(Vector2f(200, 50));
+
+	world.tick(1.0);
+	world.move(moving, Vector2f(200, 0));
+	world.tick(1.0);
+
+	// One cell away halves the rate; moving at 50 units/s adds half of it back
+	const auto priority = [&] (EntityRef e) { return world.interest.getPriority(peerId, e.getEntityId()); };
+	EXPECT_FLOAT_EQ(priority(inView), 2.0f);
+	EXPECT_FLOAT_EQ(priority(nearby), 1.0f);
+	EXPECT_FLOAT_EQ(priority(moving), 0.5f + 1.5f * 0.5f);
+}
+
+TEST(HalleyEntityNetworkInterest, BudgetSendsHighestPriorityFirst)
+{
+	// 100 bytes per tick, and every update costs 60, so two updates get sent per tick
+	InterestWorld world(makeConfig(1000));
+	Vector<EntityRef> entities;
+	for (const float x: { 50.0f, 90.0f, 175.0f, 350.0f, 450.0f }) {
+		entities.push_back(world.add(Vector2f(x, 50)));
+	}
+	Vector<EntityId> relevant;
+	for (const auto& e: entities) {
+		relevant.push_back(e.getEntityId());
+	}
+
+	// The same thing EntityNetworkRemotePeer does: sort by priority, then send until the budget runs out
+	HashMap<EntityId, int> sent;
+	auto sendTick = [&] () -> Vector<EntityId>
+	{
+		world.tick();
+		auto order = relevant;
+		std::stable_sort(order.begin(), order.end(), [&] (EntityId a, EntityId b)
+		{
+			return world.interest.getPriority(peerId, a) > world.interest.getPriority(peerId, b);
+		});
+
+		Vector<EntityId> result;
+		for (const auto id: order) {
+			if (!world.interest.hasBudget(peerId)) {
+				break;
+			}
+			world.interest.markUpToDate(peerId, id, 60);
+			result.push_back(id);
+			++sent[id];
+		}
+		return result;
+	};
+
+	// Entities 0 and 1 are in view, 2 is 75 away from it, and the rest are past the enter margin
+	const auto first = sendTick();
+	ASSERT_EQ(first.size(), 2);
+	EXPECT_EQ(first[0], relevant[0]);
+	EXPECT_EQ(first[1], relevant[1]);
+	EXPECT_FALSE(world.interest.hasBudget(peerId));
+
+	// Whatever didn't fit keeps accumulating priority, so it goes first next time
+	const auto second = sendTick();
+	ASSERT_FALSE(second.empty());
+	EXPECT_EQ(second[0], relevant[2]);
+
+	// Over a longer run nothing relevant starves, but closer entities get more of the budget
+	for (int i = 0; i < 40; ++i) {
+		sendTick();
+	}
+	EXPECT_GT(sent[relevant[2]], 0);
+	EXPECT_GT(sent[relevant[0]], sent[relevant[2]]);
+	EXPECT_EQ(sent[relevant[3]], 0);
+	EXPECT_EQ(sent[relevant[4]], 0);
+}
+
+TEST(HalleyEntityNetworkInterest, BudgetRefillIsCapped)
+{
+	InterestWorld world(makeConfig(1000));
+	auto e = world.add(Vector2f(50, 50));
+
+	// Ten idle ticks would be 1000 bytes, but only a quarter of a second's worth is kept
+	for (int i = 0; i < 10; ++i) {
+		world.tick();
+	}
+	int sends = 0;
+	while (world.interest.hasBudget(peerId)) {
+		world.interest.markUpToDate(peerId, e.getEntityId(), 60);
+		++sends;
+	}
+	EXPECT_EQ(sends, 5);
+
+	// Overspending is paid back before anything else gets sent
+	world.tick();
+	EXPECT_TRUE(world.interest.hasBudget(peerId));
+	world.interest.markUpToDate(peerId, e.getEntityId(), 400);
+	world.tick();
+	EXPECT_FALSE(world.interest.hasBudget(peerId));
+	world.tick();
+	world.tick();
+	EXPECT_FALSE(world.interest.hasBudget(peerId));
+	world.tick();
+	EXPECT_TRUE(world.interest.hasBudget(peerId));
+
+	// Without a budget there's no limit
+	InterestWorld unlimited;
+	auto u = unlimited.add(Vector2f(50, 50));
+	unlimited.tick();
+	for (int i = 0; i < 100; ++i) {
+		unlimited.interest.markUpToDate(peerId, u.getEntityId(), 100000);
+	}
+	EXPECT_TRUE(unlimited.interest.hasBudget(peerId));
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	std::unique_ptr<Font> makeLoadedFont()
+	{
+		Font source("test", "test.png", 10, 12, 12, 1, Vector2i(64, 64));
+		HashMap<int32_t, Vector2f> kerning;
+		kerning['V'] = Vector2f(-2, 0);
+		source.addGlyph(Font::Glyph('A', Rect4f(0, 0, 1, 1), Vector2f(8, 8), {}, {}, Vector2f(9, 0), kerning));
+		source.addGlyph(Font::Glyph(0x4E00, Rect4f(0, 0, 1, 1), Vector2f(12, 12), {}, {}, Vector2f(13, 0), {}));
+
+		// Deserializing builds the lookup tables
+		const auto bytes = Serializer::toBytes(source);
+		auto font = std::make_unique<Font>();
+		auto ds = Deserializer(bytes);
+		font->deserialize(ds);
+		return font;
+	}
+}
+
+TEST(HalleyFont, MoveRebuildsLookupTables)
+{
+	auto original = makeLoadedFont();
+	Font moved(std::move(*original));
+	original.reset();
+
+	EXPECT_EQ(moved.getGlyphHere('A').charcode, 'A');
+	EXPECT_EQ(moved.getGlyphHere('A').advance, Vector2f(9, 0));
+	EXPECT_EQ(moved.getGlyphHere(0x4E00).charcode, 0x4E00);
+	EXPECT_EQ(moved.getKerning('A', 'V'), Vector2f(-2, 0));
+
+	Font assigned;
+	assigned = std::move(moved);
+	EXPECT_EQ(assigned.getGlyphHere('A').advance, Vector2f(9, 0));
+	EXPECT_EQ(assigned.getKerning('A', 'V'), Vector2f(-2, 0));
+}
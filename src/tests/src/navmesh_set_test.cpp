@@ -0,0 +1,304 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/navigation/navmesh_set.h"
+#include "halley/navigation/navmesh_query_service.h"
+using namespace Halley;
+
+namespace {
+	constexpr float chunkSize = 100.0f;
+	constexpr size_t notFound = std::numeric_limits<size_t>::max();
+
+	// A square chunk made of a single polygon, with a portal on each side (0 = top, 1 = right, 2 = bottom, 3 = left)
+	Navmesh makeChunk(Vector2i gridPos, int subWorld = 0)
+	{
+		Navmesh::PolygonData poly;
+		poly.polygon = Polygon(Rect4f(0, 0, chunkSize, chunkSize));
+		poly.connections = { -2, -3, -4, -5 };
+		poly.weight = 1;
+
+		const auto bounds = NavmeshBounds(Vector2f(), Vector2f(chunkSize, 0), Vector2f(0, chunkSize), 1, 1, Vector2f(1, 1));
+		auto navmesh = Navmesh({ std::move(poly) }, bounds, subWorld);
+		navmesh.setWorldPosition(Vector2f(gridPos) * chunkSize, gridPos);
+		return navmesh;
+	}
+
+	// 6x6 chunks with two walls that paths have to wind around, plus an island that can't be reached:
+	//   . . # . . .
+	//   . . # . # .
+	//   . . # . # .
+	//   . . # . # .
+	//   . . . . # .
+	//   . . . . # .
+	NavmeshSet makeMaze()
+	{
+		NavmeshSet set;
+		for (int y = 0; y < 6; ++y) {
+			for (int x = 0; x < 6; ++x) {
+				const bool wall = (x == 2 && y <= 3) || (x == 4 && y >= 1);
+				if (!wall) {
+					set.add(makeChunk(Vector2i(x, y)));
+				}
+			}
+		}
+		set.add(makeChunk(Vector2i(10, 10)));
+		set.linkNavmeshes();
+		return set;
+	}
+
+	Vector<WorldPosition> makeSamplePositions(const NavmeshSet& set, uint32_t seed)
+	{
+		Random rng(seed);
+		Vector<WorldPosition> result;
+		for (const auto& navmesh: set.getNavmeshes()) {
+			if (navmesh.getSubWorld() == 0) {
+				const auto centre = navmesh.getOffset() + Vector2f(chunkSize, chunkSize) * 0.5f;
+				result.push_back(WorldPosition(centre + Vector2f(rng.getFloat(-40, 40), rng.getFloat(-40, 40)), 0));
+			}
+		}
+		return result;
+	}
+
+	NavigationQuery makeQuery(WorldPosition from, WorldPosition to)
+	{
+		return NavigationQuery(from, to, NavigationQuery::PostProcessingType::None, NavigationQuery::QuantizationType::None);
+	}
+
+	// Cheapest portal route between two points in different regions, found with a plain Dijkstra over every portal crossing
+	std::optional<float> getReferenceCost(const NavmeshSet& set, Vector2f from, size_t fromRegion, Vector2f to, size_t toRegion)
+	{
+		const auto navmeshes = set.getNavmeshes();
+		Vector<size_t> firstCrossing;
+		size_t nCrossings = 0;
+		for (const auto& navmesh: navmeshes) {
+			firstCrossing.push_back(nCrossings);
+			nCrossings += navmesh.getPortals().size();
+		}
+
+		Vector<float> costs(nCrossings, std::numeric_limits<float>::infinity());
+		Vector<bool> done(nCrossings, false);
+		const auto getPos = [&] (size_t region, size_t edge) { return navmeshes[region].getPortals()[edge].pos; };
+		const auto relax = [&] (size_t region, Vector2f pos, float cost)
+		{
+			const auto& portals = navmeshes[region].getPortals();
+			for (size_t edge = 0; edge < portals.size(); ++edge) {
+				if (portals[edge].connected) {
+					auto& c = costs[firstCrossing[region] + edge];
+					c = std::min(c, cost + (portals[edge].pos - pos).length());
+				}
+			}
+		};
+
+		relax(fromRegion, from, 0);
+		std::optional<float> best;
+		while (true) {
+			size_t cur = notFound;
+			for (size_t i = 0; i < nCrossings; ++i) {
+				if (!done[i] && std::isfinite(costs[i]) && (cur == notFound || costs[i] < costs[cur])) {
+					cur = i;
+				}
+			}
+			if (cur == notFound) {
+				break;
+			}
+			done[cur] = true;
+
+			const size_t region = std::upper_bound(firstCrossing.begin(), firstCrossing.end(), cur) - firstCrossing.begin() - 1;
+			const auto pos = getPos(region, cur - firstCrossing[region]);
+			const auto dst = set.getPortalDestination(static_cast<uint16_t>(region), static_cast<uint16_t>(cur - firstCrossing[region])).first;
+			if (dst == toRegion) {
+				const float cost = costs[cur] + (to - pos).length();
+				best = best ? std::min(*best, cost) : cost;
+			}
+			relax(dst, pos, costs[cur]);
+		}
+		return best;
+	}
+
+	// Length of the route through the portals of a region path, checking that each portal leads to the next region
+	float getPathCost(const NavmeshSet& set, const NavigationPath& path, Vector2f from, Vector2f to)
+	{
+		float cost = 0;
+		auto pos = from;
+		for (size_t i = 0; i + 1 < path.regions.size(); ++i) {
+			const auto& region = path.regions[i];
+			EXPECT_EQ(set.getPortalDestination(region.regionNodeId, region.exitEdgeId).first, path.regions[i + 1].regionNodeId);
+			const auto portalPos = set.getNavmeshes()[region.regionNodeId].getPortals()[region.exitEdgeId].pos;
+			cost += (portalPos - pos).length();
+			pos = portalPos;
+		}
+		return cost + (to - pos).length();
+	}
+
+	bool isSameRoute(const NavigationPath& a, const NavigationPath& b)
+	{
+		if (a.regions.size() != b.regions.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < a.regions.size(); ++i) {
+			if (a.regions[i].regionNodeId != b.regions[i].regionNodeId || a.regions[i].exitEdgeId != b.regions[i].exitEdgeId) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Paths between every pair of sample positions in different regions, checked against the reference
+	Vector<std::optional<NavigationPath>> expectShortestPaths(const NavmeshSet& set, gsl::span<const WorldPosition> positions)
+	{
+		Vector<std::optional<NavigationPath>> result;
+		for (const auto& from: positions) {
+			for (const auto& to: positions) {
+				const auto fromRegion = set.getNavMeshIdxAt(from);
+				const auto toRegion = set.getNavMeshIdxAt(to);
+				if (fromRegion == toRegion) {
+					continue;
+				}
+
+				const auto expected = getReferenceCost(set, from.pos, fromRegion, to.pos, toRegion);
+				auto path = set.pathfind(makeQuery(from, to));
+				EXPECT_EQ(path.has_value(), expected.has_value()) << from.toString() << " -> " << to.toString();
+				if (path && expected) {
+					EXPECT_EQ(path->regions.front().regionNodeId, fromRegion);
+					EXPECT_EQ(path->regions.back().regionNodeId, toRegion);
+					EXPECT_NEAR(getPathCost(set, *path, from.pos, to.pos), *expected, 0.01f) << from.toString() << " -> " << to.toString();
+				}
+				result.push_back(std::move(path));
+			}
+		}
+		return result;
+	}
+
+	void expectSameRoutes(gsl::span<const std::optional<NavigationPath>> a, gsl::span<const std::optional<NavigationPath>> b)
+	{
+		ASSERT_EQ(a.size(), b.size());
+		for (size_t i = 0; i < a.size(); ++i) {
+			ASSERT_EQ(a[i].has_value(), b[i].has_value());
+			if (a[i]) {
+				EXPECT_TRUE(isSameRoute(*a[i], *b[i])) << a[i]->query.toString();
+			}
+		}
+	}
+
+	std::thread makeThread(String name, std::function<void()> f)
+	{
+		return std::thread(std::move(f));
+	}
+}
+
+TEST(HalleyNavmeshSet, CachedPathsMatchUncached)
+{
+	const auto set = makeMaze();
+	const auto positions = makeSamplePositions(set, 1);
+	EXPECT_EQ(set.getNumCachedPortalTrees(), 0);
+
+	// The first pass fills the cache, the second one only reads from it
+	const auto cold = expectShortestPaths(set, positions);
+	EXPECT_GT(set.getNumCachedPortalTrees(), 0);
+	const auto warm = expectShortestPaths(set, positions);
+	expectSameRoutes(cold, warm);
+
+	// Copies don't share the cache
+	NavmeshSet copy = set;
+	EXPECT_EQ(copy.getNumCachedPortalTrees(), 0);
+	copy.linkNavmeshes();
+	expectSameRoutes(cold, expectShortestPaths(copy, positions));
+}
+
+TEST(HalleyNavmeshSet, UnreachableRegions)
+{
+	const auto set = makeMaze();
+	const auto island = WorldPosition(Vector2f(1050, 1050), 0);
+	const auto mainland = WorldPosition(Vector2f(50, 50), 0);
+	ASSERT_NE(set.getNavMeshIdxAt(island), notFound);
+
+	String error;
+	EXPECT_FALSE(set.pathfind(makeQuery(mainland, island), &error));
+	EXPECT_FALSE(error.isEmpty());
+	EXPECT_FALSE(set.pathfind(makeQuery(island, mainland)));
+
+	// Cached trees from the failed queries don't stop other ones from working
+	EXPECT_TRUE(set.pathfind(makeQuery(mainland, WorldPosition(Vector2f(550, 550), 0))));
+}
+
+TEST(HalleyNavmeshSet, LinkingClearsCache)
+{
+	auto set = makeMaze();
+	const auto from = WorldPosition(Vector2f(150, 250), 0);
+	const auto to = WorldPosition(Vector2f(350, 250), 0);
+	const auto before = set.pathfind(makeQuery(from, to));
+	ASSERT_TRUE(before);
+	EXPECT_GT(set.getNumCachedPortalTrees(), 0);
+
+	// Opening a gap in the first wall gives a much shorter route, which a stale cache wouldn't know about
+	set.add(makeChunk(Vector2i(2, 2)));
+	set.linkNavmeshes();
+	EXPECT_EQ(set.getNumCachedPortalTrees(), 0);
+
+	const auto after = set.pathfind(makeQuery(from, to));
+	ASSERT_TRUE(after);
+	EXPECT_EQ(after->regions.size(), 3);
+	EXPECT_LT(getPathCost(set, *after, from.pos, to.pos), getPathCost(set, *before, from.pos, to.pos));
+	expectShortestPaths(set, makeSamplePositions(set, 2));
+}
+
+TEST(HalleyNavmeshSet, ClearingSubWorldsClearsCache)
+{
+	auto set = makeMaze();
+	set.add(makeChunk(Vector2i(0, 0), 1));
+	set.linkNavmeshes();
+	const auto positions = makeSamplePositions(set, 3);
+	const auto paths = expectShortestPaths(set, positions);
+	EXPECT_GT(set.getNumCachedPortalTrees(), 0);
+
+	set.clearSubWorld(1);
+	EXPECT_EQ(set.getNumCachedPortalTrees(), 0);
+	set.linkNavmeshes();
+	expectSameRoutes(paths, expectShortestPaths(set, positions));
+	EXPECT_GT(set.getNumCachedPortalTrees(), 0);
+
+	set.clear();
+	EXPECT_EQ(set.getNumCachedPortalTrees(), 0);
+	EXPECT_TRUE(set.getNavmeshes().empty());
+	EXPECT_FALSE(set.pathfind(makeQuery(positions[0], positions[1])));
+}
+
+TEST(HalleyNavmeshSet, QueryServiceMatchesDirectPathfinding)
+{
+	static Executors executors;
+	Executors::setInstance(executors);
+	ThreadPool pool("Navmesh", Executors::getCPU(), 3, makeThread);
+
+	const auto set = std::make_shared<NavmeshSet>(makeMaze());
+	const auto positions = makeSamplePositions(*set, 4);
+	NavmeshQueryService service(set, Executors::getCPU());
+
+	Vector<NavigationQuery> queries;
+	Vector<Future<std::optional<NavigationPath>>> futures;
+	for (const auto& from: positions) {
+		for (const auto& to: positions) {
+			queries.push_back(makeQuery(from, to));
+			futures.push_back(service.request(queries.back()));
+		}
+	}
+	// Including positions off the navmesh
+	queries.push_back(makeQuery(WorldPosition(Vector2f(-500, -500), 0), positions[0]));
+	futures.push_back(service.request(queries.back()));
+	EXPECT_EQ(service.getNumPending(), queries.size());
+
+	service.dispatch().wait();
+	EXPECT_EQ(service.getNumPending(), 0);
+
+	const auto reference = NavmeshSet(makeMaze());
+	for (size_t i = 0; i < queries.size(); ++i) {
+		const auto expected = reference.pathfind(queries[i]);
+		const auto actual = futures[i].get();
+		ASSERT_EQ(actual.has_value(), expected.has_value()) << queries[i].toString();
+		if (actual) {
+			EXPECT_TRUE(isSameRoute(*actual, *expected)) << queries[i].toString();
+			EXPECT_EQ(actual->path, expected->path) << queries[i].toString();
+		}
+	}
+
+	// Nothing pending is done straight away
+	EXPECT_TRUE(service.dispatch().isReady());
+}
@@ -0,0 +1,332 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include <iostream>
+using namespace Halley;
+
+namespace {
+	constexpr int64_t onSpawnId = 1;
+	constexpr int64_t onDeathId = 2;
+
+	class SpawnRecorder final : public IParticleSpawner {
+	public:
+		Vector<Vector3f> spawned;
+		Vector<Vector3f> died;
+
+		void spawn(Vector3f pos, EntityId target) override
+		{
+			(target.value == onSpawnId ? spawned : died).push_back(pos);
+		}
+	};
+
+	ConfigNode makeEmitterConfig(float spawnRate)
+	{
+		ConfigNode::MapType node;
+		node["spawnRate"] = spawnRate;
+		node["ttl"] = Range<float>(0.3f, 0.6f);
+		node["speed"] = Range<float>(50.0f, 100.0f);
+		node["azimuth"] = Range<float>(0.0f, 360.0f);
+		node["altitude"] = Range<float>(-30.0f, 30.0f);
+		node["initialScale"] = Range<float>(0.5f, 1.5f);
+		node["acceleration"] = Vector3f(0, 30, -10);
+		node["speedDamp"] = 0.5f;
+		node["velScale"] = Vector3f(1, 0.5f, 1);
+		node["startHeight"] = 5.0f;
+		node["onSpawn"] = ConfigNode(EntityId(onSpawnId));
+		node["onDeath"] = ConfigNode(EntityId(onDeathId));
+		return ConfigNode(std::move(node));
+	}
+
+	// One particle at a time, the way Particles integrated them before they were stored as arrays
+	class ReferenceEmitter {
+	public:
+		struct Particle {
+			Vector3f pos;
+			Vector3f vel;
+			float time;
+			float ttl;
+			bool firstFrame;
+		};
+
+		Vector<Particle> particles;
+		Vector<Vector3f> spawned;
+		Vector<Vector3f> died;
+
+		ReferenceEmitter(uint32_t seed, float spawnRate, Vector3f position, Range<float> ttl = Range<float>(0.3f, 0.6f))
+			: rng(seed)
+			, spawnRate(spawnRate)
+			, position(position)
+			, ttl(ttl)
+		{}
+
+		void update(Time t)
+		{
+			pendingSpawn += static_cast<float>(t * spawnRate);
+			const int toSpawn = static_cast<int>(floor(pendingSpawn));
+			pendingSpawn = pendingSpawn - static_cast<float>(toSpawn);
+
+			const float dt = static_cast<float>(t);
+			const float timeSlice = dt / toSpawn;
+			for (int i = 0; i < toSpawn; ++i) {
+				spawn(i * timeSlice);
+			}
+
+			for (auto& p: particles) {
+				p.time += dt;
+				if (p.time >= p.ttl) {
+					died.push_back(p.pos);
+					continue;
+				}
+				if (p.firstFrame) {
+					p.firstFrame = false;
+				} else {
+					p.pos += (p.vel * dt + acceleration * (0.5f * dt * dt)) * velScale;
+					p.vel += acceleration * dt;
+				}
+				p.vel = damp(p.vel, Vector3f(), 0.5f, dt);
+			}
+			std_ex::erase_if(particles, [] (const Particle& p) { return p.time >= p.ttl; });
+		}
+
+		void burst(int n)
+		{
+			for (int i = 0; i < n; ++i) {
+				spawn(0);
+			}
+		}
+
+	private:
+		Random rng;
+		float spawnRate;
+		Vector3f position;
+		Range<float> ttl;
+		float pendingSpawn = 0;
+		Vector3f acceleration = Vector3f(0, 30, -10);
+		Vector3f velScale = Vector3f(1, 0.5f, 1);
+
+		void spawn(float time)
+		{
+			// Same draws, in the same order, as Particles::initializeParticle
+			const auto azimuth = Angle1f::fromDegrees(rng.getFloat(0.0f, 360.0f));
+			const auto altitude = Angle1f::fromDegrees(rng.getFloat(-30.0f, 30.0f));
+			const float particleTtl = rng.getFloat(ttl);
+			rng.getFloat(0.5f, 1.5f);
+			const auto vel = Vector3f(rng.getFloat(50.0f, 100.0f), azimuth, altitude);
+			rng.getFloat(-1, 1);
+			rng.getFloat(-1, 1);
+
+			const auto pos = position + Vector3f(0, 0, 5) + (vel * time + acceleration * (0.5f * time * time)) * velScale;
+			particles.push_back(Particle{ pos, vel, time, particleTtl, true });
+			spawned.push_back(pos);
+		}
+	};
+
+	void expectNear(Vector3f a, Vector3f b)
+	{
+		EXPECT_NEAR(a.x, b.x, 0.001f);
+		EXPECT_NEAR(a.y, b.y, 0.001f);
+		EXPECT_NEAR(a.z, b.z, 0.001f);
+	}
+
+	void expectSamePositions(Vector<Vector3f> actual, Vector<Vector3f> expected)
+	{
+		// Dead particles are compacted out of order, so compare them as sets
+		const auto byPosition = [] (Vector3f a, Vector3f b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+		std::sort(actual.begin(), actual.end(), byPosition);
+		std::sort(expected.begin(), expected.end(), byPosition);
+		ASSERT_EQ(actual.size(), expected.size());
+		for (size_t i = 0; i < actual.size(); ++i) {
+			expectNear(actual[i], expected[i]);
+		}
+	}
+
+	std::optional<Rect4f> getReferenceAABB(const ReferenceEmitter& reference)
+	{
+		if (reference.particles.empty()) {
+			return {};
+		}
+		const auto project = [] (Vector3f pos) { return Vector2f(pos.x, pos.y - pos.z); };
+		auto minPos = project(reference.particles[0].pos);
+		auto maxPos = minPos;
+		for (const auto& p: reference.particles) {
+			minPos = Vector2f::min(minPos, project(p.pos));
+			maxPos = Vector2f::max(maxPos, project(p.pos));
+		}
+		return Rect4f(minPos, maxPos);
+	}
+}
+
+TEST(HalleyParticles, MatchesScalarReference)
+{
+	const auto position = Vector3f(100, 50, 0);
+	HalleyAPI api;
+	Resources resources(nullptr, api, ResourceOptions());
+	Random rng(uint32_t(42));
+	SpawnRecorder recorder;
+
+	Particles particles(makeEmitterConfig(128), resources, EntitySerializationContext());
+	particles.setRNG(rng);
+	particles.setSecondarySpawner(&recorder);
+	particles.setPosition(position);
+	ReferenceEmitter reference(42, 128, position);
+
+	// Long enough for the emitter to reach a steady state where particles die every step
+	for (int step = 0; step < 40; ++step) {
+		particles.update(1.0 / 64.0);
+		reference.update(1.0 / 64.0);
+
+		ASSERT_EQ(recorder.spawned.size(), reference.spawned.size()) << "Step " << step;
+		for (size_t i = 0; i < recorder.spawned.size(); ++i) {
+			expectNear(recorder.spawned[i], reference.spawned[i]);
+		}
+		expectSamePositions(recorder.died, reference.died);
+
+		const auto aabb = particles.getAABB();
+		const auto expectedAABB = getReferenceAABB(reference);
+		ASSERT_EQ(aabb.has_value(), expectedAABB.has_value()) << "Step " << step;
+		if (aabb) {
+			EXPECT_NEAR(aabb->getLeft(), expectedAABB->getLeft(), 0.001f);
+			EXPECT_NEAR(aabb->getTop(), expectedAABB->getTop(), 0.001f);
+			EXPECT_NEAR(aabb->getRight(), expectedAABB->getRight(), 0.001f);
+			EXPECT_NEAR(aabb->getBottom(), expectedAABB->getBottom(), 0.001f);
+		}
+	}
+
+	EXPECT_EQ(recorder.spawned.size(), 80);
+	EXPECT_GT(recorder.died.size(), 10);
+}
+
+TEST(HalleyParticles, SpawnCounts)
+{
+	HalleyAPI api;
+	Resources resources(nullptr, api, ResourceOptions());
+	Random rng(uint32_t(7));
+
+	auto config = makeEmitterConfig(100);
+	config["ttl"] = Range<float>(10.0f, 10.0f);
+	config["maxParticles"] = 25;
+
+	SpawnRecorder recorder;
+	Particles particles(config, resources, EntitySerializationContext());
+	particles.setRNG(rng);
+	particles.setSecondarySpawner(&recorder);
+
+	// 100 per second, accumulating fractions of a particle across steps
+	particles.update(0.125);
+	EXPECT_EQ(recorder.spawned.size(), 12);
+	particles.update(0.125);
+	EXPECT_EQ(recorder.spawned.size(), 25);
+
+	// Capped at maxParticles while none of them have died
+	particles.update(0.125);
+	EXPECT_EQ(recorder.spawned.size(), 25);
+
+	particles.setSpawnRateMultiplier(0);
+	particles.burstParticles(3);
+	particles.update(0.125);
+	EXPECT_EQ(recorder.spawned.size(), 25);
+	EXPECT_TRUE(recorder.died.empty());
+}
+
+TEST(HalleyParticles, BurstLifetime)
+{
+	HalleyAPI api;
+	Resources resources(nullptr, api, ResourceOptions());
+	Random rng(uint32_t(7));
+
+	auto config = makeEmitterConfig(100);
+	config["ttl"] = Range<float>(0.5f, 0.5f);
+	config["burst"] = 20;
+	config["destroyWhenDone"] = true;
+
+	SpawnRecorder recorder;
+	Particles particles(config, resources, EntitySerializationContext());
+	particles.setRNG(rng);
+	particles.setSecondarySpawner(&recorder);
+
+	// A burst spawns once, on the first update, and the emitter stays alive until the last particle expires
+	for (int i = 0; i < 3; ++i) {
+		particles.update(0.125);
+		EXPECT_EQ(recorder.spawned.size(), 20);
+		EXPECT_TRUE(recorder.died.empty());
+		EXPECT_TRUE(particles.isAlive());
+	}
+
+	particles.update(0.125);
+	EXPECT_EQ(recorder.spawned.size(), 20);
+	EXPECT_EQ(recorder.died.size(), 20);
+	EXPECT_FALSE(particles.isAlive());
+	EXPECT_FALSE(particles.getAABB().has_value());
+}
+
+TEST(HalleyParticles, MinHeightKillsParticles)
+{
+	HalleyAPI api;
+	Resources resources(nullptr, api, ResourceOptions());
+	Random rng(uint32_t(7));
+
+	auto config = makeEmitterConfig(100);
+	config["ttl"] = Range<float>(10.0f, 10.0f);
+	config["altitude"] = Range<float>(-90.0f, -90.0f);
+	config["speed"] = Range<float>(8.0f, 8.0f);
+	config["speedDamp"] = 0.0f;
+	config["acceleration"] = Vector3f();
+	config["minHeight"] = 0.0f;
+	config["burst"] = 5;
+
+	SpawnRecorder recorder;
+	Particles particles(config, resources, EntitySerializationContext());
+	particles.setRNG(rng);
+	particles.setSecondarySpawner(&recorder);
+
+	// Spawned at height 5 and falling at 8 per second, so below zero on the fourth step
+	for (int i = 0; i < 3; ++i) {
+		particles.update(0.25);
+		EXPECT_TRUE(recorder.died.empty()) << "Step " << i;
+	}
+	particles.update(0.25);
+	ASSERT_EQ(recorder.died.size(), 5);
+	for (const auto& pos: recorder.died) {
+		EXPECT_LT(pos.z, 0.0f);
+	}
+}
+
+// Run with --gtest_also_run_disabled_tests; prints the cost of integrating a large burst against the scalar reference
+TEST(HalleyParticles, DISABLED_BenchmarkUpdate)
+{
+	constexpr int nParticles = 100000;
+	constexpr int steps = 200;
+	constexpr Time dt = 1.0 / 60.0;
+
+	HalleyAPI api;
+	Resources resources(nullptr, api, ResourceOptions());
+	Random rng(uint32_t(42));
+
+	auto config = makeEmitterConfig(0);
+	config["ttl"] = Range<float>(100.0f, 100.0f);
+	config["burst"] = nParticles;
+	config["onSpawn"] = ConfigNode();
+	config["onDeath"] = ConfigNode();
+	Particles particles(config, resources, EntitySerializationContext());
+	particles.setRNG(rng);
+	particles.update(dt);
+
+	ReferenceEmitter reference(42, 0, Vector3f(), Range<float>(100.0f, 100.0f));
+	reference.burst(nParticles);
+	reference.update(dt);
+
+	Stopwatch simd;
+	for (int i = 0; i < steps; ++i) {
+		particles.update(dt);
+	}
+	simd.pause();
+
+	Stopwatch scalar;
+	for (int i = 0; i < steps; ++i) {
+		reference.update(dt);
+	}
+	scalar.pause();
+
+	std::cout << nParticles << " particles, " << steps << " steps: "
+		<< (simd.elapsedNanoseconds() / steps) << " ns/step in Particles, "
+		<< (scalar.elapsedNanoseconds() / steps) << " ns/step in scalar reference" << std::endl;
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include <filesystem>
+#include "halley/support/profiler.h"
+using namespace Halley;
+
+namespace {
+	void recordEvent(ProfilerCapture& capture, ProfilerEventType type, std::string_view name)
+	{
+		const auto id = capture.recordEventStart(type, name);
+		capture.recordEventEnd(id);
+	}
+}
+
+TEST(HalleyProfiler, Capture)
+{
+	ProfilerCapture capture(64);
+
+	capture.startFrame(true);
+	const auto outer = capture.recordEventStart(ProfilerEventType::CoreVariableUpdate, "");
+	recordEvent(capture, ProfilerEventType::WorldSystemUpdate, "SomeSystem");
+	std::thread([&] () { recordEvent(capture, ProfilerEventType::DiskIO, "texture:foo"); }).join();
+	capture.recordEventEnd(outer);
+	capture.endFrame();
+
+	const auto data = capture.getCapture();
+	const auto& events = data.getEvents();
+	ASSERT_EQ(events.size(), 3);
+	EXPECT_EQ(events[0].type, ProfilerEventType::CoreVariableUpdate);
+	EXPECT_EQ(events[0].depth, 0);
+	EXPECT_EQ(events[1].name, "SomeSystem");
+	EXPECT_EQ(events[1].depth, 1);
+	EXPECT_EQ(events[2].name, "texture:foo");
+	EXPECT_NE(events[2].threadId, events[0].threadId);
+	EXPECT_EQ(data.getThreads().size(), 2);
+
+	// Not recording
+	capture.startFrame(false);
+	recordEvent(capture, ProfilerEventType::Game, "Ignored");
+	capture.endFrame();
+	EXPECT_TRUE(capture.getCapture().getEvents().empty());
+}
+
+TEST(HalleyProfiler, CaptureWrapsAround)
+{
+	ProfilerCapture capture(16);
+
+	capture.startFrame(true);
+	for (int i = 0; i < 100; ++i) {
+		recordEvent(capture, ProfilerEventType::Game, "Event" + toString(i));
+	}
+	capture.endFrame();
+
+	const auto data = capture.getCapture();
+	ASSERT_EQ(data.getEvents().size(), 16);
+	EXPECT_EQ(data.getEvents().back().name, "Event99");
+}
+
+TEST(HalleyProfiler, RecyclesBuffersOfExitedThreads)
+{
+	ProfilerCapture capture(16);
+
+	// More short-lived threads than there are buffers, one per frame
+	for (int frame = 0; frame < 300; ++frame) {
+		capture.startFrame(true);
+		std::thread([&] () { recordEvent(capture, ProfilerEventType::DiskIO, "Frame" + toString(frame)); }).join();
+		capture.endFrame();
+
+		const auto data = capture.getCapture();
+		ASSERT_EQ(data.getEvents().size(), 1) << "Frame " << frame;
+		EXPECT_EQ(data.getEvents()[0].name, "Frame" + toString(frame));
+	}
+}
+
+TEST(HalleyProfiler, Streaming)
+{
+	const auto path = Path((std::filesystem::temp_directory_path() / "halley_profiler_test.trace").string());
+
+	{
+		ProfilerCapture capture(32);
+		ASSERT_TRUE(capture.startStreaming(path));
+
+		// Longer than the buffers, across several frames
+		for (int frame = 0; frame < 10; ++frame) {
+			capture.startFrame(false);
+			const auto id = capture.recordEventStart(ProfilerEventType::CoreVariableUpdate, "Frame");
+			std::thread([&] () { recordEvent(capture, ProfilerEventType::DiskIO, "Load \"quoted\""); }).join();
+			capture.recordEventEnd(id);
+			capture.endFrame();
+		}
+
+		capture.stopStreaming();
+	}
+
+	const auto trace = ProfilerTrace(Path::readFile(path).byte_span());
+	std::filesystem::remove(path.string());
+
+	EXPECT_EQ(trace.getEvents().size() + trace.getDroppedEvents(), 20);
+	EXPECT_EQ(trace.getThreads().size(), 11);
+	for (const auto& e: trace.getEvents()) {
+		EXPECT_NE(e.endTime, 0);
+		if (e.type == ProfilerEventType::DiskIO) {
+			EXPECT_EQ(trace.getName(e.nameId), "Load \"quoted\"");
+		} else {
+			EXPECT_EQ(trace.getName(e.nameId), "Frame");
+		}
+	}
+
+	const auto json = trace.toChromeJSON();
+	EXPECT_TRUE(json.contains("\"name\":\"Load \\\"quoted\\\"\""));
+	EXPECT_TRUE(json.contains("\"cat\":\"diskIO\""));
+}
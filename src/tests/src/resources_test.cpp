@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/resources/asset_pack.h"
+#include "halley/resources/asset_database.h"
+#include "halley/resources/resource_locator.h"
+using namespace Halley;
+
+namespace {
+	class MemoryReader final : public ResourceDataReader {
+	public:
+		explicit MemoryReader(Bytes bytes)
+			: bytes(std::move(bytes))
+		{}
+
+		size_t size() const override { return bytes.size(); }
+		void seek(int64_t p, int whence) override { pos = size_t(whence == SEEK_SET ? p : whence == SEEK_CUR ? int64_t(pos) + p : int64_t(bytes.size()) + p); }
+		size_t tell() const override { return pos; }
+		void close() override {}
+
+		int read(gsl::span<gsl::byte> dst) override
+		{
+			const size_t n = std::min(size_t(dst.size()), bytes.size() - std::min(pos, bytes.size()));
+			memcpy(dst.data(), bytes.data() + pos, n);
+			pos += n;
+			return int(n);
+		}
+
+	private:
+		Bytes bytes;
+		size_t pos = 0;
+	};
+
+	// Serves one in-memory pack to the resource locator
+	class PackSystemAPI final : public SystemAPI {
+	public:
+		explicit PackSystemAPI(Bytes pack)
+			: pack(std::move(pack))
+		{}
+
+		Path getAssetsPath(const Path& gamePath) const override { return {}; }
+		Path getUnpackedAssetsPath(const Path& gamePath) const override { return {}; }
+		std::unique_ptr<ResourceDataReader> getDataReader(String path, int64_t start, int64_t end) override { return std::make_unique<MemoryReader>(pack); }
+		std::unique_ptr<GLContext> createGLContext() override { return {}; }
+		std::shared_ptr<Window> createWindow(const WindowDefinition& window) override { return {}; }
+		void destroyWindow(std::shared_ptr<Window> window) override {}
+		Vector2i getScreenSize(int n) const override { return {}; }
+		Rect4i getDisplayRect(int screen) const override { return {}; }
+		void showCursor(bool show) override {}
+		std::shared_ptr<ISaveData> getStorageContainer(SaveDataType type, const String& containerName) override { return {}; }
+
+	private:
+		Bytes pack;
+
+		bool generateEvents(VideoAPI* video, InputAPI* input) override { return true; }
+	};
+
+	Bytes makeConfigPack(const Vector<String>& names)
+	{
+		AssetPack pack;
+		for (const auto& name: names) {
+			ConfigNode::MapType root;
+			root["name"] = name;
+			root["padding"] = String(std::string(1000, 'x'));
+			const auto bytes = Serializer::toBytes(ConfigFile(ConfigNode(std::move(root))));
+			const auto location = pack.appendAsset(gsl::as_bytes(gsl::span<const Byte>(bytes)), false);
+			pack.getAssetDatabase().addAsset(name, AssetType::ConfigFile, AssetDatabase::Entry(location, Metadata()));
+		}
+		return pack.writeOut();
+	}
+
+	// Streaming needs executors; these have no threads attached, the tests run each queue by hand
+	void initExecutors()
+	{
+		static Executors executors;
+		Executors::setInstance(executors);
+	}
+
+	void runStreamer(Resources& resources)
+	{
+		Executor(Executors::getDiskIO()).runPending();
+		Executor(Executors::getCPU()).runPending();
+		resources.update(1.0);
+	}
+
+	class ConfigResources {
+	public:
+		ConfigResources()
+			: system(makeConfigPack({ "a", "b", "c" }))
+		{
+			api.system = &system;
+			auto locator = std::make_unique<ResourceLocator>(system);
+			locator->addPack(Path("test_pack.dat"));
+			resources = std::make_unique<Resources>(std::move(locator), api, ResourceOptions());
+			resources->init<ConfigFile>();
+		}
+
+		Resources& operator*() { return *resources; }
+		Resources* operator->() { return resources.get(); }
+
+		ResourceCollectionStats getStats() const
+		{
+			for (const auto& s: resources->getStats()) {
+				if (s.type == AssetType::ConfigFile) {
+					return s;
+				}
+			}
+			return {};
+		}
+
+	private:
+		PackSystemAPI system;
+		HalleyAPI api;
+		std::unique_ptr<Resources> resources;
+	};
+}
+
+TEST(HalleyResources, BudgetEvictsOnlyUnreferencedResources)
+{
+	ConfigResources resources;
+	auto a = resources->get<ConfigFile>("a");
+	resources->get<ConfigFile>("b");
+	resources->get<ConfigFile>("c");
+	EXPECT_EQ(resources.getStats().numResident, 3);
+	EXPECT_EQ(resources.getStats().misses, 3);
+
+	resources->setMemoryBudget(AssetType::ConfigFile, 1);
+	resources->update(0);
+
+	auto stats = resources.getStats();
+	EXPECT_EQ(stats.numResident, 1);
+	EXPECT_EQ(stats.evictions, 2);
+	EXPECT_EQ(resources->get<ConfigFile>("a"), a);
+	EXPECT_EQ(resources.getStats().hits, 1);
+
+	// Evicted resources load again on demand
+	EXPECT_EQ(resources->get<ConfigFile>("b")->getRoot()["name"].asString(), "b");
+	EXPECT_EQ(resources.getStats().misses, 4);
+
+	a.reset();
+	resources->update(0);
+	EXPECT_EQ(resources.getStats().numResident, 0);
+}
+
+TEST(HalleyResources, GlobalBudgetEvictsUntilUnder)
+{
+	ConfigResources resources;
+	resources->get<ConfigFile>("a");
+	resources->get<ConfigFile>("b");
+	resources->get<ConfigFile>("c");
+	const auto total = resources.getStats().memoryUsage.getTotal();
+
+	// Room for two of the three
+	resources->setMemoryBudget(total - 1);
+	resources->update(0);
+	EXPECT_EQ(resources.getStats().numResident, 2);
+	EXPECT_LE(resources.getStats().memoryUsage.getTotal(), total - 1);
+}
+
+TEST(HalleyResources, PinnedResourcesSurviveBudget)
+{
+	ConfigResources resources;
+	resources->pin<ConfigFile>("a");
+	resources->get<ConfigFile>("a");
+	resources->get<ConfigFile>("b");
+
+	resources->setMemoryBudget(AssetType::ConfigFile, 1);
+	resources->update(0);
+	auto stats = resources.getStats();
+	EXPECT_EQ(stats.numResident, 1);
+	EXPECT_EQ(stats.numPinned, 1);
+	EXPECT_EQ(stats.evictions, 1);
+
+	resources->unpin<ConfigFile>("a");
+	resources->update(0);
+	stats = resources.getStats();
+	EXPECT_EQ(stats.numResident, 0);
+	EXPECT_EQ(stats.numPinned, 0);
+	EXPECT_EQ(stats.evictions, 2);
+}
+
+TEST(HalleyResources, RequestAsyncWithoutExecutorsLoadsImmediately)
+{
+	if (Executors::hasInstance()) {
+		GTEST_SKIP() << "Executors already set up by another test";
+	}
+
+	ConfigResources resources;
+	auto future = resources->requestAsync<ConfigFile>("a");
+	ASSERT_TRUE(future.isReady());
+	EXPECT_EQ(future.get(), resources->get<ConfigFile>("a"));
+	EXPECT_EQ(resources->getNumStreamingRequests(), 0);
+}
+
+TEST(HalleyResources, StreamerLoadsAndFinalizesOnUpdate)
+{
+	initExecutors();
+	ConfigResources resources;
+
+	auto a = resources->requestAsync<ConfigFile>("a");
+	auto a2 = resources->requestAsync<ConfigFile>("a", ResourceLoadPriority::High);
+	auto b = resources->requestAsync<ConfigFile>("b", ResourceLoadPriority::Low);
+	EXPECT_FALSE(a.isReady());
+	EXPECT_EQ(resources->getNumStreamingRequests(), 2);
+	EXPECT_EQ(resources.getStats().numResident, 0);
+
+	// Nothing is published until the main thread update
+	Executor(Executors::getDiskIO()).runPending();
+	Executor(Executors::getCPU()).runPending();
+	EXPECT_FALSE(a.isReady());
+	EXPECT_EQ(resources.getStats().numResident, 0);
+
+	resources->update(1.0);
+	ASSERT_TRUE(a.isReady());
+	ASSERT_TRUE(a2.isReady());
+	ASSERT_TRUE(b.isReady());
+	EXPECT_EQ(a.get(), a2.get());
+	EXPECT_EQ(a.get(), resources->get<ConfigFile>("a"));
+	EXPECT_EQ(b.get()->getRoot()["name"].asString(), "b");
+	EXPECT_EQ(resources->getNumStreamingRequests(), 0);
+
+	// Already resident, so no streaming at all
+	auto again = resources->requestAsync<ConfigFile>("b");
+	EXPECT_TRUE(again.isReady());
+	EXPECT_EQ(again.get(), b.get());
+	EXPECT_EQ(resources->getNumStreamingRequests(), 0);
+}
+
+TEST(HalleyResources, StreamedResourcesCanBeEvicted)
+{
+	initExecutors();
+	ConfigResources resources;
+	resources->setMemoryBudget(AssetType::ConfigFile, 1);
+
+	{
+		// Held by the future until it goes away
+		auto future = resources->requestAsync<ConfigFile>("c");
+		runStreamer(*resources);
+		ASSERT_TRUE(future.isReady());
+		EXPECT_EQ(resources.getStats().numResident, 1);
+	}
+
+	resources->update(0);
+	EXPECT_EQ(resources.getStats().numResident, 0);
+	EXPECT_EQ(resources.getStats().evictions, 1);
+}
+
+TEST(HalleyResources, SpriteKeepsItsSheetAlive)
+{
+	auto sheet = std::make_shared<SpriteSheet>();
+	std::weak_ptr<const SpriteSheet> weakSheet = sheet;
+	SpriteResource sprite(sheet, 0);
+
+	// The sheet collection may evict its copy while the sprite is still in use
+	sheet.reset();
+	EXPECT_FALSE(weakSheet.expired());
+	EXPECT_EQ(sprite.getSpriteSheet(), weakSheet.lock());
+	EXPECT_EQ(sprite.getDefaultMaterialName(), MaterialDefinition::defaultMaterial);
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/scripting/script_graph.h"
+#include "halley/scripting/script_graph_program.h"
+#include "halley/scripting/script_node_type.h"
+#include "halley/scripting/script_variables.h"
+using namespace Halley;
+
+namespace {
+	bool isFlowOutput(const IScriptNodeType::PinType& pin)
+	{
+		return pin.type == GraphElementType(ScriptNodeElementType::FlowPin) && pin.direction == GraphNodePinDirection::Output;
+	}
+
+	// How the interpreter found the next nodes before programs, by walking the pin configuration every time
+	std::array<IScriptNodeType::OutputNode, 8> getOutputNodesFromGraph(const ScriptGraphNode& node, uint8_t outputActiveMask)
+	{
+		std::array<IScriptNodeType::OutputNode, 8> result;
+		result.fill({});
+
+		const auto& pinConfig = node.getNodeType().getPinConfiguration(node);
+		size_t curOutputPin = 0;
+		size_t nOutputsFound = 0;
+		for (size_t i = 0; i < pinConfig.size(); ++i) {
+			if (isFlowOutput(pinConfig[i])) {
+				if ((outputActiveMask & (1 << curOutputPin)) != 0) {
+					for (auto& conn: node.getPin(i).connections) {
+						if (conn.dstNode) {
+							result[nOutputsFound++] = IScriptNodeType::OutputNode{ conn.dstNode, static_cast<GraphPinId>(i), conn.dstPin };
+						}
+					}
+				}
+				++curOutputPin;
+			}
+		}
+		return result;
+	}
+
+	GraphPinId getNthOutputPinIdxFromGraph(const ScriptGraphNode& node, size_t n)
+	{
+		const auto& pinConfig = node.getNodeType().getPinConfiguration(node);
+		size_t curOutputPin = 0;
+		for (size_t i = 0; i < pinConfig.size(); ++i) {
+			if (isFlowOutput(pinConfig[i])) {
+				if (curOutputPin == n) {
+					return static_cast<GraphPinId>(i);
+				}
+				++curOutputPin;
+			}
+		}
+		return 0xFF;
+	}
+
+	ConfigNode makeSettings(std::initializer_list<std::pair<const char*, const char*>> values)
+	{
+		ConfigNode::MapType result;
+		for (const auto& [k, v]: values) {
+			result[k] = String(v);
+		}
+		return ConfigNode(std::move(result));
+	}
+
+	class ProgramGraph {
+	public:
+		ProgramGraph()
+		{
+			// The graph starts with a start node
+			start = 0;
+			branch = graph.addNode("branch", {}, {});
+			setScore = graph.addNode("setVariable", {}, {});
+			setLives = graph.addNode("setVariable", {}, {});
+			flag = graph.addNode("variable", {}, makeSettings({ { "variable", "flag" } }));
+			lives = graph.addNode("variable", {}, makeSettings({ { "variable", "lives" }, { "scope", "shared" } }));
+			number = graph.addNode("literal", {}, makeSettings({ { "value", "42" } }));
+			text = graph.addNode("literal", {}, makeSettings({ { "value", "hello" } }));
+			graph.assignTypes(types);
+
+			graph.connectPins(start, 0, branch, 0);
+			graph.connectPins(flag, 1, branch, 1);
+			graph.connectPins(branch, 2, setScore, 0);
+			graph.connectPins(branch, 2, setLives, 0);
+			graph.connectPins(branch, 3, setLives, 0);
+			graph.connectPins(number, 0, setScore, 2);
+			graph.connectPins(text, 0, setLives, 2);
+			graph.connectPins(setScore, 3, flag, 0);
+			graph.connectPins(setLives, 3, lives, 0);
+			graph.finishGraph();
+			graph.assignTypes(types);
+		}
+
+		ScriptNodeTypeCollection types;
+		ScriptGraph graph;
+		GraphNodeId start, branch, setScore, setLives, flag, lives, number, text;
+	};
+}
+
+TEST(HalleyScriptGraphProgram, MatchesGraph)
+{
+	ProgramGraph g;
+	const auto& program = g.graph.getProgram();
+	EXPECT_EQ(program.getGraphHash(), g.graph.getHash());
+
+	for (GraphNodeId i = 0; i < g.graph.getNodes().size(); ++i) {
+		const auto& node = g.graph.getNodes()[i];
+
+		for (GraphPinId pin = 0; pin < 8; ++pin) {
+			const auto& link = program.getLink(i, pin);
+			const auto& connections = node.getPin(pin).connections;
+			if (connections.empty()) {
+				EXPECT_FALSE(link.node) << "Node " << i << ", pin " << int(pin);
+			} else {
+				EXPECT_EQ(link.node, connections[0].dstNode) << "Node " << i << ", pin " << int(pin);
+				EXPECT_EQ(link.pin, connections[0].dstPin) << "Node " << i << ", pin " << int(pin);
+			}
+		}
+
+		for (int mask = 0; mask < 256; ++mask) {
+			const auto expected = getOutputNodesFromGraph(node, uint8_t(mask));
+			const auto actual = program.getOutputNodes(i, uint8_t(mask));
+			for (size_t j = 0; j < expected.size(); ++j) {
+				EXPECT_EQ(actual[j].dstNode, expected[j].dstNode) << "Node " << i << ", mask " << mask;
+				if (expected[j].dstNode) {
+					EXPECT_EQ(actual[j].outputPin, expected[j].outputPin) << "Node " << i << ", mask " << mask;
+					EXPECT_EQ(actual[j].inputPin, expected[j].inputPin) << "Node " << i << ", mask " << mask;
+				}
+			}
+		}
+
+		for (size_t n = 0; n < 8; ++n) {
+			EXPECT_EQ(program.getNthOutputPinIdx(i, n), getNthOutputPinIdxFromGraph(node, n)) << "Node " << i << ", output " << n;
+		}
+	}
+
+	// The true output reaches both setters
+	EXPECT_EQ(program.getOutputNodes(g.branch, 1)[0].dstNode, g.setScore);
+	EXPECT_EQ(program.getOutputNodes(g.branch, 1)[1].dstNode, g.setLives);
+	EXPECT_EQ(program.getOutputNodes(g.branch, 3)[2].dstNode, g.setLives);
+}
+
+TEST(HalleyScriptGraphProgram, ResolvesConstantsAndVariables)
+{
+	ProgramGraph g;
+	const auto& program = g.graph.getProgram();
+
+	ASSERT_TRUE(program.tryGetConstant(g.number));
+	EXPECT_EQ(*program.tryGetConstant(g.number), *static_cast<const IScriptNodeType&>(g.graph.getNodes()[g.number].getNodeType()).getConstantValue(g.graph.getNodes()[g.number]));
+	EXPECT_EQ(program.tryGetConstant(g.number)->asInt(), 42);
+	EXPECT_EQ(program.tryGetConstant(g.text)->asString(), "hello");
+	EXPECT_FALSE(program.tryGetConstant(g.branch));
+	EXPECT_FALSE(program.tryGetConstant(g.flag));
+
+	const auto* flag = program.tryGetVariable(g.flag);
+	ASSERT_TRUE(flag);
+	EXPECT_TRUE(flag->id == ScriptVariableId("flag"));
+	EXPECT_EQ(flag->id.getHash(), ScriptVariableId("flag").getHash());
+	EXPECT_EQ(flag->scope, ScriptVariableScope::Local);
+	ASSERT_TRUE(program.tryGetVariable(g.lives));
+	EXPECT_EQ(program.tryGetVariable(g.lives)->id.getName(), "lives");
+	EXPECT_EQ(program.tryGetVariable(g.lives)->scope, ScriptVariableScope::Shared);
+	EXPECT_FALSE(program.tryGetVariable(g.setScore));
+	EXPECT_FALSE(program.tryGetVariable(g.branch));
+}
+
+TEST(HalleyScriptGraphProgram, RebuiltWhenGraphChanges)
+{
+	ProgramGraph g;
+	const auto* first = &g.graph.getProgram();
+	EXPECT_EQ(&g.graph.getProgram(), first);
+
+	g.graph.disconnectPin(g.branch, 2);
+	g.graph.finishGraph();
+
+	// Only built when types are assigned, so threads running the graph never build it
+	EXPECT_ANY_THROW(g.graph.getProgram());
+	g.graph.assignTypes(g.types);
+	const auto& program = g.graph.getProgram();
+	g.graph.assignTypes(g.types);
+	EXPECT_EQ(&g.graph.getProgram(), &program);
+	EXPECT_EQ(program.getGraphHash(), g.graph.getHash());
+	EXPECT_FALSE(program.getOutputNodes(g.branch, 1)[0].dstNode);
+	EXPECT_EQ(program.getOutputNodes(g.branch, 2)[0].dstNode, g.setLives);
+}
+
+TEST(HalleyScriptVariables, IdAndNameAccessAgree)
+{
+	ScriptVariables vars;
+	const auto score = ScriptVariableId("score");
+	vars.setVariable(score, ConfigNode(10));
+	vars.setVariable("lives", ConfigNode(3));
+
+	EXPECT_EQ(vars.getVariable("score").asInt(), 10);
+	EXPECT_EQ(vars.getVariable(ScriptVariableId("lives")).asInt(), 3);
+	EXPECT_TRUE(vars.hasVariable("score"));
+	EXPECT_FALSE(vars.hasVariable("scor"));
+	EXPECT_EQ(vars.getVariable("missing").getType(), ConfigNodeType::Undefined);
+
+	vars.setVariable("score", ConfigNode(11));
+	EXPECT_EQ(vars.getVariable(score).asInt(), 11);
+
+	const auto node = vars.toConfigNode(EntitySerializationContext());
+	EXPECT_EQ(node.asMap().size(), 2);
+	EXPECT_EQ(node["score"].asInt(), 11);
+	EXPECT_EQ(node["lives"].asInt(), 3);
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_world.h"
+
+#define DONT_INCLUDE_HALLEY_HPP
+#include "halley/entity/services/scripting_service.h"
+#include "halley/resources/asset_pack.h"
+#include "halley/resources/asset_database.h"
+#include "halley/resources/resource_locator.h"
+using namespace Halley;
+
+namespace {
+	std::thread makeThread(String name, std::function<void()> f)
+	{
+		return std::thread(std::move(f));
+	}
+
+	class MemoryReader final : public ResourceDataReader {
+	public:
+		explicit MemoryReader(Bytes bytes)
+			: bytes(std::move(bytes))
+		{}
+
+		size_t size() const override { return bytes.size(); }
+		void seek(int64_t p, int whence) override { pos = size_t(whence == SEEK_SET ? p : whence == SEEK_CUR ? int64_t(pos) + p : int64_t(bytes.size()) + p); }
+		size_t tell() const override { return pos; }
+		void close() override {}
+
+		int read(gsl::span<gsl::byte> dst) override
+		{
+			const size_t n = std::min(size_t(dst.size()), bytes.size() - std::min(pos, bytes.size()));
+			memcpy(dst.data(), bytes.data() + pos, n);
+			pos += n;
+			return int(n);
+		}
+
+	private:
+		Bytes bytes;
+		size_t pos = 0;
+	};
+
+	// Serves one in-memory pack to the resource locator
+	class PackSystemAPI final : public SystemAPI {
+	public:
+		explicit PackSystemAPI(Bytes pack)
+			: pack(std::move(pack))
+		{}
+
+		Path getAssetsPath(const Path& gamePath) const override { return {}; }
+		Path getUnpackedAssetsPath(const Path& gamePath) const override { return {}; }
+		std::unique_ptr<ResourceDataReader> getDataReader(String path, int64_t start, int64_t end) override { return std::make_unique<MemoryReader>(pack); }
+		std::unique_ptr<GLContext> createGLContext() override { return {}; }
+		std::shared_ptr<Window> createWindow(const WindowDefinition& window) override { return {}; }
+		void destroyWindow(std::shared_ptr<Window> window) override {}
+		Vector2i getScreenSize(int n) const override { return {}; }
+		Rect4i getDisplayRect(int screen) const override { return {}; }
+		void showCursor(bool show) override {}
+		std::shared_ptr<ISaveData> getStorageContainer(SaveDataType type, const String& containerName) override { return {}; }
+
+	private:
+		Bytes pack;
+
+		bool generateEvents(VideoAPI* video, InputAPI* input) override { return true; }
+	};
+
+	Bytes makeLuaPack()
+	{
+		AssetPack pack;
+		const String script = "return {}";
+		const auto location = pack.appendAsset(gsl::as_bytes(gsl::span<const char>(script.c_str(), script.size())), false);
+		pack.getAssetDatabase().addAsset("lua/halley/halley.lua", AssetType::BinaryFile, AssetDatabase::Entry(location, Metadata()));
+		return pack.writeOut();
+	}
+
+	// The Lua state needs the halley module, so the service gets a stub of it
+	class LuaResources {
+	public:
+		LuaResources()
+			: system(makeLuaPack())
+		{
+			api.system = &system;
+			auto locator = std::make_unique<ResourceLocator>(system);
+			locator->addPack(Path("test_pack.dat"));
+			resources = std::make_unique<Resources>(std::move(locator), api, ResourceOptions());
+			resources->init<BinaryFile>();
+		}
+
+		Resources& operator*() { return *resources; }
+
+	private:
+		PackSystemAPI system;
+		HalleyAPI api;
+		std::unique_ptr<Resources> resources;
+	};
+
+	// Records audio in the order the main environment plays it
+	class AudioLog final : public IAudioSystemInterface {
+	public:
+		void playAudio(const String& event, EntityId entityId) override { log.push_back(event + "@" + toString(entityId.value)); }
+		void playAudio(const String& event, WorldPosition position, std::optional<AudioRegionId> regionId) override {}
+		void setVariable(EntityId entityId, const String& variableName, float value) override { log.push_back(variableName + "@" + toString(entityId.value) + "=" + toString(value)); }
+		String getSourceName(AudioEmitterId id) const override { return {}; }
+		String getRegionName(AudioRegionId id) const override { return {}; }
+		void setRegionLookup(std::function<AudioRegionId(WorldPosition pos)> f) override {}
+
+		Vector<String> log;
+	};
+
+	struct Committed {
+		Vector<String> messages;
+		Vector<String> executionRequests;
+		Vector<String> audio;
+		Vector<size_t> finished;
+	};
+
+	// Every entry sends one of each side effect, and every third one has to run on the main environment
+	Committed runUpdate(ExecutionQueue& queue, size_t n)
+	{
+		TestWorld world;
+		LuaResources resources;
+		AudioLog audio;
+		world->setInterface<IAudioSystemInterface>(&audio);
+
+		auto nodeTypes = std::make_shared<ScriptNodeTypeCollection>();
+		auto makeEnvironment = [&] ()
+		{
+			return std::make_unique<ScriptEnvironment>(world.getAPI(), *world, *resources, nodeTypes);
+		};
+		ScriptingService service(makeEnvironment(), *resources);
+		service.setWorkerEnvironmentFactory(makeEnvironment);
+
+		Committed result;
+		std::atomic<size_t> nWorkerUpdates = 0;
+		auto& mainEnv = service.getEnvironment();
+		service.updateInParallel(queue, n, [&] (size_t i)
+		{
+			return i % 3 != 0;
+		}, [&] (ScriptEnvironment& env, size_t i)
+		{
+			if (&env != &mainEnv) {
+				++nWorkerUpdates;
+			}
+
+			const auto entityId = EntityId(int64_t(i + 1));
+			env.sendEntityMessage(ScriptEnvironment::EntityMessageData{ entityId, "message" + toString(i), ConfigNode() });
+			env.startScript(entityId, "script" + toString(i), {}, {});
+			env.postAudioEvent("event" + toString(i), entityId);
+			env.setAudioVariable(entityId, "variable", float(i));
+		}, [&] (size_t i)
+		{
+			result.finished.push_back(i);
+		});
+
+		EXPECT_EQ(nWorkerUpdates.load(), n - (n + 2) / 3);
+		for (auto& msg: mainEnv.getOutboundEntityMessages()) {
+			result.messages.push_back(msg.messageName + "@" + toString(msg.targetEntity.value));
+		}
+		for (auto& request: mainEnv.getScriptExecutionRequests()) {
+			result.executionRequests.push_back(request.value + "@" + toString(request.target.value));
+		}
+		result.audio = std::move(audio.log);
+		return result;
+	}
+}
+
+TEST(HalleyScriptingService, UpdateInParallelCommitsInOrder)
+{
+	constexpr size_t n = 200;
+
+	ExecutionQueue singleQueue;
+	const auto single = runUpdate(singleQueue, n);
+
+	ExecutionQueue queue;
+	ThreadPool pool("Test", queue, 4, makeThread);
+	const auto parallel = runUpdate(queue, n);
+
+	ASSERT_EQ(single.messages.size(), n);
+	ASSERT_EQ(single.executionRequests.size(), n);
+	ASSERT_EQ(single.audio.size(), 2 * n);
+	for (size_t i = 0; i < n; ++i) {
+		const auto id = toString(i + 1);
+		EXPECT_EQ(single.messages[i], "message" + toString(i) + "@" + id);
+		EXPECT_EQ(single.executionRequests[i], "script" + toString(i) + "@" + id);
+		EXPECT_EQ(single.audio[2 * i], "event" + toString(i) + "@" + id);
+		EXPECT_EQ(single.audio[2 * i + 1], "variable@" + id + "=" + toString(float(i)));
+		EXPECT_EQ(single.finished[i], i);
+	}
+
+	EXPECT_EQ(parallel.messages, single.messages);
+	EXPECT_EQ(parallel.executionRequests, single.executionRequests);
+	EXPECT_EQ(parallel.audio, single.audio);
+	EXPECT_EQ(parallel.finished, single.finished);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <halley.hpp>
+#include <iostream>
 using namespace Halley;
 
 namespace {
@@ -73,3 +74,134 @@ TEST(Serializer, UInt64Conversion)
 		EXPECT_EQ(n, convertBackAndForth(n));
 	}
 }
+
+namespace {
+	struct NestedMessage {
+		String name;
+		Bytes payload;
+
+		void serialize(Serializer& s) const
+		{
+			s << name;
+			s << Serializer::toBytes(payload, s.getOptions()); // Serializes recursively, borrowing a second pooled buffer
+		}
+	};
+}
+
+TEST(Serializer, SinglePassMatchesDryRunSize)
+{
+	const auto options = SerializerOptions(SerializerOptions::maxVersion);
+
+	ConfigNode::MapType map;
+	map["name"] = ConfigNode("player");
+	map["position"] = ConfigNode(Vector2f(12.5f, -3.0f));
+	map["ids"] = ConfigNode(ConfigNode::SequenceType({ ConfigNode(1), ConfigNode(200000), ConfigNode(-7) }));
+	const auto node = ConfigNode(std::move(map));
+
+	const auto bytes = Serializer::toBytes(node, options);
+	EXPECT_EQ(Serializer::getSize(node, options), bytes.size());
+
+	const auto result = Deserializer::fromBytes<ConfigNode>(bytes, options);
+	EXPECT_EQ(node, result);
+}
+
+TEST(Serializer, GrowableBufferReuse)
+{
+	Bytes buffer;
+	for (int i = 0; i < 3; ++i) {
+		Vector<String> strings;
+		for (int j = 0; j < 1000 * (i + 1); ++j) {
+			strings.push_back("entry " + toString(j));
+		}
+
+		Serializer::toBytes(strings, buffer);
+		EXPECT_EQ(Serializer::getSize(strings), buffer.size());
+		EXPECT_EQ(strings, Deserializer::fromBytes<Vector<String>>(buffer));
+	}
+}
+
+TEST(Serializer, ToSpan)
+{
+	std::array<gsl::byte, 16> buffer;
+	const auto size = Serializer::toSpan(String("hello"), buffer);
+	EXPECT_EQ(size_t(9), size);
+	EXPECT_EQ(String("hello"), Deserializer::fromBytes<String>(gsl::span<const gsl::byte>(buffer).subspan(0, size)));
+
+	EXPECT_THROW(Serializer::toSpan(String("this string is too long"), buffer), Exception);
+}
+
+TEST(Serializer, NestedPooledBuffers)
+{
+	NestedMessage msg;
+	msg.name = "nested";
+	msg.payload = Bytes(300, 42);
+
+	const auto bytes = Serializer::toBytes(msg);
+	Deserializer s(bytes);
+	String name;
+	Bytes inner;
+	s >> name >> inner;
+	EXPECT_EQ(msg.name, name);
+	EXPECT_EQ(Serializer::toBytes(msg.payload), inner);
+}
+
+namespace {
+	ConfigNode makeBenchmarkNode()
+	{
+		// Shaped like a batch of entity deltas: many small maps of mixed values
+		ConfigNode::SequenceType entities;
+		for (int i = 0; i < 200; ++i) {
+			ConfigNode::MapType entity;
+			entity["id"] = ConfigNode(i * 7919);
+			entity["name"] = ConfigNode("entity_" + toString(i));
+			entity["position"] = ConfigNode(Vector2f(float(i), float(-i) * 0.5f));
+			entity["flags"] = ConfigNode(ConfigNode::SequenceType({ ConfigNode(i % 3), ConfigNode(i % 5 == 0) }));
+			entities.push_back(ConfigNode(std::move(entity)));
+		}
+		return ConfigNode(std::move(entities));
+	}
+
+	template <typename F>
+	int64_t timePerIteration(int iterations, F f)
+	{
+		Stopwatch timer;
+		for (int i = 0; i < iterations; ++i) {
+			f();
+		}
+		timer.pause();
+		return timer.elapsedNanoseconds() / iterations;
+	}
+}
+
+// Run with --gtest_also_run_disabled_tests; prints the cost of each way of serializing a large message
+TEST(Serializer, DISABLED_BenchmarkToBytes)
+{
+	constexpr int iterations = 2000;
+	const auto options = SerializerOptions(SerializerOptions::maxVersion);
+	const auto node = makeBenchmarkNode();
+	const auto size = Serializer::getSize(node, options);
+	size_t totalSize = 0;
+
+	// What toBytes used to do: a dry run to measure, then a second pass into an exact-size buffer
+	const auto twoPass = timePerIteration(iterations, [&] ()
+	{
+		Bytes result(Serializer::getSize(node, options));
+		Serializer::toSpan(node, gsl::as_writable_bytes(gsl::span<Byte>(result)), options);
+		totalSize += result.size();
+	});
+
+	const auto singlePass = timePerIteration(iterations, [&] ()
+	{
+		totalSize += Serializer::toBytes(node, options).size();
+	});
+
+	Bytes buffer;
+	const auto reused = timePerIteration(iterations, [&] ()
+	{
+		Serializer::toBytes(node, buffer, options);
+		totalSize += buffer.size();
+	});
+
+	EXPECT_EQ(totalSize, size * iterations * 3);
+	std::cout << size << " byte message: " << twoPass << " ns two-pass, " << singlePass << " ns toBytes, " << reused << " ns toBytes into a reused buffer" << std::endl;
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	std::thread makeThread(String name, std::function<void()> f)
+	{
+		return std::thread(std::move(f));
+	}
+
+	Vector<SpritePainterEntry> makeEntries(size_t n)
+	{
+		// Few layers and tie breakers, so most of the order comes down to insertion order
+		Random rng(uint32_t(1234));
+		Vector<SpritePainterEntry> result;
+		result.reserve(n);
+		for (size_t i = 0; i < n; ++i) {
+			const int layer = rng.getInt(0, 3);
+			const float tieBreaker = float(rng.getInt(0, 7));
+			result.push_back(SpritePainterEntry(SpritePainterEntryType::Callback, i, 1, 1, layer, tieBreaker, i, {}));
+		}
+		return result;
+	}
+
+	Vector<uint32_t> getOrder(const Vector<SpritePainterEntry>& entries)
+	{
+		Vector<uint32_t> result;
+		for (const auto& e: entries) {
+			result.push_back(e.getIndex());
+		}
+		return result;
+	}
+}
+
+TEST(HalleySpritePainter, ParallelSortMatchesStdSort)
+{
+	ExecutionQueue queue;
+	ThreadPool pool("Test", queue, 4, makeThread);
+
+	for (const size_t n: { size_t(0), size_t(100), size_t(1000), size_t(12345) }) {
+		auto expected = makeEntries(n);
+		auto actual = expected;
+
+		std::sort(expected.begin(), expected.end());
+		Concurrent::parallel_sort(queue, actual.begin(), actual.end(), 64);
+
+		EXPECT_EQ(getOrder(actual), getOrder(expected)) << "Size " << n;
+	}
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	class TestSystem final : public System {
+	public:
+		TestSystem(SystemAccessInfo info)
+			: System({}, {})
+		{
+			setAccessInfo(std::move(info));
+		}
+	};
+
+	Vector<std::unique_ptr<System>> makeSystems(Vector<SystemAccessInfo> infos)
+	{
+		Vector<std::unique_ptr<System>> result;
+		for (auto& info: infos) {
+			result.push_back(std::make_unique<TestSystem>(std::move(info)));
+		}
+		return result;
+	}
+}
+
+TEST(HalleySystemScheduler, ReadersShareStage)
+{
+	auto systems = makeSystems({
+		SystemAccessInfo({ 1, 2 }, {}, {}, {}, 0),
+		SystemAccessInfo({ 1 }, { 3 }, {}, {}, 0),
+		SystemAccessInfo({ 2 }, { 4 }, {}, {}, 0)
+	});
+
+	SystemScheduler scheduler;
+	scheduler.build(systems);
+	EXPECT_EQ(scheduler.getNumStages(), 1);
+	EXPECT_EQ(scheduler.getStage(0).size(), 3);
+}
+
+TEST(HalleySystemScheduler, WritersAreOrdered)
+{
+	auto systems = makeSystems({
+		SystemAccessInfo({}, { 1 }, {}, {}, 0),
+		SystemAccessInfo({ 1 }, {}, {}, {}, 0),
+		SystemAccessInfo({}, { 2 }, {}, {}, 0),
+		SystemAccessInfo({}, { 1 }, { "Foo" }, {}, 0),
+		SystemAccessInfo({}, {}, {}, { "Foo" }, 0)
+	});
+
+	SystemScheduler scheduler;
+	scheduler.build(systems);
+	ASSERT_EQ(scheduler.getNumStages(), 4);
+	EXPECT_EQ(scheduler.getStage(0)[0], systems[0].get());
+	EXPECT_EQ(scheduler.getStage(0)[1], systems[2].get());
+	EXPECT_EQ(scheduler.getStage(1)[0], systems[1].get());
+	EXPECT_EQ(scheduler.getStage(2)[0], systems[3].get());
+	EXPECT_EQ(scheduler.getStage(3)[0], systems[4].get());
+}
+
+TEST(HalleySystemScheduler, ExclusiveSystemsRunAlone)
+{
+	auto systems = makeSystems({
+		SystemAccessInfo({ 1 }, {}, {}, {}, 0),
+		SystemAccessInfo(),
+		SystemAccessInfo({ 2 }, {}, {}, {}, 0),
+		SystemAccessInfo({ 3 }, {}, {}, {}, int(SystemAccessFlags::SendEntityMessages)),
+		SystemAccessInfo({ 4 }, {}, {}, {}, int(SystemAccessFlags::ReceiveEntityMessages))
+	});
+
+	SystemScheduler scheduler;
+	scheduler.build(systems);
+	ASSERT_EQ(scheduler.getNumStages(), 4);
+	EXPECT_EQ(scheduler.getStage(0).size(), 1);
+	EXPECT_EQ(scheduler.getStage(1)[0], systems[1].get());
+	EXPECT_EQ(scheduler.getStage(2).size(), 2);
+	EXPECT_EQ(scheduler.getStage(3)[0], systems[4].get());
+}
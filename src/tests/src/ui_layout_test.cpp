@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_ui_root.h"
+using namespace Halley;
+
+namespace {
+	// Counts how often it gets placed (getLayoutOriginPosition) and measured (getMinimumSize), and can scroll its contents
+	class CountingWidget : public UIWidget {
+	public:
+		mutable int layouts = 0;
+		mutable int measures = 0;
+
+		CountingWidget(String id, Vector2f minSize)
+			: UIWidget(std::move(id), minSize, UISizer(UISizerType::Vertical, 0))
+		{}
+
+		Vector2f getMinimumSize() const override
+		{
+			++measures;
+			return UIWidget::getMinimumSize();
+		}
+
+		Vector2f getLayoutOriginPosition() const override
+		{
+			++layouts;
+			return UIWidget::getLayoutOriginPosition() + offset;
+		}
+
+		// Same as a scroll pane: only moves the contents, so it doesn't need to measure anything again
+		void setOffset(Vector2f value)
+		{
+			offset = value;
+			markAsNeedingRelayout();
+		}
+
+		void resetCounts()
+		{
+			layouts = 0;
+			measures = 0;
+		}
+
+	private:
+		Vector2f offset;
+	};
+
+	// Two top-level panels with two children each, stacked vertically
+	class LayoutTree {
+	public:
+		TestUIRoot root;
+		std::array<std::shared_ptr<CountingWidget>, 2> panels;
+		std::array<std::array<std::shared_ptr<CountingWidget>, 2>, 2> children;
+
+		LayoutTree()
+		{
+			for (int i = 0; i < 2; ++i) {
+				panels[i] = std::make_shared<CountingWidget>("panel" + toString(i), Vector2f());
+				panels[i]->setPosition(Vector2f(10.0f + 500.0f * i, 20.0f));
+				for (int j = 0; j < 2; ++j) {
+					children[i][j] = std::make_shared<CountingWidget>("child" + toString(i) + toString(j), Vector2f(50, 30));
+					panels[i]->add(children[i][j]);
+				}
+				root->addChild(panels[i]);
+			}
+			root.update();
+		}
+
+		void resetCounts()
+		{
+			for (int i = 0; i < 2; ++i) {
+				panels[i]->resetCounts();
+				for (auto& c: children[i]) {
+					c->resetCounts();
+				}
+			}
+		}
+
+		int getLayouts(int panel) const
+		{
+			return panels[panel]->layouts + children[panel][0]->layouts + children[panel][1]->layouts;
+		}
+
+		int getMeasures(int panel) const
+		{
+			return panels[panel]->measures + children[panel][0]->measures + children[panel][1]->measures;
+		}
+	};
+}
+
+TEST(HalleyUILayout, InitialLayout)
+{
+	LayoutTree tree;
+	EXPECT_EQ(tree.panels[0]->getRect(), Rect4f(10, 20, 50, 60));
+	EXPECT_EQ(tree.children[0][0]->getRect(), Rect4f(10, 20, 50, 30));
+	EXPECT_EQ(tree.children[0][1]->getRect(), Rect4f(10, 50, 50, 30));
+	EXPECT_EQ(tree.children[1][1]->getRect(), Rect4f(510, 50, 50, 30));
+}
+
+TEST(HalleyUILayout, CleanSubtreesAreSkipped)
+{
+	LayoutTree tree;
+	tree.resetCounts();
+
+	// Nothing changed
+	tree.root.update();
+	EXPECT_EQ(tree.getLayouts(0), 0);
+	EXPECT_EQ(tree.getLayouts(1), 0);
+	EXPECT_EQ(tree.getMeasures(0), 0);
+	EXPECT_EQ(tree.getMeasures(1), 0);
+
+	// Growing a child re-measures and re-places its own panel, and leaves the other one alone
+	tree.children[0][0]->setMinSize(Vector2f(50, 40));
+	tree.root.update();
+	EXPECT_GT(tree.getLayouts(0), 0);
+	EXPECT_GT(tree.children[0][0]->measures, 0);
+	EXPECT_EQ(tree.getLayouts(1), 0);
+	EXPECT_EQ(tree.getMeasures(1), 0);
+	EXPECT_EQ(tree.panels[0]->getRect(), Rect4f(10, 20, 50, 70));
+	EXPECT_EQ(tree.children[0][1]->getRect(), Rect4f(10, 60, 50, 30));
+
+	// Its sibling didn't change, so its minimum size is still cached
+	EXPECT_EQ(tree.children[0][1]->measures, 0);
+
+	tree.resetCounts();
+	tree.root.update();
+	EXPECT_EQ(tree.getLayouts(0), 0);
+	EXPECT_EQ(tree.getMeasures(0), 0);
+}
+
+TEST(HalleyUILayout, RelayoutRepositionsChildren)
+{
+	LayoutTree tree;
+	tree.resetCounts();
+
+	// Scrolling the panel's contents moves the children without measuring anything again
+	tree.panels[0]->setOffset(Vector2f(0, -15));
+	tree.root.update();
+	EXPECT_EQ(tree.children[0][0]->getRect(), Rect4f(10, 5, 50, 30));
+	EXPECT_EQ(tree.children[0][1]->getRect(), Rect4f(10, 35, 50, 30));
+	EXPECT_EQ(tree.panels[0]->getRect(), Rect4f(10, 20, 50, 60));
+	EXPECT_EQ(tree.getMeasures(0), 0);
+	EXPECT_EQ(tree.getLayouts(1), 0);
+
+	// Moving a panel moves everything in it
+	tree.resetCounts();
+	tree.panels[1]->setPosition(Vector2f(600, 100));
+	tree.root.update();
+	EXPECT_EQ(tree.panels[1]->getRect(), Rect4f(600, 100, 50, 60));
+	EXPECT_EQ(tree.children[1][0]->getRect(), Rect4f(600, 100, 50, 30));
+	EXPECT_EQ(tree.children[1][1]->getRect(), Rect4f(600, 130, 50, 30));
+	EXPECT_EQ(tree.getMeasures(1), 0);
+	EXPECT_EQ(tree.getLayouts(0), 0);
+
+	// Setting the same position again isn't a change
+	tree.resetCounts();
+	tree.panels[1]->setPosition(Vector2f(600, 100));
+	tree.root.update();
+	EXPECT_EQ(tree.getLayouts(1), 0);
+}
+
+TEST(HalleyUILayout, FullLayoutWhenRootChanges)
+{
+	LayoutTree tree;
+	tree.panels[1]->setAnchor(UIAnchor(Vector2f(1, 1), Vector2f(1, 1)));
+	tree.root.update();
+	tree.root.update();
+	EXPECT_EQ(tree.children[1][1]->getRect(), Rect4f(950, 970, 50, 30));
+	tree.resetCounts();
+
+	// A new root rect moves anchored widgets, which then place their contents again
+	tree.root->setRect(Rect4f(0, 0, 800, 600));
+	tree.root.update();
+	tree.root.update();
+	EXPECT_EQ(tree.panels[1]->getRect(), Rect4f(750, 540, 50, 60));
+	EXPECT_EQ(tree.children[1][0]->getRect(), Rect4f(750, 540, 50, 30));
+	EXPECT_EQ(tree.children[1][1]->getRect(), Rect4f(750, 570, 50, 30));
+	EXPECT_EQ(tree.getMeasures(1), 0);
+
+	// Widgets that didn't move don't need their subtrees placed again
+	EXPECT_EQ(tree.getLayouts(0), 0);
+
+	// Turning incremental layout off places everything, every frame
+	tree.root->setIncrementalLayout(false);
+	for (int i = 0; i < 2; ++i) {
+		tree.resetCounts();
+		tree.root.update();
+		EXPECT_EQ(tree.getLayouts(0), 3);
+		EXPECT_EQ(tree.getLayouts(1), 3);
+	}
+	EXPECT_EQ(tree.children[0][1]->getRect(), Rect4f(10, 50, 50, 30));
+	EXPECT_EQ(tree.children[1][1]->getRect(), Rect4f(750, 570, 50, 30));
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_ui_root.h"
+using namespace Halley;
+
+namespace {
+	// Counts how often its mouse rect is read, i.e. how often its bounds were recomputed
+	class BoundsWidget : public UIWidget {
+	public:
+		mutable int mouseRectReads = 0;
+
+		BoundsWidget(String id, Vector2f pos, Vector2f size)
+			: UIWidget(std::move(id), size)
+		{
+			setPosition(pos);
+		}
+
+		Rect4f getMouseRect() const override
+		{
+			++mouseRectReads;
+			return UIWidget::getMouseRect();
+		}
+	};
+
+	// What getMouseBounds should be, computed from scratch
+	std::optional<Rect4f> getReferenceBounds(const UIWidget& widget)
+	{
+		if (!widget.canPropagateMouseToChildren()) {
+			return std::nullopt;
+		}
+
+		std::optional<Rect4f> result;
+		const auto add = [&] (Rect4f rect)
+		{
+			if (rect.getWidth() > 0 && rect.getHeight() > 0) {
+				result = result ? result->merge(rect) : rect;
+			}
+		};
+
+		add(widget.getMouseRect());
+		for (const auto& c: widget.getChildren()) {
+			if (c->isActive()) {
+				const auto childBounds = getReferenceBounds(*c);
+				if (!childBounds) {
+					return std::nullopt;
+				}
+				add(*childBounds);
+			}
+		}
+		return result.value_or(Rect4f(widget.getPosition(), widget.getPosition()));
+	}
+
+	// A 100x100 panel with children placed by hand (no sizer), one of them well outside of it
+	class BoundsTree {
+	public:
+		TestUIRoot root;
+		std::shared_ptr<BoundsWidget> panel = std::make_shared<BoundsWidget>("panel", Vector2f(0, 0), Vector2f(100, 100));
+		std::shared_ptr<BoundsWidget> a = std::make_shared<BoundsWidget>("a", Vector2f(10, 10), Vector2f(20, 20));
+		std::shared_ptr<BoundsWidget> b = std::make_shared<BoundsWidget>("b", Vector2f(300, 50), Vector2f(20, 20));
+
+		BoundsTree()
+		{
+			panel->addChild(a);
+			panel->addChild(b);
+			root->addChild(panel);
+			root.update();
+		}
+
+		void expectBounds(std::optional<Rect4f> expected)
+		{
+			root.update();
+			EXPECT_EQ(panel->getMouseBounds(), expected);
+			EXPECT_EQ(panel->getMouseBounds(), getReferenceBounds(*panel));
+			EXPECT_EQ(a->getMouseBounds(), getReferenceBounds(*a));
+			EXPECT_EQ(b->getMouseBounds(), getReferenceBounds(*b));
+		}
+	};
+}
+
+TEST(HalleyUIMouseBounds, CoversActiveDescendants)
+{
+	BoundsTree tree;
+	tree.expectBounds(Rect4f(0, 0, 320, 100));
+	EXPECT_EQ(tree.a->getMouseBounds(), Rect4f(10, 10, 20, 20));
+
+	// Children moving
+	tree.b->setPosition(Vector2f(50, 200));
+	tree.expectBounds(Rect4f(0, 0, 100, 220));
+
+	// Children growing
+	tree.a->setShrinkOnLayout(true);
+	tree.a->setMinSize(Vector2f(150, 20));
+	tree.expectBounds(Rect4f(0, 0, 160, 220));
+	tree.a->setMinSize(Vector2f(20, 20));
+	tree.expectBounds(Rect4f(0, 0, 100, 220));
+
+	// Grandchildren being added, hidden and removed
+	auto grandChild = std::make_shared<BoundsWidget>("grandChild", Vector2f(-50, -50), Vector2f(10, 10));
+	tree.a->addChild(grandChild);
+	tree.expectBounds(Rect4f(-50, -50, 150, 270));
+	EXPECT_EQ(tree.a->getMouseBounds(), Rect4f(-50, -50, 80, 80));
+
+	grandChild->setActive(false);
+	tree.expectBounds(Rect4f(0, 0, 100, 220));
+	grandChild->setActive(true);
+	tree.expectBounds(Rect4f(-50, -50, 150, 270));
+
+	grandChild->destroy();
+	tree.expectBounds(Rect4f(0, 0, 100, 220));
+	EXPECT_EQ(tree.a->getMouseBounds(), Rect4f(10, 10, 20, 20));
+}
+
+TEST(HalleyUIMouseBounds, ClipAndPropagation)
+{
+	BoundsTree tree;
+
+	// Clipping applies to the whole subtree, and fully clipped widgets don't count
+	tree.panel->setMouseClip(Rect4f(0, 0, 60, 60), false);
+	tree.expectBounds(Rect4f(0, 0, 60, 60));
+	tree.panel->setMouseClip(Rect4f(20, 20, 300, 300), false);
+	tree.expectBounds(Rect4f(20, 20, 300, 80));
+	EXPECT_EQ(tree.a->getMouseBounds(), Rect4f(20, 20, 10, 10));
+	tree.panel->setMouseClip(std::nullopt, false);
+	tree.expectBounds(Rect4f(0, 0, 320, 100));
+
+	// Widgets that don't propagate the mouse get every mouse position, and so do their ancestors
+	tree.a->setPropagateMouseToChildren(false);
+	tree.expectBounds(std::nullopt);
+	EXPECT_EQ(tree.a->getMouseBounds(), std::nullopt);
+	tree.a->setPropagateMouseToChildren(true);
+	tree.expectBounds(Rect4f(0, 0, 320, 100));
+}
+
+TEST(HalleyUIMouseBounds, OnlyChangedBranchesAreRecomputed)
+{
+	BoundsTree tree;
+	tree.panel->getMouseBounds();
+	const auto reset = [&] ()
+	{
+		tree.panel->mouseRectReads = 0;
+		tree.a->mouseRectReads = 0;
+		tree.b->mouseRectReads = 0;
+	};
+
+	// Cached while nothing changes
+	reset();
+	tree.root.update();
+	tree.panel->getMouseBounds();
+	tree.panel->getMouseBounds();
+	EXPECT_EQ(tree.panel->mouseRectReads, 0);
+	EXPECT_EQ(tree.a->mouseRectReads, 0);
+	EXPECT_EQ(tree.b->mouseRectReads, 0);
+
+	// Moving one child recomputes it and its ancestors, but not its sibling
+	tree.b->setPosition(Vector2f(300, 150));
+	tree.root.update();
+	EXPECT_EQ(tree.panel->getMouseBounds(), Rect4f(0, 0, 320, 170));
+	EXPECT_EQ(tree.panel->mouseRectReads, 1);
+	EXPECT_EQ(tree.b->mouseRectReads, 1);
+	EXPECT_EQ(tree.a->mouseRectReads, 0);
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_ui_root.h"
+#include "test_world.h"
+using namespace Halley;
+
+namespace {
+	// Remembers what it was last bound to
+	class RowWidget : public UIWidget {
+	public:
+		int index = -1;
+		int binds = 0;
+	};
+
+	// The default style needs a font, even if nothing here renders text
+	std::shared_ptr<UIStyleSheet> makeStyleSheet(Resources& resources, const ConfigFile& file)
+	{
+		resources.init<Font>();
+		resources.of<Font>().setResource(0, "Ubuntu Bold", std::make_shared<Font>("Ubuntu Bold", "", 10, 12, 12, 1, Vector2i(64, 64)));
+		return std::make_shared<UIStyleSheet>(resources, file, std::make_shared<UIColourScheme>());
+	}
+
+	ConfigFile makeStyleFile()
+	{
+		ConfigNode::MapType item;
+		item["normal"] = "";
+		item["hover"] = "";
+
+		ConfigNode::MapType list;
+		list["innerBorder"] = ConfigNode::SequenceType{ ConfigNode(0), ConfigNode(0), ConfigNode(0), ConfigNode(0) };
+		list["gap"] = 0;
+		list["background"] = "";
+		list["item"] = std::move(item);
+
+		ConfigNode::MapType styles;
+		styles["list"] = std::move(list);
+		ConfigNode::MapType root;
+		root["uiStyle"] = std::move(styles);
+		return ConfigFile(ConfigNode(std::move(root)));
+	}
+
+	// 1000 rows of 10 units, inside a scroll pane that shows 100 units
+	class VirtualListView {
+	public:
+		TestWorld world;
+		ConfigFile styleFile = makeStyleFile();
+		std::shared_ptr<UIStyleSheet> styleSheet = makeStyleSheet(world.getResources(), styleFile);
+		TestUIRoot root;
+		std::shared_ptr<UIScrollPane> scrollPane;
+		std::shared_ptr<UIVirtualList> list;
+		int rowsMade = 0;
+		Vector<int> selectionEvents;
+
+		VirtualListView()
+		{
+			list = std::make_shared<UIVirtualList>("list", UIStyle("list", styleSheet), 10.0f, [this] ()
+			{
+				++rowsMade;
+				return std::make_shared<RowWidget>();
+			}, [] (UIWidget& row, int index)
+			{
+				auto& r = dynamic_cast<RowWidget&>(row);
+				r.index = index;
+				++r.binds;
+			});
+			list->setMinSize(Vector2f(200, 0));
+			list->setCount(1000);
+
+			scrollPane = std::make_shared<UIScrollPane>("scroll", Vector2f(200, 100), UISizer(UISizerType::Vertical, 0));
+			scrollPane->add(list);
+			scrollPane->setHandle(UIEventType::ListSelectionChanged, [this] (const UIEvent& event)
+			{
+				selectionEvents.push_back(event.getIntData());
+			});
+			root->addChild(scrollPane);
+			update();
+		}
+
+		void update()
+		{
+			// The first update spawns new rows, the second places them
+			root.update();
+			root.update();
+		}
+
+		void scrollTo(float y)
+		{
+			scrollPane->scrollTo(Vector2f(0, y));
+			update();
+		}
+
+		Vector<RowWidget*> getActiveRows() const
+		{
+			Vector<RowWidget*> result;
+			for (const auto& c: list->getChildren()) {
+				if (c->isActive()) {
+					result.push_back(&dynamic_cast<RowWidget&>(*c));
+				}
+			}
+			std::sort(result.begin(), result.end(), [] (const RowWidget* a, const RowWidget* b) { return a->index < b->index; });
+			return result;
+		}
+
+		RowWidget* getRow(int index) const
+		{
+			for (auto* row: getActiveRows()) {
+				if (row->index == index) {
+					return row;
+				}
+			}
+			return nullptr;
+		}
+
+		void expectShowing(int first, int last)
+		{
+			const auto rows = getActiveRows();
+			ASSERT_EQ(rows.size(), size_t(last - first));
+			for (int i = first; i < last; ++i) {
+				const auto* row = rows[i - first];
+				EXPECT_EQ(row->index, i);
+				EXPECT_EQ(row->getRect(), Rect4f(0, i * 10.0f - scrollPane->getScrollPosition().y, 200, 10));
+			}
+		}
+	};
+}
+
+TEST(HalleyUIVirtualList, OnlyVisibleRowsAreMade)
+{
+	VirtualListView view;
+	EXPECT_EQ(view.list->getRect(), Rect4f(0, 0, 200, 10000));
+	EXPECT_EQ(view.rowsMade, 10);
+	view.expectShowing(0, 10);
+}
+
+TEST(HalleyUIVirtualList, ScrollingRecyclesRows)
+{
+	VirtualListView view;
+	auto* row5 = view.getRow(5);
+	ASSERT_NE(row5, nullptr);
+
+	// Half a row in at each end, so one more row is needed
+	view.scrollTo(55);
+	view.expectShowing(5, 16);
+	EXPECT_EQ(view.rowsMade, 11);
+
+	// Rows that stayed in view weren't bound again
+	EXPECT_EQ(view.getRow(5), row5);
+	EXPECT_EQ(row5->binds, 1);
+
+	// Scrolling far away reuses the same widgets for different rows
+	view.scrollTo(5000);
+	view.expectShowing(500, 510);
+	EXPECT_EQ(view.rowsMade, 11);
+	EXPECT_EQ(view.list->getChildren().size(), 11);
+	EXPECT_EQ(row5->binds, 2);
+
+	view.scrollTo(9900);
+	view.expectShowing(990, 1000);
+	EXPECT_EQ(view.rowsMade, 11);
+
+	// Data changing binds the visible rows again
+	auto* row995 = view.getRow(995);
+	const int binds = row995->binds;
+	view.list->refresh();
+	view.update();
+	EXPECT_EQ(view.getRow(995), row995);
+	EXPECT_EQ(row995->binds, binds + 1);
+
+	// Shrinking the list clamps the scroll and drops the rows past the end
+	view.list->setCount(5);
+	view.update();
+	EXPECT_EQ(view.scrollPane->getScrollPosition().y, 0);
+	view.expectShowing(0, 5);
+}
+
+TEST(HalleyUIVirtualList, SelectionWhileScrolling)
+{
+	VirtualListView view;
+
+	// Clicking picks the row under the mouse wherever the list is scrolled to
+	view.scrollTo(55);
+	view.list->onClicked(Vector2f(5, 30), KeyMods::None);
+	EXPECT_EQ(view.list->getSelectedOption(), 8);
+	EXPECT_EQ(view.list->getOptionAt(Vector2f(5, 30)), 8);
+	EXPECT_EQ(view.list->getOptionAt(Vector2f(5, -56)), std::nullopt);
+
+	// Selecting a row out of view scrolls to it
+	view.list->setSelectedOption(700);
+	view.update();
+	EXPECT_EQ(view.list->getSelectedOption(), 700);
+	EXPECT_EQ(view.list->getSelectedOptionId(), "700");
+	EXPECT_NE(view.getRow(700), nullptr);
+	EXPECT_EQ(view.getRow(700)->getRect(), Rect4f(0, 90, 200, 10));
+
+	// Scrolling away doesn't change the selection, but shrinking the list past it does
+	view.scrollTo(0);
+	EXPECT_EQ(view.list->getSelectedOption(), 700);
+	EXPECT_EQ(view.getRow(700), nullptr);
+	view.list->setCount(300);
+	view.update();
+	EXPECT_EQ(view.list->getSelectedOption(), 299);
+
+	view.list->setCount(0);
+	view.update();
+	EXPECT_EQ(view.list->getSelectedOption(), -1);
+	EXPECT_TRUE(view.getActiveRows().empty());
+
+	EXPECT_EQ(view.selectionEvents, Vector<int>({ 8, 700, 299, -1 }));
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "test_world.h"
+using namespace Halley;
+
+TEST(HalleyWorld, ReloadedFlagIsCleared)
+{
+	TestWorld world;
+	auto entity = world->createEntity("entity");
+	world->spawnPending();
+
+	entity.setReloaded();
+	EXPECT_TRUE(entity.wasReloaded());
+	world->spawnPending();
+	EXPECT_FALSE(entity.wasReloaded());
+}
+
+TEST(HalleyWorld, ReloadedEntityDestroyedInSameBatch)
+{
+	TestWorld world;
+	auto entity = world->createEntity("entity");
+	auto other = world->createEntity("other");
+	world->spawnPending();
+	const auto id = entity.getEntityId();
+
+	other.setReloaded();
+	entity.setReloaded();
+	world->destroyEntity(entity);
+	world->spawnPending();
+	EXPECT_EQ(world->numEntities(), 1);
+	EXPECT_EQ(world->tryGetRawEntity(id), nullptr);
+	EXPECT_FALSE(other.wasReloaded());
+
+	// New entities may reuse the destroyed entity's memory and id, and must not inherit its pending reload
+	Vector<EntityRef> spawned;
+	for (int i = 0; i < 8; ++i) {
+		spawned.push_back(world->createEntity("new"));
+	}
+	world->spawnPending();
+	world->spawnPending();
+	for (auto& e: spawned) {
+		EXPECT_FALSE(e.wasReloaded());
+	}
+	EXPECT_EQ(world->numEntities(), 9);
+}
@@ -12,6 +12,7 @@ void InfiniCanvas::setScrollPosition(Vector2f pos)
 	auto newPos = (pos * zoom).round() / zoom;
 	if (scrollPos != newPos) {
 		scrollPos = newPos;
+		markAsNeedingRelayout();
 		onNewScrollPosition(scrollPos);
 	}
 }
@@ -101,6 +101,12 @@ namespace Halley
 		virtual void import(const ImportingAsset&, IAssetCollector&) {}
 		virtual int dropFrontCount() const { return importByExtension ? 0 : 1; }
 
+		// Asset types that must finish importing before any asset of this type starts, e.g. if this importer reads their output
+		virtual Vector<ImportAssetType> getDependencies() const { return {}; }
+
+		// Bump whenever this importer's output changes, so results cached from older versions aren't reused
+		virtual int getVersion() const { return 0; }
+
 		virtual String getAssetId(const Path& file, const std::optional<Metadata>& metadata) const
 		{
 			return file.dropFront(dropFrontCount()).string();
@@ -22,6 +22,7 @@ namespace Halley {
 		Vector<std::pair<Path, std::optional<Bytes>>> collectOutFiles();
 		const Vector<AssetResource>& getAssets() const;
 		const Vector<TimestampedPath>& getAdditionalInputs() const;
+		const Vector<uint64_t>& getAdditionalInputHashes() const;
 		
 	private:
 		const ImportingAsset& asset;
@@ -32,6 +33,7 @@ namespace Halley {
 		Vector<AssetResource> assets;
 		Vector<ImportingAsset> additionalAssets;
 		Vector<TimestampedPath> additionalInputs;
+		Vector<uint64_t> additionalInputHashes;
 		Vector<std::pair<Path, std::optional<Bytes>>> outFiles;
 
 		AssetResource& getAsset(const String& name, AssetType type, const Path& primaryInputFile = {});
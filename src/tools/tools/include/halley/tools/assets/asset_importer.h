@@ -16,6 +16,8 @@ namespace Halley
 		ImportAssetType getImportAssetType(const Path& path, bool skipRedundantTypes) const;
 		IAssetImporter& getRootImporter(const Path& path) const;
 		Vector<std::reference_wrapper<IAssetImporter>> getImporters(ImportAssetType type) const;
+		Vector<ImportAssetType> getDependencies(ImportAssetType type) const;
+		uint64_t getSignature() const;
 		const Vector<Path>& getAssetsSrc() const;
 
 	private:
@@ -23,6 +25,7 @@ namespace Halley
 		Vector<Path> assetsSrc;
 		bool importByExtension = false;
 		ConfigNode importerOptions;
+		uint64_t signature = 0;
 
 		void addImporter(Vector<std::unique_ptr<IAssetImporter>>& dst, std::unique_ptr<IAssetImporter> importer);
 	};
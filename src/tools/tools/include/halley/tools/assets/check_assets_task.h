@@ -56,6 +56,7 @@ namespace Halley
 		std::condition_variable condition;
 
 		std::optional<ReimportType> pendingReimport;
+		bool bypassImportCache = false; // Set while forcing a reimport, so everything is actually imported again
 
 		using AssetTable = HashMap<std::pair<ImportAssetType, String>, ImportAssetsDatabaseEntry>;
 
@@ -0,0 +1,57 @@
+#pragma once
+#include "halley/file/path.h"
+#include "import_assets_task.h"
+
+namespace Halley
+{
+	class AssetImporter;
+
+	// Local on-disk cache of import results, shared by every project on this machine.
+	// Entries are keyed by a hash of everything that goes into an import (inputs, metadata, importers and asset version),
+	// so assets with identical inputs are reused across checkouts and branch switches instead of being imported again.
+	class ImportArtifactCache
+	{
+	public:
+		ImportArtifactCache(Path root, size_t maxSize);
+
+		// HALLEY_IMPORT_CACHE if set (empty disables the cache), otherwise a directory under the user data dir
+		static Path getDefaultPath();
+
+		// HALLEY_IMPORT_CACHE_SIZE_MB if set, otherwise 4 GB
+		static size_t getDefaultMaxSize();
+
+		bool isEnabled() const;
+
+		std::optional<ImportAssetsTask::ImportResult> get(uint64_t key, const AssetImporter& importer) const;
+		void store(uint64_t key, const ImportAssetsTask::ImportResult& result, const AssetImporter& importer);
+
+		// Deletes the least recently used entries until the cache fits in its maximum size
+		void prune();
+
+	private:
+		struct AdditionalInput {
+			int srcIdx = 0;
+			Path path;
+			uint64_t hash = 0;
+
+			void serialize(Serializer& s) const;
+			void deserialize(Deserializer& s);
+		};
+
+		struct Entry {
+			Vector<AssetResource> out;
+			Vector<std::pair<Path, Bytes>> outFiles;
+			Vector<AdditionalInput> additionalInputs;
+
+			void serialize(Serializer& s) const;
+			void deserialize(Deserializer& s);
+		};
+
+		constexpr static int entryVersion = 1;
+
+		Path root;
+		size_t maxSize;
+
+		Path getEntryPath(uint64_t key) const;
+	};
+}
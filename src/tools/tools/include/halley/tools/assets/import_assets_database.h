@@ -18,12 +18,13 @@ namespace Halley
 	class AssetPath {
 	public:
 		AssetPath();
-		AssetPath(TimestampedPath path);
-		AssetPath(TimestampedPath path, Path dataPath);
+		AssetPath(TimestampedPath path, uint64_t contentHash = 0);
+		AssetPath(TimestampedPath path, Path dataPath, uint64_t contentHash = 0);
 
 		const Path& getPath() const;
 		const Path& getDataPath() const;
 		int64_t getTimestamp() const;
+		uint64_t getContentHash() const;
 
 		void serialize(Serializer& s) const;
 		void deserialize(Deserializer& s);
@@ -31,6 +32,7 @@ namespace Halley
 	private:
 		TimestampedPath path;
 		Path dataPath;
+		uint64_t contentHash = 0; // Hash of the file and its metas, 0 if unknown
 	};
 	
 	class ImportAssetsDatabaseEntry
@@ -40,6 +42,7 @@ namespace Halley
 		Path srcDir;
 		Vector<AssetPath> inputFiles;
 		Vector<TimestampedPath> additionalInputFiles; // These were requested by the importer, rather than enumerated directly
+		Vector<uint64_t> additionalInputHashes; // Content hash of each additional input file
 		Vector<AssetResource> outputFiles;
 		ImportAssetType assetType = ImportAssetType::Undefined;
 
@@ -66,8 +69,8 @@ namespace Halley
 		void deserialize(Deserializer& s);
 		int64_t getLatestTimestamp() const;
 
-		void addInputFile(TimestampedPath path);
-		void addInputFile(TimestampedPath path, Path dataPath);
+		void addInputFile(TimestampedPath path, uint64_t contentHash = 0);
+		void addInputFile(TimestampedPath path, Path dataPath, uint64_t contentHash = 0);
 	};
 
 	class ImportAssetsDatabase
@@ -85,6 +88,7 @@ namespace Halley
 		{
 		public:
 			std::array<int64_t, 3> timestamp;
+			uint64_t contentHash = 0;
 			Metadata metadata;
 			Path basePath;
 			bool missing = false; // Not serialized
@@ -102,7 +106,8 @@ namespace Halley
 		std::unique_ptr<AssetDatabase> makeAssetDatabase(const String& platform) const;
 
 		bool needToLoadInputMetadata(const Path& path, std::array<int64_t, 3> timestamps) const;
-		void setInputFileMetadata(const Path& path, std::array<int64_t, 3> timestamps, const Metadata& data, Path basePath);
+		void setInputFileMetadata(const Path& path, std::array<int64_t, 3> timestamps, uint64_t contentHash, const Metadata& data, Path basePath);
+		uint64_t getInputFileHash(const Path& path) const;
 		std::optional<Metadata> getMetadata(const Path& path) const;
 		std::optional<Metadata> getMetadata(AssetType type, const String& assetId) const;
 
@@ -136,6 +141,9 @@ namespace Halley
 		void deserialize(Deserializer& s);
 
 		void setPlatforms(Vector<String> platforms);
+		uint64_t getConfigurationHash() const;
+
+		static uint64_t hashFiles(gsl::span<const Path> paths);
 
 	private:
 		Vector<String> platforms;
@@ -151,10 +159,12 @@ namespace Halley
 
 		mutable std::map<std::pair<AssetType, String>, const AssetEntry*> assetIndex;
 		mutable bool indexDirty = true;
+		mutable HashMap<String, std::pair<int64_t, uint64_t>> fileHashCache; // Timestamp and hash of additional input files, saved with the database
 	
 		mutable std::mutex mutex;
 
 		const AssetEntry* findEntry(AssetType type, const String& id) const;
 		std::unique_ptr<AssetDatabase> doMakeAssetDatabase(const String& platform) const;
+		uint64_t getFileHash(const Path& path, int64_t timestamp) const;
 	};
 }
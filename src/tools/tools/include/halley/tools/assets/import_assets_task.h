@@ -10,6 +10,7 @@
 namespace Halley
 {
 	class Project;
+	class ImportArtifactCache;
 	
 	class ImportAssetsTask : public Task
 	{
@@ -18,12 +19,13 @@ namespace Halley
 			Vector<AssetResource> out;
 			Vector<std::pair<Path, std::optional<Bytes>>> outFiles;
 			Vector<TimestampedPath> additionalInputs;
+			Vector<uint64_t> additionalInputHashes;
 			bool success = false;
 			String errorMsg;
 		};
 		using MetadataFetchCallback = std::function<std::optional<Metadata>(const Path&)>;
 		
-		ImportAssetsTask(String taskName, ImportAssetsDatabase& db, std::shared_ptr<AssetImporter> importer, Path assetsPath, Vector<ImportAssetsDatabaseEntry> files, Vector<String> deletedAssets, Project& project, bool packAfter);
+		ImportAssetsTask(String taskName, ImportAssetsDatabase& db, std::shared_ptr<AssetImporter> importer, Path assetsPath, Vector<ImportAssetsDatabaseEntry> files, Vector<String> deletedAssets, Project& project, bool packAfter, bool useImportCache);
 
 	protected:
 		void run() override;
@@ -33,7 +35,9 @@ namespace Halley
 		std::shared_ptr<AssetImporter> importer;
 		Path assetsPath;
 		Project& project;
+		ImportArtifactCache* artifactCache = nullptr;
 		const bool packAfter;
+		const bool useImportCache; // If false, results are still stored in the cache, but never read from it
 
 		Vector<ImportAssetsDatabaseEntry> files;
 		Vector<String> deletedAssets;
@@ -41,16 +45,20 @@ namespace Halley
 		
 		std::atomic<int64_t> totalImportTime;
 		std::atomic<size_t> assetsImported{};
+		std::atomic<size_t> assetsFromCache{};
+		std::atomic<size_t> assetsStoredInCache{};
 		size_t assetsToImport{};
 
 		std::mutex mutex;
 		
 		std::string curFileLabel;
 
+		Vector<Vector<size_t>> makeImportStages() const;
 		bool doImportAsset(ImportAssetsDatabaseEntry& asset);
 
 		Vector<Path> loadFont(const ImportAssetsDatabaseEntry& asset, Path dstDir);
 		Vector<Path> genericImporter(const ImportAssetsDatabaseEntry& asset, Path dstDir);
 		ImportResult importAsset(const ImportAssetsDatabaseEntry& asset, const MetadataFetchCallback& metadataFetcher, const AssetImporter& importer, Path assetsPath, AssetCollector::ProgressReporter progressReporter = {});
+		uint64_t getCacheKey(const ImportingAsset& asset, const AssetImporter& importer) const;
 	};
 }
@@ -66,6 +66,7 @@ namespace Halley
 	public:
 		String name;
 		bool optional = false;
+		bool write = true;
 
 		ServiceSchema() = default;
 		ServiceSchema(const String& value);
@@ -98,6 +99,8 @@ namespace Halley
 		Vector<MessageReferenceSchema> systemMessages;
 		Vector<ServiceSchema> services;
 
+		bool isExclusive() const;
+
 		bool operator< (const SystemSchema& other) const;
 	};
 }
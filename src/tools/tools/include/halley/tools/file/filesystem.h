@@ -18,6 +18,7 @@ namespace Halley {
 		static bool createParentDir(const Path& p);
 
 		static int64_t getLastWriteTime(const Path& p);
+		static bool touch(const Path& p);
 		static bool isFile(const Path& p);
 		static bool isDirectory(const Path& p);
 
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "halley/tools/cli_tool.h"
+
+namespace Halley
+{
+	// Converts a trace written by ProfilerCapture::startStreaming() to Chrome's trace JSON
+	class ProfilerTraceTool : public CommandLineTool
+	{
+	public:
+		int run(Vector<std::string> args) override;
+	};
+}
@@ -21,6 +21,7 @@ namespace Halley
 	class IHalleyEntryPoint;
 	class ProjectLoader;
 	class ImportAssetsDatabase;
+	class ImportArtifactCache;
 
 	class HalleyStatics;
 	class IHalleyPlugin;
@@ -86,6 +87,7 @@ namespace Halley
 		ImportAssetsDatabase& getImportAssetsDatabase() const;
 		ImportAssetsDatabase& getCodegenDatabase() const;
 		ImportAssetsDatabase& getSharedCodegenDatabase() const;
+		ImportArtifactCache& getImportArtifactCache() const;
 		ECSData& getECSData();
 		ImportAssetType getImportAssetType(const Path& filePath) override;
 
@@ -194,6 +196,7 @@ namespace Halley
 		std::unique_ptr<ImportAssetsDatabase> importAssetsDatabase;
 		std::unique_ptr<ImportAssetsDatabase> codegenDatabase;
 		std::unique_ptr<ImportAssetsDatabase> sharedCodegenDatabase;
+		std::unique_ptr<ImportArtifactCache> importArtifactCache;
 		std::shared_ptr<AssetImporter> assetImporter;
 
 		std::unique_ptr<ProjectProperties> properties;
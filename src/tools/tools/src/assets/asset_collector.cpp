@@ -5,6 +5,7 @@
 #include "halley/support/logger.h"
 #include "halley/bytes/compression.h"
 #include "halley/utils/algorithm.h"
+#include "halley/utils/hash.h"
 
 using namespace Halley;
 
@@ -101,10 +102,15 @@ Bytes AssetCollector::readAdditionalFile(const Path& filePath)
 	for (const auto& path: assetsSrc) {
 		Path f = path / filePath;
 		if (FileSystem::exists(f)) {
-			if (!std_ex::contains_if(additionalInputs, [&] (const auto& e) { return e.first == f; })) {
-				additionalInputs.push_back(TimestampedPath(f, FileSystem::getLastWriteTime(f)));			
+			const bool known = std_ex::contains_if(additionalInputs, [&] (const auto& e) { return e.first == f; });
+			if (!known) {
+				additionalInputs.push_back(TimestampedPath(f, FileSystem::getLastWriteTime(f)));
 			}
-			return FileSystem::readFile(f);
+			auto data = FileSystem::readFile(f);
+			if (!known) {
+				additionalInputHashes.push_back(Hash::hash(data));
+			}
+			return data;
 		}
 	}
 	throw Exception("Unable to find asset dependency: \"" + filePath.getString() + "\"", HalleyExceptions::Tools);
@@ -129,3 +135,8 @@ const Vector<TimestampedPath>& AssetCollector::getAdditionalInputs() const
 {
 	return additionalInputs;
 }
+
+const Vector<uint64_t>& AssetCollector::getAdditionalInputHashes() const
+{
+	return additionalInputHashes;
+}
@@ -24,6 +24,9 @@
 #include "importers/render_graph_importer.h"
 #include "importers/script_graph_importer.h"
 #include "importers/ui_importer.h"
+#include "halley/utils/algorithm.h"
+#include "halley/utils/hash.h"
+#include "halley/version/version.h"
 
 using namespace Halley;
 
@@ -72,6 +75,24 @@ AssetImporter::AssetImporter(Project& project, Vector<Path> assetsSrc, ConfigNod
 			addImporter(importerSet, std::move(pluginImporter));
 		}
 	}
+
+	// Identifies this set of importers and their versions, so that cached import results are invalidated if they change
+	const auto halleyVersion = getHalleyVersion();
+	Hash::Hasher hasher;
+	hasher.feed(halleyVersion.major);
+	hasher.feed(halleyVersion.minor);
+	hasher.feed(halleyVersion.revision);
+	hasher.feed(importByExtension);
+	hasher.feed(Hash::hash(Serializer::toBytes(this->importerOptions)));
+	for (const auto& [type, importerSet]: importers) {
+		hasher.feed(int(type));
+		for (const auto& importer: importerSet) {
+			const IAssetImporter& ref = *importer;
+			hasher.feed(std::string_view(typeid(ref).name()));
+			hasher.feed(importer->getVersion());
+		}
+	}
+	signature = hasher.digest();
 }
 
 void AssetImporter::addImporter(Vector<std::unique_ptr<IAssetImporter>>& dst, std::unique_ptr<IAssetImporter> importer)
@@ -151,6 +172,29 @@ Vector<std::reference_wrapper<IAssetImporter>> AssetImporter::getImporters(Impor
 	throw Exception("Unknown asset type: " + toString(int(type)), HalleyExceptions::Tools);
 }
 
+Vector<ImportAssetType> AssetImporter::getDependencies(ImportAssetType type) const
+{
+	Vector<ImportAssetType> result;
+
+	const auto iter = importers.find(type);
+	if (iter != importers.end()) {
+		for (const auto& importer: iter->second) {
+			for (const auto dep: importer->getDependencies()) {
+				if (dep != type && !std_ex::contains(result, dep)) {
+					result.push_back(dep);
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+uint64_t AssetImporter::getSignature() const
+{
+	return signature;
+}
+
 const Vector<Path>& AssetImporter::getAssetsSrc() const
 {
 	return assetsSrc;
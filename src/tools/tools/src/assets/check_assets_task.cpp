@@ -124,7 +124,9 @@ void CheckAssetsTask::run()
 					project.getImportAssetsDatabase().clear();
 				}
 				const float rangeStart = hasCodeGen ? 0.1f : 0.0f;
+				bypassImportCache = curPendingReimport == ReimportType::ReimportAll;
 				importing |= importAll(project.getImportAssetsDatabase(), { project.getAssetsSrcPath(), project.getSharedAssetsSrcPath() }, true, project.getUnpackedAssetsPath(), "Importing assets", true, Range(rangeStart, 1.0f));
+				bypassImportCache = false;
 			}
 			setVisible(false);
 			while (hasPendingTasks()) {
@@ -209,13 +211,23 @@ bool CheckAssetsTask::doImportFile(ImportAssetsDatabase& db, AssetTable& assets,
 		privateMetaPath = {};
 	}
 
-	// Load metadata if needed
+	// Load metadata and hash contents if needed
 	if (db.needToLoadInputMetadata(filePath, timestamps)) {
 		Metadata meta = MetadataImporter::getMetaData(filePath, dirMetaPath, privateMetaPath);
 		if (skipGen) {
 			meta.set("skipGen", true);
 		}
-		db.setInputFileMetadata(filePath, timestamps, meta, srcPath);
+
+		Vector<Path> hashedFiles = { srcPath / filePath };
+		if (dirMetaPath) {
+			hashedFiles.push_back(dirMetaPath.value());
+		}
+		if (privateMetaPath) {
+			hashedFiles.push_back(privateMetaPath.value());
+		}
+		const auto contentHash = ImportAssetsDatabase::hashFiles(hashedFiles);
+
+		db.setInputFileMetadata(filePath, timestamps, contentHash, meta, srcPath);
 		dbChanged = true;
 	} else {
 		db.markInputPresent(filePath);
@@ -240,6 +252,7 @@ bool CheckAssetsTask::doImportFile(ImportAssetsDatabase& db, AssetTable& assets,
 
 	// Build timestamped path
 	auto input = TimestampedPath(filePath, std::max(timestamps[0], std::max(timestamps[1], timestamps[2])));
+	const auto inputHash = db.getInputFileHash(filePath);
 
 	// Build the asset
 	auto iter = assets.find(assetKey);
@@ -249,7 +262,7 @@ bool CheckAssetsTask::doImportFile(ImportAssetsDatabase& db, AssetTable& assets,
 		asset.assetId = assetId;
 		asset.assetType = assetImporter.getType();
 		asset.srcDir = srcPath;
-		asset.inputFiles.push_back(input);
+		asset.inputFiles.emplace_back(input, inputHash);
 
 		// Check all other input files for this asset
 		if (!isCodegen && additionalFilesToImport) {
@@ -271,10 +284,10 @@ bool CheckAssetsTask::doImportFile(ImportAssetsDatabase& db, AssetTable& assets,
 			throw Exception("AssetId conflict on " + assetId, HalleyExceptions::Tools);
 		}
 		if (asset.srcDir == srcPath) {
-			asset.addInputFile(input);
+			asset.addInputFile(input, inputHash);
 		} else {
 			auto relPath = (srcPath / input.first).makeRelativeTo(asset.srcDir);
-			asset.addInputFile(input, relPath);
+			asset.addInputFile(input, relPath, inputHash);
 
 			// Don't mix files from two different source paths
 			//throw Exception("Mixed source dir input for " + assetId, HalleyExceptions::Tools);
@@ -373,7 +386,7 @@ bool CheckAssetsTask::requestImport(ImportAssetsDatabase& db, AssetTable assets,
 	const bool hasImport = hasAssetsToImport(db, assets);
 	if (hasImport || !deletedAssets.empty()) {
 		auto toImport = hasImport ? getAssetsToImport(db, assets) : Vector<ImportAssetsDatabaseEntry>();
-		addPendingTask(std::make_unique<ImportAssetsTask>(taskName, db, projectAssetImporter, dstPath, std::move(toImport), std::move(deletedAssets), project, packAfter));
+		addPendingTask(std::make_unique<ImportAssetsTask>(taskName, db, projectAssetImporter, dstPath, std::move(toImport), std::move(deletedAssets), project, packAfter, !bypassImportCache));
 		return true;
 	}
 	return false;
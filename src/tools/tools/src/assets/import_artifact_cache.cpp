@@ -0,0 +1,215 @@
+#include "halley/tools/assets/import_artifact_cache.h"
+#include <cstdlib>
+#include <thread>
+#include "halley/tools/assets/asset_importer.h"
+#include "halley/tools/file/filesystem.h"
+#include "halley/bytes/byte_serializer.h"
+#include "halley/os/os.h"
+#include "halley/support/logger.h"
+#include "halley/text/string_converter.h"
+#include "halley/utils/hash.h"
+
+using namespace Halley;
+
+void ImportArtifactCache::AdditionalInput::serialize(Serializer& s) const
+{
+	s << srcIdx;
+	s << path;
+	s << hash;
+}
+
+void ImportArtifactCache::AdditionalInput::deserialize(Deserializer& s)
+{
+	s >> srcIdx;
+	s >> path;
+	s >> hash;
+}
+
+void ImportArtifactCache::Entry::serialize(Serializer& s) const
+{
+	s << entryVersion;
+	s << out;
+	s << outFiles;
+	s << additionalInputs;
+}
+
+void ImportArtifactCache::Entry::deserialize(Deserializer& s)
+{
+	int version;
+	s >> version;
+	if (version != entryVersion) {
+		throw Exception("Import cache entry version mismatch", HalleyExceptions::Tools);
+	}
+	s >> out;
+	s >> outFiles;
+	s >> additionalInputs;
+}
+
+ImportArtifactCache::ImportArtifactCache(Path root, size_t maxSize)
+	: root(std::move(root))
+	, maxSize(maxSize)
+{
+}
+
+Path ImportArtifactCache::getDefaultPath()
+{
+	if (const char* env = getenv("HALLEY_IMPORT_CACHE")) {
+		return Path(env);
+	}
+
+	const auto userDir = OS::get().getUserDataDir();
+	if (userDir.isEmpty()) {
+		return {};
+	}
+	return Path(userDir) / "halley" / "import_cache";
+}
+
+size_t ImportArtifactCache::getDefaultMaxSize()
+{
+	if (const char* env = getenv("HALLEY_IMPORT_CACHE_SIZE_MB"); env && String(env).isInteger()) {
+		return size_t(String(env).toInteger64()) * 1024 * 1024;
+	}
+	return size_t(4) * 1024 * 1024 * 1024;
+}
+
+bool ImportArtifactCache::isEnabled() const
+{
+	return !root.isEmpty();
+}
+
+std::optional<ImportAssetsTask::ImportResult> ImportArtifactCache::get(uint64_t key, const AssetImporter& importer) const
+{
+	if (!isEnabled()) {
+		return {};
+	}
+
+	const auto entryPath = getEntryPath(key);
+	const auto data = FileSystem::readFile(entryPath);
+	if (data.empty()) {
+		return {};
+	}
+
+	Entry entry;
+	try {
+		Deserializer::fromBytes(entry, data);
+	} catch (...) {
+		return {};
+	}
+
+	// Files requested by the importer aren't part of the key, so make sure they still match
+	const auto& srcPaths = importer.getAssetsSrc();
+	ImportAssetsTask::ImportResult result;
+	for (const auto& input: entry.additionalInputs) {
+		if (input.srcIdx < 0 || input.srcIdx >= int(srcPaths.size())) {
+			return {};
+		}
+		const auto path = srcPaths[input.srcIdx] / input.path;
+		const auto inputData = FileSystem::readFile(path);
+		if (inputData.empty() || Hash::hash(inputData) != input.hash) {
+			return {};
+		}
+		result.additionalInputs.push_back(TimestampedPath(path, FileSystem::getLastWriteTime(path)));
+		result.additionalInputHashes.push_back(input.hash);
+	}
+
+	result.out = std::move(entry.out);
+	result.outFiles.reserve(entry.outFiles.size());
+	for (auto& [path, bytes]: entry.outFiles) {
+		result.outFiles.emplace_back(std::move(path), std::move(bytes));
+	}
+	result.success = true;
+
+	// Pruning goes by last write time, so mark the entry as recently used
+	FileSystem::touch(entryPath);
+
+	return result;
+}
+
+void ImportArtifactCache::store(uint64_t key, const ImportAssetsTask::ImportResult& result, const AssetImporter& importer)
+{
+	if (!isEnabled() || !result.success) {
+		return;
+	}
+
+	Entry entry;
+	entry.out = result.out;
+
+	for (const auto& [path, bytes]: result.outFiles) {
+		if (!bytes) {
+			// Written directly by the importer, can't be cached
+			return;
+		}
+		entry.outFiles.emplace_back(path, bytes.value());
+	}
+
+	// Additional inputs are stored relative to the assets source path that contains them, so they're valid on other checkouts
+	const auto& srcPaths = importer.getAssetsSrc();
+	for (size_t i = 0; i < result.additionalInputs.size(); ++i) {
+		const auto& path = result.additionalInputs[i].first;
+		const auto srcIter = std::find_if(srcPaths.begin(), srcPaths.end(), [&] (const Path& src) { return path.getString().startsWith(src.getString()); });
+		if (srcIter == srcPaths.end() || i >= result.additionalInputHashes.size()) {
+			return;
+		}
+
+		AdditionalInput& input = entry.additionalInputs.emplace_back();
+		input.srcIdx = int(srcIter - srcPaths.begin());
+		input.path = path.makeRelativeTo(*srcIter);
+		input.hash = result.additionalInputHashes[i];
+	}
+
+	// Write to a temporary file and move it in place, so other processes sharing the cache never see a partial entry
+	const auto dst = getEntryPath(key);
+	const auto tmp = dst.replaceExtension(".tmp" + toString(std::hash<std::thread::id>()(std::this_thread::get_id()), 16));
+	if (FileSystem::writeFile(tmp, Serializer::toBytes(entry))) {
+		if (!FileSystem::rename(tmp, dst)) {
+			FileSystem::remove(tmp);
+		}
+	} else {
+		Logger::logWarning("Unable to write import cache entry \"" + dst.getNativeString() + "\"");
+	}
+}
+
+void ImportArtifactCache::prune()
+{
+	if (!isEnabled()) {
+		return;
+	}
+
+	struct FileInfo {
+		Path path;
+		int64_t lastWrite;
+		size_t size;
+	};
+
+	Vector<FileInfo> files;
+	size_t totalSize = 0;
+	for (const auto& file: FileSystem::enumerateDirectory(root)) {
+		const auto path = root / file;
+		files.push_back(FileInfo{ path, FileSystem::getLastWriteTime(path), FileSystem::fileSize(path) });
+		totalSize += files.back().size;
+	}
+	if (totalSize <= maxSize) {
+		return;
+	}
+
+	// Delete down to 90% of the maximum, so this doesn't run again on every import
+	const size_t targetSize = maxSize - maxSize / 10;
+	std::sort(files.begin(), files.end(), [] (const FileInfo& a, const FileInfo& b) { return a.lastWrite < b.lastWrite; });
+	size_t nRemoved = 0;
+	for (const auto& file: files) {
+		if (totalSize <= targetSize) {
+			break;
+		}
+		if (FileSystem::remove(file.path)) {
+			totalSize -= file.size;
+			++nRemoved;
+		}
+	}
+	Logger::logInfo("Pruned " + toString(nRemoved) + " entries from the import cache");
+}
+
+Path ImportArtifactCache::getEntryPath(uint64_t key) const
+{
+	const auto name = toString(key, 16, 16);
+	return root / name.substr(0, 2) / (name + ".bin");
+}
@@ -5,19 +5,22 @@
 #include "halley/tools/file/filesystem.h"
 #include "halley/tools/file/filesystem_cache.h"
 #include "halley/utils/algorithm.h"
+#include "halley/utils/hash.h"
 
 using namespace Halley;
 
 AssetPath::AssetPath()
 {}
 
-AssetPath::AssetPath(TimestampedPath path)
+AssetPath::AssetPath(TimestampedPath path, uint64_t contentHash)
 	: path(std::move(path))
+	, contentHash(contentHash)
 {}
 
-AssetPath::AssetPath(TimestampedPath path, Path dataPath)
+AssetPath::AssetPath(TimestampedPath path, Path dataPath, uint64_t contentHash)
 	: path(std::move(path))
 	, dataPath(std::move(dataPath))
+	, contentHash(contentHash)
 {}
 
 const Path& AssetPath::getPath() const
@@ -35,16 +38,23 @@ int64_t AssetPath::getTimestamp() const
 	return path.second;
 }
 
+uint64_t AssetPath::getContentHash() const
+{
+	return contentHash;
+}
+
 void AssetPath::serialize(Serializer& s) const
 {
 	s << path;
 	s << dataPath;
+	s << contentHash;
 }
 
 void AssetPath::deserialize(Deserializer& s)
 {
 	s >> path;
 	s >> dataPath;
+	s >> contentHash;
 }
 
 void ImportAssetsDatabaseEntry::serialize(Serializer& s) const
@@ -53,6 +63,7 @@ void ImportAssetsDatabaseEntry::serialize(Serializer& s) const
 	s << srcDir;
 	s << inputFiles;
 	s << additionalInputFiles;
+	s << additionalInputHashes;
 	s << outputFiles;
 	int t = int(assetType);
 	s << t;
@@ -64,6 +75,7 @@ void ImportAssetsDatabaseEntry::deserialize(Deserializer& s)
 	s >> srcDir;
 	s >> inputFiles;
 	s >> additionalInputFiles;
+	s >> additionalInputHashes;
 	s >> outputFiles;
 	int t;
 	s >> t;
@@ -82,17 +94,17 @@ int64_t ImportAssetsDatabaseEntry::getLatestTimestamp() const
 	return t;
 }
 
-void ImportAssetsDatabaseEntry::addInputFile(TimestampedPath path)
+void ImportAssetsDatabaseEntry::addInputFile(TimestampedPath path, uint64_t contentHash)
 {
 	if (!std_ex::contains_if(inputFiles, [&] (const AssetPath& entry) { return entry.getPath() == path.first; })) {
-		inputFiles.push_back(std::move(path));
+		inputFiles.emplace_back(std::move(path), contentHash);
 	}
 }
 
-void ImportAssetsDatabaseEntry::addInputFile(TimestampedPath path, Path dataPath)
+void ImportAssetsDatabaseEntry::addInputFile(TimestampedPath path, Path dataPath, uint64_t contentHash)
 {
 	if (!std_ex::contains_if(inputFiles, [&] (const AssetPath& entry) { return entry.getPath() == path.first; })) {
-		inputFiles.emplace_back(std::move(path), std::move(dataPath));
+		inputFiles.emplace_back(std::move(path), std::move(dataPath), contentHash);
 	}
 }
 
@@ -113,6 +125,7 @@ void ImportAssetsDatabase::InputFileEntry::serialize(Serializer& s) const
 	for (int i = 0; i < nTimestamps; ++i) {
 		s << timestamp[i];
 	}
+	s << contentHash;
 	s << metadata;
 	s << basePath;
 }
@@ -129,6 +142,7 @@ void ImportAssetsDatabase::InputFileEntry::deserialize(Deserializer& s)
 	for (int i = nTimestamps; i < int(timestamp.size()); ++i) {
 		timestamp[i] = 0;
 	}
+	s >> contentHash;
 	s >> metadata;
 	s >> basePath;
 }
@@ -169,6 +183,7 @@ void ImportAssetsDatabase::clear()
 	assetsImported.clear();
 	assetsFailed.clear();
 	assetIndex.clear();
+	fileHashCache.clear();
 }
 
 bool ImportAssetsDatabase::needToLoadInputMetadata(const Path& path, std::array<int64_t, 3> timestamps) const
@@ -191,17 +206,26 @@ bool ImportAssetsDatabase::needToLoadInputMetadata(const Path& path, std::array<
 	return false;
 }
 
-void ImportAssetsDatabase::setInputFileMetadata(const Path& path, std::array<int64_t, 3> timestamps, const Metadata& data, Path basePath)
+void ImportAssetsDatabase::setInputFileMetadata(const Path& path, std::array<int64_t, 3> timestamps, uint64_t contentHash, const Metadata& data, Path basePath)
 {
 	std::lock_guard<std::mutex> lock(mutex);
 
 	auto& input = inputFiles[path.toString()];
 	input.timestamp = timestamps;
+	input.contentHash = contentHash;
 	input.metadata = data;
 	input.basePath = std::move(basePath);
 	input.missing = false;
 }
 
+uint64_t ImportAssetsDatabase::getInputFileHash(const Path& path) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	const auto iter = inputFiles.find(path.toString());
+	return iter == inputFiles.end() ? 0 : iter->second.contentHash;
+}
+
 void ImportAssetsDatabase::markInputPresent(const Path& path)
 {
 	std::lock_guard<std::mutex> lock(mutex);
@@ -350,20 +374,28 @@ bool ImportAssetsDatabase::needsImporting(const ImportAssetsDatabaseEntry& asset
 			// File wasn't there before
 			return true;
 		} else if (result->getTimestamp() != i.getTimestamp()) {
-			// Timestamp changed
-			return true;
+			// Timestamp changed, but the contents might not have (e.g. after switching branches)
+			if (result->getContentHash() == 0 || result->getContentHash() != i.getContentHash()) {
+				return true;
+			}
 		}
 	}
 
 	// Any of the additional input files changed?
-	for (const auto& i: oldAsset.additionalInputFiles) {
+	const bool hasAdditionalHashes = oldAsset.additionalInputHashes.size() == oldAsset.additionalInputFiles.size();
+	for (size_t idx = 0; idx < oldAsset.additionalInputFiles.size(); ++idx) {
+		const auto& i = oldAsset.additionalInputFiles[idx];
 		if (!fsCache.exists(i.first)) {
 			// File removed
 			return true;
-		} else if (fsCache.getLastWriteTime(i.first) != i.second) {
-			// Timestamp changed
-			return true;
-		}		
+		}
+		const auto timestamp = fsCache.getLastWriteTime(i.first);
+		if (timestamp != i.second) {
+			// Timestamp changed, check contents
+			if (!hasAdditionalHashes || getFileHash(i.first, timestamp) != oldAsset.additionalInputHashes[idx]) {
+				return true;
+			}
+		}
 	}
 
 	// Have any of the output files gone missing?
@@ -598,6 +630,18 @@ void ImportAssetsDatabase::serialize(Serializer& s) const
 	s << platforms;
 	s << assetsImported;
 	s << inputFiles;
+
+	// Only keep hashes of files that are still additional inputs
+	HashMap<String, std::pair<int64_t, uint64_t>> hashes;
+	for (const auto& [key, entry]: assetsImported) {
+		for (const auto& input: entry.asset.additionalInputFiles) {
+			const auto path = input.first.getString();
+			if (const auto iter = fileHashCache.find(path); iter != fileHashCache.end()) {
+				hashes[path] = iter->second;
+			}
+		}
+	}
+	s << hashes;
 }
 
 void ImportAssetsDatabase::deserialize(Deserializer& s)
@@ -610,6 +654,7 @@ void ImportAssetsDatabase::deserialize(Deserializer& s)
 		if (platformsRead == platforms) {
 			s >> assetsImported;
 			s >> inputFiles;
+			s >> fileHashCache;
 			indexDirty = true;
 		}
 	}
@@ -623,6 +668,38 @@ void ImportAssetsDatabase::setPlatforms(Vector<String> platforms)
 	}
 }
 
+uint64_t ImportAssetsDatabase::getConfigurationHash() const
+{
+	Hash::Hasher hasher;
+	hasher.feed(version);
+	for (const auto& platform: platforms) {
+		hasher.feed(platform);
+	}
+	return hasher.digest();
+}
+
+uint64_t ImportAssetsDatabase::hashFiles(gsl::span<const Path> paths)
+{
+	Hash::Hasher hasher;
+	for (const auto& path: paths) {
+		const auto data = FileSystem::readFile(path);
+		hasher.feed(data.size());
+		hasher.feedBytes(data.byte_span());
+	}
+	return hasher.digest();
+}
+
+uint64_t ImportAssetsDatabase::getFileHash(const Path& path, int64_t timestamp) const
+{
+	// Assumes that the mutex is locked
+	auto& entry = fileHashCache[path.getString()];
+	if (entry.second == 0 || entry.first != timestamp) {
+		entry.first = timestamp;
+		entry.second = Hash::hash(FileSystem::readFile(path));
+	}
+	return entry.second;
+}
+
 const ImportAssetsDatabase::AssetEntry* ImportAssetsDatabase::findEntry(AssetType type, const String& id) const
 {
 	if (indexDirty) {
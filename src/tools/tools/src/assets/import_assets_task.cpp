@@ -11,16 +11,20 @@
 #include "halley/support/debug.h"
 #include "halley/tools/file/filesystem_cache.h"
 #include "halley/utils/algorithm.h"
+#include "halley/utils/hash.h"
+#include "halley/tools/assets/import_artifact_cache.h"
 
 using namespace Halley;
 
-ImportAssetsTask::ImportAssetsTask(String taskName, ImportAssetsDatabase& db, std::shared_ptr<AssetImporter> importer, Path assetsPath, Vector<ImportAssetsDatabaseEntry> files, Vector<String> deletedAssets, Project& project, bool packAfter)
+ImportAssetsTask::ImportAssetsTask(String taskName, ImportAssetsDatabase& db, std::shared_ptr<AssetImporter> importer, Path assetsPath, Vector<ImportAssetsDatabaseEntry> files, Vector<String> deletedAssets, Project& project, bool packAfter, bool useImportCache)
 	: Task(std::move(taskName), true, !files.empty(), { files.size() == 1 && files[0].assetId == ":codegen" ? "code" : "assets" })
 	, db(db)
 	, importer(std::move(importer))
 	, assetsPath(std::move(assetsPath))
 	, project(project)
+	, artifactCache(&project.getImportArtifactCache())
 	, packAfter(packAfter)
+	, useImportCache(useImportCache)
 	, files(std::move(files))
 	, deletedAssets(std::move(deletedAssets))
 	, totalImportTime(0)
@@ -33,40 +37,52 @@ void ImportAssetsTask::run()
 	auto lastSave = std::chrono::steady_clock::now();
 
 	assetsImported = 0;
+	assetsFromCache = 0;
+	assetsStoredInCache = 0;
 	assetsToImport = files.size();
-	Vector<Future<void>> tasks;
 
 	constexpr bool parallelImport = !Debug::isDebug();
+	std::mutex saveMutex;
 
-	for (size_t i = 0; i < files.size(); ++i) {
-		auto importFunc = [&, i] () {
-			if (isCancelled()) {
-				return;
-			}
+	// Each stage only starts once the previous one is done, so importers can rely on the output of the types they depend on
+	for (const auto& stage: makeImportStages()) {
+		Vector<Future<void>> tasks;
 
-			setProgressLabel(files[i].assetId);
-			if (doImportAsset(files[i])) {
-				++assetsImported;
-				setProgress(float(assetsImported) * 0.98f / float(assetsToImport));
-			}
+		for (const size_t i: stage) {
+			auto importFunc = [&, i] () {
+				if (isCancelled()) {
+					return;
+				}
 
-			auto now = std::chrono::steady_clock::now();
-			if (now - lastSave > 1s) {
-				db.save();
-				lastSave = now;
-			}
-		};
+				setProgressLabel(files[i].assetId);
+				if (doImportAsset(files[i])) {
+					++assetsImported;
+					setProgress(float(assetsImported) * 0.98f / float(assetsToImport));
+				}
 
-		if (parallelImport) {
-			tasks.push_back(Concurrent::execute(Executors::getCPUAux(), importFunc));
-		} else {
-			importFunc();
+				std::unique_lock<std::mutex> lock(saveMutex, std::try_to_lock);
+				auto now = std::chrono::steady_clock::now();
+				if (lock.owns_lock() && now - lastSave > 1s) {
+					db.save();
+					lastSave = now;
+				}
+			};
+
+			if (parallelImport) {
+				tasks.push_back(Concurrent::execute(Executors::getCPUAux(), importFunc));
+			} else {
+				importFunc();
+			}
 		}
-	}
 
-	Concurrent::whenAll(tasks.begin(), tasks.end()).wait();
+		Concurrent::whenAll(tasks.begin(), tasks.end()).wait();
+	}
 	db.save();
 
+	if (assetsStoredInCache > 0) {
+		artifactCache->prune();
+	}
+
 	if (!isCancelled()) {
 		setProgress(1.0f, "");
 
@@ -94,6 +110,47 @@ void ImportAssetsTask::run()
 	const Time realTime = timer.elapsedNanoseconds() / 1000000000.0;
 	const Time importTime = totalImportTime / 1000000000.0;
 	logInfo("Import took " + toString(realTime) + " seconds, on which " + toString(importTime) + " seconds of work were performed (" + toString(importTime / realTime) + "x realtime)");
+	if (assetsFromCache > 0) {
+		logInfo(toString(size_t(assetsFromCache)) + " of " + toString(assetsToImport) + " assets were retrieved from the import cache");
+	}
+}
+
+Vector<Vector<size_t>> ImportAssetsTask::makeImportStages() const
+{
+	// Each type goes in the stage after the last of its dependencies
+	std::map<ImportAssetType, size_t> typeStages;
+	Vector<ImportAssetType> visiting;
+	std::function<size_t(ImportAssetType)> getStage = [&] (ImportAssetType type) -> size_t
+	{
+		if (const auto iter = typeStages.find(type); iter != typeStages.end()) {
+			return iter->second;
+		}
+		if (std_ex::contains(visiting, type)) {
+			throw Exception("Circular dependency between importers of type " + toString(type), HalleyExceptions::Tools);
+		}
+
+		visiting.push_back(type);
+		size_t stage = 0;
+		for (const auto dep: importer->getDependencies(type)) {
+			stage = std::max(stage, getStage(dep) + 1);
+		}
+		visiting.pop_back();
+
+		typeStages[type] = stage;
+		return stage;
+	};
+
+	Vector<Vector<size_t>> stages;
+	for (size_t i = 0; i < files.size(); ++i) {
+		const auto stage = getStage(files[i].assetType);
+		if (stage >= stages.size()) {
+			stages.resize(stage + 1);
+		}
+		stages[stage].push_back(i);
+	}
+	std_ex::erase_if(stages, [] (const Vector<size_t>& stage) { return stage.empty(); });
+
+	return stages;
 }
 
 bool ImportAssetsTask::doImportAsset(ImportAssetsDatabaseEntry& asset)
@@ -106,6 +163,7 @@ bool ImportAssetsTask::doImportAsset(ImportAssetsDatabaseEntry& asset)
 	if (!result.success) {
 		logError("\"" + asset.assetId + "\" - " + result.errorMsg);
 		asset.additionalInputFiles = std::move(result.additionalInputs);
+		asset.additionalInputHashes = std::move(result.additionalInputHashes);
 		db.markFailed(asset);
 
 		return false;
@@ -153,6 +211,7 @@ bool ImportAssetsTask::doImportAsset(ImportAssetsDatabaseEntry& asset)
 
 	// Store output in db
 	asset.additionalInputFiles = std::move(result.additionalInputs);
+	asset.additionalInputHashes = std::move(result.additionalInputHashes);
 	asset.outputFiles = std::move(result.out);
 	db.markAsImported(asset);
 
@@ -189,6 +248,19 @@ ImportAssetsTask::ImportResult ImportAssetsTask::importAsset(const ImportAssetsD
 			}
 			importingAsset.inputFiles.emplace_back(ImportingAssetFile(f.getPath(), std::move(data), meta ? std::move(meta.value()) : Metadata()));
 		}
+
+		// Try the shared cache before doing any actual work
+		std::optional<uint64_t> cacheKey;
+		if (artifactCache && artifactCache->isEnabled() && asset.assetType != ImportAssetType::Codegen) {
+			cacheKey = getCacheKey(importingAsset, importer);
+			if (useImportCache) {
+				if (auto cached = artifactCache->get(cacheKey.value(), importer)) {
+					++assetsFromCache;
+					return std::move(cached.value());
+				}
+			}
+		}
+
 		toLoad.emplace_back(std::move(importingAsset));
 
 		// Import
@@ -205,6 +277,9 @@ ImportAssetsTask::ImportResult ImportAssetsTask::importAsset(const ImportAssetsD
 					for (const auto& i: collector.getAdditionalInputs()) {
 						result.additionalInputs.push_back(i);
 					}
+					for (const auto& h: collector.getAdditionalInputHashes()) {
+						result.additionalInputHashes.push_back(h);
+					}
 					throw;
 				}
 			}
@@ -224,9 +299,18 @@ ImportAssetsTask::ImportResult ImportAssetsTask::importAsset(const ImportAssetsD
 			for (const auto& i: collector.getAdditionalInputs()) {
 				result.additionalInputs.push_back(i);
 			}
+
+			for (const auto& h: collector.getAdditionalInputHashes()) {
+				result.additionalInputHashes.push_back(h);
+			}
 		}
 		
 		result.success = true;
+
+		if (cacheKey) {
+			artifactCache->store(cacheKey.value(), result, importer);
+			++assetsStoredInCache;
+		}
 	} catch (const Exception& e) {
 		result.errorMsg = e.getMessage();
 		result.success = false;
@@ -237,3 +321,19 @@ ImportAssetsTask::ImportResult ImportAssetsTask::importAsset(const ImportAssetsD
 
 	return result;
 }
+
+uint64_t ImportAssetsTask::getCacheKey(const ImportingAsset& asset, const AssetImporter& importer) const
+{
+	// Source paths are left out, so identical assets on different checkouts share the same key
+	Hash::Hasher hasher;
+	hasher.feed(db.getConfigurationHash());
+	hasher.feed(importer.getSignature());
+	hasher.feed(int(asset.assetType));
+	hasher.feed(asset.assetId);
+	for (const auto& file: asset.inputFiles) {
+		hasher.feed(file.name.getString());
+		hasher.feed(Hash::hash(file.data));
+		hasher.feed(Hash::hash(Serializer::toBytes(file.metadata)));
+	}
+	return hasher.digest();
+}
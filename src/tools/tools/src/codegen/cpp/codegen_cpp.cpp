@@ -273,10 +273,19 @@ Vector<String> CodegenCPP::generateComponentHeader(ComponentSchema component)
 		contents.push_back("template <typename T>");
 	}
 
+	// Fields sent over the network, in a fixed order so the binary network codec can refer to them by index
+	Vector<String> networkFieldNames;
+	for (const auto& m: component.members) {
+		if (std_ex::contains(m.serializationTypes, EntitySerialization::Type::Network)) {
+			networkFieldNames.push_back(m.name);
+		}
+	}
+
 	gen
 		.setAccessLevel(MemberAccess::Public)
 		.addMember(MemberSchema(TypeSchema("int", false, true, true), "componentIndex", toString(component.id)))
 		.addMember(MemberSchema(TypeSchema("char*", true, true, true), "componentName", component.name))
+		.addMember(MemberSchema(TypeSchema("std::array<const char*, " + toString(networkFieldNames.size()) + ">", false, true, true), "networkFieldNames", networkFieldNames))
 		.addBlankLine()
 		.addMembers(component.members)
 		.addBlankLine()
@@ -733,7 +742,10 @@ Vector<String> CodegenCPP::generateSystemHeader(SystemSchema& system, const Hash
 		.setAccessLevel(MemberAccess::Public)
 		.addCustomConstructor({}, {
 			VariableSchema(TypeSchema(""), "System", "{" + String::concatList(convert<FamilySchema, String>(system.families, [](auto& fam) { return "&" + fam.name + "Family"; }), ", ") + "}, {" + String::concatList(entityMsgsReceived, ", ") + "}")
-		}, { "static_assert(std::is_final_v<T>, \"System must be final.\");" })
+		}, {
+			"static_assert(std::is_final_v<T>, \"System must be final.\");",
+			"setAccessInfo(" + generateSystemAccessInfo(system) + ");"
+		})
 		.finish()
 		.writeTo(contents);
 
@@ -742,6 +754,48 @@ Vector<String> CodegenCPP::generateSystemHeader(SystemSchema& system, const Hash
 	return contents;
 }
 
+String CodegenCPP::generateSystemAccessInfo(const SystemSchema& system) const
+{
+	Vector<String> componentsRead;
+	Vector<String> componentsWritten;
+	for (const auto& fam: system.families) {
+		for (const auto& comp: fam.components) {
+			auto& dst = comp.write ? componentsWritten : componentsRead;
+			const auto index = comp.name + "Component::componentIndex";
+			if (!std_ex::contains(dst, index)) {
+				dst.push_back(index);
+			}
+		}
+	}
+
+	Vector<String> servicesRead;
+	Vector<String> servicesWritten;
+	for (const auto& service: system.services) {
+		(service.write ? servicesWritten : servicesRead).push_back("\"" + service.name + "\"");
+	}
+
+	Vector<String> flags;
+	if (system.isExclusive()) {
+		flags.push_back("Exclusive");
+	}
+	if ((int(system.access) & int(SystemAccess::API)) != 0) {
+		flags.push_back("API");
+	}
+	if (std::any_of(system.messages.begin(), system.messages.end(), [] (const auto& msg) { return msg.send; })) {
+		flags.push_back("SendEntityMessages");
+	}
+	if (std::any_of(system.messages.begin(), system.messages.end(), [] (const auto& msg) { return msg.receive; })) {
+		flags.push_back("ReceiveEntityMessages");
+	}
+	if (std::any_of(system.systemMessages.begin(), system.systemMessages.end(), [] (const auto& msg) { return msg.send; })) {
+		flags.push_back("SendSystemMessages");
+	}
+	const auto flagsStr = flags.empty() ? String("0") : String::concatList(convert<String, String>(flags, [] (const String& f) { return "int(Halley::SystemAccessFlags::" + f + ")"; }), " | ");
+
+	return "Halley::SystemAccessInfo({ " + String::concatList(componentsRead, ", ") + " }, { " + String::concatList(componentsWritten, ", ") + " }, { "
+		+ String::concatList(servicesRead, ", ") + " }, { " + String::concatList(servicesWritten, ", ") + " }, " + flagsStr + ")";
+}
+
 Vector<String> CodegenCPP::generateSystemStub(SystemSchema& system) const
 {
 	auto info = SystemInfo(system);
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <halley/file_formats/image.h>
 #include <gsl/assert>
+#include "halley/concurrency/concurrent.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -12,37 +13,132 @@
 using namespace Halley;
 
 namespace {
-	float getDistanceAt(const int* src, int srcW, int srcH, int xCentre, int yCentre, float radius)
-	{
-		auto getAlpha = [&](int x, int y) { return (src[x + y * srcW] & 0xFF000000) >> 24; };
-		bool isInside = getAlpha(xCentre, yCentre) > 127;
-		if (radius < 0.001f) {
-			return isInside ? 1.0f : 0.0f;
+	constexpr int noSite = std::numeric_limits<int>::max();
+
+	struct DistanceTransformScratch {
+		Vector<int> f;
+		Vector<int> d;
+		Vector<int> nearest;
+		Vector<int> v;
+		Vector<float> z;
+
+		void resize(int n)
+		{
+			f.resize(n);
+			d.resize(n);
+			nearest.resize(n);
+			v.resize(n);
+			z.resize(n + 1);
 		}
+	};
+
+	// Exact 1D squared Euclidean distance transform (Felzenszwalb & Huttenlocher), as the lower envelope of the parabolas
+	// rooted at every site. Entries of f equal to noSite aren't sites; if there are none, d is noSite everywhere.
+	void distanceTransform1D(DistanceTransformScratch& s, int n)
+	{
+		const auto* f = s.f.data();
+		auto* v = s.v.data();
+		auto* z = s.z.data();
+
+		int k = -1;
+		for (int q = 0; q < n; ++q) {
+			if (f[q] == noSite) {
+				continue;
+			}
 
-		int iRadius = int(ceil(radius));
-		int x0 = std::max(0, xCentre - iRadius);
-		int x1 = std::min(xCentre + iRadius, srcW - 1);
-		int y0 = std::max(0, yCentre - iRadius);
-		int y1 = std::min(yCentre + iRadius, srcH - 1);
-
-		int bestDistSqr = 2147483647;
-		for (int y = y0; y <= y1; y++) {
-			for (int x = x0; x <= x1; x++) {
-				bool thisInside = getAlpha(x, y) > 127;
-				if (isInside != thisInside) {
-					// Candidate for best neighbour
-					int distSqr = (x - xCentre) * (x - xCentre) + (y - yCentre) * (y - yCentre);
-					bestDistSqr = std::min(distSqr, bestDistSqr);
+			float intersection = -std::numeric_limits<float>::infinity();
+			while (k >= 0) {
+				const int64_t num = (int64_t(f[q]) + int64_t(q) * q) - (int64_t(f[v[k]]) + int64_t(v[k]) * v[k]);
+				intersection = float(num) / float(2 * (q - v[k]));
+				if (intersection > z[k]) {
+					break;
 				}
+				--k;
 			}
+			++k;
+			v[k] = q;
+			z[k] = k == 0 ? -std::numeric_limits<float>::infinity() : intersection;
+			z[k + 1] = std::numeric_limits<float>::infinity();
 		}
 
-		const float dist = float(sqrt(bestDistSqr));
-		const float normalDistance = (2 * dist - 1) / (2 * radius);
-		const float finalValue = 0.5f * (isInside ? 1.0f + normalDistance : 1.0f - normalDistance);
+		if (k < 0) {
+			std::fill_n(s.d.data(), n, noSite);
+			std::fill_n(s.nearest.data(), n, -1);
+			return;
+		}
 
-		return finalValue;
+		k = 0;
+		for (int q = 0; q < n; ++q) {
+			while (z[k + 1] < float(q)) {
+				++k;
+			}
+			const int dq = q - v[k];
+			s.d[q] = dq * dq + f[v[k]];
+			s.nearest[q] = v[k];
+		}
+	}
+
+	struct DistanceField {
+		Vector<int> distSqr;
+		Vector<int> nearestX;
+		Vector<int> nearestY;
+	};
+
+	// For every pixel, squared distance to (and position of) the closest pixel whose insideness differs from its own.
+	// Runs a column pass and then a row pass, both split across the CPU executor.
+	DistanceField computeDistanceField(gsl::span<const uint8_t> inside, int w, int h)
+	{
+		DistanceField result;
+		const size_t n = size_t(w) * size_t(h);
+		result.distSqr.resize(n);
+		result.nearestX.resize(n);
+		result.nearestY.resize(n);
+
+		// Each pixel looks for the opposite colour, so run the transform once per colour and keep the relevant half
+		for (const uint8_t siteValue: { uint8_t(0), uint8_t(1) }) {
+			Vector<int> colDist(n);
+			Vector<int> colNearestY(n);
+
+			constexpr int linesPerTask = 32;
+			Concurrent::parallel_for(0, size_t((w + linesPerTask - 1) / linesPerTask), 1, [&] (size_t task)
+			{
+				DistanceTransformScratch scratch;
+				scratch.resize(h);
+				const int x1 = std::min(int(task + 1) * linesPerTask, w);
+				for (int x = int(task) * linesPerTask; x < x1; ++x) {
+					for (int y = 0; y < h; ++y) {
+						scratch.f[y] = inside[x + y * w] == siteValue ? 0 : noSite;
+					}
+					distanceTransform1D(scratch, h);
+					for (int y = 0; y < h; ++y) {
+						colDist[x + y * w] = scratch.d[y];
+						colNearestY[x + y * w] = scratch.nearest[y];
+					}
+				}
+			});
+
+			Concurrent::parallel_for(0, size_t((h + linesPerTask - 1) / linesPerTask), 1, [&] (size_t task)
+			{
+				DistanceTransformScratch scratch;
+				scratch.resize(w);
+				const int y1 = std::min(int(task + 1) * linesPerTask, h);
+				for (int y = int(task) * linesPerTask; y < y1; ++y) {
+					const auto row = size_t(y) * w;
+					std::copy_n(colDist.data() + row, w, scratch.f.data());
+					distanceTransform1D(scratch, w);
+					for (int x = 0; x < w; ++x) {
+						if (inside[row + x] != siteValue) {
+							const int nx = scratch.nearest[x];
+							result.distSqr[row + x] = scratch.d[x];
+							result.nearestX[row + x] = nx;
+							result.nearestY[row + x] = nx >= 0 ? colNearestY[row + nx] : -1;
+						}
+					}
+				}
+			});
+		}
+
+		return result;
 	}
 
 	std::unique_ptr<Image> generateSDFInternal(Image& srcImg, Vector2i size, float radius)
@@ -53,6 +149,39 @@ namespace {
 		const int srcH = srcImg.getHeight();
 		const auto src = srcImg.getPixels4BPP();
 
+		auto getAlpha = [&](int x, int y) { return (src[x + y * srcW] & 0xFF000000) >> 24; };
+
+		Vector<uint8_t> inside(size_t(srcW) * size_t(srcH));
+		for (int y = 0; y < srcH; y++) {
+			for (int x = 0; x < srcW; x++) {
+				inside[x + y * srcW] = getAlpha(x, y) > 127 ? 1 : 0;
+			}
+		}
+		const auto field = computeDistanceField(inside, srcW, srcH);
+
+		const float srcRadius = radius * srcW / size.x;
+		const float maxDist = std::ceil(srcRadius) + 1.0f;
+		auto getDistanceAt = [&](int x, int y) -> float
+		{
+			const auto idx = x + y * srcW;
+			const bool isInside = inside[idx] != 0;
+			if (srcRadius < 0.001f) {
+				return isInside ? 1.0f : 0.0f;
+			}
+
+			// Sub-pixel refinement: the coverage of the closest opposite pixel tells how far into it the edge sits.
+			// On hard-edged images this is the same as assuming the edge halfway between the two pixel centres.
+			float dist = maxDist;
+			if (field.distSqr[idx] != noSite) {
+				const float coverage = getAlpha(field.nearestX[idx], field.nearestY[idx]) / 255.0f;
+				const float edgeOffset = isInside ? coverage : 1.0f - coverage;
+				dist = std::min(std::sqrt(float(field.distSqr[idx])) - 0.5f + edgeOffset, maxDist);
+			}
+
+			const float normalDistance = dist / srcRadius;
+			return 0.5f * (isInside ? 1.0f + normalDistance : 1.0f - normalDistance);
+		};
+
 		auto dstImg = std::make_unique<Image>(Image::Format::SingleChannel, size);
 
 		const int w = size.x;
@@ -62,21 +191,23 @@ namespace {
 		int texelW = srcW / w;
 		int texelH = srcH / h;
 
-		for (int y = 0; y < h; y++) {
+		Concurrent::parallel_for(0, size_t(h), 8, [&] (size_t row)
+		{
+			const int y = int(row);
 			for (int x = 0; x < w; x++) {
 				unsigned char* dst = &dstStart[x + y * w];
 				float distAcc = 0;
-				// For each sub-pixel, compute the distance to closest pixel of the opposite value
+				// For each sub-pixel, take the distance to closest pixel of the opposite value
 				// Then average it all
 				for (int j = 0; j < texelH; j++) {
 					for (int i = 0; i < texelW; i++) {
-						distAcc += getDistanceAt(src.data(), srcW, srcH, x * srcW / w + i, y * srcH / h + j, radius * srcW / w);
+						distAcc += getDistanceAt(x * srcW / w + i, y * srcH / h + j);
 					}
 				}
 				int distance = clamp(int(distAcc * 255 / (texelW * texelH)), 0, 255);
 				*dst = static_cast<unsigned char>(distance);
 			}
-		}
+		});
 
 		return dstImg;
 	}
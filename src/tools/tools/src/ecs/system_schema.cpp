@@ -27,12 +27,18 @@ MessageReferenceSchema::MessageReferenceSchema(String name, const String& parame
 
 ServiceSchema::ServiceSchema(const String& value)
 {
-	auto split = value.split(' ', 2);
+	auto split = value.split(' ');
 	if (!split.empty()) {
 		name = split[0];
 	}
-	if (split.size() >= 2) {
-		optional = split[1] == "optional";
+	for (size_t i = 1; i < split.size(); ++i) {
+		if (split[i] == "optional") {
+			optional = true;
+		} else if (split[i] == "read") {
+			write = false;
+		} else {
+			throw Exception("Unknown service descriptor: " + split[i] + ", in service " + name, HalleyExceptions::Resources);
+		}
 	}
 }
 
@@ -167,6 +173,13 @@ SystemSchema::SystemSchema(YAML::Node node, bool generate)
 	}
 }
 
+bool SystemSchema::isExclusive() const
+{
+	// Systems that can reach the world (or spawn parallel work of their own) can't be scheduled alongside others
+	const int exclusiveAccess = int(SystemAccess::World) | int(SystemAccess::MessageBridge);
+	return (int(access) & exclusiveAccess) != 0 || strategy == SystemStrategy::Parallel || language != CodegenLanguage::CPlusPlus;
+}
+
 bool SystemSchema::operator<(const SystemSchema& other) const
 {
 	return name < other.name;
@@ -49,6 +49,13 @@ int64_t FileSystem::getLastWriteTime(const Path& p)
 	return result.time_since_epoch().count();
 }
 
+bool FileSystem::touch(const Path& p)
+{
+	std::error_code ec;
+	last_write_time(getNative(p), file_time_type::clock::now(), ec);
+	return !ec;
+}
+
 bool FileSystem::isFile(const Path& p)
 {
 	return is_regular_file(getNative(p));
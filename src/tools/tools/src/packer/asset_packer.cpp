@@ -198,7 +198,6 @@ void AssetPacker::generatePack(Project& project, const String& packId, const Ass
 {
 	AssetPack pack;
 	AssetDatabase& db = pack.getAssetDatabase();
-	Bytes& data = pack.getData();
 	auto& fs = project.getFileSystemCache();
 
 	// Read old version of this pack, if available
@@ -244,13 +243,9 @@ void AssetPacker::generatePack(Project& project, const String& packId, const Ass
 			continue;
 		}
 		
-		// Read data into pack data
-		const size_t pos = data.size();
-		data.reserve(nextPowerOf2(pos + size));
-		data.resize(pos + size);
-		memcpy(data.data() + pos, fileData.data(), size);
-
-		db.addAsset(entry.name, entry.type, AssetDatabase::Entry(toString(pos) + ":" + toString(size), entry.metadata));
+		// Read data into pack data, compressing it if worthwhile
+		const auto location = pack.appendAsset(gsl::as_bytes(gsl::span<const Byte>(fileData)), true);
+		db.addAsset(entry.name, entry.type, AssetDatabase::Entry(location, entry.metadata));
 
 		progress(float(i) / float(n), packId);
 		i++;
@@ -274,7 +269,7 @@ void AssetPacker::generatePack(Project& project, const String& packId, const Ass
 	}
 
 	if (packed) {
-		Logger::logInfo("- Packed " + toString(packListing.getEntries().size()) + " entries on \"" + packId + "\" (" + String::prettySize(data.size()) + ").");
+		Logger::logInfo("- Packed " + toString(packListing.getEntries().size()) + " entries on \"" + packId + "\" (" + String::prettySize(pack.getData().size()) + ").");
 	} else {
 		throw Exception("Unable to write pack file " + dst.getNativeString(), HalleyExceptions::Tools);
 	}
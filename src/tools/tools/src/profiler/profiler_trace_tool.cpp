@@ -0,0 +1,28 @@
+#include "halley/tools/profiler/profiler_trace_tool.h"
+
+#include "halley/support/logger.h"
+#include "halley/support/profiler.h"
+#include "halley/text/string_converter.h"
+
+using namespace Halley;
+
+int ProfilerTraceTool::run(Vector<std::string> args)
+{
+	if (args.size() != 2) {
+		Logger::logError("Usage: halley-cmd profiler-trace input.trace output.json");
+		return 1;
+	}
+
+	const auto trace = ProfilerTrace(Path::readFile(Path(args[0])).byte_span());
+	if (trace.getDroppedEvents() > 0) {
+		Logger::logWarning(toString(trace.getDroppedEvents()) + " events were dropped while recording this trace.");
+	}
+
+	if (!Path::writeFile(Path(args[1]), trace.toChromeJSON())) {
+		Logger::logError("Unable to write " + args[1]);
+		return 1;
+	}
+
+	Logger::logInfo("Wrote " + toString(trace.getEvents().size()) + " events to " + args[1]);
+	return 0;
+}
@@ -22,11 +22,12 @@
 #include "halley/tools/codegen/codegen.h"
 #include "halley/tools/file/filesystem_cache.h"
 #include "halley/tools/project/project_comments.h"
+#include "halley/tools/assets/import_artifact_cache.h"
 #include "halley/utils/algorithm.h"
 
 using namespace Halley;
 
-constexpr static int currentAssetVersion = 157;
+constexpr static int currentAssetVersion = 159;
 constexpr static int currentCodegenVersion = Codegen::currentCodegenVersion;
 
 Project::Project(Path projectRootPath, Path halleyRootPath, Vector<String> disabledPlatforms)
@@ -49,6 +50,7 @@ Project::Project(Path projectRootPath, Path halleyRootPath, Vector<String> disab
 	importAssetsDatabase = std::make_unique<ImportAssetsDatabase>(getUnpackedAssetsPath(), getUnpackedAssetsPath() / "import.db", getUnpackedAssetsPath() / "assets.db", platforms, currentAssetVersion);
 	codegenDatabase = std::make_unique<ImportAssetsDatabase>(getGenPath(), getGenPath() / "import.db", getGenPath() / "assets.db", Vector<String>{ "" }, currentCodegenVersion + currentAssetVersion);
 	sharedCodegenDatabase = std::make_unique<ImportAssetsDatabase>(getSharedGenPath(), getSharedGenPath() / "import.db", getSharedGenPath() / "assets.db", Vector<String>{ "" }, currentCodegenVersion + currentAssetVersion);
+	importArtifactCache = std::make_unique<ImportArtifactCache>(ImportArtifactCache::getDefaultPath(), ImportArtifactCache::getDefaultMaxSize());
 }
 
 Project::~Project()
@@ -205,6 +207,11 @@ ImportAssetsDatabase& Project::getSharedCodegenDatabase() const
 	return *sharedCodegenDatabase;
 }
 
+ImportArtifactCache& Project::getImportArtifactCache() const
+{
+	return *importArtifactCache;
+}
+
 ECSData& Project::getECSData()
 {
 	if (!ecsData) {
@@ -10,6 +10,7 @@
 #include "halley/support/debug.h"
 #include "halley/tools/vs_project/vs_project_tool.h"
 #include "halley/tools/packer/asset_pack_inspector.h"
+#include "halley/tools/profiler/profiler_trace_tool.h"
 #include "halley/tools/project/write_version_tool.h"
 #include "halley/tools/runner/runner_tool.h"
 
@@ -23,6 +24,7 @@ CommandLineTools::CommandLineTools()
 	factories["makeFont"] = []() { return std::make_unique<MakeFontTool>(); };
 	factories["pack"] = []() { return std::make_unique<AssetPackerTool>(); };
 	factories["pack-inspector"] = []() { return std::make_unique<AssetPackInspectorTool>(); };
+	factories["profiler-trace"] = []() { return std::make_unique<ProfilerTraceTool>(); };
 	factories["vs_project"] = []() { return std::make_unique<VSProjectTool>(); };
 	factories["run"] = []() { return std::make_unique<RunnerTool>(); };
 	factories["write_version"] = []() { return std::make_unique<WriteVersionTool>(); };